@@ -21,10 +21,15 @@
 # THE SOFTWARE.
 
 
-from .datatype import datatype, MATCH
+from .datatype import datatype, MATCH, Categorical, Tail, Inline, Packed, categorical_size, categorical_reset, stats_snapshot
 from ._dataobject import dataobject, datastruct, astuple, asdict, clone, update, make, Factory
+from ._dataobject import asdicts, astuples, column, columns
+from ._dataobject import constructor_counts, arena, drain, deferred_pending, fieldgetter
+from ._dataobject import changed_fields, changes, reset_changes
+from ._dataobject import diff, diffs, patch
 from ._litelist import litelist, litelist_fromargs
 from ._litetuple import litetuple, mutabletuple
+from ._sizeof import deep_sizeof
 from .recordclass import recordclass
 from .typing import RecordClass
 from .dataclass import make_dataclass, make_structclass, make_class, join_dataclasses
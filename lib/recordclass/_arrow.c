@@ -0,0 +1,1015 @@
+// Copyright (c) «2015-2023» «Shibzukhov Zaur, szport at gmail dot com»
+
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software - recordclass library - and associated documentation files
+// (the "Software"), to deal in the Software without restriction, including
+// without limitation the rights to use, copy, modify, merge, publish, distribute,
+// sublicense, and/or sell copies of the Software, and to permit persons to whom
+// the Software is furnished to do so, subject to the following conditions:
+
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+
+#ifdef Py_LIMITED_API
+#undef Py_LIMITED_API
+#endif
+
+#include "Python.h"
+#include "_dataobject.h"
+
+#include <stdint.h>
+#include <string.h>
+
+// Arrow C Data Interface (https://arrow.apache.org/docs/format/CDataInterface.html)
+
+#ifndef ARROW_C_DATA_INTERFACE
+#define ARROW_C_DATA_INTERFACE
+
+#define ARROW_FLAG_DICTIONARY_ORDERED 1
+#define ARROW_FLAG_NULLABLE 2
+#define ARROW_FLAG_MAP_KEYS_SORTED 4
+
+struct ArrowSchema {
+    const char* format;
+    const char* name;
+    const char* metadata;
+    int64_t flags;
+    int64_t n_children;
+    struct ArrowSchema** children;
+    struct ArrowSchema* dictionary;
+    void (*release)(struct ArrowSchema*);
+    void* private_data;
+};
+
+struct ArrowArray {
+    int64_t length;
+    int64_t null_count;
+    int64_t offset;
+    int64_t n_buffers;
+    int64_t n_children;
+    const void** buffers;
+    struct ArrowArray** children;
+    struct ArrowArray* dictionary;
+    void (*release)(struct ArrowArray*);
+    void* private_data;
+};
+
+#endif
+
+#if PY_VERSION_HEX < 0x03080000
+#define PyObject_Vectorcall(func, args, nargs, kwnames) _PyObject_FastCall((func), (args), (nargs))
+#elif PY_VERSION_HEX < 0x03090000
+#define PyObject_Vectorcall _PyObject_Vectorcall
+#endif
+
+#define ARROW_SCHEMA_NAME "arrow_schema"
+#define ARROW_ARRAY_NAME "arrow_array"
+
+#define bitmap_get(bm, i) ((((const uint8_t*)(bm))[(i) >> 3] >> ((i) & 7)) & 1)
+#define bitmap_set(bm, i) (((uint8_t*)(bm))[(i) >> 3] |= (uint8_t)(1 << ((i) & 7)))
+
+static PyObject *__fields__name;
+static PyObject *__tail__name;
+static PyObject *__inline__name;
+
+static PyTypeObject *dataobject_type;
+static PyTypeObject *datastruct_type;
+static PyTypeObject *sparseproperty_type;
+static PyTypeObject *bitproperty_type;
+static PyTypeObject *inlineproperty_type;
+
+static PyObject *
+get_module_object(const char *modname, const char *attrname)
+{
+    PyObject *mod, *ob;
+
+    mod = PyImport_ImportModule(modname);
+    if (mod == NULL)
+        return NULL;
+    ob = PyObject_GetAttrString(mod, attrname);
+    Py_DECREF(mod);
+    return ob;
+}
+
+////////////////////////// layout of the class ///////////////////////////
+
+// The values of the fields are read and written directly in the slots of the
+// fields, so the class should be dataobject/datastruct with the plain layout:
+// the items of the Tail field follow the slots of the fields, the values of
+// the sparse and Packed fields aren't in the slots of the fields and the fields
+// of the Inline datastructs are flattened into them
+static int
+arrow_check_layout(PyObject *cls)
+{
+    PyTypeObject *tp = (PyTypeObject*)cls;
+    PyObject *plan;
+    Py_ssize_t i, n;
+
+    if (!PyType_Check(cls) ||
+            !(PyType_IsSubtype(tp, dataobject_type) || PyType_IsSubtype(tp, datastruct_type))) {
+        PyErr_SetString(PyExc_TypeError, "the class should be a subclass of dataobject or datastruct");
+        return -1;
+    }
+
+    if (_PyType_Lookup(tp, __tail__name)) {
+        PyErr_Format(PyExc_TypeError,
+                     "%s with Tail field can't be exported to arrow or imported from it", tp->tp_name);
+        return -1;
+    }
+
+    plan = _PyType_Lookup(tp, __inline__name);
+    if (plan == NULL)
+        return 0;
+    if (!PyTuple_Check(plan)) {
+        PyErr_SetString(PyExc_TypeError, "__inline__ should be a tuple");
+        return -1;
+    }
+    n = PyTuple_GET_SIZE(plan);
+    for (i = 0; i < n; i++) {
+        PyObject *entry = PyTuple_GET_ITEM(plan, i);
+        PyTypeObject *descr_type;
+        const char *what;
+
+        if (!PyTuple_Check(entry) || PyTuple_GET_SIZE(entry) != 2) {
+            PyErr_SetString(PyExc_TypeError, "invalid __inline__ entry");
+            return -1;
+        }
+        descr_type = Py_TYPE(PyTuple_GET_ITEM(entry, 1));
+        if (descr_type == sparseproperty_type)
+            what = "with sparse=True";
+        else if (descr_type == bitproperty_type)
+            what = "with Packed fields";
+        else if (descr_type == inlineproperty_type)
+            what = "with Inline fields";
+        else
+            continue;
+        PyErr_Format(PyExc_TypeError,
+                     "%s %s can't be exported to arrow or imported from it", tp->tp_name, what);
+        return -1;
+    }
+    return 0;
+}
+
+PyDoc_STRVAR(_check_layout_doc,
+"Check that the fields of the class can be exported to arrow or imported from it");
+
+static PyObject *
+_check_layout(PyObject *module, PyObject *cls)
+{
+    if (arrow_check_layout(cls) < 0)
+        return NULL;
+    Py_RETURN_NONE;
+}
+
+////////////////////////// release callbacks /////////////////////////////
+
+static void
+arrow_schema_release_child(struct ArrowSchema *schema)
+{
+    free(schema->private_data);
+    schema->private_data = NULL;
+    schema->release = NULL;
+}
+
+static void
+arrow_schema_release(struct ArrowSchema *schema)
+{
+    Py_ssize_t i;
+
+    for (i = 0; i < schema->n_children; i++) {
+        struct ArrowSchema *child = schema->children[i];
+        if (child->release)
+            child->release(child);
+    }
+    free(schema->private_data);
+    free(schema->children);
+    schema->children = NULL;
+    schema->private_data = NULL;
+    schema->release = NULL;
+}
+
+typedef struct {
+    void *buffers[3];
+} arrow_buffers;
+
+static void
+arrow_array_release_child(struct ArrowArray *array)
+{
+    arrow_buffers *p = (arrow_buffers*)array->private_data;
+
+    free(p->buffers[0]);
+    free(p->buffers[1]);
+    free(p->buffers[2]);
+    free(p);
+    array->private_data = NULL;
+    array->release = NULL;
+}
+
+static void
+arrow_array_release(struct ArrowArray *array)
+{
+    Py_ssize_t i;
+
+    for (i = 0; i < array->n_children; i++) {
+        struct ArrowArray *child = array->children[i];
+        if (child->release)
+            child->release(child);
+    }
+    free(array->private_data);
+    free(array->children);
+    free((void*)array->buffers);
+    array->buffers = NULL;
+    array->children = NULL;
+    array->private_data = NULL;
+    array->release = NULL;
+}
+
+static void
+arrow_schema_capsule_destructor(PyObject *capsule)
+{
+    struct ArrowSchema *schema = PyCapsule_GetPointer(capsule, ARROW_SCHEMA_NAME);
+
+    if (schema == NULL) {
+        PyErr_WriteUnraisable(capsule);
+        return;
+    }
+    if (schema->release)
+        schema->release(schema);
+    free(schema);
+}
+
+static void
+arrow_array_capsule_destructor(PyObject *capsule)
+{
+    struct ArrowArray *array = PyCapsule_GetPointer(capsule, ARROW_ARRAY_NAME);
+
+    if (array == NULL) {
+        PyErr_WriteUnraisable(capsule);
+        return;
+    }
+    if (array->release)
+        array->release(array);
+    free(array);
+}
+
+////////////////////////// export ////////////////////////////////////////
+
+static inline PyObject *
+_arrow_value(PyObject **src, Py_ssize_t i, Py_ssize_t j)
+{
+    // j >= 0: src is a sequence of rows and the value is the j-th field;
+    // j < 0: src is a column of values
+    if (j >= 0)
+        return PyDataObject_GET_VALUE(src[i], j);
+    else
+        return src[i];
+}
+
+static int
+arrow_build_child(struct ArrowArray *array, char fmt,
+                  PyObject **src, Py_ssize_t n, Py_ssize_t j)
+{
+    arrow_buffers *p;
+    uint8_t *validity = NULL;
+    Py_ssize_t i, bitmap_size = (n + 7) / 8;
+    int64_t null_count = 0;
+
+    p = (arrow_buffers*)calloc(1, sizeof(arrow_buffers));
+    if (p == NULL) {
+        PyErr_NoMemory();
+        return -1;
+    }
+
+    memset(array, 0, sizeof(struct ArrowArray));
+    array->length = n;
+    array->private_data = p;
+    array->buffers = (const void**)p->buffers;
+    array->release = arrow_array_release_child;
+
+    for (i = 0; i < n; i++) {
+        if (_arrow_value(src, i, j) != Py_None)
+            continue;
+        if (validity == NULL) {
+            validity = (uint8_t*)malloc(bitmap_size ? bitmap_size : 1);
+            if (validity == NULL) {
+                PyErr_NoMemory();
+                return -1;
+            }
+            memset(validity, 0xff, bitmap_size);
+            p->buffers[0] = validity;
+        }
+        validity[i >> 3] &= (uint8_t)~(1 << (i & 7));
+        null_count++;
+    }
+    array->null_count = null_count;
+
+    switch (fmt) {
+    case 'l': {
+        int64_t *data = (int64_t*)calloc(n ? n : 1, sizeof(int64_t));
+        if (data == NULL) {
+            PyErr_NoMemory();
+            return -1;
+        }
+        p->buffers[1] = data;
+        array->n_buffers = 2;
+        for (i = 0; i < n; i++) {
+            PyObject *v = _arrow_value(src, i, j);
+            if (v == Py_None)
+                continue;
+            data[i] = PyLong_AsLongLong(v);
+            if (data[i] == -1 && PyErr_Occurred())
+                return -1;
+        }
+        break;
+    }
+    case 'g': {
+        double *data = (double*)calloc(n ? n : 1, sizeof(double));
+        if (data == NULL) {
+            PyErr_NoMemory();
+            return -1;
+        }
+        p->buffers[1] = data;
+        array->n_buffers = 2;
+        for (i = 0; i < n; i++) {
+            PyObject *v = _arrow_value(src, i, j);
+            if (v == Py_None)
+                continue;
+            data[i] = PyFloat_AsDouble(v);
+            if (data[i] == -1.0 && PyErr_Occurred())
+                return -1;
+        }
+        break;
+    }
+    case 'b': {
+        uint8_t *data = (uint8_t*)calloc(bitmap_size ? bitmap_size : 1, 1);
+        if (data == NULL) {
+            PyErr_NoMemory();
+            return -1;
+        }
+        p->buffers[1] = data;
+        array->n_buffers = 2;
+        for (i = 0; i < n; i++) {
+            PyObject *v = _arrow_value(src, i, j);
+            int truth;
+            if (v == Py_None)
+                continue;
+            truth = PyObject_IsTrue(v);
+            if (truth < 0)
+                return -1;
+            if (truth)
+                bitmap_set(data, i);
+        }
+        break;
+    }
+    case 'u':
+    case 'z': {
+        int32_t *offsets = (int32_t*)malloc((n + 1) * sizeof(int32_t));
+        char *data;
+        Py_ssize_t size = 0, allocated = 64;
+
+        if (offsets == NULL) {
+            PyErr_NoMemory();
+            return -1;
+        }
+        p->buffers[1] = offsets;
+        data = (char*)malloc(allocated);
+        if (data == NULL) {
+            PyErr_NoMemory();
+            return -1;
+        }
+        p->buffers[2] = data;
+        array->n_buffers = 3;
+
+        offsets[0] = 0;
+        for (i = 0; i < n; i++) {
+            PyObject *v = _arrow_value(src, i, j);
+            const char *s;
+            Py_ssize_t len;
+
+            if (v == Py_None) {
+                offsets[i+1] = (int32_t)size;
+                continue;
+            }
+            if (fmt == 'u') {
+                s = PyUnicode_AsUTF8AndSize(v, &len);
+                if (s == NULL)
+                    return -1;
+            } else {
+                if (!PyBytes_Check(v)) {
+                    PyErr_Format(PyExc_TypeError,
+                                 "expected bytes, got %s", Py_TYPE(v)->tp_name);
+                    return -1;
+                }
+                s = PyBytes_AS_STRING(v);
+                len = PyBytes_GET_SIZE(v);
+            }
+            if (size + len > INT32_MAX) {
+                PyErr_SetString(PyExc_OverflowError,
+                                "column data exceeds 2GB: can't be exported with 32-bit offsets");
+                return -1;
+            }
+            if (size + len > allocated) {
+                char *tmp;
+                while (size + len > allocated)
+                    allocated += allocated / 2 + len;
+                tmp = (char*)realloc(data, allocated);
+                if (tmp == NULL) {
+                    PyErr_NoMemory();
+                    return -1;
+                }
+                p->buffers[2] = data = tmp;
+            }
+            memcpy(data + size, s, len);
+            size += len;
+            offsets[i+1] = (int32_t)size;
+        }
+        break;
+    }
+    default:
+        PyErr_Format(PyExc_TypeError, "unsupported arrow format '%c'", fmt);
+        return -1;
+    }
+
+    return 0;
+}
+
+static PyObject *
+arrow_export(PyObject *fields, PyObject *formats, PyObject **src,
+             Py_ssize_t n, int by_rows, PyObject **columns)
+{
+    struct ArrowSchema *schema = NULL;
+    struct ArrowArray *array = NULL;
+    PyObject *schema_capsule = NULL, *array_capsule = NULL;
+    Py_ssize_t i, n_fields = PyTuple_GET_SIZE(fields);
+
+    schema = (struct ArrowSchema*)calloc(1, sizeof(struct ArrowSchema));
+    if (schema == NULL)
+        return PyErr_NoMemory();
+    schema_capsule = PyCapsule_New(schema, ARROW_SCHEMA_NAME, arrow_schema_capsule_destructor);
+    if (schema_capsule == NULL) {
+        free(schema);
+        return NULL;
+    }
+
+    schema->format = "+s";
+    schema->name = "";
+    schema->release = arrow_schema_release;
+    schema->children = (struct ArrowSchema**)calloc(n_fields ? n_fields : 1, sizeof(struct ArrowSchema*));
+    schema->private_data = calloc(n_fields ? n_fields : 1, sizeof(struct ArrowSchema));
+    if (schema->children == NULL || schema->private_data == NULL) {
+        PyErr_NoMemory();
+        goto error;
+    }
+    for (i = 0; i < n_fields; i++) {
+        struct ArrowSchema *child = (struct ArrowSchema*)schema->private_data + i;
+        const char *name = PyUnicode_AsUTF8(PyTuple_GET_ITEM(fields, i));
+        const char *fmt = PyUnicode_AsUTF8(PyTuple_GET_ITEM(formats, i));
+        char *name_copy;
+
+        if (name == NULL || fmt == NULL)
+            goto error;
+        name_copy = strdup(name);
+        if (name_copy == NULL) {
+            PyErr_NoMemory();
+            goto error;
+        }
+        switch (fmt[0]) {
+            case 'l': child->format = "l"; break;
+            case 'g': child->format = "g"; break;
+            case 'b': child->format = "b"; break;
+            case 'u': child->format = "u"; break;
+            case 'z': child->format = "z"; break;
+            default:
+                free(name_copy);
+                PyErr_Format(PyExc_TypeError, "unsupported arrow format '%s'", fmt);
+                goto error;
+        }
+        child->name = name_copy;
+        child->private_data = name_copy;
+        child->flags = ARROW_FLAG_NULLABLE;
+        child->release = arrow_schema_release_child;
+        schema->children[i] = child;
+        schema->n_children = i + 1;
+    }
+
+    array = (struct ArrowArray*)calloc(1, sizeof(struct ArrowArray));
+    if (array == NULL) {
+        PyErr_NoMemory();
+        goto error;
+    }
+    array_capsule = PyCapsule_New(array, ARROW_ARRAY_NAME, arrow_array_capsule_destructor);
+    if (array_capsule == NULL) {
+        free(array);
+        goto error;
+    }
+
+    array->length = n;
+    array->n_buffers = 1;
+    array->release = arrow_array_release;
+    array->buffers = (const void**)calloc(1, sizeof(void*));
+    array->children = (struct ArrowArray**)calloc(n_fields ? n_fields : 1, sizeof(struct ArrowArray*));
+    array->private_data = calloc(n_fields ? n_fields : 1, sizeof(struct ArrowArray));
+    if (array->buffers == NULL || array->children == NULL || array->private_data == NULL) {
+        PyErr_NoMemory();
+        goto error;
+    }
+    for (i = 0; i < n_fields; i++) {
+        struct ArrowArray *child = (struct ArrowArray*)array->private_data + i;
+        int ret;
+
+        array->children[i] = child;
+        array->n_children = i + 1;
+        if (by_rows)
+            ret = arrow_build_child(child, schema->children[i]->format[0], src, n, i);
+        else
+            ret = arrow_build_child(child, schema->children[i]->format[0],
+                                    PySequence_Fast_ITEMS(columns[i]), n, -1);
+        if (ret < 0)
+            goto error;
+    }
+
+    return PyTuple_Pack(2, schema_capsule, array_capsule);
+
+error:
+    Py_XDECREF(array_capsule);
+    Py_XDECREF(schema_capsule);
+    return NULL;
+}
+
+static int
+check_fields_formats(PyObject *fields, PyObject *formats)
+{
+    if (!PyTuple_Check(fields)) {
+        PyErr_SetString(PyExc_TypeError, "__fields__ should be a tuple");
+        return -1;
+    }
+    if (!PyTuple_Check(formats) || PyTuple_GET_SIZE(formats) != PyTuple_GET_SIZE(fields)) {
+        PyErr_SetString(PyExc_TypeError, "formats should be a tuple with a format for each field");
+        return -1;
+    }
+    return 0;
+}
+
+PyDoc_STRVAR(_export_rows_doc,
+"Export a list of rows into a pair of arrow_schema/arrow_array capsules");
+
+static PyObject *
+_export_rows(PyObject *module, PyObject *args)
+{
+    PyObject *cls, *rows, *formats, *fields, *seq, *ret;
+    Py_ssize_t i, n;
+
+    if (!PyArg_ParseTuple(args, "OOO", &cls, &rows, &formats))
+        return NULL;
+    if (arrow_check_layout(cls) < 0)
+        return NULL;
+
+    fields = PyObject_GetAttr(cls, __fields__name);
+    if (fields == NULL)
+        return NULL;
+    if (check_fields_formats(fields, formats) < 0) {
+        Py_DECREF(fields);
+        return NULL;
+    }
+
+    seq = PySequence_Fast(rows, "rows should be iterable");
+    if (seq == NULL) {
+        Py_DECREF(fields);
+        return NULL;
+    }
+
+    n = PySequence_Fast_GET_SIZE(seq);
+    for (i = 0; i < n; i++) {
+        PyObject *row = PySequence_Fast_GET_ITEM(seq, i);
+        if (!PyObject_TypeCheck(row, (PyTypeObject*)cls)) {
+            PyErr_Format(PyExc_TypeError, "row %zd is not an instance of %s",
+                         i, ((PyTypeObject*)cls)->tp_name);
+            Py_DECREF(seq);
+            Py_DECREF(fields);
+            return NULL;
+        }
+    }
+
+    ret = arrow_export(fields, formats, PySequence_Fast_ITEMS(seq), n, 1, NULL);
+
+    Py_DECREF(seq);
+    Py_DECREF(fields);
+    return ret;
+}
+
+PyDoc_STRVAR(_export_columns_doc,
+"Export a batch of columns into a pair of arrow_schema/arrow_array capsules");
+
+static PyObject *
+_export_columns(PyObject *module, PyObject *args)
+{
+    PyObject *cls, *columns, *formats, *fields, *seq, *ret = NULL;
+    PyObject **cols = NULL;
+    Py_ssize_t i, n = 0, n_fields;
+
+    if (!PyArg_ParseTuple(args, "OOO", &cls, &columns, &formats))
+        return NULL;
+    if (arrow_check_layout(cls) < 0)
+        return NULL;
+
+    fields = PyObject_GetAttr(cls, __fields__name);
+    if (fields == NULL)
+        return NULL;
+    if (check_fields_formats(fields, formats) < 0) {
+        Py_DECREF(fields);
+        return NULL;
+    }
+
+    seq = PySequence_Fast(columns, "columns should be iterable");
+    if (seq == NULL) {
+        Py_DECREF(fields);
+        return NULL;
+    }
+
+    n_fields = PyTuple_GET_SIZE(fields);
+    if (PySequence_Fast_GET_SIZE(seq) != n_fields) {
+        PyErr_Format(PyExc_TypeError, "expected %zd columns, got %zd",
+                     n_fields, PySequence_Fast_GET_SIZE(seq));
+        goto done;
+    }
+
+    cols = (PyObject**)PyMem_Calloc(n_fields ? n_fields : 1, sizeof(PyObject*));
+    if (cols == NULL) {
+        PyErr_NoMemory();
+        goto done;
+    }
+    for (i = 0; i < n_fields; i++) {
+        cols[i] = PySequence_Fast(PySequence_Fast_GET_ITEM(seq, i), "column should be iterable");
+        if (cols[i] == NULL)
+            goto done;
+        if (i == 0)
+            n = PySequence_Fast_GET_SIZE(cols[0]);
+        else if (PySequence_Fast_GET_SIZE(cols[i]) != n) {
+            PyErr_SetString(PyExc_ValueError, "columns should have the same length");
+            goto done;
+        }
+    }
+
+    ret = arrow_export(fields, formats, NULL, n, 0, cols);
+
+done:
+    if (cols) {
+        for (i = 0; i < n_fields; i++)
+            Py_XDECREF(cols[i]);
+        PyMem_Free(cols);
+    }
+    Py_DECREF(seq);
+    Py_DECREF(fields);
+    return ret;
+}
+
+////////////////////////// import ////////////////////////////////////////
+
+static int
+arrow_check_format(const char *fmt)
+{
+    if (fmt[0] == '\0' || fmt[1] != '\0')
+        return 0;
+    switch (fmt[0]) {
+        case 'n': case 'b':
+        case 'c': case 'C': case 's': case 'S':
+        case 'i': case 'I': case 'l': case 'L':
+        case 'f': case 'g':
+        case 'u': case 'z': case 'U': case 'Z':
+            return 1;
+        default:
+            return 0;
+    }
+}
+
+// The number of the buffers of the array with the format accepted by arrow_check_format
+static int64_t
+arrow_format_n_buffers(char fmt)
+{
+    switch (fmt) {
+        case 'n':
+            return 0;
+        case 'u': case 'z': case 'U': case 'Z':
+            return 3;
+        default:
+            return 2;
+    }
+}
+
+// The offset and the length of the foreign array should be valid and
+// the array should cover the rows [0, n) of the parent
+static int
+arrow_check_range(const struct ArrowArray *array, int64_t n)
+{
+    if (array->offset < 0 || array->length < 0 || array->length < n ||
+            array->offset > INT64_MAX - array->length) {
+        PyErr_SetString(PyExc_ValueError, "malformed arrow array: invalid offset or length");
+        return -1;
+    }
+    return 0;
+}
+
+// Check the foreign child array before reading its values
+static int
+arrow_check_child(const struct ArrowSchema *schema, const struct ArrowArray *array,
+                  int64_t n, const char *name)
+{
+    int64_t i, n_buffers = arrow_format_n_buffers(schema->format[0]);
+
+    if (array == NULL || array->release == NULL) {
+        PyErr_Format(PyExc_ValueError, "malformed arrow array: the column '%s' is missing", name);
+        return -1;
+    }
+    if (arrow_check_range(array, n) < 0)
+        return -1;
+    if (array->n_buffers != n_buffers || (n_buffers && array->buffers == NULL)) {
+        PyErr_Format(PyExc_ValueError, "malformed arrow array: the column '%s' should have %lld buffers",
+                     name, (long long)n_buffers);
+        return -1;
+    }
+    // the validity bitmap can be omitted, the data buffers can't
+    for (i = 1; i < n_buffers; i++) {
+        if (array->buffers[i] == NULL) {
+            PyErr_Format(PyExc_ValueError, "malformed arrow array: the buffer %lld of the column '%s' is NULL",
+                         (long long)i, name);
+            return -1;
+        }
+    }
+    return 0;
+}
+
+static PyObject *
+arrow_get_value(const struct ArrowSchema *schema, const struct ArrowArray *array, int64_t i)
+{
+    const char fmt = schema->format[0];
+    const void **buffers = array->buffers;
+
+    i += array->offset;
+
+    if (fmt == 'n')
+        Py_RETURN_NONE;
+    if (array->null_count != 0 && buffers[0] != NULL && !bitmap_get(buffers[0], i))
+        Py_RETURN_NONE;
+
+    switch (fmt) {
+        case 'b': return PyBool_FromLong(bitmap_get(buffers[1], i));
+        case 'c': return PyLong_FromLong(((const int8_t*)buffers[1])[i]);
+        case 'C': return PyLong_FromLong(((const uint8_t*)buffers[1])[i]);
+        case 's': return PyLong_FromLong(((const int16_t*)buffers[1])[i]);
+        case 'S': return PyLong_FromLong(((const uint16_t*)buffers[1])[i]);
+        case 'i': return PyLong_FromLong(((const int32_t*)buffers[1])[i]);
+        case 'I': return PyLong_FromUnsignedLong(((const uint32_t*)buffers[1])[i]);
+        case 'l': return PyLong_FromLongLong(((const int64_t*)buffers[1])[i]);
+        case 'L': return PyLong_FromUnsignedLongLong(((const uint64_t*)buffers[1])[i]);
+        case 'f': return PyFloat_FromDouble(((const float*)buffers[1])[i]);
+        case 'g': return PyFloat_FromDouble(((const double*)buffers[1])[i]);
+        case 'u': case 'z': {
+            const int32_t *offsets = (const int32_t*)buffers[1];
+            const char *data = (const char*)buffers[2];
+            if (offsets[i] < 0 || offsets[i+1] < offsets[i]) {
+                PyErr_SetString(PyExc_ValueError, "malformed arrow array: invalid offsets");
+                return NULL;
+            }
+            if (fmt == 'u')
+                return PyUnicode_FromStringAndSize(data + offsets[i], offsets[i+1] - offsets[i]);
+            else
+                return PyBytes_FromStringAndSize(data + offsets[i], offsets[i+1] - offsets[i]);
+        }
+        case 'U': case 'Z': {
+            const int64_t *offsets = (const int64_t*)buffers[1];
+            const char *data = (const char*)buffers[2];
+            if (offsets[i] < 0 || offsets[i+1] < offsets[i]) {
+                PyErr_SetString(PyExc_ValueError, "malformed arrow array: invalid offsets");
+                return NULL;
+            }
+            if (fmt == 'U')
+                return PyUnicode_FromStringAndSize(data + offsets[i], offsets[i+1] - offsets[i]);
+            else
+                return PyBytes_FromStringAndSize(data + offsets[i], offsets[i+1] - offsets[i]);
+        }
+    }
+
+    PyErr_Format(PyExc_TypeError, "unsupported arrow format '%s'", schema->format);
+    return NULL;
+}
+
+PyDoc_STRVAR(_import_rows_doc,
+"Create a list of instances of cls from arrow_schema/arrow_array capsules");
+
+static PyObject *
+_import_rows(PyObject *module, PyObject *args)
+{
+    PyObject *cls, *schema_capsule, *array_capsule;
+    PyObject *fields, *result = NULL;
+    struct ArrowSchema *schema;
+    struct ArrowArray *array;
+    Py_ssize_t *index = NULL;
+    PyObject **values = NULL;
+    Py_ssize_t i, k, n_fields;
+    int64_t row, length;
+
+    if (!PyArg_ParseTuple(args, "OOO", &cls, &schema_capsule, &array_capsule))
+        return NULL;
+    if (arrow_check_layout(cls) < 0)
+        return NULL;
+
+    schema = (struct ArrowSchema*)PyCapsule_GetPointer(schema_capsule, ARROW_SCHEMA_NAME);
+    if (schema == NULL)
+        return NULL;
+    array = (struct ArrowArray*)PyCapsule_GetPointer(array_capsule, ARROW_ARRAY_NAME);
+    if (array == NULL)
+        return NULL;
+
+    if (schema->release == NULL || array->release == NULL) {
+        PyErr_SetString(PyExc_ValueError, "arrow schema or array is already released");
+        return NULL;
+    }
+    if (schema->format == NULL || strcmp(schema->format, "+s") != 0 ||
+            schema->n_children != array->n_children) {
+        PyErr_Format(PyExc_TypeError, "expected arrow struct array, got format '%s'",
+                     schema->format ? schema->format : "");
+        return NULL;
+    }
+    if (arrow_check_range(array, 0) < 0)
+        return NULL;
+    if (array->n_buffers != 1 || array->buffers == NULL ||
+            (array->n_children && (schema->children == NULL || array->children == NULL))) {
+        PyErr_SetString(PyExc_ValueError, "malformed arrow array: invalid struct array");
+        return NULL;
+    }
+    for (k = 0; k < schema->n_children; k++) {
+        if (schema->children[k] == NULL || schema->children[k]->format == NULL) {
+            PyErr_SetString(PyExc_ValueError, "malformed arrow schema: invalid child");
+            return NULL;
+        }
+    }
+
+    fields = PyObject_GetAttr(cls, __fields__name);
+    if (fields == NULL)
+        return NULL;
+    if (!PyTuple_Check(fields)) {
+        PyErr_SetString(PyExc_TypeError, "__fields__ should be a tuple");
+        Py_DECREF(fields);
+        return NULL;
+    }
+    n_fields = PyTuple_GET_SIZE(fields);
+
+    index = (Py_ssize_t*)PyMem_Malloc((n_fields ? n_fields : 1) * sizeof(Py_ssize_t));
+    values = (PyObject**)PyMem_Calloc(n_fields ? n_fields : 1, sizeof(PyObject*));
+    if (index == NULL || values == NULL) {
+        PyErr_NoMemory();
+        goto done;
+    }
+
+    for (i = 0; i < n_fields; i++) {
+        const char *name = PyUnicode_AsUTF8(PyTuple_GET_ITEM(fields, i));
+        if (name == NULL)
+            goto done;
+        index[i] = -1;
+        for (k = 0; k < schema->n_children; k++) {
+            const char *child_name = schema->children[k]->name;
+            if (child_name && strcmp(child_name, name) == 0) {
+                index[i] = k;
+                break;
+            }
+        }
+        if (index[i] < 0) {
+            PyErr_Format(PyExc_TypeError, "column '%s' is missing", name);
+            goto done;
+        }
+        // the values of the dictionary-encoded column are the indices into the dictionary
+        if (schema->children[index[i]]->dictionary != NULL) {
+            PyErr_Format(PyExc_TypeError, "dictionary-encoded column '%s' is not supported", name);
+            goto done;
+        }
+        if (!arrow_check_format(schema->children[index[i]]->format)) {
+            PyErr_Format(PyExc_TypeError, "unsupported arrow format '%s' of the column '%s'",
+                         schema->children[index[i]]->format, name);
+            goto done;
+        }
+        // the rows of the parent are [offset, offset + length) of the child
+        if (arrow_check_child(schema->children[index[i]], array->children[index[i]],
+                              array->offset + array->length, name) < 0)
+            goto done;
+    }
+
+    length = array->length;
+    result = PyList_New(length);
+    if (result == NULL)
+        goto done;
+
+    for (row = 0; row < length; row++) {
+        PyObject *ob;
+        int64_t j = row + array->offset;
+
+        if (array->null_count != 0 && array->buffers[0] != NULL &&
+                !bitmap_get(array->buffers[0], j)) {
+            Py_INCREF(Py_None);
+            PyList_SET_ITEM(result, row, Py_None);
+            continue;
+        }
+
+        for (i = 0; i < n_fields; i++) {
+            k = index[i];
+            values[i] = arrow_get_value(schema->children[k], array->children[k], j);
+            if (values[i] == NULL) {
+                while (i-- > 0)
+                    Py_CLEAR(values[i]);
+                Py_CLEAR(result);
+                goto done;
+            }
+        }
+
+        ob = PyObject_Vectorcall(cls, values, n_fields, NULL);
+        for (i = 0; i < n_fields; i++)
+            Py_CLEAR(values[i]);
+        if (ob == NULL) {
+            Py_CLEAR(result);
+            goto done;
+        }
+        PyList_SET_ITEM(result, row, ob);
+    }
+
+done:
+    PyMem_Free(index);
+    PyMem_Free(values);
+    Py_DECREF(fields);
+    return result;
+}
+
+//////////////////////////////////////////////////
+
+PyDoc_STRVAR(arrowmodule_doc,
+"_arrow module provide export/import of dataobjects through Arrow C Data Interface.");
+
+static PyMethodDef arrowmodule_methods[] = {
+    {"_export_rows", _export_rows, METH_VARARGS, _export_rows_doc},
+    {"_export_columns", _export_columns, METH_VARARGS, _export_columns_doc},
+    {"_import_rows", _import_rows, METH_VARARGS, _import_rows_doc},
+    {"_check_layout", _check_layout, METH_O, _check_layout_doc},
+    {0, 0, 0, 0}
+};
+
+static struct PyModuleDef arrowmodule = {
+    PyModuleDef_HEAD_INIT,
+    "recordclass._arrow",
+    arrowmodule_doc,
+    -1,
+    arrowmodule_methods,
+    NULL,
+    NULL,
+    NULL,
+    NULL
+};
+
+PyMODINIT_FUNC
+PyInit__arrow(void)
+{
+    PyObject *m;
+
+    m = PyState_FindModule(&arrowmodule);
+    if (m) {
+        Py_INCREF(m);
+        return m;
+    }
+
+    m = PyModule_Create(&arrowmodule);
+    if (m == NULL)
+        return NULL;
+
+    __fields__name = PyUnicode_FromString("__fields__");
+    if (__fields__name == NULL)
+        return NULL;
+    __tail__name = PyUnicode_InternFromString("__tail__");
+    if (__tail__name == NULL)
+        return NULL;
+    __inline__name = PyUnicode_InternFromString("__inline__");
+    if (__inline__name == NULL)
+        return NULL;
+
+    dataobject_type = (PyTypeObject*)get_module_object("recordclass._dataobject", "dataobject");
+    if (dataobject_type == NULL)
+        return NULL;
+    datastruct_type = (PyTypeObject*)get_module_object("recordclass._dataobject", "datastruct");
+    if (datastruct_type == NULL)
+        return NULL;
+    sparseproperty_type = (PyTypeObject*)get_module_object("recordclass._dataobject", "sparseproperty");
+    if (sparseproperty_type == NULL)
+        return NULL;
+    bitproperty_type = (PyTypeObject*)get_module_object("recordclass._dataobject", "bitproperty");
+    if (bitproperty_type == NULL)
+        return NULL;
+    inlineproperty_type = (PyTypeObject*)get_module_object("recordclass._dataobject", "inlineproperty");
+    if (inlineproperty_type == NULL)
+        return NULL;
+
+    return m;
+}
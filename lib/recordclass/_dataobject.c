@@ -51,12 +51,59 @@ static PyTypeObject PyDataStruct_Type;
 static PyTypeObject *datatype;
 static PyTypeObject PyDataObjectProperty_Type;
 static PyTypeObject PyFactory_Type;
+static PyTypeObject PyDataObjectStats_Type;
+static PyTypeObject PyDataObjectTypeInfo_Type;
+
+// typeinfo of the class or NULL (see typeinfo section)
+static inline dataobjecttypeinfo_object *
+dataobject_get_typeinfo(PyTypeObject *tp)
+{
+    PyObject *info = tp->tp_cache;
+
+    if (info && Py_TYPE(info) == &PyDataObjectTypeInfo_Type)
+        return (dataobjecttypeinfo_object*)info;
+    return NULL;
+}
+
+static inline int
+dataobject_type_flags(PyTypeObject *tp)
+{
+    dataobjecttypeinfo_object *info = dataobject_get_typeinfo(tp);
+
+    return info ? info->flags : 0;
+}
+
+static inline int
+dataobject_type_layout(PyTypeObject *tp)
+{
+    dataobjecttypeinfo_object *info = dataobject_get_typeinfo(tp);
+
+    return info ? info->layout : 0;
+}
+
+// the plan (__inline__) of the class with Inline, Packed or sparse fields or NULL
+static inline PyObject *
+dataobject_type_plan(PyTypeObject *tp)
+{
+    dataobjecttypeinfo_object *info = dataobject_get_typeinfo(tp);
+
+    return info ? info->plan : NULL;
+}
 
 static PyObject *__fields__name;
 static PyObject *__dict__name;
 static PyObject *__weakref__name;
 static PyObject *__default_vals__name;
+static PyObject *__categorical_fields__name;
+static PyObject *__categorical_table__name;
+static PyObject *__stats__name;
+static PyObject *__fields_index__name;
+static PyObject *__default_copy__name;
+static PyObject *__copy__name;
+static PyObject *__validator__name;
 static PyObject *__init__name;
+static PyObject *__tail__name;
+static PyObject *__inline__name;
 
 static PyObject *fields_dict_name;
 
@@ -64,8 +111,86 @@ static int dataobjectproperty_set(PyObject *self, PyObject *obj, PyObject *value
 static PyObject* dataobjectproperty_get(PyObject *self, PyObject *obj, PyObject *type);
 
 static int dataobject_ass_item(PyObject *op, Py_ssize_t i, PyObject *val);
+static int dataobject_init_validate(PyObject *op, PyObject *args, PyObject *kwds);
+static PyObject *dataobject_validate_item(PyObject *op, Py_ssize_t i, PyObject *val);
+
+// the classes with validate=True (see validator section)
+#define DATAOBJECT_VALIDATED(op) (Py_TYPE(op)->tp_init == dataobject_init_validate)
 static Py_ssize_t _tuple_index(PyTupleObject *self, PyObject *value);
 
+// the classes with Inline[S] fields (see inline section)
+static PyObject *dataobject_new_inline(PyTypeObject *type, PyObject *args, PyObject *kwds);
+static PyObject *dataobject_repr_inline(PyObject *self);
+static PyObject *inline_logical_args(PyObject *op);
+// the classes with the plan (Inline, Packed or sparse fields) are constructed by dataobject_new_inline
+#define DATAOBJECT_HAS_PLAN(tp) (dataobject_type_layout(tp) & DATAOBJECT_L_PLAN)
+
+// the classes with Packed[T] fields in the words after the fields (see packed section)
+static PyObject *dataobject_alloc_bits(PyTypeObject *type, Py_ssize_t unused);
+#define DATAOBJECT_HAS_BITS(tp) (dataobject_type_layout(tp) & DATAOBJECT_L_PACKED)
+
+static PyTypeObject PyInlineProperty_Type;
+static PyTypeObject PyBitProperty_Type;
+static int inline_assign(PyObject *op, PyObject *descr, PyObject *value);
+static int bits_assign(PyObject *op, PyObject *descr, PyObject *value);
+static PyObject *dataobject_bits_values(PyObject *op);
+static int dataobject_plan_to_dict(PyObject *op, PyObject *dict);
+
+// the classes with sparse=True (see sparse section)
+static PyObject *dataobject_alloc_sparse(PyTypeObject *type, Py_ssize_t unused);
+#define DATAOBJECT_IS_SPARSE(tp) (dataobject_type_layout(tp) & DATAOBJECT_L_SPARSE)
+
+static PyTypeObject PyDataObjectSparseProperty_Type;
+static int sparse_assign(PyObject *op, PyObject *descr, PyObject *value);
+static Py_ssize_t dataobject_sparse_count(PyObject *op);
+static int dataobject_sparse_copy(PyObject *new_op, PyObject *op);
+static PyObject *sparse_value(PyObject *op, sparseproperty_object *p);
+
+// the values of the instances of these classes aren't only in the slots of the fields,
+// so len, iteration and astuple(s)/asdicts use the values in the order of __inline__
+#define DATAOBJECT_HAS_PLAN_VALUES(tp) \
+    (dataobject_type_layout(tp) & (DATAOBJECT_L_SPARSE | DATAOBJECT_L_PACKED))
+
+// the words of the packed fields follow the fields, __dict__ and __weakref__
+static inline Py_ssize_t
+dataobject_bits_offset(PyTypeObject *tp)
+{
+    Py_ssize_t offset = sizeof(PyObject) + PyDataObject_NUMITEMS(tp) * sizeof(PyObject*);
+
+    if (tp->tp_dictoffset)
+        offset += sizeof(PyObject*);
+    if (tp->tp_weaklistoffset)
+        offset += sizeof(PyObject*);
+    return offset;
+}
+
+// the classes with track_changes=True: the bitmap of the changed fields in the words
+// after the fields, __dict__ and __weakref__ (see change tracking section)
+static PyObject *dataobject_alloc_tracked(PyTypeObject *type, Py_ssize_t unused);
+#define DATAOBJECT_TRACKS_CHANGES(tp) (dataobject_type_layout(tp) & DATAOBJECT_L_TRACKED)
+
+static inline void
+dataobject_mark_changed(PyObject *op, Py_ssize_t i)
+{
+    PyTypeObject *tp = Py_TYPE(op);
+
+    if (DATAOBJECT_TRACKS_CHANGES(tp)) {
+        uint64_t *changed = (uint64_t*)((char*)op + dataobject_bits_offset(tp));
+        changed[i >> 6] |= ((uint64_t)1) << (i & 63);
+    }
+}
+
+static inline void
+dataobject_reset_changes(PyObject *op)
+{
+    PyTypeObject *tp = Py_TYPE(op);
+
+    if (DATAOBJECT_TRACKS_CHANGES(tp)) {
+        Py_ssize_t offset = dataobject_bits_offset(tp);
+        memset((char*)op + offset, 0, tp->tp_basicsize - offset);
+    }
+}
+
 static inline PyObject *
 type_error(const char *msg, PyObject *obj)
 {
@@ -192,23 +317,236 @@ static PyObject* _astuple(PyObject *op);
 static int _dataobject_update(PyObject *op, PyObject *kw, int flag);
 static PyObject *empty_tuple;
 
+//////////////////////// instrumentation /////////////////////////////////
+
+// Build with RECORDCLASS_INSTRUMENT defined in order to count the branches
+// taken by the constructors of each type and the time spent in the calls of
+// the factories of default values (see `constructor_counts`).
+
+#ifdef RECORDCLASS_INSTRUMENT
+
+typedef struct {
+    Py_ssize_t calls;
+    Py_ssize_t positional;
+    Py_ssize_t defaults;
+    Py_ssize_t factory;
+    Py_ssize_t kwargs;
+    Py_ssize_t dict_fallback;
+    long long factory_ns;
+} instrument_counts;
+
+static PyObject *instrument_dict = NULL;
+static instrument_counts *instrument_current = NULL;
+
+#if PY_VERSION_HEX >= 0x030D0000
+static inline long long
+instrument_clock(void) {
+    PyTime_t t;
+    PyTime_PerfCounterRaw(&t);
+    return (long long)t;
+}
+#else
+static inline long long
+instrument_clock(void) {
+    return (long long)_PyTime_GetPerfCounter();
+}
+#endif
+
+static void
+instrument_counts_free(PyObject *capsule) {
+    PyMem_Free(PyCapsule_GetPointer(capsule, NULL));
+}
+
+static instrument_counts *
+instrument_get(PyTypeObject *type) {
+    PyObject *capsule;
+    instrument_counts *ic;
+
+    if (instrument_dict == NULL) {
+        instrument_dict = PyDict_New();
+        if (instrument_dict == NULL) {
+            PyErr_Clear();
+            return NULL;
+        }
+    }
+
+    capsule = PyDict_GetItem(instrument_dict, (PyObject*)type);
+    if (capsule)
+        return (instrument_counts*)PyCapsule_GetPointer(capsule, NULL);
+
+    ic = PyMem_Calloc(1, sizeof(instrument_counts));
+    if (ic == NULL)
+        return NULL;
+
+    capsule = PyCapsule_New(ic, NULL, instrument_counts_free);
+    if (capsule == NULL) {
+        PyMem_Free(ic);
+        PyErr_Clear();
+        return NULL;
+    }
+    if (PyDict_SetItem(instrument_dict, (PyObject*)type, capsule) < 0) {
+        Py_DECREF(capsule);
+        PyErr_Clear();
+        return NULL;
+    }
+    Py_DECREF(capsule);
+
+    return ic;
+}
+
+static void
+instrument_kwds(PyTypeObject *type, PyObject *kwds) {
+    instrument_counts *ic;
+    PyObject *fields, *key, *val;
+    Py_ssize_t pos = 0;
+
+    if (kwds == NULL || !PyDict_GET_SIZE(kwds))
+        return;
+
+    ic = instrument_get(type);
+    if (ic == NULL)
+        return;
+
+    ic->kwargs++;
+
+    fields = PyDict_GetItem(type->tp_dict, __fields__name);
+    if (fields == NULL || !PyTuple_Check(fields))
+        return;
+
+    while (PyDict_Next(kwds, &pos, &key, &val)) {
+        if (_tuple_index((PyTupleObject*)fields, key) < 0)
+            ic->dict_fallback++;
+    }
+}
+
+#define INSTRUMENT_BEGIN(type) \
+    instrument_counts *ic = instrument_get(type); \
+    instrument_current = ic; \
+    if (ic) ic->calls++
+#define INSTRUMENT_COUNT(name) do { if (ic) ic->name++; } while(0)
+#define INSTRUMENT_KWDS(type, kwds) instrument_kwds(type, kwds)
+
+#else
+
+#define INSTRUMENT_BEGIN(type)
+#define INSTRUMENT_COUNT(name) ((void)0)
+#define INSTRUMENT_KWDS(type, kwds) ((void)0)
+
+#endif
+
 static PyObject* call_factory(PyObject *f) {
     struct PyFactoryObject *p = (struct PyFactoryObject *)f;
     PyObject *ret;
 
-    ret = PyObject_Call(p->factory, empty_tuple, NULL);
+#ifdef RECORDCLASS_INSTRUMENT
+    instrument_counts *ic = instrument_current;
+    long long t0 = instrument_clock();
+#endif
+
+    // the empty builtin containers are created directly
+    switch (p->kind) {
+        case FACTORY_LIST:
+            ret = PyList_New(0);
+            break;
+        case FACTORY_DICT:
+            ret = PyDict_New();
+            break;
+        case FACTORY_SET:
+            ret = PySet_New(NULL);
+            break;
+        default:
+#if PY_VERSION_HEX >= 0x03090000
+            ret = PyObject_Vectorcall(p->factory, NULL, 0, NULL);
+#else
+            ret = PyObject_Call(p->factory, empty_tuple, NULL);
+#endif
+    }
+
+#ifdef RECORDCLASS_INSTRUMENT
+    // the factory may call other constructors
+    instrument_current = ic;
+    if (ic) {
+        ic->factory++;
+        ic->factory_ns += instrument_clock() - t0;
+    }
+#endif
+
     if (!ret) {
-        PyErr_Format(PyExc_TypeError, "Bad call of the factory: %U", p->factory);
+        PyErr_Format(PyExc_TypeError, "Bad call of the factory: %R", p->factory);
         return NULL;
     }
 
     return ret;
 }
 
+//////////////////////// deferred deallocation ////////////////
+
+// The references released by the deallocation of the instances of
+// deferred_dealloc=True classes are pushed to the bounded stack and
+// released later by `drain(budget)` or by small slices at the entry of the
+// constructors of dataobject instances. It's a safe point to run arbitrary
+// deallocators, __del__ and weakref callbacks: no argument is borrowed and
+// nothing is allocated yet (tp_alloc is not such a point).
+// The stack is shared by the interpreter, so it relies on the GIL and
+// deferred_dealloc=True is refused by the free-threaded builds.
+
+#define DEFERRED_QUEUE_SIZE (1 << 16)
+#define DEFERRED_STEP_SLICE 8
+
+static PyObject **deferred_queue = NULL;
+static Py_ssize_t deferred_len = 0;
+static int deferred_draining = 0;
+
+static int
+deferred_push(PyObject *ob)
+{
+    if (deferred_len == DEFERRED_QUEUE_SIZE)
+        return 0;
+
+    if (deferred_queue == NULL) {
+        deferred_queue = PyMem_RawMalloc(DEFERRED_QUEUE_SIZE * sizeof(PyObject*));
+        if (deferred_queue == NULL)
+            return 0;
+    }
+
+    deferred_queue[deferred_len++] = ob;
+    return 1;
+}
+
+// release the object now if it's not the last reference or the queue is full
+static inline void
+deferred_decref(PyObject *ob)
+{
+    if (Py_REFCNT(ob) > 1 || !deferred_push(ob))
+        Py_DECREF(ob);
+}
+
+static Py_ssize_t
+deferred_drain(Py_ssize_t budget)
+{
+    Py_ssize_t n = 0;
+    int draining = deferred_draining;
+
+    deferred_draining = 1;
+    while (deferred_len > 0 && (budget < 0 || n < budget)) {
+        PyObject *ob = deferred_queue[--deferred_len];
+        Py_DECREF(ob);
+        n++;
+    }
+    deferred_draining = draining;
+
+    return n;
+}
+
+#define DEFERRED_STEP() \
+    do { if (deferred_len > 0 && !deferred_draining) deferred_drain(DEFERRED_STEP_SLICE); } while(0)
+
 static PyObject *
 dataobject_alloc(PyTypeObject *type, Py_ssize_t unused)
 {
-    PyObject *op = (PyObject*)_PyObject_New(type);
+    PyObject *op;
+
+    op = (PyObject*)_PyObject_New(type);
 
 #if PY_VERSION_HEX < 0x03080000
     if (type->tp_flags & Py_TPFLAGS_HEAPTYPE)
@@ -230,7 +568,9 @@ dataobject_alloc(PyTypeObject *type, Py_ssize_t unused)
 static PyObject *
 dataobject_alloc_gc(PyTypeObject *type, Py_ssize_t unused)
 {
-    PyObject *op = _PyObject_GC_New(type);
+    PyObject *op;
+
+    op = _PyObject_GC_New(type);
 
 #if PY_VERSION_HEX < 0x03080000
     if (type->tp_flags & Py_TPFLAGS_HEAPTYPE)
@@ -251,7 +591,201 @@ dataobject_alloc_gc(PyTypeObject *type, Py_ssize_t unused)
     return op;
 }
 
-static void 
+// the counters are set by _datatype_stats (a subclass has its own ones)
+static inline dataobjectstats_object *
+dataobject_get_stats(PyTypeObject *type)
+{
+    dataobjecttypeinfo_object *info = dataobject_get_typeinfo(type);
+
+    return info ? info->stats : NULL;
+}
+
+static void
+dataobject_stats_inc(PyTypeObject *type)
+{
+    dataobjectstats_object *stats = dataobject_get_stats(type);
+
+    if (stats) {
+        stats->allocated++;
+        if (++stats->live > stats->peak)
+            stats->peak = stats->live;
+    }
+}
+
+static void
+dataobject_stats_dec(PyTypeObject *type)
+{
+    dataobjectstats_object *stats = dataobject_get_stats(type);
+
+    if (stats)
+        stats->live--;
+}
+
+static PyObject *
+dataobject_alloc_stats(PyTypeObject *type, Py_ssize_t unused)
+{
+    PyObject *op = dataobject_alloc(type, unused);
+
+    if (op)
+        dataobject_stats_inc(type);
+
+    return op;
+}
+
+static PyObject *
+dataobject_alloc_gc_stats(PyTypeObject *type, Py_ssize_t unused)
+{
+    PyObject *op = dataobject_alloc_gc(type, unused);
+
+    if (op)
+        dataobject_stats_inc(type);
+
+    return op;
+}
+
+//////////////////////// variable-length tail ///////////////////////////
+
+// The items of the trailing Tail[T] field are allocated inline after the fixed
+// part of the instance. As tp_itemsize of the dataobject types is the number of
+// the fields, the number of the items is kept in the last word of the fixed part
+// (tp_basicsize includes it) and the items follow it.
+
+static PyObject *dataobject_alloc_tail(PyTypeObject *type, Py_ssize_t n_tail);
+
+#define DATAOBJECT_HAS_TAIL(tp) (dataobject_type_layout(tp) & DATAOBJECT_L_TAIL)
+#define PyDataObject_TAIL_SIZE(op) \
+    (*(Py_ssize_t*)((char*)(op) + Py_TYPE(op)->tp_basicsize - sizeof(Py_ssize_t)))
+#define PyDataObject_TAIL_ITEMS(op) ((PyObject**)((char*)(op) + Py_TYPE(op)->tp_basicsize))
+
+static PyObject *
+dataobject_alloc_tail(PyTypeObject *type, Py_ssize_t n_tail)
+{
+    PyObject *op;
+
+    if (n_tail > (PY_SSIZE_T_MAX - type->tp_basicsize) / (Py_ssize_t)sizeof(PyObject*))
+        return PyErr_NoMemory();
+
+    op = (PyObject*)PyObject_Malloc(type->tp_basicsize + n_tail * sizeof(PyObject*));
+    if (op == NULL)
+        return PyErr_NoMemory();
+
+    // the fields, __dict__, __weakref__ and the items of the tail are NULL
+    memset(op, 0, type->tp_basicsize + n_tail * sizeof(PyObject*));
+    PyObject_Init(op, type);
+
+#if PY_VERSION_HEX < 0x03080000
+    if (type->tp_flags & Py_TPFLAGS_HEAPTYPE)
+        Py_INCREF(type);
+#endif
+
+    PyDataObject_TAIL_SIZE(op) = n_tail;
+
+    return op;
+}
+
+static inline Py_ssize_t
+dataobject_tail_len(PyObject *op)
+{
+    return DATAOBJECT_HAS_TAIL(Py_TYPE(op)) ? PyDataObject_TAIL_SIZE(op) : 0;
+}
+
+// i-th item of the fields followed by the items of the tail
+static inline PyObject *
+dataobject_seq_get(PyObject *op, const Py_ssize_t n_items, const Py_ssize_t i)
+{
+    if (i < n_items)
+        return PyDataObject_GET_VALUE(op, i);
+    return PyDataObject_TAIL_ITEMS(op)[i - n_items];
+}
+
+static PyObject *
+dataobject_tail_tuple(PyObject *op)
+{
+    const Py_ssize_t n_tail = PyDataObject_TAIL_SIZE(op);
+    PyObject **items = PyDataObject_TAIL_ITEMS(op);
+    Py_ssize_t i;
+
+    PyObject *tpl = PyTuple_New(n_tail);
+    if (tpl == NULL)
+        return NULL;
+    for (i = 0; i < n_tail; i++) {
+        PyObject *v = items[i];
+        Py_INCREF(v);
+        PyTuple_SET_ITEM(tpl, i, v);
+    }
+    return tpl;
+}
+
+// dict[__tail__] = tuple of the items of the tail
+static int
+dataobject_tail_to_dict(PyObject *op, PyObject *dict)
+{
+    PyObject *name = PyDict_GetItem(Py_TYPE(op)->tp_dict, __tail__name);
+    PyObject *tpl;
+    int ret;
+
+    if (name == NULL)
+        return 0;
+    tpl = dataobject_tail_tuple(op);
+    if (tpl == NULL)
+        return -1;
+    ret = PyDict_SetItem(dict, name, tpl);
+    Py_DECREF(tpl);
+    return ret;
+}
+
+//////////////////////// untracking of gc=True instances ////////////////
+
+// As for tuples in CPython, the instances of gc=True classes, which values
+// of the fields can't be a part of a reference cycle, are untracked after
+// construction. They are tracked again when such value is assigned.
+// This is enabled (DATAOBJECT_F_MAY_UNTRACK flag of the class) only when the class
+// has no __dict__ and __setattr__ and every field is either readonly or has
+// dataobjectproperty descriptor (validate=True or Categorical fields), which setter
+// tracks the instance again. The instances of the classes with writable member
+// descriptors always stay tracked, because the specialized STORE_ATTR_SLOT writes
+// into the slot directly and can't track them again.
+
+#if PY_VERSION_HEX < 0x03090000
+#define PyObject_GC_IsTracked(op) _PyObject_GC_IS_TRACKED(op)
+#endif
+
+static inline int
+_may_be_tracked(PyObject *v) {
+    if (!PyObject_IS_GC(v))
+        return 0;
+    if (PyTuple_CheckExact(v))
+        return PyObject_GC_IsTracked(v);
+    return 1;
+}
+
+#define DATAOBJECT_MAY_UNTRACK(tp) (dataobject_type_flags(tp) & DATAOBJECT_F_MAY_UNTRACK)
+
+static inline void
+dataobject_maybe_track(PyObject *op, PyObject *val)
+{
+    if (DATAOBJECT_MAY_UNTRACK(Py_TYPE(op)) &&
+            !PyObject_GC_IsTracked(op) && _may_be_tracked(val))
+        PyObject_GC_Track(op);
+}
+
+static inline void
+dataobject_maybe_untrack(PyObject *op)
+{
+    if (DATAOBJECT_MAY_UNTRACK(Py_TYPE(op))) {
+        PyObject **items = PyDataObject_ITEMS(op);
+        Py_ssize_t n = PyDataObject_LEN(op);
+
+        while (n--) {
+            PyObject *v = *(items++);
+            if (v && _may_be_tracked(v))
+                return;
+        }
+        PyObject_GC_UnTrack(op);
+    }
+}
+
+static void
 _fill_items(PyObject **items, PyObject * const*args, const Py_ssize_t n_args) {
     Py_ssize_t i;
     for (i = 0; i < n_args; i++) {
@@ -261,6 +795,17 @@ _fill_items(PyObject **items, PyObject * const*args, const Py_ssize_t n_args) {
     } 
 }
 
+// the copy keeps the deleted fields
+static void
+_copy_items(PyObject **items, PyObject * const*args, const Py_ssize_t n_args) {
+    Py_ssize_t i;
+    for (i = 0; i < n_args; i++) {
+        PyObject *v = args[i];
+        Py_XINCREF(v);
+        items[i] = v;
+    }
+}
+
 static void 
 _fill_items_none(PyObject **items, const Py_ssize_t start, const Py_ssize_t n_args) {
     Py_ssize_t i;
@@ -296,11 +841,12 @@ dataobject_vectorcall(PyObject *type0, PyObject * const*args,
                       size_t nargsf, PyObject *kwnames)
 {
     PyTypeObject *type = (PyTypeObject*)type0;
-    PyObject *op = type->tp_alloc(type, 0);
 
     const Py_ssize_t n_items = PyDataObject_NUMITEMS(type);
     const Py_ssize_t n_args = PyVectorcall_NARGS(nargsf);
-    PyObject **items = PyDataObject_ITEMS(op);
+
+    DEFERRED_STEP();
+    INSTRUMENT_BEGIN(type);
 
     if (n_args > n_items) {
         PyErr_SetString(PyExc_TypeError,
@@ -308,9 +854,18 @@ dataobject_vectorcall(PyObject *type0, PyObject * const*args,
         return NULL;
     }
 
+    PyObject *op = type->tp_alloc(type, 0);
+    if (op == NULL)
+        return NULL;
+    PyObject **items = PyDataObject_ITEMS(op);
+
     _fill_items(items, args, n_args);
 
+    if (n_args == n_items)
+        INSTRUMENT_COUNT(positional);
+
     if (n_args < n_items) {
+        INSTRUMENT_COUNT(defaults);
         PyObject *tp_dict = type->tp_dict;
         PyMappingMethods *mp = Py_TYPE(tp_dict)->tp_as_mapping;
         PyObject *default_vals = mp->mp_subscript(tp_dict, __default_vals__name);
@@ -321,8 +876,10 @@ dataobject_vectorcall(PyObject *type0, PyObject * const*args,
         } else {
             int ret = _fill_items_defaults(items, default_vals, n_args, n_items);
             Py_DECREF(default_vals);
-            if (!ret)
+            if (!ret) {
+                Py_DECREF(op);
                 return NULL;
+            }
         }
     }
 
@@ -332,6 +889,8 @@ dataobject_vectorcall(PyObject *type0, PyObject * const*args,
             PyObject *val;
             PyObject *name;
 
+            INSTRUMENT_COUNT(kwargs);
+
             PyObject *tp_dict = type->tp_dict;
             PyMappingMethods *mp = Py_TYPE(tp_dict)->tp_as_mapping;
             PyObject *fields = mp->mp_subscript(tp_dict, __fields__name);
@@ -343,48 +902,142 @@ dataobject_vectorcall(PyObject *type0, PyObject * const*args,
     
                 Py_ssize_t index = _tuple_index((PyTupleObject*)fields, name);
                 if (index >= 0) {
-                    dataobject_ass_item(op, index, val);
+                    if (dataobject_ass_item(op, index, val) < 0) {
+                        Py_DECREF(fields);
+                        Py_DECREF(op);
+                        return NULL;
+                    }
                     continue;
                 } else {
                     if (!type->tp_dictoffset) {
                         PyErr_Format(PyExc_TypeError, "Invalid kwarg: %U not in __fields__", name);
                         Py_DECREF(fields);
+                        Py_DECREF(op);
                         return NULL;
                     }
                 }
     
+                INSTRUMENT_COUNT(dict_fallback);
                 Py_INCREF(val);
                 PyObject_SetAttr(op, name, val);
             }
             Py_DECREF(fields);            
+            dataobject_reset_changes(op);
         } 
     }
 
+    dataobject_maybe_untrack(op);
+
     return op;
 }
-#endif
 
-static PyObject*
-dataobject_new_basic(PyTypeObject *type, PyObject *args, PyObject *kwds)
-{
-    PyObject *op = type->tp_alloc(type, 0);
+/*
+ * Constructors specialized by the number of fields (1..DATAOBJECT_VECTORCALL_MAXARITY).
+ * They handle only the call with all fields passed by position without keywords:
+ * the copying of the arguments is unrolled and there are no lookups of the defaults
+ * and __fields__. Any other call goes to dataobject_vectorcall.
+ */
 
-    const Py_ssize_t n_items = PyDataObject_NUMITEMS(type);
-    const Py_ssize_t n_args = Py_SIZE(args);
+#define DATAOBJECT_VECTORCALL_MAXARITY 8
 
-    if (n_args > n_items) {
-        PyErr_SetString(PyExc_TypeError,
-            "number of the arguments greater than the number of fields");
-        return NULL;
+static inline void
+_fill_items_unrolled(PyObject **items, PyObject * const*args, const Py_ssize_t n)
+{
+    switch (n) {
+        case 8: items[7] = Py_NewRef(args[7]); /* fallthrough */
+        case 7: items[6] = Py_NewRef(args[6]); /* fallthrough */
+        case 6: items[5] = Py_NewRef(args[5]); /* fallthrough */
+        case 5: items[4] = Py_NewRef(args[4]); /* fallthrough */
+        case 4: items[3] = Py_NewRef(args[3]); /* fallthrough */
+        case 3: items[2] = Py_NewRef(args[2]); /* fallthrough */
+        case 2: items[1] = Py_NewRef(args[1]); /* fallthrough */
+        case 1: items[0] = Py_NewRef(args[0]);
     }
+}
 
-    PyObject **items = PyDataObject_ITEMS(op);
+#define DATAOBJECT_VECTORCALL_ARITY(n) \
+static PyObject* \
+dataobject_vectorcall_##n(PyObject *type0, PyObject * const*args, \
+                          size_t nargsf, PyObject *kwnames) \
+{ \
+    PyTypeObject *type = (PyTypeObject*)type0; \
+    if (PyVectorcall_NARGS(nargsf) != n || (kwnames && PyTuple_GET_SIZE(kwnames))) \
+        return dataobject_vectorcall(type0, args, nargsf, kwnames); \
+    DEFERRED_STEP(); \
+    { \
+        INSTRUMENT_BEGIN(type); \
+        INSTRUMENT_COUNT(positional); \
+    } \
+    PyObject *op = type->tp_alloc(type, 0); \
+    if (op == NULL) \
+        return NULL; \
+    _fill_items_unrolled(PyDataObject_ITEMS(op), args, n); \
+    dataobject_maybe_untrack(op); \
+    return op; \
+}
+
+DATAOBJECT_VECTORCALL_ARITY(1)
+DATAOBJECT_VECTORCALL_ARITY(2)
+DATAOBJECT_VECTORCALL_ARITY(3)
+DATAOBJECT_VECTORCALL_ARITY(4)
+DATAOBJECT_VECTORCALL_ARITY(5)
+DATAOBJECT_VECTORCALL_ARITY(6)
+DATAOBJECT_VECTORCALL_ARITY(7)
+DATAOBJECT_VECTORCALL_ARITY(8)
+
+static vectorcallfunc dataobject_vectorcall_arity[DATAOBJECT_VECTORCALL_MAXARITY+1] = {
+    dataobject_vectorcall,
+    dataobject_vectorcall_1,
+    dataobject_vectorcall_2,
+    dataobject_vectorcall_3,
+    dataobject_vectorcall_4,
+    dataobject_vectorcall_5,
+    dataobject_vectorcall_6,
+    dataobject_vectorcall_7,
+    dataobject_vectorcall_8,
+};
+
+static int
+dataobject_is_vectorcall(vectorcallfunc f)
+{
+    Py_ssize_t i;
+    for (i = 0; i <= DATAOBJECT_VECTORCALL_MAXARITY; i++) {
+        if (f == dataobject_vectorcall_arity[i])
+            return 1;
+    }
+    return 0;
+}
+#endif
+
+static PyObject*
+dataobject_new_basic(PyTypeObject *type, PyObject *args, PyObject *kwds)
+{
+    DEFERRED_STEP();
+
+    PyObject *op = type->tp_alloc(type, 0);
+
+    const Py_ssize_t n_items = PyDataObject_NUMITEMS(type);
+    const Py_ssize_t n_args = Py_SIZE(args);
+
+    INSTRUMENT_BEGIN(type);
+
+    if (n_args > n_items) {
+        PyErr_SetString(PyExc_TypeError,
+            "number of the arguments greater than the number of fields");
+        return NULL;
+    }
+
+    PyObject **items = PyDataObject_ITEMS(op);
     const PyTupleObject *tpl = (const PyTupleObject*)args;
     PyObject *const*tmp = (PyObject*const*)(tpl->ob_item);
 
     _fill_items(items, tmp, n_args);
 
+    if (n_args == n_items)
+        INSTRUMENT_COUNT(positional);
+
     if (n_args < n_items) {
+        INSTRUMENT_COUNT(defaults);
         PyObject *tp_dict = type->tp_dict;
         PyMappingMethods *mp = Py_TYPE(tp_dict)->tp_as_mapping;
         PyObject *default_vals = mp->mp_subscript(tp_dict, __default_vals__name);
@@ -401,23 +1054,31 @@ dataobject_new_basic(PyTypeObject *type, PyObject *args, PyObject *kwds)
     }
 
     if (kwds) {
+        INSTRUMENT_KWDS(type, kwds);
         int retval = _dataobject_update(op, kwds, 1);
         if (retval < 0)
             return NULL;
+        dataobject_reset_changes(op);
     }
 
+    dataobject_maybe_untrack(op);
+
     return op;
 }
 
 static PyObject*
 dataobject_new(PyTypeObject *type, PyObject *args, PyObject *kwds)
 {
+    DEFERRED_STEP();
+
     PyObject *op = type->tp_alloc(type, 0);
 
     const Py_ssize_t n_items = PyDataObject_NUMITEMS(type);
     const Py_ssize_t n_args = Py_SIZE(args);
     PyObject **items = PyDataObject_ITEMS(op);
 
+    INSTRUMENT_BEGIN(type);
+
     if (n_args > n_items) {
         PyErr_SetString(PyExc_TypeError,
             "number of the arguments greater than the number of fields");
@@ -426,7 +1087,11 @@ dataobject_new(PyTypeObject *type, PyObject *args, PyObject *kwds)
 
     _fill_items_none(items, 0, n_args);
 
+    if (n_args == n_items)
+        INSTRUMENT_COUNT(positional);
+
     if (n_args < n_items) {
+        INSTRUMENT_COUNT(defaults);
         PyObject *tp_dict = type->tp_dict;
         PyMappingMethods *mp = Py_TYPE(tp_dict)->tp_as_mapping;
         PyObject *default_vals = mp->mp_subscript(tp_dict, __default_vals__name);
@@ -445,14 +1110,63 @@ dataobject_new(PyTypeObject *type, PyObject *args, PyObject *kwds)
     return op;
 }
 
+/*
+ * The copy strategy of the default value for copy_default=True classes:
+ * None (the value is shared), list/dict/set type (the builtin container is copied),
+ * Factory type (the factory is called), the __copy__ function of the type of the value
+ * or the name "__copy__" (the method is called by name).
+ */
 static PyObject*
-dataobject_new_copy_default(PyTypeObject *type, PyObject *args, PyObject *kwds)
+dataobject_default_copier(PyObject *value)
 {
-    PyObject *op = type->tp_alloc(type, 0);
+    PyTypeObject *tp = Py_TYPE(value);
+    PyObject *copier;
+
+    if (value == Py_None)
+        copier = Py_None;
+    else if (tp == &PyList_Type || tp == &PyDict_Type || tp == &PySet_Type || tp == &PyFactory_Type)
+        copier = (PyObject*)tp;
+    else {
+        copier = _PyType_Lookup(tp, __copy__name);
+        if (copier == NULL)
+            copier = Py_None;
+        // other descriptors (classmethod, ...) are bound by the method call
+        else if (!PyFunction_Check(copier) && Py_TYPE(copier) != &PyMethodDescr_Type)
+            copier = __copy__name;
+    }
+    Py_INCREF(copier);
+    return copier;
+}
 
+static PyObject*
+dataobject_copy_default_value(PyObject *copier, PyObject *value)
+{
+    if (copier == Py_None) {
+        Py_INCREF(value);
+        return value;
+    }
+    else if (copier == (PyObject*)&PyList_Type)
+        return PyList_GetSlice(value, 0, PY_SSIZE_T_MAX);
+    else if (copier == (PyObject*)&PyDict_Type)
+        return PyDict_Copy(value);
+    else if (copier == (PyObject*)&PySet_Type)
+        return PySet_New(value);
+    else if (copier == (PyObject*)&PyFactory_Type)
+        return call_factory(value);
+    else if (copier == __copy__name)
+        return PyObject_CallMethodObjArgs(value, __copy__name, NULL);
+    else
+        return PyObject_CallFunctionObjArgs(copier, value, NULL);
+}
+
+static PyObject*
+dataobject_new_copy_default(PyTypeObject *type, PyObject *args, PyObject *kwds)
+{
     const Py_ssize_t n_items = PyDataObject_NUMITEMS(type);
     const Py_ssize_t n_args = Py_SIZE(args);
-    PyObject **items = PyDataObject_ITEMS(op);
+
+    DEFERRED_STEP();
+    INSTRUMENT_BEGIN(type);
 
     if (n_args > n_items) {
         PyErr_SetString(PyExc_TypeError,
@@ -460,49 +1174,68 @@ dataobject_new_copy_default(PyTypeObject *type, PyObject *args, PyObject *kwds)
         return NULL;
     }
 
+    PyObject *op = type->tp_alloc(type, 0);
+    if (op == NULL)
+        return NULL;
+    PyObject **items = PyDataObject_ITEMS(op);
+
     _fill_items_none(items, 0, n_args);
 
+    if (n_args == n_items)
+        INSTRUMENT_COUNT(positional);
+
     if (n_args < n_items) {
-        PyObject *tp_dict = type->tp_dict;
-        PyMappingMethods *mp = Py_TYPE(tp_dict)->tp_as_mapping;
-        PyObject *default_vals = mp->mp_subscript(tp_dict, __default_vals__name);
+        INSTRUMENT_COUNT(defaults);
+        PyObject *default_vals = PyDict_GetItemWithError(type->tp_dict, __default_vals__name);
 
         if (default_vals == NULL) {
-            PyErr_Clear();
+            if (PyErr_Occurred()) {
+                _fill_items_none(items, n_args, n_items);
+                Py_DECREF(op);
+                return NULL;
+            }
             _fill_items_none(items, n_args, n_items);
         } else {
+            // the strategies are resolved by _datatype_copy_default,
+            // but a subclass with __init__ may not have them
+            PyObject *copiers = PyDict_GetItemWithError(type->tp_dict, __default_copy__name);
+            if (copiers != NULL && Py_SIZE(copiers) != Py_SIZE(default_vals))
+                copiers = NULL;
+            if (copiers == NULL && PyErr_Occurred()) {
+                _fill_items_none(items, n_args, n_items);
+                Py_DECREF(op);
+                return NULL;
+            }
+
+            // the factories may run any code, so the tuples are kept alive
+            Py_INCREF(default_vals);
+            Py_XINCREF(copiers);
+
             Py_ssize_t i;
             for(i = n_args; i < n_items; i++) {
                 PyObject *value = PyTuple_GET_ITEM(default_vals, i);
-                if (value == Py_None) {
-                    Py_INCREF(Py_None);
-                    items[i] = Py_None;                    
-                } 
+                PyObject *val;
+
+                if (copiers != NULL)
+                    val = dataobject_copy_default_value(PyTuple_GET_ITEM(copiers, i), value);
                 else {
-                    PyObject *val;
-                    PyTypeObject *tp = Py_TYPE(value);
-
-                    if (tp == &PyList_Type)
-                        val = PyList_GetSlice(value, 0, Py_SIZE(value));
-                    else if (tp == &PyDict_Type || tp == &PySet_Type) 
-                        val = PyObject_CallMethod(value, "copy", NULL);
-                    else if (tp == &PyFactory_Type) {
-                        val = call_factory(value);
-                        if (!val) {
-                            Py_DECREF(default_vals);
-                            return NULL;
-                        }
-                    }
-                    else if (PyObject_HasAttrString(value, "__copy__"))
-                        val = PyObject_CallMethod(value, "__copy__", NULL);
-                    else {
-                        val = value;
-                        Py_INCREF(val);
-                    }                        
-                    items[i] = val;    
+                    PyObject *copier = dataobject_default_copier(value);
+                    val = dataobject_copy_default_value(copier, value);
+                    Py_DECREF(copier);
+                }
+                if (val == NULL) {
+                    Py_ssize_t j;
+                    for (j = i; j < n_items; j++)
+                        items[j] = NULL;
+                    Py_DECREF(default_vals);
+                    Py_XDECREF(copiers);
+                    Py_DECREF(op);
+                    return NULL;
                 }
+                items[i] = val;
             }
             Py_DECREF(default_vals);
+            Py_XDECREF(copiers);
         }
     }
 
@@ -522,6 +1255,132 @@ dataobject_new_empty(PyTypeObject *type)
     return op;
 }
 
+/*
+ * Constructor of the classes with Tail field: the positional arguments after the fields
+ * are the items of the tail, or the items are passed as an iterable by the keyword
+ * argument with the name of the tail field.
+ */
+static PyObject*
+dataobject_make_tail(PyTypeObject *type, PyObject *const*args, const Py_ssize_t n_args, PyObject *kwds)
+{
+    const Py_ssize_t n_items = PyDataObject_NUMITEMS(type);
+    PyObject *op = NULL, *tail = NULL, *seq = NULL, *kw = NULL;
+    PyObject *const*tail_args = NULL;
+    Py_ssize_t n_tail = 0;
+
+    DEFERRED_STEP();
+    INSTRUMENT_BEGIN(type);
+
+    if (kwds && PyDict_GET_SIZE(kwds) > 0) {
+        PyObject *name = PyDict_GetItem(type->tp_dict, __tail__name);
+
+        INSTRUMENT_KWDS(type, kwds);
+        if (name)
+            tail = PyDict_GetItem(kwds, name);
+        if (tail) {
+            if (n_args > n_items) {
+                PyErr_Format(PyExc_TypeError,
+                    "the items of the tail %U are passed by position and by keyword", name);
+                return NULL;
+            }
+            kw = PyDict_Copy(kwds);
+            if (kw == NULL)
+                return NULL;
+            if (PyDict_DelItem(kw, name) < 0)
+                goto error;
+        } else {
+            kw = kwds;
+            Py_INCREF(kw);
+        }
+    }
+
+    if (tail) {
+        seq = PySequence_Fast(tail, "the items of the tail should be an iterable");
+        if (seq == NULL)
+            goto error;
+        n_tail = PySequence_Fast_GET_SIZE(seq);
+        tail_args = PySequence_Fast_ITEMS(seq);
+    }
+    else if (n_args > n_items) {
+        n_tail = n_args - n_items;
+        tail_args = args + n_items;
+    }
+
+    op = type->tp_alloc(type, n_tail);
+    if (op == NULL)
+        goto error;
+
+    PyObject **items = PyDataObject_ITEMS(op);
+    const Py_ssize_t n_fixed = (n_args < n_items) ? n_args : n_items;
+
+    _fill_items(items, args, n_fixed);
+    _fill_items(PyDataObject_TAIL_ITEMS(op), tail_args, n_tail);
+    Py_CLEAR(seq);
+
+    if (n_fixed == n_items)
+        INSTRUMENT_COUNT(positional);
+    else {
+        PyObject *default_vals = PyDict_GetItem(type->tp_dict, __default_vals__name);
+
+        INSTRUMENT_COUNT(defaults);
+        if (default_vals == NULL)
+            _fill_items_none(items, n_fixed, n_items);
+        else if (!_fill_items_defaults(items, default_vals, n_fixed, n_items))
+            goto error;
+    }
+
+    if (kw && PyDict_GET_SIZE(kw) > 0) {
+        if (_dataobject_update(op, kw, 1) < 0)
+            goto error;
+        dataobject_reset_changes(op);
+    }
+    Py_XDECREF(kw);
+
+    return op;
+
+error:
+    Py_XDECREF(op);
+    Py_XDECREF(seq);
+    Py_XDECREF(kw);
+    return NULL;
+}
+
+static PyObject*
+dataobject_new_tail(PyTypeObject *type, PyObject *args, PyObject *kwds)
+{
+    PyObject *const*tmp = (PyObject*const*)(((PyTupleObject*)args)->ob_item);
+
+    return dataobject_make_tail(type, tmp, Py_SIZE(args), kwds);
+}
+
+#if PY_VERSION_HEX >= 0x030A0000
+static PyObject*
+dataobject_vectorcall_tail(PyObject *type0, PyObject * const*args,
+                           size_t nargsf, PyObject *kwnames)
+{
+    const Py_ssize_t n_args = PyVectorcall_NARGS(nargsf);
+    PyObject *kwds = NULL, *op;
+
+    if (kwnames && PyTuple_GET_SIZE(kwnames) > 0) {
+        Py_ssize_t i, n_kwnames = PyTuple_GET_SIZE(kwnames);
+
+        kwds = PyDict_New();
+        if (kwds == NULL)
+            return NULL;
+        for (i = 0; i < n_kwnames; i++) {
+            if (PyDict_SetItem(kwds, PyTuple_GET_ITEM(kwnames, i), args[n_args + i]) < 0) {
+                Py_DECREF(kwds);
+                return NULL;
+            }
+        }
+    }
+
+    op = dataobject_make_tail((PyTypeObject*)type0, args, n_args, kwds);
+    Py_XDECREF(kwds);
+    return op;
+}
+#endif
+
 static int
 dataobject_init_basic(PyObject *op, PyObject *args, PyObject *kwds)
 {
@@ -540,17 +1399,21 @@ dataobject_init(PyObject *op, PyObject *args0, PyObject *kwds)
     Py_ssize_t i;
     for (i = 0; i < n_args; i++) {
         PyObject *v = *(args++);
-        Py_DECREF(*items);
+        Py_XDECREF(*items);
         Py_INCREF(v);
         *(items++) = v;            
     }
 
     if (kwds) {
+        INSTRUMENT_KWDS(Py_TYPE(op), kwds);
         int retval = _dataobject_update(op, kwds, 1);
         if (retval < 0)
             return retval;
+        dataobject_reset_changes(op);
     }    
 
+    dataobject_maybe_untrack(op);
+
     return 0;
 }
 
@@ -587,12 +1450,39 @@ _dataobject_update(PyObject *op, PyObject *kwds, int flag)
         if (flag) {            
             Py_ssize_t index = _tuple_index((PyTupleObject*)fields, key);
             if (index >= 0) {
-                dataobject_ass_item(op, index, val);
+                int ret = dataobject_ass_item(op, index, val);
                 Py_DECREF(val);
                 Py_DECREF(key);
+                if (ret < 0) {
+                    Py_DECREF(iter);
+                    Py_DECREF(fields);
+                    return -1;
+                }
                 continue;
             }
             else {
+                // the Inline, Packed and sparse fields are assigned by their descriptors
+                if (DATAOBJECT_HAS_PLAN(type)) {
+                    PyObject *d = PyDict_GetItem(type->tp_dict, key);
+                    int ret = 1;
+
+                    if (d && Py_TYPE(d) == &PyInlineProperty_Type)
+                        ret = inline_assign(op, d, val);
+                    else if (d && Py_TYPE(d) == &PyBitProperty_Type)
+                        ret = bits_assign(op, d, val);
+                    else if (d && Py_TYPE(d) == &PyDataObjectSparseProperty_Type)
+                        ret = sparse_assign(op, d, val);
+                    if (ret <= 0) {
+                        Py_DECREF(val);
+                        Py_DECREF(key);
+                        if (ret < 0) {
+                            Py_DECREF(iter);
+                            Py_DECREF(fields);
+                            return -1;
+                        }
+                        continue;
+                    }
+                }
                 if (!has___dict___) {
                     PyErr_Format(
                         PyExc_TypeError,
@@ -607,9 +1497,11 @@ _dataobject_update(PyObject *op, PyObject *kwds, int flag)
         }
 
         if (PyObject_SetAttr(op, key, val) < 0) {
-            PyErr_Format(
-                PyExc_TypeError, 
-                "Invalid kwarg: %U not in __fields__", key);
+            // the errors of the value (validation) are kept
+            if (PyErr_ExceptionMatches(PyExc_AttributeError))
+                PyErr_Format(
+                    PyExc_TypeError, 
+                    "Invalid kwarg: %U not in __fields__", key);
             Py_DECREF(val);
             Py_DECREF(key);
             Py_DECREF(iter);
@@ -624,6 +1516,89 @@ _dataobject_update(PyObject *op, PyObject *kwds, int flag)
     return 0;
 }
 
+//////////////////////// categorical fields /////////////////////////////
+
+// The str values of the categorical fields are replaced by the equal
+// value from the intern table of the type (the table is filled on the fly).
+// The table keeps every distinct value, until it's cleared by categorical_reset.
+
+static inline PyObject *
+categorical_value(PyObject *table, PyObject *value)
+{
+    if (PyUnicode_CheckExact(value)) {
+        PyObject *v = PyDict_SetDefault(table, value, value);
+        if (v == NULL)
+            return NULL;
+        Py_INCREF(v);
+        return v;
+    }
+    Py_INCREF(value);
+    return value;
+}
+
+static int
+dataobject_intern_categorical(PyObject *op)
+{
+    dataobjecttypeinfo_object *info = dataobject_get_typeinfo(Py_TYPE(op));
+    PyObject **items = PyDataObject_ITEMS(op);
+    Py_ssize_t k;
+
+    if (info == NULL || info->categorical_table == NULL)
+        return 0;
+
+    for (k = 0; k < info->n_categorical; k++) {
+        Py_ssize_t i = info->categorical_fields[k];
+        PyObject *v;
+
+        if (items[i] == NULL)
+            continue;
+        v = categorical_value(info->categorical_table, items[i]);
+        if (v == NULL)
+            return -1;
+        Py_DECREF(items[i]);
+        items[i] = v;
+    }
+    return 0;
+}
+
+#if PY_VERSION_HEX >= 0x030A0000
+static PyObject*
+dataobject_vectorcall_categorical(PyObject *type0, PyObject * const*args,
+                                  size_t nargsf, PyObject *kwnames)
+{
+    PyObject *op = dataobject_vectorcall(type0, args, nargsf, kwnames);
+
+    if (op == NULL)
+        return NULL;
+    if (dataobject_intern_categorical(op) < 0) {
+        Py_DECREF(op);
+        return NULL;
+    }
+    return op;
+}
+#endif
+
+static PyObject*
+dataobject_new_basic_categorical(PyTypeObject *type, PyObject *args, PyObject *kwds)
+{
+    PyObject *op = dataobject_new_basic(type, args, kwds);
+
+    if (op == NULL)
+        return NULL;
+    if (dataobject_intern_categorical(op) < 0) {
+        Py_DECREF(op);
+        return NULL;
+    }
+    return op;
+}
+
+static int
+dataobject_init_categorical(PyObject *op, PyObject *args, PyObject *kwds)
+{
+    if (dataobject_init(op, args, kwds) < 0)
+        return -1;
+    return dataobject_intern_categorical(op);
+}
 
 static int
 dataobject_clear(PyObject *op)
@@ -672,6 +1647,16 @@ dataobject_xdecref(PyObject *op)
         *items = NULL;
         items++;
     }
+
+    if (DATAOBJECT_HAS_TAIL(type)) {
+        items = PyDataObject_TAIL_ITEMS(op);
+        n_items = PyDataObject_TAIL_SIZE(op);
+        while (n_items--) {
+            Py_XDECREF(*items);
+            *items = NULL;
+            items++;
+        }
+    }
     return 0;
 }
 
@@ -716,66 +1701,188 @@ dataobject_dealloc_gc(PyObject *op)
 }
 
 static void
-dataobject_finalize_step(PyObject *op, PyObject *stack)
+dataobject_dealloc_stats(PyObject *op)
 {
-    Py_ssize_t n_items = PyDataObject_LEN(op);
-    PyObject **items = PyDataObject_ITEMS(op);
+    PyTypeObject *type = Py_TYPE(op);
 
-    while (n_items--) {
-        PyObject *o = *items;
+    if (type->tp_finalize != NULL) {
+        if(PyObject_CallFinalizerFromDealloc(op) < 0)
+            return;
+    }
 
-        if (py_refcnt(o) == 1 && Py_METATYPE(o) == datatype) {
-            PyList_Append(stack, o);
-        } else
-            Py_DECREF(o);
+    dataobject_stats_dec(type);
 
-        *(items++) = NULL;
-    }
-}
+    dataobject_xdecref(op);
 
-static PyObject* stack = NULL;
+#if PY_VERSION_HEX < 0x03080000
+    if (type->tp_flags & Py_TPFLAGS_HEAPTYPE)
+        Py_DECREF(type);
+#endif
+
+    type->tp_free((PyObject *)op);
+}
 
 static void
-dataobject_finalize(PyObject *ob) {
-    Py_ssize_t j;
+dataobject_dealloc_gc_stats(PyObject *op)
+{
+    PyTypeObject *type = Py_TYPE(op);
 
-    if (!stack)
-        stack = PyList_New(0);
+    if (type->tp_finalize != NULL) {
+        if(PyObject_CallFinalizerFromDealloc(op) < 0)
+            return;
+    }
 
-    dataobject_finalize_step(ob, stack);
+    PyObject_GC_UnTrack(op);
 
-    Py_ssize_t n_stack = PyList_GET_SIZE(stack);
-    while (n_stack) {
-        PyObject *op = PyList_GET_ITEM(stack, 0);
+    dataobject_stats_dec(type);
 
-        if (py_refcnt(op) == 1)
-            dataobject_finalize_step(op, stack);
+    dataobject_xdecref(op);
 
-        Py_DECREF(op);
+    if (type->tp_flags & Py_TPFLAGS_HEAPTYPE)
+        Py_DECREF(type);
 
-        {   PyList_SET_ITEM(stack, 0, NULL);
-            for(j=1; j<n_stack; j++) {
-                PyList_SET_ITEM(stack, j-1, PyList_GET_ITEM(stack, j));
-            }
-            n_stack--;
-            PyList_SET_ITEM(stack, n_stack, NULL);
-            Py_SET_SIZE(stack, n_stack);
-        }
-    }
+    type->tp_free((PyObject *)op);
 }
 
-PyDoc_STRVAR(dataobject_len_doc,
-"T.__len__() -- len of T");
-
-static Py_ssize_t
-dataobject_len(PyObject *op)
+static void
+dataobject_xdecref_deferred(PyObject *op)
 {
-    Py_ssize_t n = PyDataObject_LEN(op);
     PyTypeObject *type = Py_TYPE(op);
+
+    if (type->tp_weaklistoffset)
+        PyObject_ClearWeakRefs(op);
+
     if (type->tp_dictoffset) {
         PyObject **dictptr = PyDataObject_DICTPTR(type, op);
         if (dictptr && *dictptr) {
-            n += PyDict_Size(*dictptr);
+            deferred_decref(*dictptr);
+            *dictptr = NULL;
+        }
+    }
+
+    PyObject **items = PyDataObject_ITEMS(op);
+    Py_ssize_t n_items = PyDataObject_NUMITEMS(type);
+
+    while (n_items--) {
+        PyObject *v = *items;
+        if (v) {
+            *items = NULL;
+            deferred_decref(v);
+        }
+        items++;
+    }
+}
+
+static void
+dataobject_dealloc_deferred(PyObject *op)
+{
+    PyTypeObject *type = Py_TYPE(op);
+
+    if (type->tp_finalize != NULL) {
+        if(PyObject_CallFinalizerFromDealloc(op) < 0)
+            return;
+    }
+
+    dataobject_xdecref_deferred(op);
+
+#if PY_VERSION_HEX < 0x03080000
+    if (type->tp_flags & Py_TPFLAGS_HEAPTYPE)
+        Py_DECREF(type);
+#endif
+
+    type->tp_free((PyObject *)op);
+
+}
+
+static void
+dataobject_dealloc_gc_deferred(PyObject *op)
+{
+    PyTypeObject *type = Py_TYPE(op);
+
+    if (type->tp_finalize != NULL) {
+        if(PyObject_CallFinalizerFromDealloc(op) < 0)
+            return;
+    }
+
+    PyObject_GC_UnTrack(op);
+
+    dataobject_xdecref_deferred(op);
+
+    type->tp_free((PyObject *)op);
+
+
+    if (type->tp_flags & Py_TPFLAGS_HEAPTYPE)
+        Py_DECREF(type);
+}
+
+static void
+dataobject_finalize_step(PyObject *op, PyObject *stack)
+{
+    Py_ssize_t n_items = PyDataObject_LEN(op);
+    PyObject **items = PyDataObject_ITEMS(op);
+
+    while (n_items--) {
+        PyObject *o = *items;
+
+        if (o == NULL)
+            ;
+        else if (py_refcnt(o) == 1 && Py_METATYPE(o) == datatype) {
+            PyList_Append(stack, o);
+        } else
+            Py_DECREF(o);
+
+        *(items++) = NULL;
+    }
+}
+
+static PyObject* stack = NULL;
+
+static void
+dataobject_finalize(PyObject *ob) {
+    Py_ssize_t j;
+
+    if (!stack)
+        stack = PyList_New(0);
+
+    dataobject_finalize_step(ob, stack);
+
+    Py_ssize_t n_stack = PyList_GET_SIZE(stack);
+    while (n_stack) {
+        PyObject *op = PyList_GET_ITEM(stack, 0);
+
+        if (py_refcnt(op) == 1)
+            dataobject_finalize_step(op, stack);
+
+        Py_DECREF(op);
+
+        {   PyList_SET_ITEM(stack, 0, NULL);
+            for(j=1; j<n_stack; j++) {
+                PyList_SET_ITEM(stack, j-1, PyList_GET_ITEM(stack, j));
+            }
+            n_stack--;
+            PyList_SET_ITEM(stack, n_stack, NULL);
+            Py_SET_SIZE(stack, n_stack);
+        }
+    }
+}
+
+PyDoc_STRVAR(dataobject_len_doc,
+"T.__len__() -- len of T");
+
+static Py_ssize_t
+dataobject_len(PyObject *op)
+{
+    Py_ssize_t n = PyDataObject_LEN(op) + dataobject_tail_len(op);
+    PyTypeObject *type = Py_TYPE(op);
+
+    if (DATAOBJECT_HAS_PLAN_VALUES(type)) {
+        PyObject *plan = dataobject_type_plan(type);
+        n = plan ? PyTuple_GET_SIZE(plan) : 0;
+    }
+    if (type->tp_dictoffset) {
+        PyObject **dictptr = PyDataObject_DICTPTR(type, op);
+        if (dictptr && *dictptr) {
+            n += PyDict_Size(*dictptr);
         }
     }
     return n;
@@ -816,11 +1923,7 @@ dataobject_sq_item(PyObject *op, Py_ssize_t i)
         return NULL;
     }
 
-    PyObject *v = PyDataObject_GET_ITEM(op, i);
-    // if (v == NULL) {
-    //     PyErr_SetString(PyExc_IndexError, "item has no value");
-    //     return NULL;
-    // }
+    PyObject *v = PyDataObject_GET_VALUE(op, i);
 
     Py_INCREF(v);
     return v;
@@ -840,13 +1943,54 @@ dataobject_sq_ass_item(PyObject *op, Py_ssize_t i, PyObject *val)
 
     PyObject **item = PyDataObject_ITEMS(op) + i;
 
-    Py_DECREF(*item);
-    Py_INCREF(val);
+    if (val == NULL) {
+        PyErr_SetString(PyExc_TypeError, "the items can't be deleted");
+        return -1;
+    }
+    if (DATAOBJECT_VALIDATED(op)) {
+        val = dataobject_validate_item(op, i, val);
+        if (val == NULL)
+            return -1;
+    } else
+        Py_INCREF(val);
+
+    Py_XDECREF(*item);
     *item = val;
 
+    dataobject_maybe_track(op, val);
+    dataobject_mark_changed(op, i);
+
     return 0;
 }
 
+// the bit of the categorical field in the mask of the type made by _datatype_categorical
+#define categorical_mask_test(mask, i) (((mask)[(i) >> 3] >> ((i) & 7)) & 1)
+
+static int
+dataobject_sq_ass_item_categorical(PyObject *op, Py_ssize_t i, PyObject *val)
+{
+    dataobjecttypeinfo_object *info;
+    const Py_ssize_t n = PyDataObject_LEN(op);
+    int ret;
+
+    if (i < 0)
+        i += n;
+    if (val == NULL || !PyUnicode_CheckExact(val) || i < 0 || i >= n)
+        return dataobject_sq_ass_item(op, i, val);
+
+    info = dataobject_get_typeinfo(Py_TYPE(op));
+    if (info == NULL || info->categorical_table == NULL ||
+            !categorical_mask_test(info->categorical_mask, i))
+        return dataobject_sq_ass_item(op, i, val);
+
+    val = categorical_value(info->categorical_table, val);
+    if (val == NULL)
+        return -1;
+    ret = dataobject_sq_ass_item(op, i, val);
+    Py_DECREF(val);
+    return ret;
+}
+
 static PyObject*
 dataobject_mp_subscript(PyObject* op, PyObject* name)
 {
@@ -900,6 +2044,34 @@ dataobject_mp_ass_subscript_sq(PyObject* op, PyObject* item, PyObject *val)
     }
 }
 
+static int
+dataobject_mp_ass_subscript2_categorical(PyObject* op, PyObject* item, PyObject *val)
+{
+    PyNumberMethods *tp_as_number = Py_TYPE(item)->tp_as_number;
+    if (tp_as_number != NULL && tp_as_number->nb_index != NULL) {
+        Py_ssize_t i = PyLong_AsSsize_t(item);
+        if (i == -1 && PyErr_Occurred())
+            return -1;
+        return dataobject_sq_ass_item_categorical(op, i, val);
+    } else
+        return Py_TYPE(op)->tp_setattro(op, item, val);
+}
+
+static int
+dataobject_mp_ass_subscript_sq_categorical(PyObject* op, PyObject* item, PyObject *val)
+{
+    PyNumberMethods *tp_as_number = Py_TYPE(item)->tp_as_number;
+    if (tp_as_number != NULL && tp_as_number->nb_index != NULL) {
+        Py_ssize_t i = PyLong_AsSsize_t(item);
+        if (i == -1 && PyErr_Occurred())
+            return -1;
+        return dataobject_sq_ass_item_categorical(op, i, val);
+    } else {
+        type_error("object %s support only assignment by index", op);
+        return -1;
+    }
+}
+
 static PyObject*
 dataobject_mp_subscript_sq(PyObject* op, PyObject* item)
 {
@@ -915,6 +2087,84 @@ dataobject_mp_subscript_sq(PyObject* op, PyObject* item)
     }
 }
 
+// The items of the tail follow the fields in the sequence of the Tail class
+
+static PyObject *
+dataobject_sq_item_tail(PyObject *op, Py_ssize_t i)
+{
+    const Py_ssize_t n_items = PyDataObject_LEN(op);
+    const Py_ssize_t n = n_items + PyDataObject_TAIL_SIZE(op);
+
+    if (i < 0)
+        i += n;
+    if (i < 0 || i >= n) {
+        PyErr_Format(PyExc_IndexError, "index %d out of range", i);
+        return NULL;
+    }
+
+    PyObject *v = dataobject_seq_get(op, n_items, i);
+    Py_INCREF(v);
+    return v;
+}
+
+static int
+dataobject_sq_ass_item_tail(PyObject *op, Py_ssize_t i, PyObject *val)
+{
+    const Py_ssize_t n_items = PyDataObject_LEN(op);
+    const Py_ssize_t n = n_items + PyDataObject_TAIL_SIZE(op);
+
+    if (i < 0)
+        i += n;
+    if (i < 0 || i >= n) {
+        PyErr_Format(PyExc_IndexError, "index %d out of range", i);
+        return -1;
+    }
+    if (i < n_items)
+        return dataobject_sq_ass_item(op, i, val);
+    if (val == NULL) {
+        PyErr_SetString(PyExc_TypeError, "the items of the tail can't be deleted");
+        return -1;
+    }
+
+    PyObject **item = PyDataObject_TAIL_ITEMS(op) + (i - n_items);
+
+    Py_INCREF(val);
+    Py_DECREF(*item);
+    *item = val;
+
+    return 0;
+}
+
+static PyObject*
+dataobject_mp_subscript_sq_tail(PyObject* op, PyObject* item)
+{
+    PyNumberMethods *tp_as_number = Py_TYPE(item)->tp_as_number;
+    if (tp_as_number != NULL && tp_as_number->nb_index != NULL) {
+        Py_ssize_t i = PyLong_AsSsize_t(item);
+        if (i == -1 && PyErr_Occurred())
+            return NULL;
+        return dataobject_sq_item_tail(op, i);
+    } else {
+        type_error("object %s get item only by index", op);
+        return NULL;
+    }
+}
+
+static int
+dataobject_mp_ass_subscript_sq_tail(PyObject* op, PyObject* item, PyObject *val)
+{
+    PyNumberMethods *tp_as_number = Py_TYPE(item)->tp_as_number;
+    if (tp_as_number != NULL && tp_as_number->nb_index != NULL) {
+        Py_ssize_t i = PyLong_AsSsize_t(item);
+        if (i == -1 && PyErr_Occurred())
+            return -1;
+        return dataobject_sq_ass_item_tail(op, i, val);
+    } else {
+        type_error("object %s support only assignment by index", op);
+        return -1;
+    }
+}
+
 static void copy_sequence_methods(PySequenceMethods *out, PySequenceMethods *in) {
     out->sq_length = in->sq_length;
     out->sq_concat = in->sq_concat;
@@ -1015,13 +2265,25 @@ static PyMappingMethods dataobject_as_mapping_sq_ro = {
 static Py_hash_t
 dataobject_hash(PyObject *op)
 {
-    const Py_ssize_t len = PyDataObject_LEN(op);
+    const Py_ssize_t n_items = PyDataObject_LEN(op);
+    const Py_ssize_t len = n_items + dataobject_tail_len(op);
     Py_hash_t mult = _PyHASH_MULTIPLIER;
     Py_ssize_t i;
 
+    if (DATAOBJECT_IS_SPARSE(Py_TYPE(op))) {
+        PyObject *args = inline_logical_args(op);
+        Py_hash_t h;
+
+        if (args == NULL)
+            return -1;
+        h = PyObject_Hash(args);
+        Py_DECREF(args);
+        return h;
+    }
+
     Py_uhash_t x = 0x345678L;
     for(i=0; i<len; i++) {
-        PyObject *o = PyDataObject_GET_ITEM(op, i);
+        PyObject *o = dataobject_seq_get(op, n_items, i);
         Py_hash_t y = PyObject_Hash(o);
 //         Py_DECREF(o);
         if (y == -1)
@@ -1030,6 +2292,18 @@ dataobject_hash(PyObject *op)
         mult += (Py_hash_t)(82520L + len + len);
     }
 
+    // the equal packed values have the equal words
+    if (DATAOBJECT_HAS_BITS(Py_TYPE(op))) {
+        PyTypeObject *tp = Py_TYPE(op);
+        uint64_t *words = (uint64_t*)((char*)op + dataobject_bits_offset(tp));
+        uint64_t *end = (uint64_t*)((char*)op + tp->tp_basicsize);
+
+        for (; words < end; words++) {
+            x = (x ^ (Py_uhash_t)(*words ^ (*words >> 32))) * mult;
+            mult += (Py_hash_t)(82520L + len + len);
+        }
+    }
+
     x += 97531L;
     if (x == (Py_uhash_t)-1)
         x = -2;
@@ -1063,7 +2337,8 @@ static PyObject *
 dataobject_richcompare(PyObject *v, PyObject *w, int op)
 {
     Py_ssize_t i, k;
-    Py_ssize_t vlen = PyDataObject_LEN(v), wlen = PyDataObject_LEN(w);
+    Py_ssize_t vlen, wlen;
+    Py_ssize_t v_items, w_items;
     PyObject *vv;
     PyObject *ww;
     PyObject *ret;
@@ -1072,6 +2347,28 @@ dataobject_richcompare(PyObject *v, PyObject *w, int op)
         (!PyObject_IsSubclass((PyObject*)Py_TYPE(w), (PyObject*)Py_TYPE(v))))
                   Py_RETURN_NOTIMPLEMENTED;
 
+    if (DATAOBJECT_IS_SPARSE(Py_TYPE(v))) {
+        PyObject *va = inline_logical_args(v);
+        PyObject *wa;
+
+        if (va == NULL)
+            return NULL;
+        wa = inline_logical_args(w);
+        if (wa == NULL) {
+            Py_DECREF(va);
+            return NULL;
+        }
+        ret = PyObject_RichCompare(va, wa, op);
+        Py_DECREF(va);
+        Py_DECREF(wa);
+        return ret;
+    }
+
+    v_items = PyDataObject_LEN(v);
+    w_items = PyDataObject_LEN(w);
+    vlen = v_items + dataobject_tail_len(v);
+    wlen = w_items + dataobject_tail_len(w);
+
     if ((vlen != wlen) && (op == Py_EQ || op == Py_NE)) {
         PyObject *res;
         if (op == Py_EQ)
@@ -1083,8 +2380,8 @@ dataobject_richcompare(PyObject *v, PyObject *w, int op)
     }
 
     for (i = 0; i < vlen && i < wlen; i++) {
-        vv = PyDataObject_GET_ITEM(v, i);
-        ww = PyDataObject_GET_ITEM(w, i);
+        vv = dataobject_seq_get(v, v_items, i);
+        ww = dataobject_seq_get(w, w_items, i);
         k = PyObject_RichCompareBool(vv, ww, Py_EQ);
 //         Py_DECREF(vv);
 //         Py_DECREF(ww);
@@ -1094,6 +2391,32 @@ dataobject_richcompare(PyObject *v, PyObject *w, int op)
             break;
     }
 
+    if (i >= vlen && i >= wlen && DATAOBJECT_HAS_BITS(Py_TYPE(v))) {
+        /* The equal fields -- compare the packed values */
+        PyTypeObject *tp = Py_TYPE(v);
+        Py_ssize_t offset = dataobject_bits_offset(tp);
+
+        if (op == Py_EQ || op == Py_NE) {
+            int eq = memcmp((char*)v + offset, (char*)w + offset, tp->tp_basicsize - offset) == 0;
+            return PyBool_FromLong((long)(op == Py_EQ ? eq : !eq));
+        } else {
+            PyObject *vb = dataobject_bits_values(v);
+            PyObject *wb;
+
+            if (vb == NULL)
+                return NULL;
+            wb = dataobject_bits_values(w);
+            if (wb == NULL) {
+                Py_DECREF(vb);
+                return NULL;
+            }
+            ret = PyObject_RichCompare(vb, wb, op);
+            Py_DECREF(vb);
+            Py_DECREF(wb);
+            return ret;
+        }
+    }
+
     if (i >= vlen || i >= wlen) {
         /* No more items to compare -- compare sizes */
         int cmp;
@@ -1126,8 +2449,8 @@ dataobject_richcompare(PyObject *v, PyObject *w, int op)
     }
 
     /* Compare the final item again using the proper operator */
-    vv = PyDataObject_GET_ITEM(v, i);
-    ww = PyDataObject_GET_ITEM(w, i);
+    vv = dataobject_seq_get(v, v_items, i);
+    ww = dataobject_seq_get(w, w_items, i);
     ret = PyObject_RichCompare(vv, ww, op);
 //     Py_DECREF(vv);
 //     Py_DECREF(ww);
@@ -1141,7 +2464,11 @@ PyDoc_STRVAR(dataobject_sizeof_doc,
 static PyObject *
 dataobject_sizeof(PyObject *self)
 {
-    return PyLong_FromSsize_t(Py_TYPE(self)->tp_basicsize);
+    Py_ssize_t n = dataobject_tail_len(self);
+
+    if (DATAOBJECT_IS_SPARSE(Py_TYPE(self)))
+        n += dataobject_sparse_count(self);
+    return PyLong_FromSsize_t(Py_TYPE(self)->tp_basicsize + n * sizeof(PyObject*));
 }
 
 PyDoc_STRVAR(dataobject_copy_doc,
@@ -1153,13 +2480,28 @@ dataobject_copy(PyObject* op)
     PyTypeObject *type = Py_TYPE(op);
 
     const Py_ssize_t n_items = PyDataObject_NUMITEMS(type);
+    const Py_ssize_t n_tail = dataobject_tail_len(op);
 
-    PyObject *new_op = type->tp_alloc(type, 0);
+    PyObject *new_op = type->tp_alloc(type, n_tail);
+    if (new_op == NULL)
+        return NULL;
 
     PyObject **items = PyDataObject_ITEMS(new_op);
     PyObject **args = (PyObject**)PyDataObject_ITEMS(op);
 
-    _fill_items(items, args, n_items);
+    _copy_items(items, args, n_items);
+    if (n_tail)
+        _fill_items(PyDataObject_TAIL_ITEMS(new_op), PyDataObject_TAIL_ITEMS(op), n_tail);
+    // the packed values of the original (the copy is a new object, so the bitmap of
+    // the changed fields stays clear as after the constructor and unpickling)
+    if (DATAOBJECT_HAS_BITS(type)) {
+        Py_ssize_t offset = dataobject_bits_offset(type);
+        memcpy((char*)new_op + offset, (char*)op + offset, type->tp_basicsize - offset);
+    }
+    if (DATAOBJECT_IS_SPARSE(type) && dataobject_sparse_copy(new_op, op) < 0) {
+        Py_DECREF(new_op);
+        return NULL;
+    }
 
     if (type->tp_dictoffset) {
         PyObject **dictptr = PyDataObject_DICTPTR(type, op);
@@ -1195,7 +2537,7 @@ dataobject_item(PyObject *op, Py_ssize_t i)
         return NULL;
     }
 
-    PyObject *v = ((PyDataStruct*)op)->ob_items[i];
+    PyObject *v = PyDataObject_GET_VALUE(op, i);
     Py_INCREF(v);
     return v;
 }
@@ -1213,9 +2555,22 @@ static int dataobject_ass_item(PyObject *op, Py_ssize_t i, PyObject *val)
 
     PyObject **items = PyDataObject_ITEMS(op) + i;
 
+    if (val == NULL) {
+        PyErr_SetString(PyExc_TypeError, "the items can't be deleted");
+        return -1;
+    }
+    if (DATAOBJECT_VALIDATED(op)) {
+        val = dataobject_validate_item(op, i, val);
+        if (val == NULL)
+            return -1;
+    } else
+        Py_INCREF(val);
+
     Py_XDECREF(*items);
-    Py_INCREF(val);
     *items = val;
+
+    dataobject_maybe_track(op, val);
+    dataobject_mark_changed(op, i);
     return 0;
 }
 
@@ -1228,6 +2583,10 @@ dataobject_repr(PyObject *self)
     Py_ssize_t i;
     PyObject *fs;
     PyTypeObject *tp = Py_TYPE(self);
+
+    if (DATAOBJECT_HAS_PLAN(tp))
+        return dataobject_repr_inline(self);
+
     PyObject *tp_name = PyObject_GetAttrString((PyObject*)tp, "__name__");
     PyObject *tmp;
     PyObject *sep = PyUnicode_FromString(", ");
@@ -1251,7 +2610,7 @@ dataobject_repr(PyObject *self)
         PyErr_Clear();
 
     Py_ssize_t n = PyDataObject_LEN(self);
-    if (n == 0) {
+    if (n == 0 && !DATAOBJECT_HAS_TAIL(tp)) {
         PyObject *s = PyUnicode_FromString("()");
         PyObject *text = PyUnicode_Concat(tp_name, s);
         Py_DECREF(s);
@@ -1299,6 +2658,27 @@ dataobject_repr(PyObject *self)
         }
     }
 
+    if (DATAOBJECT_HAS_TAIL(tp)) {
+        PyObject *tail_name = PyDict_GetItem(tp->tp_dict, __tail__name);
+        PyObject *tail = dataobject_tail_tuple(self);
+        if (tail_name == NULL || tail == NULL) {
+            Py_XDECREF(tail);
+            goto error;
+        }
+
+        if (n > 0)
+            PyList_Append(items, sep);
+        PyList_Append(items, tail_name);
+        PyList_Append(items, eq);
+
+        PyObject *s = PyObject_Repr(tail);
+        Py_DECREF(tail);
+        if (s == NULL)
+            goto error;
+        PyList_Append(items, s);
+        Py_DECREF(s);
+    }
+
     Py_XDECREF(fs);
     Py_DECREF(sep);
     Py_DECREF(eq);
@@ -1328,6 +2708,7 @@ dataobject_repr(PyObject *self)
     tmp = PyUnicode_FromString("");
     PyObject *ret = PyUnicode_Join(tmp, items);
     Py_DECREF(tmp);
+    Py_DECREF(items);
 
     return ret;
 
@@ -1395,7 +2776,8 @@ dataobject_reduce(PyObject *ob, PyObject *Py_UNUSED(ignore))
     PyObject *kw = NULL;
     PyObject **dictptr;
 
-    PyObject *args = _astuple(ob);
+    // the constructor of the class with inline fields takes the datastructs
+    PyObject *args = DATAOBJECT_HAS_PLAN(tp) ? inline_logical_args(ob) : _astuple(ob);
     if (args == NULL)
         return NULL;
 
@@ -1470,6 +2852,12 @@ dataobject_setstate(PyObject *ob, PyObject *state) {
     Py_RETURN_NONE;
 }
 
+static PyObject *dataobject_replacer(PyObject *cls, PyObject *args, PyObject *kw);
+
+PyDoc_STRVAR(dataobject_replacer_doc,
+"T.__replacer__(*names, inplace=False) -- callable r(ob, *values) that returns a copy of ob\n"
+"with the new values of the given fields (or assigns them to ob if inplace=True)");
+
 static PyMethodDef dataobject_methods[] = {
     // {"__getitem__",  (PyCFunction)(void(*)(void))dataobject_subscript, METH_O|METH_COEXIST, dataobject_subscript_doc},
     // {"__setitem__",  (PyCFunction)dataobject_ass_subscript, METH_VARARGS|METH_COEXIST, dataobject_ass_subscript_doc},
@@ -1480,6 +2868,7 @@ static PyMethodDef dataobject_methods[] = {
     {"__reduce__",    (PyCFunction)dataobject_reduce, METH_NOARGS, dataobject_reduce_doc},
     {"__getstate__",  (PyCFunction)dataobject_getstate, METH_NOARGS, dataobject_getstate_doc},
     {"__setstate__",  (PyCFunction)dataobject_setstate, METH_O, dataobject_setstate_doc},
+    {"__replacer__",  (PyCFunction)dataobject_replacer, METH_VARARGS|METH_KEYWORDS|METH_CLASS, dataobject_replacer_doc},
     // {"__hash__",     (PyCFunction)dataobject_hash2_ni, METH_O, dataobject_hash_doc},
     {NULL}
 };
@@ -1682,7 +3071,7 @@ dataobjectiter_next(dataobjectiterobject *it)
     PyObject *op = it->it_seq;
 
     if (it->it_index < it->it_len) {
-        item = PyDataObject_GET_ITEM(op, it->it_index);
+        item = dataobject_seq_get(op, PyDataObject_LEN(op), it->it_index);
         Py_INCREF(item);
         it->it_index++;
         return item;
@@ -1802,7 +3191,7 @@ dataobject_iter(PyObject *seq)
     it->it_index = 0;
     it->it_seq = seq;
     Py_INCREF(seq);
-    it->it_len = PyDataObject_LEN(seq);
+    it->it_len = PyDataObject_LEN(seq) + dataobject_tail_len(seq);
 
     return (PyObject *)it;
 }
@@ -1821,9 +3210,11 @@ dataobjectproperty_new(PyTypeObject *t, PyObject *args, PyObject *k)
     Py_ssize_t len, index;
     int readonly;
 
+    PyObject *table = NULL;
+
     len = Py_SIZE(args);
-    if (len == 0 || len > 2) {
-        PyErr_SetString(PyExc_TypeError, "number of args is 1 or 2");
+    if (len == 0 || len > 3) {
+        PyErr_SetString(PyExc_TypeError, "number of args is 1, 2 or 3");
         return NULL;
     }
 
@@ -1833,12 +3224,22 @@ dataobjectproperty_new(PyTypeObject *t, PyObject *args, PyObject *k)
         return NULL;
     }
 
-    if (len == 2) {
+    if (len >= 2) {
         item = PyTuple_GET_ITEM(args, 1);
         readonly = PyObject_IsTrue(item);
     } else
         readonly = 0;
 
+    if (len == 3) {
+        table = PyTuple_GET_ITEM(args, 2);
+        if (table == Py_None)
+            table = NULL;
+        else if (!PyDict_CheckExact(table)) {
+            PyErr_SetString(PyExc_TypeError, "the intern table should be a dict");
+            return NULL;
+        }
+    }
+
     ob = PyObject_New(dataobjectproperty_object, t);
     if (ob == NULL)
         return NULL;
@@ -1849,6 +3250,8 @@ dataobjectproperty_new(PyTypeObject *t, PyObject *args, PyObject *k)
 #endif
     ob->readonly = readonly;
     ob->index = index;
+    Py_XINCREF(table);
+    ob->table = table;
     return (PyObject*)ob;
 }
 
@@ -1857,6 +3260,7 @@ dataobjectproperty_dealloc(PyObject *o)
 {
     PyTypeObject *t = Py_TYPE(o);
 
+    Py_XDECREF(((dataobjectproperty_object *)o)->table);
     t->tp_free(o);
 
 #if PY_VERSION_HEX >= 0x03080000
@@ -1873,7 +3277,7 @@ dataobjectproperty_get(PyObject *self, PyObject *obj, PyObject *type)
         return self;
     }
 
-    PyObject *v = PyDataObject_GET_ITEM(obj, ((dataobjectproperty_object *)self)->index);
+    PyObject *v = PyDataObject_GET_VALUE(obj, ((dataobjectproperty_object *)self)->index);
 
     Py_INCREF(v);
     return v;
@@ -1896,12 +3300,29 @@ dataobjectproperty_set(PyObject *self, PyObject *obj, PyObject *value)
     }
 
     PyObject **ptr = PyDataObject_ITEMS(obj) + ((dataobjectproperty_object *)self)->index;
+    PyObject *table = ((dataobjectproperty_object *)self)->table;
+
+    if (table) {
+        value = categorical_value(table, value);
+        if (value == NULL)
+            return -1;
+    } else
+        Py_INCREF(value);
 
-    Py_DECREF(*ptr);
+    if (DATAOBJECT_VALIDATED(obj)) {
+        PyObject *v = dataobject_validate_item(obj, ((dataobjectproperty_object *)self)->index, value);
+        Py_DECREF(value);
+        if (v == NULL)
+            return -1;
+        value = v;
+    }
 
-    Py_INCREF(value);
+    Py_XDECREF(*ptr);
     *ptr = value;
 
+    dataobject_maybe_track(obj, value);
+    dataobject_mark_changed(obj, ((dataobjectproperty_object *)self)->index);
+
     return 0;
 }
 
@@ -1917,6 +3338,12 @@ dataobjectproperty_readonly(PyObject *self)
     return PyBool_FromLong((long)(((dataobjectproperty_object*)self)->readonly));
 }
 
+static PyObject*
+dataobjectproperty_categorical(PyObject *self)
+{
+    return PyBool_FromLong(((dataobjectproperty_object*)self)->table != NULL);
+}
+
 // static int
 // dataobjectproperty_readonly_set(PyObject *self, PyObject *val)
 // {
@@ -1927,6 +3354,7 @@ dataobjectproperty_readonly(PyObject *self)
 static PyGetSetDef dataobjectproperty_getsets[] = {
     {"index", (getter)dataobjectproperty_index, NULL, NULL},
     {"readonly", (getter)dataobjectproperty_readonly, NULL, NULL},
+    {"categorical", (getter)dataobjectproperty_categorical, NULL, NULL},
     {0}
 };
 
@@ -1973,50 +3401,201 @@ static PyTypeObject PyDataObjectProperty_Type = {
     0, /*tp_is_gc*/
 };
 
-///////////////////////// Factory ////////////////////////////////////////
+///////////////////////// inline datastruct fields ///////////////////////
 
-static PyObject *Factory_new(PyTypeObject *tp, PyObject *args, PyObject *kw) {
-    struct PyFactoryObject *p;
-    Py_ssize_t n_args = Py_SIZE(args);
-    PyObject *o;
-    
-    o = (*tp->tp_alloc)(tp, 0);
-    if (!o) return NULL;
-    
-    p = ((struct PyFactoryObject *)o);
-    if (n_args != 1) {
-        PyErr_SetString(PyExc_TypeError, "number of arguments != 1");
-        return NULL;        
+// The fields of the datastruct S of the field annotated by Inline[S] are stored
+// by value in the slots of the record. The inlineproperty descriptor of the field
+// returns a copy of the datastruct (or a proxy to the slots) and flattens the
+// assigned value into the slots. __inline__ of the class is the tuple of pairs
+// (name, inlineproperty or None) of the positional arguments of the constructor.
+
+static PyTypeObject PyInlineProxy_Type;
+
+// borrowed values of the slots of the inline field from the datastruct, proxy or tuple
+static PyObject **
+inline_value_items(inlineproperty_object *p, PyObject *value)
+{
+    const Py_ssize_t n = PyDataObject_NUMITEMS(p->type);
+
+    if (Py_TYPE(value) == p->type)
+        return PyDataObject_ITEMS(value);
+    if (Py_TYPE(value) == &PyInlineProxy_Type) {
+        inlineproxy_object *px = (inlineproxy_object*)value;
+        if (px->prop->type == p->type)
+            return PyDataObject_ITEMS(px->ob) + px->prop->start;
     }
-    
-    PyObject *f = PyTuple_GET_ITEM(args, 0);
-    p->factory = f; Py_INCREF(f);
+    else if (PyTuple_CheckExact(value) && PyTuple_GET_SIZE(value) == n)
+        return ((PyTupleObject*)value)->ob_item;
 
-    return o;
+    PyErr_Format(PyExc_TypeError, "expected %s or tuple of %zd values, got %s",
+                 p->type->tp_name, n, Py_TYPE(value)->tp_name);
+    return NULL;
 }
 
-static void Factory_dealloc(PyObject *o) {
-    struct PyFactoryObject *p = (struct PyFactoryObject *)o;
+static PyObject *
+inline_copy(inlineproperty_object *p, PyObject **items)
+{
+    PyTypeObject *type = p->type;
+    PyObject *op = type->tp_alloc(type, 0);
+
+    if (op == NULL)
+        return NULL;
+    _copy_items(PyDataObject_ITEMS(op), items, PyDataObject_NUMITEMS(type));
+    return op;
+}
+
+static int
+inline_store(PyObject *op, inlineproperty_object *p, PyObject **src)
+{
+    const Py_ssize_t n = PyDataObject_NUMITEMS(p->type);
+    PyObject **items = PyDataObject_ITEMS(op) + p->start;
+    Py_ssize_t i;
+
+    for (i = 0; i < n; i++) {
+        PyObject *v = src[i];
+        PyObject *old = items[i];
+
+        Py_XINCREF(v);
+        items[i] = v;
+        Py_XDECREF(old);
+        dataobject_maybe_track(op, v);
+    }
+    return 0;
+}
+
+static PyObject*
+inlineproperty_new(PyTypeObject *t, PyObject *args, PyObject *k)
+{
+    inlineproperty_object *ob;
+    Py_ssize_t start;
+    PyObject *type;
+    int proxy = 0, readonly = 0;
+
+    if (!PyArg_ParseTuple(args, "nO!|pp:inlineproperty", &start, &PyType_Type, &type, &proxy, &readonly))
+        return NULL;
+    if (!PyType_IsSubtype((PyTypeObject*)type, &PyDataStruct_Type)) {
+        PyErr_SetString(PyExc_TypeError, "the type of the inline field should be a subclass of datastruct");
+        return NULL;
+    }
+    if (start < 0) {
+        PyErr_SetString(PyExc_ValueError, "the index of the slot should not be negative");
+        return NULL;
+    }
+
+    ob = PyObject_New(inlineproperty_object, t);
+    if (ob == NULL)
+        return NULL;
+
+    ob->start = start;
+    Py_INCREF(type);
+    ob->type = (PyTypeObject*)type;
+    ob->proxy = proxy;
+    ob->readonly = readonly;
+    return (PyObject*)ob;
+}
+
+static void
+inlineproperty_dealloc(PyObject *o)
+{
     PyTypeObject *t = Py_TYPE(o);
-    
-    Py_CLEAR(p->factory);
+
+    Py_XDECREF(((inlineproperty_object *)o)->type);
     t->tp_free(o);
 }
 
-static PyMethodDef Factory_methods[] = {
-  {0, 0, 0, 0}
-};
+static PyObject*
+inlineproperty_get(PyObject *self, PyObject *obj, PyObject *type)
+{
+    inlineproperty_object *p = (inlineproperty_object*)self;
 
-static PyGetSetDef Factory_getsets[] = {
+    if (obj == Py_None || obj == NULL) {
+        Py_INCREF(self);
+        return self;
+    }
+
+    if (p->proxy) {
+        inlineproxy_object *px = PyObject_GC_New(inlineproxy_object, &PyInlineProxy_Type);
+        if (px == NULL)
+            return NULL;
+        Py_INCREF(obj);
+        px->ob = obj;
+        Py_INCREF(self);
+        px->prop = p;
+        PyObject_GC_Track(px);
+        return (PyObject*)px;
+    }
+
+    return inline_copy(p, PyDataObject_ITEMS(obj) + p->start);
+}
+
+static int
+inline_assign(PyObject *op, PyObject *descr, PyObject *value)
+{
+    inlineproperty_object *p = (inlineproperty_object*)descr;
+    PyObject **items = inline_value_items(p, value);
+
+    if (items == NULL)
+        return -1;
+    return inline_store(op, p, items);
+}
+
+static int
+inlineproperty_set(PyObject *self, PyObject *obj, PyObject *value)
+{
+    if (!value) {
+        PyErr_SetString(PyExc_AttributeError, "The field and it's value can't be deleted");
+        return -1;
+    }
+    if (((inlineproperty_object*)self)->readonly) {
+        PyErr_SetString(PyExc_AttributeError, "the field is readonly");
+        return -1;
+    }
+    return inline_assign(obj, self, value);
+}
+
+static PyObject*
+inlineproperty_start(PyObject *self)
+{
+    return PyLong_FromSsize_t(((inlineproperty_object*)self)->start);
+}
+
+static PyObject*
+inlineproperty_type(PyObject *self)
+{
+    PyObject *type = (PyObject*)((inlineproperty_object*)self)->type;
+    Py_INCREF(type);
+    return type;
+}
+
+static PyObject*
+inlineproperty_proxy(PyObject *self)
+{
+    return PyBool_FromLong((long)(((inlineproperty_object*)self)->proxy));
+}
+
+static PyObject*
+inlineproperty_readonly(PyObject *self)
+{
+    return PyBool_FromLong((long)(((inlineproperty_object*)self)->readonly));
+}
+
+static PyGetSetDef inlineproperty_getsets[] = {
+    {"start", (getter)inlineproperty_start, NULL, NULL},
+    {"type", (getter)inlineproperty_type, NULL, NULL},
+    {"proxy", (getter)inlineproperty_proxy, NULL, NULL},
+    {"readonly", (getter)inlineproperty_readonly, NULL, NULL},
     {0}
 };
 
-static PyTypeObject PyFactory_Type = {
+PyDoc_STRVAR(inlineproperty_doc,
+"inlineproperty(start, type, proxy=False, readonly=False) -- descriptor of the datastruct embedded in the slots");
+
+static PyTypeObject PyInlineProperty_Type = {
     PyVarObject_HEAD_INIT(DEFERRED_ADDRESS(&PyType_Type), 0)
-    "recordclass._dataobject.Factory", /*tp_name*/
-    sizeof(struct PyFactoryObject), /*tp_basicsize*/
+    "recordclass._dataobject.inlineproperty", /*tp_name*/
+    sizeof(inlineproperty_object), /*tp_basicsize*/
     0, /*tp_itemsize*/
-    Factory_dealloc, /*tp_dealloc*/
+    inlineproperty_dealloc, /*tp_dealloc*/
     0, /*tp_print*/
     0, /*tp_getattr*/
     0, /*tp_setattr*/
@@ -2031,585 +3610,5490 @@ static PyTypeObject PyFactory_Type = {
     0, /*tp_getattro*/
     0, /*tp_setattro*/
     0, /*tp_as_buffer*/
-    Py_TPFLAGS_DEFAULT|Py_TPFLAGS_BASETYPE, /*tp_flags*/
-    0, /*tp_doc*/
+    Py_TPFLAGS_DEFAULT, /*tp_flags*/
+    inlineproperty_doc, /*tp_doc*/
     0, /*tp_traverse*/
     0, /*tp_clear*/
     0, /*tp_richcompare*/
     0, /*tp_weaklistoffset*/
     0, /*tp_iter*/
     0, /*tp_iternext*/
-    Factory_methods, /*tp_methods*/
+    0, /*tp_methods*/
     0, /*tp_members*/
-    Factory_getsets, /*tp_getset*/
+    inlineproperty_getsets, /*tp_getset*/
     0, /*tp_base*/
     0, /*tp_dict*/
-    0, /*tp_descr_get*/
-    0, /*tp_descr_set*/
+    inlineproperty_get, /*tp_descr_get*/
+    inlineproperty_set, /*tp_descr_set*/
     0, /*tp_dictoffset*/
     0, /*tp_init*/
     0, /*tp_alloc*/
-    Factory_new, /*tp_new*/
+    inlineproperty_new, /*tp_new*/
     0, /*tp_free*/
     0, /*tp_is_gc*/
 };
 
+// The proxy reads and writes the fields of the datastruct in the slots of the record
 
-//////////////////// datatype ////////////////////////////////////////////
-
-// static int _get_bool_value(PyObject *options, const char *name) {
-//         PyObject* b;
+static Py_ssize_t
+inlineproxy_index(inlineproxy_object *px, PyObject *name)
+{
+    PyObject *fields = PyDict_GetItem(px->prop->type->tp_dict, __fields__name);
 
-//         b = PyMapping_GetItemString(options, name);
-//         if (b && PyObject_IsTrue(b))
-//             return 1;
-//         else
-//             return 0;
-// }
+    if (fields == NULL || !PyTuple_Check(fields) || !PyUnicode_Check(name))
+        return -1;
+    return _tuple_index((PyTupleObject*)fields, name);
+}
 
+static PyObject *
+inlineproxy_value(PyObject *o)
+{
+    inlineproxy_object *px = (inlineproxy_object*)o;
+    return inline_copy(px->prop, PyDataObject_ITEMS(px->ob) + px->prop->start);
+}
 
+static void
+inlineproxy_dealloc(PyObject *o)
+{
+    inlineproxy_object *px = (inlineproxy_object*)o;
 
-//////////////////// module level functions //////////////////////////////
+    PyObject_GC_UnTrack(o);
+    Py_CLEAR(px->ob);
+    Py_CLEAR(px->prop);
+    PyObject_GC_Del(o);
+}
 
+static int
+inlineproxy_traverse(PyObject *o, visitproc visit, void *arg)
+{
+    Py_VISIT(((inlineproxy_object*)o)->ob);
+    return 0;
+}
 
+static PyObject *
+inlineproxy_getattro(PyObject *o, PyObject *name)
+{
+    inlineproxy_object *px = (inlineproxy_object*)o;
+    Py_ssize_t i = inlineproxy_index(px, name);
 
-PyDoc_STRVAR(_dataobject_type_init_doc,
-"Initialize dataobject subclass");
+    PyObject *v;
 
-static PyObject*
-_dataobject_type_init(PyObject *module, PyObject *args) {
-    PyObject *cls;
+    if (i >= 0) {
+        v = PyDataObject_GET_VALUE(px->ob, px->prop->start + i);
+        Py_INCREF(v);
+        return v;
+    }
 
-    PyTypeObject *tp;
-    PyTypeObject *tp_base;
-    // int __init__, __new__;
-    PyObject *fields, *dict;
-    Py_ssize_t n_fields;
+    v = PyObject_GenericGetAttr(o, name);
+    if (v == NULL && PyErr_ExceptionMatches(PyExc_AttributeError)) {
+        // the methods and the nested inline fields of the datastruct are taken from the copy
+        PyObject *copy = inlineproxy_value(o);
 
-    if (Py_SIZE(args) != 1) {
-        PyErr_SetString(PyExc_TypeError, "number of arguments != 1");
-        return NULL;
+        PyErr_Clear();
+        if (copy == NULL)
+            return NULL;
+        v = PyObject_GetAttr(copy, name);
+        Py_DECREF(copy);
     }
+    return v;
+}
 
-    cls = PyTuple_GET_ITEM(args, 0);
-    tp = (PyTypeObject*)cls;
-    tp_base = tp->tp_base;
+static int
+inlineproxy_setattro(PyObject *o, PyObject *name, PyObject *val)
+{
+    inlineproxy_object *px = (inlineproxy_object*)o;
+    Py_ssize_t i = inlineproxy_index(px, name);
 
-    if ((tp_base != &PyDataObject_Type && !PyType_IsSubtype(tp_base, &PyDataObject_Type)) &&
-         (tp_base != &PyDataStruct_Type && !PyType_IsSubtype(tp_base, &PyDataStruct_Type))) {
-        PyErr_Format(PyExc_TypeError,
-                        "common base class %s should be subclass of dataobject or datastruct", tp_base->tp_name);
-        return NULL;
+    if (i < 0) {
+        PyErr_Format(PyExc_AttributeError, "%s has no field %R", px->prop->type->tp_name, name);
+        return -1;
+    }
+    if (val == NULL) {
+        PyErr_SetString(PyExc_AttributeError, "The field and it's value can't be deleted");
+        return -1;
+    }
+    if (px->prop->readonly) {
+        PyErr_SetString(PyExc_AttributeError, "the field is readonly");
+        return -1;
     }
+    return dataobject_ass_item(px->ob, px->prop->start + i, val);
+}
 
-    dict = tp->tp_dict;
+static PyObject *
+inlineproxy_repr(PyObject *o)
+{
+    PyObject *v = inlineproxy_value(o);
+    PyObject *s;
 
-    fields = PyMapping_GetItemString(dict, "__fields__");
-    if (!fields){
-        PyErr_SetString(PyExc_TypeError, "__fields__ is missing");
+    if (v == NULL)
         return NULL;
-    }
+    s = PyObject_Repr(v);
+    Py_DECREF(v);
+    return s;
+}
 
-    if (PyTuple_Check(fields)) {
-        n_fields = PyTuple_GET_SIZE(fields);
-    } else {
-        n_fields = PyNumber_AsSsize_t(fields, PyExc_IndexError);
-        if (n_fields == -1 && PyErr_Occurred()) {
-            Py_DECREF(fields);
-            return NULL;
-        }
-        if (n_fields < 0) {
-            PyErr_SetString(PyExc_TypeError, "number of fields should not be negative");
+static PyObject *
+inlineproxy_richcompare(PyObject *v, PyObject *w, int op)
+{
+    PyObject *a, *b, *ret;
+
+    a = inlineproxy_value(v);
+    if (a == NULL)
+        return NULL;
+    if (Py_TYPE(w) == &PyInlineProxy_Type) {
+        b = inlineproxy_value(w);
+        if (b == NULL) {
+            Py_DECREF(a);
             return NULL;
         }
+    } else {
+        b = w;
+        Py_INCREF(b);
     }
+    ret = PyObject_RichCompare(a, b, op);
+    Py_DECREF(a);
+    Py_DECREF(b);
+    return ret;
+}
 
-    Py_DECREF(fields);
-
-    #if PY_VERSION_HEX >= 0x030B0000
-            tp->tp_flags &= ~Py_TPFLAGS_MANAGED_DICT;
-    #endif
+PyDoc_STRVAR(inlineproxy_copy_doc,
+"copy of the embedded datastruct");
 
-    #if PY_VERSION_HEX >= 0x030C0000
+static PyObject *
+inlineproxy_copy(PyObject *o, PyObject *Py_UNUSED(ignore))
+{
+    return inlineproxy_value(o);
+}
+
+static PyMethodDef inlineproxy_methods[] = {
+    {"__copy__", (PyCFunction)inlineproxy_copy, METH_NOARGS, inlineproxy_copy_doc},
+    {0, 0, 0, 0}
+};
+
+static PyTypeObject PyInlineProxy_Type = {
+    PyVarObject_HEAD_INIT(DEFERRED_ADDRESS(&PyType_Type), 0)
+    "recordclass._dataobject.inlineproxy", /*tp_name*/
+    sizeof(inlineproxy_object), /*tp_basicsize*/
+    0, /*tp_itemsize*/
+    inlineproxy_dealloc, /*tp_dealloc*/
+    0, /*tp_print*/
+    0, /*tp_getattr*/
+    0, /*tp_setattr*/
+    0, /*reserved*/
+    inlineproxy_repr, /*tp_repr*/
+    0, /*tp_as_number*/
+    0, /*tp_as_sequence*/
+    0, /*tp_as_mapping*/
+    PyObject_HashNotImplemented, /*tp_hash*/
+    0, /*tp_call*/
+    0, /*tp_str*/
+    inlineproxy_getattro, /*tp_getattro*/
+    inlineproxy_setattro, /*tp_setattro*/
+    0, /*tp_as_buffer*/
+    Py_TPFLAGS_DEFAULT|Py_TPFLAGS_HAVE_GC, /*tp_flags*/
+    0, /*tp_doc*/
+    inlineproxy_traverse, /*tp_traverse*/
+    0, /*tp_clear*/
+    inlineproxy_richcompare, /*tp_richcompare*/
+    0, /*tp_weaklistoffset*/
+    0, /*tp_iter*/
+    0, /*tp_iternext*/
+    inlineproxy_methods, /*tp_methods*/
+};
+
+///////////////////////// packed fields //////////////////////////////////
+
+// The values of the field annotated by Packed[T] (bool, Enum or range) are stored
+// as the codes in the bits of the words after the other parts of the instance.
+// The code is the index of the value in the values of T xor the index of the default
+// value, so the zeroed words contain the default values. The bitproperty descriptors
+// of the packed fields are in __inline__ with the descriptors of the Inline fields.
+
+#define PyDataObject_BITS_WORD(op, p) ((uint64_t*)((char*)(op) + (p)->offset))
+
+// the instance with the zeroed words after the fields, __dict__ and __weakref__
+static PyObject *
+dataobject_alloc_words(PyTypeObject *type)
+{
+    PyObject *op;
+    Py_ssize_t offset;
+
+    if (type->tp_flags & Py_TPFLAGS_HAVE_GC)
+        op = dataobject_alloc_gc(type, 0);
+    else
+        op = dataobject_alloc(type, 0);
+    if (op == NULL)
+        return NULL;
+
+    offset = dataobject_bits_offset(type);
+    memset((char*)op + offset, 0, type->tp_basicsize - offset);
+    return op;
+}
+
+static PyObject *
+dataobject_alloc_bits(PyTypeObject *type, Py_ssize_t unused)
+{
+    return dataobject_alloc_words(type);
+}
+
+static int
+bits_encode(bitproperty_object *p, PyObject *value, uint64_t *code)
+{
+    if (PyTuple_Check(p->values)) {
+        Py_ssize_t i;
+
+        for (i = 0; i < p->count; i++) {
+            if (PyTuple_GET_ITEM(p->values, i) == value) {
+                *code = (uint64_t)i;
+                return 0;
+            }
+        }
+        PyErr_Format(PyExc_TypeError, "expected one of %R, got %R", p->values, value);
+        return -1;
+    }
+    else {
+        Py_ssize_t v;
+        size_t diff, step;
+
+        if (!PyLong_Check(value)) {
+            PyErr_Format(PyExc_TypeError, "expected int, got %s", Py_TYPE(value)->tp_name);
+            return -1;
+        }
+        v = PyLong_AsSsize_t(value);
+        if (v == -1 && PyErr_Occurred()) {
+            if (!PyErr_ExceptionMatches(PyExc_OverflowError))
+                return -1;
+            PyErr_Clear();
+            goto out_of_range;
+        }
+
+        if (p->step > 0) {
+            if (v < p->start)
+                goto out_of_range;
+            diff = (size_t)v - (size_t)p->start;
+            step = (size_t)p->step;
+        } else {
+            if (v > p->start)
+                goto out_of_range;
+            diff = (size_t)p->start - (size_t)v;
+            step = -(size_t)p->step;
+        }
+        if (diff % step || diff / step >= (size_t)p->count)
+            goto out_of_range;
+        *code = (uint64_t)(diff / step);
+        return 0;
+
+out_of_range:
+        PyErr_Format(PyExc_ValueError, "%R not in %R", value, p->values);
+        return -1;
+    }
+}
+
+static PyObject *
+bits_value(PyObject *op, bitproperty_object *p)
+{
+    uint64_t code = ((*PyDataObject_BITS_WORD(op, p) >> p->shift) & p->mask) ^ p->default_code;
+
+    if (code >= (uint64_t)p->count) {
+        PyErr_SetString(PyExc_SystemError, "invalid code of the packed field");
+        return NULL;
+    }
+    if (PyTuple_Check(p->values)) {
+        PyObject *v = PyTuple_GET_ITEM(p->values, (Py_ssize_t)code);
+        Py_INCREF(v);
+        return v;
+    }
+    return PyLong_FromSsize_t(p->start + (Py_ssize_t)code * p->step);
+}
+
+static int
+bits_assign(PyObject *op, PyObject *descr, PyObject *value)
+{
+    bitproperty_object *p = (bitproperty_object*)descr;
+    uint64_t *word = PyDataObject_BITS_WORD(op, p);
+    uint64_t code;
+
+    if (bits_encode(p, value, &code) < 0)
+        return -1;
+    *word = (*word & ~(p->mask << p->shift)) | ((code ^ p->default_code) << p->shift);
+    return 0;
+}
+
+static PyObject*
+bitproperty_new(PyTypeObject *t, PyObject *args, PyObject *k)
+{
+    bitproperty_object *ob;
+    Py_ssize_t index, count, width = 1;
+    int shift, readonly = 0;
+    PyObject *values, *default_value;
+    Py_ssize_t start = 0, step = 1;
+    uint64_t code;
+
+    if (!PyArg_ParseTuple(args, "niOO|p:bitproperty", &index, &shift, &values, &default_value, &readonly))
+        return NULL;
+
+    if (PyTuple_Check(values))
+        count = PyTuple_GET_SIZE(values);
+    else if (Py_TYPE(values) == &PyRange_Type) {
+        PyObject *o;
+
+        count = PyObject_Size(values);
+        if (count < 0)
+            return NULL;
+        o = PyObject_GetAttrString(values, "start");
+        if (o == NULL)
+            return NULL;
+        start = PyLong_AsSsize_t(o);
+        Py_DECREF(o);
+        o = PyObject_GetAttrString(values, "step");
+        if (o == NULL)
+            return NULL;
+        step = PyLong_AsSsize_t(o);
+        Py_DECREF(o);
+        if (PyErr_Occurred())
+            return NULL;
+    }
+    else {
+        PyErr_SetString(PyExc_TypeError, "the values of the packed field should be a tuple or a range");
+        return NULL;
+    }
+    if (count == 0) {
+        PyErr_SetString(PyExc_ValueError, "the values of the packed field are empty");
+        return NULL;
+    }
+
+    while (width < 64 && ((uint64_t)(count - 1) >> width))
+        width++;
+    if (index < 0 || shift < 0 || shift + width > 64) {
+        PyErr_SetString(PyExc_ValueError, "the bits of the packed field should be in the word");
+        return NULL;
+    }
+
+    ob = PyObject_New(bitproperty_object, t);
+    if (ob == NULL)
+        return NULL;
+
+    ob->index = index;
+    ob->offset = 0;
+    ob->shift = shift;
+    ob->readonly = readonly;
+    ob->mask = (width == 64) ? ~(uint64_t)0 : (((uint64_t)1 << width) - 1);
+    ob->default_code = 0;
+    Py_INCREF(values);
+    ob->values = values;
+    ob->start = start;
+    ob->step = step;
+    ob->count = count;
+
+    if (bits_encode(ob, default_value, &code) < 0) {
+        Py_DECREF(ob);
+        return NULL;
+    }
+    ob->default_code = code;
+    return (PyObject*)ob;
+}
+
+static void
+bitproperty_dealloc(PyObject *o)
+{
+    PyTypeObject *t = Py_TYPE(o);
+
+    Py_XDECREF(((bitproperty_object *)o)->values);
+    t->tp_free(o);
+}
+
+static PyObject*
+bitproperty_get(PyObject *self, PyObject *obj, PyObject *type)
+{
+    if (obj == Py_None || obj == NULL) {
+        Py_INCREF(self);
+        return self;
+    }
+    return bits_value(obj, (bitproperty_object*)self);
+}
+
+static int
+bitproperty_set(PyObject *self, PyObject *obj, PyObject *value)
+{
+    if (!value) {
+        PyErr_SetString(PyExc_AttributeError, "The field and it's value can't be deleted");
+        return -1;
+    }
+    if (((bitproperty_object*)self)->readonly) {
+        PyErr_SetString(PyExc_AttributeError, "the field is readonly");
+        return -1;
+    }
+    return bits_assign(obj, self, value);
+}
+
+static PyObject*
+bitproperty_index(PyObject *self)
+{
+    return PyLong_FromSsize_t(((bitproperty_object*)self)->index);
+}
+
+static PyObject*
+bitproperty_shift(PyObject *self)
+{
+    return PyLong_FromLong((long)((bitproperty_object*)self)->shift);
+}
+
+static PyObject*
+bitproperty_mask(PyObject *self)
+{
+    return PyLong_FromUnsignedLongLong((unsigned long long)((bitproperty_object*)self)->mask);
+}
+
+static PyObject*
+bitproperty_values(PyObject *self)
+{
+    PyObject *values = ((bitproperty_object*)self)->values;
+    Py_INCREF(values);
+    return values;
+}
+
+static PyObject*
+bitproperty_readonly(PyObject *self)
+{
+    return PyBool_FromLong((long)(((bitproperty_object*)self)->readonly));
+}
+
+static PyGetSetDef bitproperty_getsets[] = {
+    {"index", (getter)bitproperty_index, NULL, NULL},
+    {"shift", (getter)bitproperty_shift, NULL, NULL},
+    {"mask", (getter)bitproperty_mask, NULL, NULL},
+    {"values", (getter)bitproperty_values, NULL, NULL},
+    {"readonly", (getter)bitproperty_readonly, NULL, NULL},
+    {0}
+};
+
+PyDoc_STRVAR(bitproperty_doc,
+"bitproperty(index, shift, values, default, readonly=False) -- descriptor of the packed field in the bits of the word");
+
+static PyTypeObject PyBitProperty_Type = {
+    PyVarObject_HEAD_INIT(DEFERRED_ADDRESS(&PyType_Type), 0)
+    "recordclass._dataobject.bitproperty", /*tp_name*/
+    sizeof(bitproperty_object), /*tp_basicsize*/
+    0, /*tp_itemsize*/
+    bitproperty_dealloc, /*tp_dealloc*/
+    0, /*tp_print*/
+    0, /*tp_getattr*/
+    0, /*tp_setattr*/
+    0, /*reserved*/
+    0, /*tp_repr*/
+    0, /*tp_as_number*/
+    0, /*tp_as_sequence*/
+    0, /*tp_as_mapping*/
+    0, /*tp_hash*/
+    0, /*tp_call*/
+    0, /*tp_str*/
+    0, /*tp_getattro*/
+    0, /*tp_setattro*/
+    0, /*tp_as_buffer*/
+    Py_TPFLAGS_DEFAULT, /*tp_flags*/
+    bitproperty_doc, /*tp_doc*/
+    0, /*tp_traverse*/
+    0, /*tp_clear*/
+    0, /*tp_richcompare*/
+    0, /*tp_weaklistoffset*/
+    0, /*tp_iter*/
+    0, /*tp_iternext*/
+    0, /*tp_methods*/
+    0, /*tp_members*/
+    bitproperty_getsets, /*tp_getset*/
+    0, /*tp_base*/
+    0, /*tp_dict*/
+    bitproperty_get, /*tp_descr_get*/
+    bitproperty_set, /*tp_descr_set*/
+    0, /*tp_dictoffset*/
+    0, /*tp_init*/
+    0, /*tp_alloc*/
+    bitproperty_new, /*tp_new*/
+    0, /*tp_free*/
+    0, /*tp_is_gc*/
+};
+
+// the values of the packed fields in the order of __inline__
+static PyObject *
+dataobject_bits_values(PyObject *op)
+{
+    PyObject *plan = dataobject_type_plan(Py_TYPE(op));
+    PyObject *values;
+    Py_ssize_t i, n;
+
+    if (plan == NULL) {
+        PyErr_SetString(PyExc_TypeError, "__inline__ is missing");
+        return NULL;
+    }
+
+    values = PyList_New(0);
+    if (values == NULL)
+        return NULL;
+
+    n = PyTuple_GET_SIZE(plan);
+    for (i = 0; i < n; i++) {
+        PyObject *p = PyTuple_GET_ITEM(PyTuple_GET_ITEM(plan, i), 1);
+        PyObject *v;
+
+        if (Py_TYPE(p) != &PyBitProperty_Type)
+            continue;
+        v = bits_value(op, (bitproperty_object*)p);
+        if (v == NULL || PyList_Append(values, v) < 0) {
+            Py_XDECREF(v);
+            Py_DECREF(values);
+            return NULL;
+        }
+        Py_DECREF(v);
+    }
+    return values;
+}
+
+// the values of the packed and sparse fields into the dict
+static int
+dataobject_plan_to_dict(PyObject *op, PyObject *dict)
+{
+    PyObject *plan = dataobject_type_plan(Py_TYPE(op));
+    Py_ssize_t i, n;
+
+    if (plan == NULL) {
+        PyErr_SetString(PyExc_TypeError, "__inline__ is missing");
+        return -1;
+    }
+
+    n = PyTuple_GET_SIZE(plan);
+    for (i = 0; i < n; i++) {
+        PyObject *e = PyTuple_GET_ITEM(plan, i);
+        PyObject *p = PyTuple_GET_ITEM(e, 1);
+        PyObject *v;
+        int ret;
+
+        if (Py_TYPE(p) == &PyBitProperty_Type)
+            v = bits_value(op, (bitproperty_object*)p);
+        else if (Py_TYPE(p) == &PyDataObjectSparseProperty_Type)
+            v = sparse_value(op, (sparseproperty_object*)p);
+        else
+            continue;
+        if (v == NULL)
+            return -1;
+        ret = PyDict_SetItem(dict, PyTuple_GET_ITEM(e, 0), v);
+        Py_DECREF(v);
+        if (ret < 0)
+            return -1;
+    }
+    return 0;
+}
+
+///////////////////////// sparse records /////////////////////////////////
+
+// The instances of the class with sparse=True have no slots of the fields. The bits of
+// the presence bitmap after the other parts of the instance mark the fields with the value
+// other than the default one, and these values are in the array in the order of the fields
+// (the last word of the instance). The index of the value is the number of the present
+// fields before it. The sparseproperty descriptors of the fields are in __inline__.
+
+#define PyDataObject_SPARSE_VALUES(op) \
+    (*(PyObject***)((char*)(op) + Py_TYPE(op)->tp_basicsize - sizeof(PyObject**)))
+
+static inline int
+bits_popcount(uint64_t x)
+{
+#if defined(__GNUC__) || defined(__clang__)
+    return __builtin_popcountll(x);
+#else
+    x = x - ((x >> 1) & 0x5555555555555555ULL);
+    x = (x & 0x3333333333333333ULL) + ((x >> 2) & 0x3333333333333333ULL);
+    x = (x + (x >> 4)) & 0x0F0F0F0F0F0F0F0FULL;
+    return (int)((x * 0x0101010101010101ULL) >> 56);
+#endif
+}
+
+static inline Py_ssize_t
+sparse_n_words(PyTypeObject *tp)
+{
+    return (tp->tp_basicsize - sizeof(PyObject**) - dataobject_bits_offset(tp)) / sizeof(uint64_t);
+}
+
+static inline uint64_t *
+sparse_bitmap(PyObject *op)
+{
+    return (uint64_t*)((char*)op + dataobject_bits_offset(Py_TYPE(op)));
+}
+
+// the number of the present fields before the field
+static inline Py_ssize_t
+sparse_rank(uint64_t *bitmap, Py_ssize_t index)
+{
+    Py_ssize_t i, k = 0, n = index >> 6;
+
+    for (i = 0; i < n; i++)
+        k += bits_popcount(bitmap[i]);
+    return k + bits_popcount(bitmap[n] & ((((uint64_t)1) << (index & 63)) - 1));
+}
+
+static Py_ssize_t
+dataobject_sparse_count(PyObject *op)
+{
+    uint64_t *bitmap = sparse_bitmap(op);
+    Py_ssize_t i, k = 0, n = sparse_n_words(Py_TYPE(op));
+
+    for (i = 0; i < n; i++)
+        k += bits_popcount(bitmap[i]);
+    return k;
+}
+
+static PyObject *
+dataobject_alloc_sparse(PyTypeObject *type, Py_ssize_t unused)
+{
+    PyObject *op = dataobject_alloc(type, 0);
+    Py_ssize_t offset;
+
+    if (op == NULL)
+        return NULL;
+
+    offset = dataobject_bits_offset(type);
+    memset((char*)op + offset, 0, type->tp_basicsize - offset);
+    return op;
+}
+
+static void
+dataobject_sparse_clear(PyObject *op)
+{
+    PyObject **values = PyDataObject_SPARSE_VALUES(op);
+    Py_ssize_t i, n = dataobject_sparse_count(op);
+
+    memset(sparse_bitmap(op), 0, sparse_n_words(Py_TYPE(op)) * sizeof(uint64_t));
+    PyDataObject_SPARSE_VALUES(op) = NULL;
+    for (i = 0; i < n; i++)
+        Py_DECREF(values[i]);
+    PyMem_Free(values);
+}
+
+static void
+dataobject_dealloc_sparse(PyObject *op)
+{
+    PyTypeObject *type = Py_TYPE(op);
+
+    if (type->tp_finalize != NULL) {
+        if(PyObject_CallFinalizerFromDealloc(op) < 0)
+            return;
+    }
+
+    dataobject_sparse_clear(op);
+    dataobject_xdecref(op);
+
+#if PY_VERSION_HEX < 0x03080000
+    if (type->tp_flags & Py_TPFLAGS_HEAPTYPE)
+        Py_DECREF(type);
+#endif
+
+    type->tp_free((PyObject *)op);
+}
+
+static int
+dataobject_sparse_copy(PyObject *new_op, PyObject *op)
+{
+    Py_ssize_t i, n = dataobject_sparse_count(op);
+    PyObject **values, **src = PyDataObject_SPARSE_VALUES(op);
+
+    if (n == 0)
+        return 0;
+    values = PyMem_New(PyObject*, n);
+    if (values == NULL) {
+        PyErr_NoMemory();
+        return -1;
+    }
+    for (i = 0; i < n; i++) {
+        Py_INCREF(src[i]);
+        values[i] = src[i];
+    }
+    memcpy(sparse_bitmap(new_op), sparse_bitmap(op), sparse_n_words(Py_TYPE(op)) * sizeof(uint64_t));
+    PyDataObject_SPARSE_VALUES(new_op) = values;
+    return 0;
+}
+
+static PyObject *
+sparse_value(PyObject *op, sparseproperty_object *p)
+{
+    uint64_t *bitmap = (uint64_t*)((char*)op + p->offset);
+    PyObject *v;
+
+    if (bitmap[p->index >> 6] & (((uint64_t)1) << (p->index & 63)))
+        v = PyDataObject_SPARSE_VALUES(op)[sparse_rank(bitmap, p->index)];
+    else
+        v = p->default_value;
+    Py_INCREF(v);
+    return v;
+}
+
+static int
+sparse_assign(PyObject *op, PyObject *descr, PyObject *value)
+{
+    sparseproperty_object *p = (sparseproperty_object*)descr;
+    uint64_t *bitmap = (uint64_t*)((char*)op + p->offset);
+    uint64_t *word = bitmap + (p->index >> 6);
+    const uint64_t bit = ((uint64_t)1) << (p->index & 63);
+    PyObject **values = PyDataObject_SPARSE_VALUES(op);
+    Py_ssize_t k = sparse_rank(bitmap, p->index);
+    Py_ssize_t n = dataobject_sparse_count(op);
+    PyObject *old;
+
+    if (value == p->default_value) {
+        // the default value isn't stored
+        if (!(*word & bit))
+            return 0;
+        old = values[k];
+        memmove(values + k, values + k + 1, (n - k - 1) * sizeof(PyObject*));
+        *word &= ~bit;
+        if (n == 1) {
+            PyMem_Free(values);
+            PyDataObject_SPARSE_VALUES(op) = NULL;
+        } else {
+            PyObject **tmp = (PyObject**)PyMem_Realloc(values, (n - 1) * sizeof(PyObject*));
+            if (tmp != NULL)
+                PyDataObject_SPARSE_VALUES(op) = tmp;
+        }
+        Py_DECREF(old);
+        return 0;
+    }
+
+    Py_INCREF(value);
+    if (*word & bit) {
+        old = values[k];
+        values[k] = value;
+        Py_DECREF(old);
+        return 0;
+    }
+
+    values = (PyObject**)PyMem_Realloc(values, (n + 1) * sizeof(PyObject*));
+    if (values == NULL) {
+        Py_DECREF(value);
+        PyErr_NoMemory();
+        return -1;
+    }
+    memmove(values + k + 1, values + k, (n - k) * sizeof(PyObject*));
+    values[k] = value;
+    PyDataObject_SPARSE_VALUES(op) = values;
+    *word |= bit;
+    return 0;
+}
+
+// the iterator over the values of the fields in the order of __inline__
+static PyObject *
+dataobject_iter_plan(PyObject *op)
+{
+    PyObject *args = inline_logical_args(op);
+    PyObject *it;
+
+    if (args == NULL)
+        return NULL;
+    it = PyObject_GetIter(args);
+    Py_DECREF(args);
+    return it;
+}
+
+static PyObject*
+sparseproperty_new(PyTypeObject *t, PyObject *args, PyObject *k)
+{
+    sparseproperty_object *ob;
+    Py_ssize_t index;
+    PyObject *default_value = Py_None;
+    int readonly = 0;
+
+    if (!PyArg_ParseTuple(args, "n|Op:sparseproperty", &index, &default_value, &readonly))
+        return NULL;
+    if (index < 0) {
+        PyErr_SetString(PyExc_ValueError, "the index of the field should not be negative");
+        return NULL;
+    }
+
+    ob = PyObject_New(sparseproperty_object, t);
+    if (ob == NULL)
+        return NULL;
+
+    ob->index = index;
+    ob->offset = 0;
+    Py_INCREF(default_value);
+    ob->default_value = default_value;
+    ob->readonly = readonly;
+    return (PyObject*)ob;
+}
+
+static void
+sparseproperty_dealloc(PyObject *o)
+{
+    PyTypeObject *t = Py_TYPE(o);
+
+    Py_XDECREF(((sparseproperty_object *)o)->default_value);
+    t->tp_free(o);
+}
+
+static PyObject*
+sparseproperty_get(PyObject *self, PyObject *obj, PyObject *type)
+{
+    if (obj == Py_None || obj == NULL) {
+        Py_INCREF(self);
+        return self;
+    }
+    return sparse_value(obj, (sparseproperty_object*)self);
+}
+
+static int
+sparseproperty_set(PyObject *self, PyObject *obj, PyObject *value)
+{
+    if (!value) {
+        PyErr_SetString(PyExc_AttributeError, "The field and it's value can't be deleted");
+        return -1;
+    }
+    if (((sparseproperty_object*)self)->readonly) {
+        PyErr_SetString(PyExc_AttributeError, "the field is readonly");
+        return -1;
+    }
+    return sparse_assign(obj, self, value);
+}
+
+static PyObject*
+sparseproperty_index(PyObject *self)
+{
+    return PyLong_FromSsize_t(((sparseproperty_object*)self)->index);
+}
+
+static PyObject*
+sparseproperty_default(PyObject *self)
+{
+    PyObject *v = ((sparseproperty_object*)self)->default_value;
+    Py_INCREF(v);
+    return v;
+}
+
+static PyObject*
+sparseproperty_readonly(PyObject *self)
+{
+    return PyBool_FromLong((long)(((sparseproperty_object*)self)->readonly));
+}
+
+static PyGetSetDef sparseproperty_getsets[] = {
+    {"index", (getter)sparseproperty_index, NULL, NULL},
+    {"default", (getter)sparseproperty_default, NULL, NULL},
+    {"readonly", (getter)sparseproperty_readonly, NULL, NULL},
+    {0}
+};
+
+PyDoc_STRVAR(sparseproperty_doc,
+"sparseproperty(index, default=None, readonly=False) -- descriptor of the field of the sparse record");
+
+static PyTypeObject PyDataObjectSparseProperty_Type = {
+    PyVarObject_HEAD_INIT(DEFERRED_ADDRESS(&PyType_Type), 0)
+    "recordclass._dataobject.sparseproperty", /*tp_name*/
+    sizeof(sparseproperty_object), /*tp_basicsize*/
+    0, /*tp_itemsize*/
+    sparseproperty_dealloc, /*tp_dealloc*/
+    0, /*tp_print*/
+    0, /*tp_getattr*/
+    0, /*tp_setattr*/
+    0, /*reserved*/
+    0, /*tp_repr*/
+    0, /*tp_as_number*/
+    0, /*tp_as_sequence*/
+    0, /*tp_as_mapping*/
+    0, /*tp_hash*/
+    0, /*tp_call*/
+    0, /*tp_str*/
+    0, /*tp_getattro*/
+    0, /*tp_setattro*/
+    0, /*tp_as_buffer*/
+    Py_TPFLAGS_DEFAULT, /*tp_flags*/
+    sparseproperty_doc, /*tp_doc*/
+    0, /*tp_traverse*/
+    0, /*tp_clear*/
+    0, /*tp_richcompare*/
+    0, /*tp_weaklistoffset*/
+    0, /*tp_iter*/
+    0, /*tp_iternext*/
+    0, /*tp_methods*/
+    0, /*tp_members*/
+    sparseproperty_getsets, /*tp_getset*/
+    0, /*tp_base*/
+    0, /*tp_dict*/
+    sparseproperty_get, /*tp_descr_get*/
+    sparseproperty_set, /*tp_descr_set*/
+    0, /*tp_dictoffset*/
+    0, /*tp_init*/
+    0, /*tp_alloc*/
+    sparseproperty_new, /*tp_new*/
+    0, /*tp_free*/
+    0, /*tp_is_gc*/
+};
+
+///////////////////////// change tracking //////////////////////////////////
+
+// The bit of the field in the words after the other parts of the instance of the class
+// with track_changes=True is set by the assignment of the field (by the descriptor, the index,
+// update, replacer and the keyword arguments of clone). The new objects are clean: the
+// constructors, the copy, unpickling and reset_changes clear the bits.
+
+static PyObject *
+dataobject_alloc_tracked(PyTypeObject *type, Py_ssize_t unused)
+{
+    return dataobject_alloc_words(type);
+}
+
+static int
+dataobject_check_tracked(PyObject *op)
+{
+    if (!DATAOBJECT_TRACKS_CHANGES(Py_TYPE(op))) {
+        PyErr_Format(PyExc_TypeError, "%s doesn't track changes", Py_TYPE(op)->tp_name);
+        return -1;
+    }
+    return 0;
+}
+
+// the indices of the changed fields
+static PyObject *
+dataobject_changed_indices(PyObject *op)
+{
+    PyTypeObject *tp = Py_TYPE(op);
+    uint64_t *changed = (uint64_t*)((char*)op + dataobject_bits_offset(tp));
+    const Py_ssize_t n_words = (PyDataObject_NUMITEMS(tp) + 63) / 64;
+    Py_ssize_t i, k = 0, n = 0;
+    PyObject *indices;
+
+    for (i = 0; i < n_words; i++)
+        n += bits_popcount(changed[i]);
+
+    indices = PyTuple_New(n);
+    if (indices == NULL)
+        return NULL;
+
+    for (i = 0; i < n_words; i++) {
+        uint64_t w = changed[i];
+
+        while (w) {
+            Py_ssize_t j = i * 64 + bits_popcount((w & (~w + 1)) - 1);
+            PyObject *index = PyLong_FromSsize_t(j);
+
+            if (index == NULL) {
+                Py_DECREF(indices);
+                return NULL;
+            }
+            PyTuple_SET_ITEM(indices, k++, index);
+            w &= w - 1;
+        }
+    }
+    return indices;
+}
+
+PyDoc_STRVAR(dataobject_changed_fields_doc,
+"changed_fields(ob) -- the names of the fields assigned since the creation of ob or reset_changes(ob)");
+
+static PyObject *
+dataobject_changed_fields(PyObject *module, PyObject *op)
+{
+    PyObject *fields, *indices, *names;
+    Py_ssize_t i, n;
+
+    if (dataobject_check_tracked(op) < 0)
+        return NULL;
+
+    fields = PyDict_GetItem(Py_TYPE(op)->tp_dict, __fields__name);
+    if (fields == NULL || !PyTuple_Check(fields)) {
+        PyErr_SetString(PyExc_TypeError, "__fields__ should be a tuple");
+        return NULL;
+    }
+
+    indices = dataobject_changed_indices(op);
+    if (indices == NULL)
+        return NULL;
+
+    n = PyTuple_GET_SIZE(indices);
+    names = PyTuple_New(n);
+    if (names == NULL) {
+        Py_DECREF(indices);
+        return NULL;
+    }
+    for (i = 0; i < n; i++) {
+        PyObject *name = PyTuple_GET_ITEM(fields, PyLong_AsSsize_t(PyTuple_GET_ITEM(indices, i)));
+        Py_INCREF(name);
+        PyTuple_SET_ITEM(names, i, name);
+    }
+    Py_DECREF(indices);
+    return names;
+}
+
+PyDoc_STRVAR(dataobject_changes_doc,
+"changes(ob) -- dict of the values of the fields assigned since the creation of ob or reset_changes(ob)");
+
+static PyObject *
+dataobject_changes(PyObject *module, PyObject *op)
+{
+    PyObject *names, *dict, *fields;
+    Py_ssize_t i, n;
+
+    names = dataobject_changed_fields(module, op);
+    if (names == NULL)
+        return NULL;
+
+    dict = PyDict_New();
+    if (dict == NULL) {
+        Py_DECREF(names);
+        return NULL;
+    }
+
+    fields = PyDict_GetItem(Py_TYPE(op)->tp_dict, __fields__name);
+    n = PyTuple_GET_SIZE(names);
+    for (i = 0; i < n; i++) {
+        PyObject *name = PyTuple_GET_ITEM(names, i);
+        Py_ssize_t index = _tuple_index((PyTupleObject*)fields, name);
+
+        if (PyDict_SetItem(dict, name, PyDataObject_GET_VALUE(op, index)) < 0) {
+            Py_DECREF(names);
+            Py_DECREF(dict);
+            return NULL;
+        }
+    }
+    Py_DECREF(names);
+    return dict;
+}
+
+PyDoc_STRVAR(dataobject_reset_changes_doc,
+"reset_changes(ob) -- forget the changed fields of ob");
+
+static PyObject *
+dataobject_reset_changes_func(PyObject *module, PyObject *op)
+{
+    if (dataobject_check_tracked(op) < 0)
+        return NULL;
+    dataobject_reset_changes(op);
+    Py_RETURN_NONE;
+}
+
+///////////////////////// the constructor of the inline, packed and sparse fields //
+
+// positional arguments of the constructor flattened into the values of the slots
+static PyObject *
+inline_flat_args(PyTypeObject *type, PyObject *const*args, const Py_ssize_t n_args)
+{
+    PyObject *plan = dataobject_type_plan(type);
+    Py_ssize_t i, j, n = 0, pos = 0;
+    PyObject *flat;
+
+    if (plan == NULL) {
+        PyErr_SetString(PyExc_TypeError, "__inline__ is missing");
+        return NULL;
+    }
+    if (n_args > PyTuple_GET_SIZE(plan)) {
+        PyErr_SetString(PyExc_TypeError,
+            "number of the arguments greater than the number of fields");
+        return NULL;
+    }
+
+    for (i = 0; i < n_args; i++) {
+        PyObject *p = PyTuple_GET_ITEM(PyTuple_GET_ITEM(plan, i), 1);
+        if (p == Py_None)
+            n++;
+        else if (Py_TYPE(p) == &PyInlineProperty_Type)
+            n += PyDataObject_NUMITEMS(((inlineproperty_object*)p)->type);
+    }
+
+    flat = PyTuple_New(n);
+    if (flat == NULL)
+        return NULL;
+
+    for (i = 0; i < n_args; i++) {
+        PyObject *p = PyTuple_GET_ITEM(PyTuple_GET_ITEM(plan, i), 1);
+        PyObject *v = args[i];
+
+        if (p == Py_None) {
+            Py_INCREF(v);
+            PyTuple_SET_ITEM(flat, pos++, v);
+        } else if (Py_TYPE(p) == &PyInlineProperty_Type) {
+            PyObject **items = inline_value_items((inlineproperty_object*)p, v);
+            if (items == NULL) {
+                Py_DECREF(flat);
+                return NULL;
+            }
+            n = PyDataObject_NUMITEMS(((inlineproperty_object*)p)->type);
+            for (j = 0; j < n; j++) {
+                Py_INCREF(items[j]);
+                PyTuple_SET_ITEM(flat, pos++, items[j]);
+            }
+        }
+    }
+    return flat;
+}
+
+static PyObject*
+dataobject_make_inline(PyTypeObject *type, PyObject *const*args, const Py_ssize_t n_args, PyObject *kwds)
+{
+    PyObject *flat = inline_flat_args(type, args, n_args);
+    PyObject *plan, *op;
+    Py_ssize_t i;
+
+    if (flat == NULL)
+        return NULL;
+    if (!DATAOBJECT_HAS_PLAN_VALUES(type)) {
+        op = dataobject_new_basic(type, flat, kwds);
+        Py_DECREF(flat);
+        return op;
+    }
+
+    // the packed and sparse values are stored into the allocated instance, so the keyword arguments go last
+    op = dataobject_new_basic(type, flat, NULL);
+    Py_DECREF(flat);
+    if (op == NULL)
+        return NULL;
+
+    plan = dataobject_type_plan(type);
+    for (i = 0; i < n_args; i++) {
+        PyObject *p = PyTuple_GET_ITEM(PyTuple_GET_ITEM(plan, i), 1);
+
+        int ret = 0;
+
+        if (Py_TYPE(p) == &PyBitProperty_Type)
+            ret = bits_assign(op, p, args[i]);
+        else if (Py_TYPE(p) == &PyDataObjectSparseProperty_Type)
+            ret = sparse_assign(op, p, args[i]);
+        if (ret < 0) {
+            Py_DECREF(op);
+            return NULL;
+        }
+    }
+    if (kwds && _dataobject_update(op, kwds, 1) < 0) {
+        Py_DECREF(op);
+        return NULL;
+    }
+    return op;
+}
+
+static PyObject*
+dataobject_new_inline(PyTypeObject *type, PyObject *args, PyObject *kwds)
+{
+    PyObject *const*tmp = (PyObject*const*)(((PyTupleObject*)args)->ob_item);
+
+    return dataobject_make_inline(type, tmp, Py_SIZE(args), kwds);
+}
+
+#if PY_VERSION_HEX >= 0x030A0000
+static PyObject*
+dataobject_vectorcall_inline(PyObject *type0, PyObject * const*args,
+                             size_t nargsf, PyObject *kwnames)
+{
+    const Py_ssize_t n_args = PyVectorcall_NARGS(nargsf);
+    PyObject *kwds = NULL, *op;
+
+    if (kwnames && PyTuple_GET_SIZE(kwnames) > 0) {
+        Py_ssize_t i, n_kwnames = PyTuple_GET_SIZE(kwnames);
+
+        kwds = PyDict_New();
+        if (kwds == NULL)
+            return NULL;
+        for (i = 0; i < n_kwnames; i++) {
+            if (PyDict_SetItem(kwds, PyTuple_GET_ITEM(kwnames, i), args[n_args + i]) < 0) {
+                Py_DECREF(kwds);
+                return NULL;
+            }
+        }
+    }
+
+    op = dataobject_make_inline((PyTypeObject*)type0, args, n_args, kwds);
+    Py_XDECREF(kwds);
+    return op;
+}
+#endif
+
+// the arguments of the constructor: the copies of the datastructs, the packed values and the values of the other fields
+static PyObject *
+inline_logical_args(PyObject *op)
+{
+    PyObject *plan = dataobject_type_plan(Py_TYPE(op));
+    PyObject **items = PyDataObject_ITEMS(op);
+    Py_ssize_t i, m, pos = 0;
+    PyObject *args;
+
+    if (plan == NULL) {
+        PyErr_SetString(PyExc_TypeError, "__inline__ is missing");
+        return NULL;
+    }
+
+    m = PyTuple_GET_SIZE(plan);
+    args = PyTuple_New(m);
+    if (args == NULL)
+        return NULL;
+
+    for (i = 0; i < m; i++) {
+        PyObject *p = PyTuple_GET_ITEM(PyTuple_GET_ITEM(plan, i), 1);
+        PyObject *v;
+
+        if (p == Py_None) {
+            v = PyDataObject_VALUE(items[pos]);
+            pos++;
+            Py_INCREF(v);
+        } else if (Py_TYPE(p) == &PyBitProperty_Type) {
+            v = bits_value(op, (bitproperty_object*)p);
+            if (v == NULL) {
+                Py_DECREF(args);
+                return NULL;
+            }
+        } else if (Py_TYPE(p) == &PyDataObjectSparseProperty_Type) {
+            v = sparse_value(op, (sparseproperty_object*)p);
+        } else {
+            v = inline_copy((inlineproperty_object*)p, items + pos);
+            if (v == NULL) {
+                Py_DECREF(args);
+                return NULL;
+            }
+            pos += PyDataObject_NUMITEMS(((inlineproperty_object*)p)->type);
+        }
+        PyTuple_SET_ITEM(args, i, v);
+    }
+    return args;
+}
+
+static PyObject *
+dataobject_repr_inline(PyObject *self)
+{
+    PyObject *plan = dataobject_type_plan(Py_TYPE(self));
+    PyObject *args, *parts = NULL, *sep = NULL, *text = NULL, *ret = NULL;
+    Py_ssize_t i, m;
+
+    i = Py_ReprEnter(self);
+    if (i != 0)
+        return i > 0 ? PyUnicode_FromString("(...)") : NULL;
+
+    args = inline_logical_args(self);
+    if (args == NULL)
+        goto done;
+
+    m = PyTuple_GET_SIZE(args);
+    parts = PyList_New(m);
+    if (parts == NULL)
+        goto done;
+    for (i = 0; i < m; i++) {
+        PyObject *name = PyTuple_GET_ITEM(PyTuple_GET_ITEM(plan, i), 0);
+        PyObject *s = PyUnicode_FromFormat("%U=%R", name, PyTuple_GET_ITEM(args, i));
+        if (s == NULL)
+            goto done;
+        PyList_SET_ITEM(parts, i, s);
+    }
+
+    sep = PyUnicode_FromString(", ");
+    if (sep == NULL)
+        goto done;
+    text = PyUnicode_Join(sep, parts);
+    if (text == NULL)
+        goto done;
+    ret = PyUnicode_FromFormat("%s(%U)", _PyType_Name(Py_TYPE(self)), text);
+
+done:
+    Py_XDECREF(args);
+    Py_XDECREF(parts);
+    Py_XDECREF(sep);
+    Py_XDECREF(text);
+    Py_ReprLeave(self);
+    return ret;
+}
+
+///////////////////////// Factory ////////////////////////////////////////
+
+static PyObject *Factory_new(PyTypeObject *tp, PyObject *args, PyObject *kw) {
+    struct PyFactoryObject *p;
+    Py_ssize_t n_args = Py_SIZE(args);
+    PyObject *o;
+    
+    if (n_args != 1) {
+        PyErr_SetString(PyExc_TypeError, "number of arguments != 1");
+        return NULL;        
+    }
+
+    o = (*tp->tp_alloc)(tp, 0);
+    if (!o) return NULL;
+    
+    p = ((struct PyFactoryObject *)o);
+    PyObject *f = PyTuple_GET_ITEM(args, 0);
+    p->factory = f; Py_INCREF(f);
+
+    // the builtin containers (not subclasses) are detected once
+    if (f == (PyObject*)&PyList_Type)
+        p->kind = FACTORY_LIST;
+    else if (f == (PyObject*)&PyDict_Type)
+        p->kind = FACTORY_DICT;
+    else if (f == (PyObject*)&PySet_Type)
+        p->kind = FACTORY_SET;
+    else
+        p->kind = FACTORY_CALL;
+
+    return o;
+}
+
+static void Factory_dealloc(PyObject *o) {
+    struct PyFactoryObject *p = (struct PyFactoryObject *)o;
+    PyTypeObject *t = Py_TYPE(o);
+    
+    Py_CLEAR(p->factory);
+    t->tp_free(o);
+}
+
+static PyMethodDef Factory_methods[] = {
+  {0, 0, 0, 0}
+};
+
+static PyGetSetDef Factory_getsets[] = {
+    {0}
+};
+
+static PyTypeObject PyFactory_Type = {
+    PyVarObject_HEAD_INIT(DEFERRED_ADDRESS(&PyType_Type), 0)
+    "recordclass._dataobject.Factory", /*tp_name*/
+    sizeof(struct PyFactoryObject), /*tp_basicsize*/
+    0, /*tp_itemsize*/
+    Factory_dealloc, /*tp_dealloc*/
+    0, /*tp_print*/
+    0, /*tp_getattr*/
+    0, /*tp_setattr*/
+    0, /*reserved*/
+    0, /*tp_repr*/
+    0, /*tp_as_number*/
+    0, /*tp_as_sequence*/
+    0, /*tp_as_mapping*/
+    0, /*tp_hash*/
+    0, /*tp_call*/
+    0, /*tp_str*/
+    0, /*tp_getattro*/
+    0, /*tp_setattro*/
+    0, /*tp_as_buffer*/
+    Py_TPFLAGS_DEFAULT|Py_TPFLAGS_BASETYPE, /*tp_flags*/
+    0, /*tp_doc*/
+    0, /*tp_traverse*/
+    0, /*tp_clear*/
+    0, /*tp_richcompare*/
+    0, /*tp_weaklistoffset*/
+    0, /*tp_iter*/
+    0, /*tp_iternext*/
+    Factory_methods, /*tp_methods*/
+    0, /*tp_members*/
+    Factory_getsets, /*tp_getset*/
+    0, /*tp_base*/
+    0, /*tp_dict*/
+    0, /*tp_descr_get*/
+    0, /*tp_descr_set*/
+    0, /*tp_dictoffset*/
+    0, /*tp_init*/
+    0, /*tp_alloc*/
+    Factory_new, /*tp_new*/
+    0, /*tp_free*/
+    0, /*tp_is_gc*/
+};
+
+///////////////////////// typeinfo ////////////////////////////////
+
+static void
+dataobjecttypeinfo_dealloc(PyObject *o) {
+    dataobjecttypeinfo_object *info = (dataobjecttypeinfo_object*)o;
+
+    Py_XDECREF(info->plan);
+    Py_XDECREF(info->categorical_table);
+    PyMem_Free(info->categorical_fields);
+    PyMem_Free(info->categorical_mask);
+    Py_XDECREF(info->stats);
+    Py_TYPE(o)->tp_free(o);
+}
+
+PyDoc_STRVAR(dataobjecttypeinfo_doc,
+"C-level information of the dataobject class");
+
+static PyTypeObject PyDataObjectTypeInfo_Type = {
+    PyVarObject_HEAD_INIT(DEFERRED_ADDRESS(&PyType_Type), 0)
+    "recordclass._dataobject.typeinfo", /*tp_name*/
+    sizeof(dataobjecttypeinfo_object), /*tp_basicsize*/
+    0, /*tp_itemsize*/
+    dataobjecttypeinfo_dealloc, /*tp_dealloc*/
+    0, /*tp_print*/
+    0, /*tp_getattr*/
+    0, /*tp_setattr*/
+    0, /*reserved*/
+    0, /*tp_repr*/
+    0, /*tp_as_number*/
+    0, /*tp_as_sequence*/
+    0, /*tp_as_mapping*/
+    0, /*tp_hash*/
+    0, /*tp_call*/
+    0, /*tp_str*/
+    0, /*tp_getattro*/
+    0, /*tp_setattro*/
+    0, /*tp_as_buffer*/
+    Py_TPFLAGS_DEFAULT, /*tp_flags*/
+    dataobjecttypeinfo_doc, /*tp_doc*/
+    0, /*tp_traverse*/
+    0, /*tp_clear*/
+    0, /*tp_richcompare*/
+    0, /*tp_weaklistoffset*/
+    0, /*tp_iter*/
+    0, /*tp_iternext*/
+    0, /*tp_methods*/
+    0, /*tp_members*/
+    0, /*tp_getset*/
+    0, /*tp_base*/
+    0, /*tp_dict*/
+    0, /*tp_descr_get*/
+    0, /*tp_descr_set*/
+    0, /*tp_dictoffset*/
+    0, /*tp_init*/
+    0, /*tp_alloc*/
+    0, /*tp_new*/
+    0, /*tp_free*/
+    0, /*tp_is_gc*/
+};
+
+// typeinfo of the class, which is created on the first call;
+// the subclasses don't inherit tp_cache, so each class has its own one
+static dataobjecttypeinfo_object *
+dataobject_typeinfo(PyTypeObject *type)
+{
+    dataobjecttypeinfo_object *info;
+
+    if (type->tp_cache) {
+        if (Py_TYPE(type->tp_cache) != &PyDataObjectTypeInfo_Type) {
+            PyErr_SetString(PyExc_TypeError, "tp_cache of the class is already in use");
+            return NULL;
+        }
+        return (dataobjecttypeinfo_object*)type->tp_cache;
+    }
+
+    info = PyObject_New(dataobjecttypeinfo_object, &PyDataObjectTypeInfo_Type);
+    if (info == NULL)
+        return NULL;
+    info->flags = 0;
+    info->layout = 0;
+    info->plan = NULL;
+    info->categorical_table = NULL;
+    info->categorical_fields = NULL;
+    info->n_categorical = 0;
+    info->categorical_mask = NULL;
+    info->stats = NULL;
+
+    type->tp_cache = (PyObject*)info;
+    return info;
+}
+
+///////////////////////// dataobjectstats ////////////////////////////////
+
+static void
+dataobjectstats_dealloc(PyObject *o) {
+    Py_TYPE(o)->tp_free(o);
+}
+
+static PyObject *
+dataobjectstats_call(PyObject *op, PyObject *args, PyObject *kw) {
+    dataobjectstats_object *stats = (dataobjectstats_object*)op;
+
+    if (PyTuple_GET_SIZE(args) || (kw && PyDict_GET_SIZE(kw))) {
+        PyErr_SetString(PyExc_TypeError, "__stats__() takes no arguments");
+        return NULL;
+    }
+
+    return Py_BuildValue("{s:n,s:n,s:n,s:n,s:n}",
+                         "live", stats->live,
+                         "allocated", stats->allocated,
+                         "peak", stats->peak,
+                         "bytes", stats->live * stats->size,
+                         "peak_bytes", stats->peak * stats->size);
+}
+
+PyDoc_STRVAR(dataobjectstats_reset_doc,
+"Reset the number of allocations and the peak number of live instances");
+
+static PyObject *
+dataobjectstats_reset(PyObject *op, PyObject *unused) {
+    dataobjectstats_object *stats = (dataobjectstats_object*)op;
+
+    stats->allocated = 0;
+    stats->peak = stats->live;
+
+    Py_RETURN_NONE;
+}
+
+static PyMethodDef dataobjectstats_methods[] = {
+  {"reset", dataobjectstats_reset, METH_NOARGS, dataobjectstats_reset_doc},
+  {0, 0, 0, 0}
+};
+
+PyDoc_STRVAR(dataobjectstats_doc,
+"Allocation statistics of the class: call it to get a dict with the number of the live instances, \
+the total number of the allocations, the peak number of the live instances and their sizes in bytes");
+
+static PyTypeObject PyDataObjectStats_Type = {
+    PyVarObject_HEAD_INIT(DEFERRED_ADDRESS(&PyType_Type), 0)
+    "recordclass._dataobject.dataobjectstats", /*tp_name*/
+    sizeof(dataobjectstats_object), /*tp_basicsize*/
+    0, /*tp_itemsize*/
+    dataobjectstats_dealloc, /*tp_dealloc*/
+    0, /*tp_print*/
+    0, /*tp_getattr*/
+    0, /*tp_setattr*/
+    0, /*reserved*/
+    0, /*tp_repr*/
+    0, /*tp_as_number*/
+    0, /*tp_as_sequence*/
+    0, /*tp_as_mapping*/
+    0, /*tp_hash*/
+    dataobjectstats_call, /*tp_call*/
+    0, /*tp_str*/
+    0, /*tp_getattro*/
+    0, /*tp_setattro*/
+    0, /*tp_as_buffer*/
+    Py_TPFLAGS_DEFAULT, /*tp_flags*/
+    dataobjectstats_doc, /*tp_doc*/
+    0, /*tp_traverse*/
+    0, /*tp_clear*/
+    0, /*tp_richcompare*/
+    0, /*tp_weaklistoffset*/
+    0, /*tp_iter*/
+    0, /*tp_iternext*/
+    dataobjectstats_methods, /*tp_methods*/
+    0, /*tp_members*/
+    0, /*tp_getset*/
+    0, /*tp_base*/
+    0, /*tp_dict*/
+    0, /*tp_descr_get*/
+    0, /*tp_descr_set*/
+    0, /*tp_dictoffset*/
+    0, /*tp_init*/
+    0, /*tp_alloc*/
+    0, /*tp_new*/
+    0, /*tp_free*/
+    0, /*tp_is_gc*/
+};
+
+
+///////////////////////// arena ///////////////////////////////////////////
+
+// The instances of the classes with arena=True, which are created inside
+// `with arena():`, are bump-allocated from the current block of the arena.
+// The memory of the freed instances is not reused: the block is released
+// when all its instances are freed and it isn't the current block of an
+// active arena. So the instances, which escape the region, are valid and
+// keep their block alive. The blocks are aligned to ARENA_BLOCK_SIZE,
+// so the block of an instance is found by its address.
+// The current arena is thread-local; the blocks are managed under the GIL.
+
+#define ARENA_BLOCK_SIZE (256 * 1024)
+#define ARENA_ALIGN 16
+#define ARENA_ALIGN_UP(n) (((n) + (ARENA_ALIGN - 1)) & ~(size_t)(ARENA_ALIGN - 1))
+
+typedef struct {
+    char *pos;
+    char *end;
+    Py_ssize_t live;
+    int current;
+} arena_block;
+
+#define ARENA_BLOCK_START ARENA_ALIGN_UP(sizeof(arena_block))
+#define ARENA_BLOCK_OF(p) ((arena_block*)((uintptr_t)(p) & ~(uintptr_t)(ARENA_BLOCK_SIZE - 1)))
+
+typedef struct arena_object {
+    PyObject_HEAD
+    arena_block *block;
+    struct arena_object *prev;
+    Py_ssize_t n_blocks;
+    Py_ssize_t n_objects;
+    int active;
+} arena_object;
+
+static Py_tss_t current_arena_key = Py_tss_NEEDS_INIT;
+
+static inline arena_object *
+arena_current(void) {
+    return (arena_object*)PyThread_tss_get(&current_arena_key);
+}
+
+// The set of the addresses of all allocated blocks (open addressing with linear probing)
+
+static arena_block **arena_blocks = NULL;
+static size_t arena_blocks_mask = 0;
+static size_t arena_blocks_used = 0;
+
+static inline size_t
+arena_block_hash(arena_block *block) {
+    size_t h = (size_t)((uintptr_t)block / ARENA_BLOCK_SIZE);
+    return h * (size_t)0x9E3779B97F4A7C15ULL;
+}
+
+static int
+arena_blocks_resize(size_t capacity) {
+    arena_block **old = arena_blocks;
+    size_t i, old_capacity = old ? arena_blocks_mask + 1 : 0;
+    arena_block **blocks = PyMem_RawCalloc(capacity, sizeof(arena_block*));
+
+    if (blocks == NULL)
+        return -1;
+
+    arena_blocks = blocks;
+    arena_blocks_mask = capacity - 1;
+    for (i = 0; i < old_capacity; i++) {
+        if (old[i]) {
+            size_t j = arena_block_hash(old[i]) & arena_blocks_mask;
+            while (arena_blocks[j])
+                j = (j + 1) & arena_blocks_mask;
+            arena_blocks[j] = old[i];
+        }
+    }
+    PyMem_RawFree(old);
+    return 0;
+}
+
+static int
+arena_blocks_add(arena_block *block) {
+    size_t j;
+
+    if (arena_blocks == NULL || 2 * (arena_blocks_used + 1) > arena_blocks_mask + 1) {
+        if (arena_blocks_resize(arena_blocks ? 2 * (arena_blocks_mask + 1) : 64) < 0)
+            return -1;
+    }
+
+    j = arena_block_hash(block) & arena_blocks_mask;
+    while (arena_blocks[j])
+        j = (j + 1) & arena_blocks_mask;
+    arena_blocks[j] = block;
+    arena_blocks_used++;
+    return 0;
+}
+
+static inline int
+arena_blocks_contains(arena_block *block) {
+    size_t j;
+
+    if (arena_blocks == NULL)
+        return 0;
+
+    j = arena_block_hash(block) & arena_blocks_mask;
+    while (arena_blocks[j]) {
+        if (arena_blocks[j] == block)
+            return 1;
+        j = (j + 1) & arena_blocks_mask;
+    }
+    return 0;
+}
+
+static void
+arena_blocks_remove(arena_block *block) {
+    size_t i, j, k;
+
+    i = arena_block_hash(block) & arena_blocks_mask;
+    while (arena_blocks[i] != block) {
+        if (arena_blocks[i] == NULL)
+            return;
+        i = (i + 1) & arena_blocks_mask;
+    }
+    arena_blocks[i] = NULL;
+    arena_blocks_used--;
+
+    // backward shift of the following entries
+    j = i;
+    for (;;) {
+        j = (j + 1) & arena_blocks_mask;
+        if (arena_blocks[j] == NULL)
+            break;
+        k = arena_block_hash(arena_blocks[j]) & arena_blocks_mask;
+        if ((j > i && (k <= i || k > j)) || (j < i && (k <= i && k > j))) {
+            arena_blocks[i] = arena_blocks[j];
+            arena_blocks[j] = NULL;
+            i = j;
+        }
+    }
+}
+
+static void *
+arena_aligned_malloc(void) {
+#ifdef _WIN32
+    return _aligned_malloc(ARENA_BLOCK_SIZE, ARENA_BLOCK_SIZE);
+#else
+    void *p;
+    if (posix_memalign(&p, ARENA_BLOCK_SIZE, ARENA_BLOCK_SIZE) != 0)
+        return NULL;
+    return p;
+#endif
+}
+
+static void
+arena_aligned_free(void *p) {
+#ifdef _WIN32
+    _aligned_free(p);
+#else
+    free(p);
+#endif
+}
+
+// The released blocks are cached for reuse (up to ARENA_FREE_BLOCKS)
+
+#define ARENA_FREE_BLOCKS 64
+
+static arena_block *arena_free_blocks[ARENA_FREE_BLOCKS];
+static int arena_n_free_blocks = 0;
+
+static arena_block *
+arena_block_new(void) {
+    arena_block *block;
+
+    if (arena_n_free_blocks)
+        block = arena_free_blocks[--arena_n_free_blocks];
+    else {
+        block = (arena_block*)arena_aligned_malloc();
+        if (block == NULL)
+            return NULL;
+        if (arena_blocks_add(block) < 0) {
+            arena_aligned_free(block);
+            return NULL;
+        }
+    }
+    block->pos = (char*)block + ARENA_BLOCK_START;
+    block->end = (char*)block + ARENA_BLOCK_SIZE;
+    block->live = 0;
+    block->current = 1;
+    return block;
+}
+
+static void
+arena_block_free(arena_block *block) {
+    if (arena_n_free_blocks < ARENA_FREE_BLOCKS) {
+        // the cached block stays in arena_blocks, but it has no instances
+        arena_free_blocks[arena_n_free_blocks++] = block;
+        return;
+    }
+    arena_blocks_remove(block);
+    arena_aligned_free(block);
+}
+
+static void
+arena_release_block(arena_object *arena) {
+    arena_block *block = arena->block;
+
+    if (block) {
+        block->current = 0;
+        if (block->live == 0)
+            arena_block_free(block);
+        arena->block = NULL;
+    }
+}
+
+static PyObject *
+dataobject_alloc_arena(PyTypeObject *type, Py_ssize_t unused)
+{
+    arena_object *arena;
+    size_t size = ARENA_ALIGN_UP((size_t)type->tp_basicsize);
+    arena_block *block;
+    PyObject *op;
+
+    arena = arena_current();
+    if (arena == NULL || size > (ARENA_BLOCK_SIZE - ARENA_BLOCK_START) / 4)
+        return dataobject_alloc(type, unused);
+
+    block = arena->block;
+    if (block == NULL || block->pos + size > block->end) {
+        arena_release_block(arena);
+        block = arena_block_new();
+        if (block == NULL)
+            return PyErr_NoMemory();
+        arena->block = block;
+        arena->n_blocks++;
+    }
+
+    op = (PyObject*)block->pos;
+    block->pos += size;
+    block->live++;
+    arena->n_objects++;
+
+    PyObject_Init(op, type);
+
+#if PY_VERSION_HEX < 0x03080000
+    if (type->tp_flags & Py_TPFLAGS_HEAPTYPE)
+        Py_INCREF(type);
+#endif
+
+    if (type->tp_dictoffset) {
+        PyObject **dictptr = PyDataObject_DICTPTR(type, op);
+        *dictptr = NULL;
+    }
+    if (type->tp_weaklistoffset) {
+        PyObject **weakrefsptr = PyDataObject_WEAKLISTPTR(type, op);
+        *weakrefsptr = NULL;
+    }
+
+    return op;
+}
+
+static void
+dataobject_free_arena(void *op)
+{
+    arena_block *block = ARENA_BLOCK_OF(op);
+
+    if (arena_blocks_contains(block)) {
+        if (--block->live == 0 && !block->current)
+            arena_block_free(block);
+    }
+    else
+        PyObject_Free(op);
+}
+
+static PyObject *
+arena_new(PyTypeObject *type, PyObject *args, PyObject *kw)
+{
+    arena_object *arena;
+
+    if (PyTuple_GET_SIZE(args) || (kw && PyDict_GET_SIZE(kw))) {
+        PyErr_SetString(PyExc_TypeError, "arena() takes no arguments");
+        return NULL;
+    }
+
+    arena = (arena_object*)type->tp_alloc(type, 0);
+    if (arena == NULL)
+        return NULL;
+
+    arena->block = NULL;
+    arena->prev = NULL;
+    arena->n_blocks = 0;
+    arena->n_objects = 0;
+    arena->active = 0;
+
+    return (PyObject*)arena;
+}
+
+static void
+arena_dealloc(PyObject *op)
+{
+    arena_release_block((arena_object*)op);
+    Py_TYPE(op)->tp_free(op);
+}
+
+static PyObject *
+arena_enter(PyObject *op, PyObject *unused)
+{
+    arena_object *arena = (arena_object*)op;
+
+    if (arena->active) {
+        PyErr_SetString(PyExc_RuntimeError, "the arena is already active");
+        return NULL;
+    }
+
+    arena->prev = arena_current();
+    if (PyThread_tss_set(&current_arena_key, arena) != 0) {
+        arena->prev = NULL;
+        PyErr_SetString(PyExc_RuntimeError, "can't set the current arena");
+        return NULL;
+    }
+    Py_INCREF(op);
+    arena->active = 1;
+
+    Py_INCREF(op);
+    return op;
+}
+
+static PyObject *
+arena_exit(PyObject *op, PyObject *args)
+{
+    arena_object *arena = (arena_object*)op;
+
+    if (arena_current() != arena) {
+        PyErr_SetString(PyExc_RuntimeError, "the arena is not the current one in this thread");
+        return NULL;
+    }
+
+    if (PyThread_tss_set(&current_arena_key, arena->prev) != 0) {
+        PyErr_SetString(PyExc_RuntimeError, "can't restore the current arena");
+        return NULL;
+    }
+    arena->prev = NULL;
+    arena->active = 0;
+    arena_release_block(arena);
+    Py_DECREF(op);
+
+    Py_RETURN_FALSE;
+}
+
+static PyMethodDef arena_methods[] = {
+    {"__enter__", arena_enter, METH_NOARGS, 0},
+    {"__exit__", arena_exit, METH_VARARGS, 0},
+    {0, 0, 0, 0}
+};
+
+static PyMemberDef arena_members[] = {
+    {"n_blocks", T_PYSSIZET, offsetof(arena_object, n_blocks), READONLY,
+     "Number of the allocated blocks"},
+    {"n_objects", T_PYSSIZET, offsetof(arena_object, n_objects), READONLY,
+     "Number of the allocated instances"},
+    {0}
+};
+
+PyDoc_STRVAR(arena_doc,
+"Allocation region for the instances of the classes with arena=True:\n\n\
+    with arena():\n\
+        rows = [Row(...) for ...]\n\n\
+Inside the region such instances are allocated from large blocks. The memory of an instance\n\
+is never reused after its deallocation: a block is released in bulk only when all its instances are\n\
+deallocated and the region is closed. Instances, which escape the region, remain valid.\n\
+The current region is thread-local.");
+
+static PyTypeObject PyArena_Type = {
+    PyVarObject_HEAD_INIT(DEFERRED_ADDRESS(&PyType_Type), 0)
+    "recordclass._dataobject.arena", /*tp_name*/
+    sizeof(arena_object), /*tp_basicsize*/
+    0, /*tp_itemsize*/
+    arena_dealloc, /*tp_dealloc*/
+    0, /*tp_print*/
+    0, /*tp_getattr*/
+    0, /*tp_setattr*/
+    0, /*reserved*/
+    0, /*tp_repr*/
+    0, /*tp_as_number*/
+    0, /*tp_as_sequence*/
+    0, /*tp_as_mapping*/
+    0, /*tp_hash*/
+    0, /*tp_call*/
+    0, /*tp_str*/
+    0, /*tp_getattro*/
+    0, /*tp_setattro*/
+    0, /*tp_as_buffer*/
+    Py_TPFLAGS_DEFAULT, /*tp_flags*/
+    arena_doc, /*tp_doc*/
+    0, /*tp_traverse*/
+    0, /*tp_clear*/
+    0, /*tp_richcompare*/
+    0, /*tp_weaklistoffset*/
+    0, /*tp_iter*/
+    0, /*tp_iternext*/
+    arena_methods, /*tp_methods*/
+    arena_members, /*tp_members*/
+    0, /*tp_getset*/
+    0, /*tp_base*/
+    0, /*tp_dict*/
+    0, /*tp_descr_get*/
+    0, /*tp_descr_set*/
+    0, /*tp_dictoffset*/
+    0, /*tp_init*/
+    0, /*tp_alloc*/
+    arena_new, /*tp_new*/
+    0, /*tp_free*/
+    0, /*tp_is_gc*/
+};
+
+///////////////////////// fieldgetter ////////////////////////////////////
+
+static PyTypeObject *litetuple_type = NULL;
+
+static int
+dataobject_field_indexes(PyTypeObject *type, PyObject *names, Py_ssize_t *index)
+{
+    PyObject *fields;
+    Py_ssize_t i, j, n = PyTuple_GET_SIZE(names), n_fields;
+
+    fields = PyObject_GetAttr((PyObject*)type, __fields__name);
+    if (fields == NULL)
+        return -1;
+    if (!PyTuple_Check(fields)) {
+        PyErr_SetString(PyExc_TypeError, "__fields__ should be a tuple");
+        Py_DECREF(fields);
+        return -1;
+    }
+    n_fields = PyTuple_GET_SIZE(fields);
+
+    for (i = 0; i < n; i++) {
+        PyObject *name = PyTuple_GET_ITEM(names, i);
+
+        if (!PyUnicode_Check(name)) {
+            PyErr_SetString(PyExc_TypeError, "field name should be a str");
+            Py_DECREF(fields);
+            return -1;
+        }
+        for (j = 0; j < n_fields; j++) {
+            PyObject *fn = PyTuple_GET_ITEM(fields, j);
+            if (fn == name || PyUnicode_Compare(fn, name) == 0)
+                break;
+        }
+        if (j == n_fields) {
+            PyErr_Format(PyExc_TypeError, "%U not in __fields__", name);
+            Py_DECREF(fields);
+            return -1;
+        }
+        index[i] = j;
+    }
+
+    Py_DECREF(fields);
+    return 0;
+}
+
+static int
+dataobject_type_check(PyObject *cls)
+{
+    if (!PyType_Check(cls) ||
+            (!PyType_IsSubtype((PyTypeObject*)cls, &PyDataObject_Type) &&
+             !PyType_IsSubtype((PyTypeObject*)cls, &PyDataStruct_Type))) {
+        PyErr_SetString(PyExc_TypeError, "1st argument is not subclass of dataobject");
+        return 0;
+    }
+    return 1;
+}
+
+static int
+dataobject_instance_check(PyTypeObject *type, PyObject *op)
+{
+    PyTypeObject *tp = Py_TYPE(op);
+
+    if (tp != type && !PyType_IsSubtype(tp, type)) {
+        PyErr_Format(PyExc_TypeError, "expected %s instance, got %s",
+                     type->tp_name, tp->tp_name);
+        return 0;
+    }
+    return 1;
+}
+
+static PyObject *
+fieldgetter_get(fieldgetter_object *fg, PyObject *op)
+{
+    Py_ssize_t i, n = Py_SIZE(fg);
+    PyObject *ret;
+
+    if (!dataobject_instance_check(fg->type, op))
+        return NULL;
+
+    if (n == 1) {
+        ret = PyDataObject_GET_VALUE(op, fg->index[0]);
+        Py_INCREF(ret);
+        return ret;
+    }
+
+    if (fg->as_litetuple)
+        ret = (PyObject*)_PyObject_NewVar(litetuple_type, n);
+    else
+        ret = PyTuple_New(n);
+    if (ret == NULL)
+        return NULL;
+
+    PyObject **items = ((PyTupleObject*)ret)->ob_item;
+    for (i = 0; i < n; i++) {
+        PyObject *v = PyDataObject_GET_VALUE(op, fg->index[i]);
+        Py_INCREF(v);
+        items[i] = v;
+    }
+
+    return ret;
+}
+
+static PyObject *
+fieldgetter_call(PyObject *self, PyObject *args, PyObject *kw)
+{
+    if (kw && PyDict_GET_SIZE(kw)) {
+        PyErr_SetString(PyExc_TypeError, "fieldgetter() takes no keyword arguments");
+        return NULL;
+    }
+    if (PyTuple_GET_SIZE(args) != 1) {
+        PyErr_SetString(PyExc_TypeError, "fieldgetter() expected 1 argument");
+        return NULL;
+    }
+
+    return fieldgetter_get((fieldgetter_object*)self, PyTuple_GET_ITEM(args, 0));
+}
+
+#if PY_VERSION_HEX >= 0x030A0000
+static PyObject *
+fieldgetter_vectorcall(PyObject *self, PyObject *const *args, size_t nargsf, PyObject *kwnames)
+{
+    if (kwnames && PyTuple_GET_SIZE(kwnames)) {
+        PyErr_SetString(PyExc_TypeError, "fieldgetter() takes no keyword arguments");
+        return NULL;
+    }
+    if (PyVectorcall_NARGS(nargsf) != 1) {
+        PyErr_SetString(PyExc_TypeError, "fieldgetter() expected 1 argument");
+        return NULL;
+    }
+
+    return fieldgetter_get((fieldgetter_object*)self, args[0]);
+}
+#endif
+
+static PyObject *
+fieldgetter_new(PyTypeObject *tp, PyObject *args, PyObject *kw)
+{
+    fieldgetter_object *fg;
+    PyObject *cls, *names;
+    Py_ssize_t n;
+    int as_litetuple = 0;
+
+    n = PyTuple_GET_SIZE(args) - 1;
+    if (n < 1) {
+        PyErr_SetString(PyExc_TypeError, "fieldgetter(cls, *names) expected at least one field name");
+        return NULL;
+    }
+
+    if (kw && PyDict_GET_SIZE(kw)) {
+        PyObject *v = PyDict_GetItemString(kw, "litetuple");
+        if (v == NULL || PyDict_GET_SIZE(kw) > 1) {
+            PyErr_SetString(PyExc_TypeError, "fieldgetter() got an unexpected keyword argument");
+            return NULL;
+        }
+        as_litetuple = PyObject_IsTrue(v);
+        if (as_litetuple < 0)
+            return NULL;
+    }
+
+    cls = PyTuple_GET_ITEM(args, 0);
+    if (!dataobject_type_check(cls))
+        return NULL;
+
+    if (as_litetuple && litetuple_type == NULL) {
+        litetuple_type = (PyTypeObject*)_PyObject_GetObject("recordclass._litetuple", "litetuple");
+        if (litetuple_type == NULL)
+            return NULL;
+    }
+
+    names = PyTuple_GetSlice(args, 1, n + 1);
+    if (names == NULL)
+        return NULL;
+
+    fg = (fieldgetter_object*)PyObject_GC_NewVar(fieldgetter_object, tp, n);
+    if (fg == NULL) {
+        Py_DECREF(names);
+        return NULL;
+    }
+
+    Py_INCREF(cls);
+    fg->type = (PyTypeObject*)cls;
+    fg->names = names;
+    fg->as_litetuple = as_litetuple;
+#if PY_VERSION_HEX >= 0x030A0000
+    fg->vectorcall = fieldgetter_vectorcall;
+#endif
+
+    if (dataobject_field_indexes(fg->type, names, fg->index) < 0) {
+        Py_DECREF(fg);
+        return NULL;
+    }
+
+    PyObject_GC_Track(fg);
+    return (PyObject*)fg;
+}
+
+static int
+fieldgetter_traverse(PyObject *o, visitproc visit, void *arg)
+{
+    fieldgetter_object *fg = (fieldgetter_object*)o;
+
+    Py_VISIT(fg->type);
+    return 0;
+}
+
+static void
+fieldgetter_dealloc(PyObject *o)
+{
+    fieldgetter_object *fg = (fieldgetter_object*)o;
+
+    PyObject_GC_UnTrack(o);
+    Py_CLEAR(fg->type);
+    Py_CLEAR(fg->names);
+    PyObject_GC_Del(o);
+}
+
+static PyObject *
+fieldgetter_repr(PyObject *o)
+{
+    fieldgetter_object *fg = (fieldgetter_object*)o;
+    PyObject *sep, *names, *ret;
+
+    sep = PyUnicode_FromString("', '");
+    if (sep == NULL)
+        return NULL;
+    names = PyUnicode_Join(sep, fg->names);
+    Py_DECREF(sep);
+    if (names == NULL)
+        return NULL;
+    ret = PyUnicode_FromFormat("fieldgetter(%s, '%U'%s)", fg->type->tp_name, names,
+                               fg->as_litetuple ? ", litetuple=True" : "");
+    Py_DECREF(names);
+    return ret;
+}
+
+static PyObject *
+fieldgetter_reduce(PyObject *o, PyObject *Py_UNUSED(ignored))
+{
+    fieldgetter_object *fg = (fieldgetter_object*)o;
+    PyObject *args, *ret;
+
+    if (fg->as_litetuple) {
+        PyErr_SetString(PyExc_TypeError, "fieldgetter with litetuple=True can't be pickled");
+        return NULL;
+    }
+
+    args = PyTuple_New(PyTuple_GET_SIZE(fg->names) + 1);
+    if (args == NULL)
+        return NULL;
+    Py_INCREF(fg->type);
+    PyTuple_SET_ITEM(args, 0, (PyObject*)fg->type);
+    for (Py_ssize_t i = 0; i < PyTuple_GET_SIZE(fg->names); i++) {
+        PyObject *name = PyTuple_GET_ITEM(fg->names, i);
+        Py_INCREF(name);
+        PyTuple_SET_ITEM(args, i+1, name);
+    }
+
+    ret = PyTuple_Pack(2, (PyObject*)Py_TYPE(o), args);
+    Py_DECREF(args);
+    return ret;
+}
+
+static PyMethodDef fieldgetter_methods[] = {
+    {"__reduce__", fieldgetter_reduce, METH_NOARGS, 0},
+    {0, 0, 0, 0}
+};
+
+PyDoc_STRVAR(fieldgetter_doc,
+"fieldgetter(cls, *names, litetuple=False)\n"
+"--\n\n"
+"Return a callable object that fetches the given fields from the instance of `cls`\n"
+"(or it's subclass) by precomputed indexes. For one name it returns the value,\n"
+"for several names it returns a tuple (or litetuple if `litetuple=True`).");
+
+static PyTypeObject PyFieldGetter_Type = {
+    PyVarObject_HEAD_INIT(DEFERRED_ADDRESS(&PyType_Type), 0)
+    "recordclass._dataobject.fieldgetter", /*tp_name*/
+    sizeof(fieldgetter_object) - sizeof(Py_ssize_t), /*tp_basicsize*/
+    sizeof(Py_ssize_t), /*tp_itemsize*/
+    fieldgetter_dealloc, /*tp_dealloc*/
+#if PY_VERSION_HEX >= 0x030A0000
+    offsetof(fieldgetter_object, vectorcall), /*tp_vectorcall_offset*/
+#else
+    0, /*tp_print*/
+#endif
+    0, /*tp_getattr*/
+    0, /*tp_setattr*/
+    0, /*reserved*/
+    fieldgetter_repr, /*tp_repr*/
+    0, /*tp_as_number*/
+    0, /*tp_as_sequence*/
+    0, /*tp_as_mapping*/
+    0, /*tp_hash*/
+    fieldgetter_call, /*tp_call*/
+    0, /*tp_str*/
+    0, /*tp_getattro*/
+    0, /*tp_setattro*/
+    0, /*tp_as_buffer*/
+#if PY_VERSION_HEX >= 0x030A0000
+    Py_TPFLAGS_DEFAULT|Py_TPFLAGS_HAVE_GC|Py_TPFLAGS_HAVE_VECTORCALL, /*tp_flags*/
+#else
+    Py_TPFLAGS_DEFAULT|Py_TPFLAGS_HAVE_GC, /*tp_flags*/
+#endif
+    fieldgetter_doc, /*tp_doc*/
+    fieldgetter_traverse, /*tp_traverse*/
+    0, /*tp_clear*/
+    0, /*tp_richcompare*/
+    0, /*tp_weaklistoffset*/
+    0, /*tp_iter*/
+    0, /*tp_iternext*/
+    fieldgetter_methods, /*tp_methods*/
+    0, /*tp_members*/
+    0, /*tp_getset*/
+    0, /*tp_base*/
+    0, /*tp_dict*/
+    0, /*tp_descr_get*/
+    0, /*tp_descr_set*/
+    0, /*tp_dictoffset*/
+    0, /*tp_init*/
+    0, /*tp_alloc*/
+    fieldgetter_new, /*tp_new*/
+    0, /*tp_free*/
+    0, /*tp_is_gc*/
+};
+
+///////////////////////// replacer ///////////////////////////////////////
+
+static int
+dataobject_is_readonly_field(PyTypeObject *type, PyObject *name)
+{
+    PyObject *d = _PyType_Lookup(type, name);
+
+    if (d == NULL)
+        return 0;
+    if (Py_TYPE(d) == &PyMemberDescr_Type)
+        return (((PyMemberDescrObject*)d)->d_member->flags & READONLY) != 0;
+    if (Py_TYPE(d) == &PyDataObjectProperty_Type)
+        return ((dataobjectproperty_object*)d)->readonly;
+    return 0;
+}
+
+static PyObject *
+replacer_apply(replacer_object *r, PyObject *op, PyObject *const *args, Py_ssize_t nargs)
+{
+    Py_ssize_t i, n = Py_SIZE(r);
+    PyObject **items;
+
+    if (nargs != n + 1) {
+        PyErr_Format(PyExc_TypeError, "replacer expected %zd arguments, got %zd", n + 1, nargs);
+        return NULL;
+    }
+
+    if (!dataobject_instance_check(r->type, op))
+        return NULL;
+
+    if (r->inplace)
+        Py_INCREF(op);
+    else {
+        op = dataobject_copy(op);
+        if (op == NULL)
+            return NULL;
+    }
+
+    items = PyDataObject_ITEMS(op);
+    for (i = 0; i < n; i++) {
+        PyObject *v = args[i];
+        PyObject *old = items[r->index[i]];
+
+        if (DATAOBJECT_VALIDATED(op)) {
+            v = dataobject_validate_item(op, r->index[i], v);
+            if (v == NULL) {
+                Py_DECREF(op);
+                return NULL;
+            }
+        } else
+            Py_INCREF(v);
+        items[r->index[i]] = v;
+        Py_XDECREF(old);
+        dataobject_maybe_track(op, v);
+        dataobject_mark_changed(op, r->index[i]);
+    }
+
+    if (Py_TYPE(op) == r->type ? r->categorical : 1) {
+        if (dataobject_intern_categorical(op) < 0) {
+            Py_DECREF(op);
+            return NULL;
+        }
+    }
+
+    if (r->inplace) {
+        Py_DECREF(op);
+        Py_RETURN_NONE;
+    }
+
+    return op;
+}
+
+static PyObject *
+replacer_call(PyObject *self, PyObject *args, PyObject *kw)
+{
+    if (kw && PyDict_GET_SIZE(kw)) {
+        PyErr_SetString(PyExc_TypeError, "replacer takes no keyword arguments");
+        return NULL;
+    }
+    if (PyTuple_GET_SIZE(args) < 1) {
+        PyErr_SetString(PyExc_TypeError, "replacer expected an instance as 1st argument");
+        return NULL;
+    }
+
+    return replacer_apply((replacer_object*)self, PyTuple_GET_ITEM(args, 0),
+                          &PyTuple_GET_ITEM(args, 1), PyTuple_GET_SIZE(args));
+}
+
+#if PY_VERSION_HEX >= 0x030A0000
+static PyObject *
+replacer_vectorcall(PyObject *self, PyObject *const *args, size_t nargsf, PyObject *kwnames)
+{
+    Py_ssize_t nargs = PyVectorcall_NARGS(nargsf);
+
+    if (kwnames && PyTuple_GET_SIZE(kwnames)) {
+        PyErr_SetString(PyExc_TypeError, "replacer takes no keyword arguments");
+        return NULL;
+    }
+    if (nargs < 1) {
+        PyErr_SetString(PyExc_TypeError, "replacer expected an instance as 1st argument");
+        return NULL;
+    }
+
+    return replacer_apply((replacer_object*)self, args[0], args + 1, nargs);
+}
+#endif
+
+static int
+replacer_traverse(PyObject *o, visitproc visit, void *arg)
+{
+    replacer_object *r = (replacer_object*)o;
+
+    Py_VISIT(r->type);
+    return 0;
+}
+
+static void
+replacer_dealloc(PyObject *o)
+{
+    replacer_object *r = (replacer_object*)o;
+
+    PyObject_GC_UnTrack(o);
+    Py_CLEAR(r->type);
+    Py_CLEAR(r->names);
+    PyObject_GC_Del(o);
+}
+
+static PyObject *
+replacer_repr(PyObject *o)
+{
+    replacer_object *r = (replacer_object*)o;
+    PyObject *sep, *names, *ret;
+
+    sep = PyUnicode_FromString("', '");
+    if (sep == NULL)
+        return NULL;
+    names = PyUnicode_Join(sep, r->names);
+    Py_DECREF(sep);
+    if (names == NULL)
+        return NULL;
+    ret = PyUnicode_FromFormat("%s.__replacer__('%U'%s)", r->type->tp_name, names,
+                               r->inplace ? ", inplace=True" : "");
+    Py_DECREF(names);
+    return ret;
+}
+
+static PyTypeObject PyReplacer_Type = {
+    PyVarObject_HEAD_INIT(DEFERRED_ADDRESS(&PyType_Type), 0)
+    "recordclass._dataobject.replacer", /*tp_name*/
+    sizeof(replacer_object) - sizeof(Py_ssize_t), /*tp_basicsize*/
+    sizeof(Py_ssize_t), /*tp_itemsize*/
+    replacer_dealloc, /*tp_dealloc*/
+#if PY_VERSION_HEX >= 0x030A0000
+    offsetof(replacer_object, vectorcall), /*tp_vectorcall_offset*/
+#else
+    0, /*tp_print*/
+#endif
+    0, /*tp_getattr*/
+    0, /*tp_setattr*/
+    0, /*reserved*/
+    replacer_repr, /*tp_repr*/
+    0, /*tp_as_number*/
+    0, /*tp_as_sequence*/
+    0, /*tp_as_mapping*/
+    0, /*tp_hash*/
+    replacer_call, /*tp_call*/
+    0, /*tp_str*/
+    0, /*tp_getattro*/
+    0, /*tp_setattro*/
+    0, /*tp_as_buffer*/
+#if PY_VERSION_HEX >= 0x030A0000
+    Py_TPFLAGS_DEFAULT|Py_TPFLAGS_HAVE_GC|Py_TPFLAGS_HAVE_VECTORCALL, /*tp_flags*/
+#else
+    Py_TPFLAGS_DEFAULT|Py_TPFLAGS_HAVE_GC, /*tp_flags*/
+#endif
+    0, /*tp_doc*/
+    replacer_traverse, /*tp_traverse*/
+    0, /*tp_clear*/
+    0, /*tp_richcompare*/
+    0, /*tp_weaklistoffset*/
+    0, /*tp_iter*/
+    0, /*tp_iternext*/
+    0, /*tp_methods*/
+    0, /*tp_members*/
+    0, /*tp_getset*/
+    0, /*tp_base*/
+    0, /*tp_dict*/
+    0, /*tp_descr_get*/
+    0, /*tp_descr_set*/
+    0, /*tp_dictoffset*/
+    0, /*tp_init*/
+    0, /*tp_alloc*/
+    0, /*tp_new*/
+    0, /*tp_free*/
+    0, /*tp_is_gc*/
+};
+
+static PyObject *
+dataobject_replacer(PyObject *cls, PyObject *args, PyObject *kw)
+{
+    replacer_object *r;
+    PyTypeObject *type = (PyTypeObject*)cls;
+    Py_ssize_t i, n = PyTuple_GET_SIZE(args);
+    int inplace = 0;
+
+    if (n < 1) {
+        PyErr_SetString(PyExc_TypeError, "__replacer__(*names) expected at least one field name");
+        return NULL;
+    }
+
+    if (kw && PyDict_GET_SIZE(kw)) {
+        PyObject *v = PyDict_GetItemString(kw, "inplace");
+        if (v == NULL || PyDict_GET_SIZE(kw) > 1) {
+            PyErr_SetString(PyExc_TypeError, "__replacer__() got an unexpected keyword argument");
+            return NULL;
+        }
+        inplace = PyObject_IsTrue(v);
+        if (inplace < 0)
+            return NULL;
+    }
+
+    r = (replacer_object*)PyObject_GC_NewVar(replacer_object, &PyReplacer_Type, n);
+    if (r == NULL)
+        return NULL;
+
+    Py_INCREF(type);
+    r->type = type;
+    Py_INCREF(args);
+    r->names = args;
+    r->inplace = inplace;
+    r->categorical = PyDict_GetItem(type->tp_dict, __categorical_fields__name) != NULL;
+#if PY_VERSION_HEX >= 0x030A0000
+    r->vectorcall = replacer_vectorcall;
+#endif
+
+    if (dataobject_field_indexes(type, args, r->index) < 0) {
+        Py_DECREF(r);
+        return NULL;
+    }
+
+    if (inplace) {
+        for (i = 0; i < n; i++) {
+            PyObject *name = PyTuple_GET_ITEM(args, i);
+            if (dataobject_is_readonly_field(type, name)) {
+                PyErr_Format(PyExc_TypeError, "field %U is readonly", name);
+                Py_DECREF(r);
+                return NULL;
+            }
+        }
+    }
+
+    PyObject_GC_Track(r);
+    return (PyObject*)r;
+}
+
+///////////////////////// validator //////////////////////////////////////
+
+/*
+ * The validator of validate=True classes is compiled from the annotations of the fields
+ * (see datatype._validation_plan) and is stored in the class as __validator__.
+ * The values are checked and coerced after the construction (tp_init and vectorcall
+ * wrappers) and on assignment of the fields (properties, items, update).
+ */
+
+static PyTypeObject PyValidator_Type;
+static PyTypeObject *litelist_type = NULL;
+
+static const char *validate_kind_names[] = {
+    "any", "int", "float", "str", "bytes", "bool", "dataobject", "instance", "litelist", NULL
+};
+
+static const char *
+validate_expected(validate_spec *s)
+{
+    if (s->kind == VALIDATE_DATAOBJECT || s->kind == VALIDATE_INSTANCE)
+        return ((PyTypeObject*)s->arg)->tp_name;
+    return validate_kind_names[s->kind];
+}
+
+static PyObject *validate_value(validate_spec *s, PyObject *v, PyObject *field, PyTypeObject *owner);
+
+static PyObject *
+validate_litelist(validate_spec *s, PyObject *v, PyObject *field, PyTypeObject *owner)
+{
+    validate_spec *item = s->arg ? ((validator_object*)s->arg)->specs : NULL;
+    int is_litelist = PyObject_TypeCheck(v, litelist_type);
+    PyObject *tmp, *ret;
+    Py_ssize_t i;
+
+    if (!is_litelist && !PyList_Check(v) && !PyTuple_Check(v))
+        return NULL;
+
+    if (is_litelist) {
+        if (item == NULL || item->kind == VALIDATE_ANY) {
+            Py_INCREF(v);
+            return v;
+        }
+        // the items of litelist are checked in place while they aren't changed
+        Py_INCREF(v);
+        for (i = 0; i < Py_SIZE(v); i++) {
+            PyObject *it = ((PyListObject*)v)->ob_item[i];
+            PyObject *nv;
+
+            Py_INCREF(it);
+            nv = validate_value(item, it, field, owner);
+            Py_DECREF(it);
+            if (nv == NULL) {
+                Py_DECREF(v);
+                return NULL;
+            }
+            Py_DECREF(nv);
+            if (nv != it)
+                break;
+        }
+        if (i == Py_SIZE(v))
+            return v;
+        Py_DECREF(v);
+    }
+
+    tmp = PySequence_List(v);
+    if (tmp == NULL)
+        return NULL;
+    if (item != NULL) {
+        for (i = 0; i < PyList_GET_SIZE(tmp); i++) {
+            PyObject *it = PyList_GET_ITEM(tmp, i);
+            PyObject *nv = validate_value(item, it, field, owner);
+
+            if (nv == NULL) {
+                Py_DECREF(tmp);
+                return NULL;
+            }
+            PyList_SET_ITEM(tmp, i, nv);
+            Py_DECREF(it);
+        }
+    }
+    ret = PyObject_CallFunctionObjArgs((PyObject*)litelist_type, tmp, NULL);
+    Py_DECREF(tmp);
+    return ret;
+}
+
+// Return the checked (maybe coerced) value as new reference or NULL with TypeError
+static PyObject *
+validate_value(validate_spec *s, PyObject *v, PyObject *field, PyTypeObject *owner)
+{
+    PyObject *ret = NULL;
+
+    if (s->kind == VALIDATE_ANY || (v == Py_None && s->optional)) {
+        Py_INCREF(v);
+        return v;
+    }
+
+    switch (s->kind) {
+        case VALIDATE_INT:
+            if (PyLong_CheckExact(v) || (PyLong_Check(v) && !PyBool_Check(v))) {
+                Py_INCREF(v);
+                return v;
+            }
+            if (PyFloat_Check(v)) {
+                double d = PyFloat_AS_DOUBLE(v);
+                if (isfinite(d) && d == floor(d))
+                    return PyLong_FromDouble(d);
+            }
+            break;
+        case VALIDATE_FLOAT:
+            if (PyFloat_Check(v)) {
+                Py_INCREF(v);
+                return v;
+            }
+            if (PyLong_Check(v) && !PyBool_Check(v)) {
+                double d = PyLong_AsDouble(v);
+                if (d == -1.0 && PyErr_Occurred())
+                    return NULL;
+                return PyFloat_FromDouble(d);
+            }
+            break;
+        case VALIDATE_STR:
+            if (PyUnicode_Check(v)) {
+                Py_INCREF(v);
+                return v;
+            }
+            break;
+        case VALIDATE_BYTES:
+            if (PyBytes_Check(v)) {
+                Py_INCREF(v);
+                return v;
+            }
+            if (PyByteArray_Check(v))
+                return PyBytes_FromStringAndSize(PyByteArray_AS_STRING(v), PyByteArray_GET_SIZE(v));
+            break;
+        case VALIDATE_BOOL:
+            if (PyBool_Check(v)) {
+                Py_INCREF(v);
+                return v;
+            }
+            break;
+        case VALIDATE_DATAOBJECT:
+            if (PyObject_TypeCheck(v, (PyTypeObject*)s->arg)) {
+                Py_INCREF(v);
+                return v;
+            }
+            // the nested records are created from tuples and dicts
+            if (PyTuple_CheckExact(v))
+                return PyObject_Call(s->arg, v, NULL);
+            if (PyDict_CheckExact(v))
+                return PyObject_Call(s->arg, empty_tuple, v);
+            break;
+        case VALIDATE_INSTANCE: {
+            int r = PyObject_IsInstance(v, s->arg);
+            if (r < 0)
+                return NULL;
+            if (r) {
+                Py_INCREF(v);
+                return v;
+            }
+            break;
+        }
+        case VALIDATE_LITELIST:
+            ret = validate_litelist(s, v, field, owner);
+            if (ret != NULL || PyErr_Occurred())
+                return ret;
+            break;
+    }
+
+    PyErr_Format(PyExc_TypeError, "%s.%U: expected %s, got %s",
+                 owner->tp_name, field, validate_expected(s), Py_TYPE(v)->tp_name);
+    return NULL;
+}
+
+static validator_object *
+dataobject_get_validator(PyTypeObject *type)
+{
+    PyObject *vd = _PyType_Lookup(type, __validator__name);
+
+    if (vd == NULL || Py_TYPE(vd) != &PyValidator_Type) {
+        PyErr_Format(PyExc_TypeError, "%s has no validator", type->tp_name);
+        return NULL;
+    }
+    return (validator_object*)vd;
+}
+
+static int
+dataobject_validate(PyObject *op, validator_object *vd)
+{
+    PyObject **items = PyDataObject_ITEMS(op);
+    Py_ssize_t i, n = PyDataObject_LEN(op);
+
+    if (n > Py_SIZE(vd))
+        n = Py_SIZE(vd);
+    for (i = 0; i < n; i++) {
+        validate_spec *s = vd->specs + i;
+        PyObject *v = items[i], *nv;
+
+        if (s->kind == VALIDATE_ANY || v == NULL)
+            continue;
+        nv = validate_value(s, v, PyTuple_GET_ITEM(vd->names, i), Py_TYPE(op));
+        if (nv == NULL)
+            return -1;
+        if (nv != v) {
+            items[i] = nv;
+            Py_DECREF(v);
+            dataobject_maybe_track(op, nv);
+        } else
+            Py_DECREF(nv);
+    }
+    return 0;
+}
+
+static PyObject *
+dataobject_validate_item(PyObject *op, Py_ssize_t i, PyObject *val)
+{
+    validator_object *vd = dataobject_get_validator(Py_TYPE(op));
+    PyObject *ret;
+
+    if (vd == NULL)
+        return NULL;
+    if (i >= Py_SIZE(vd)) {
+        Py_INCREF(val);
+        return val;
+    }
+    Py_INCREF(vd);
+    ret = validate_value(vd->specs + i, val, PyTuple_GET_ITEM(vd->names, i), Py_TYPE(op));
+    Py_DECREF(vd);
+    return ret;
+}
+
+static int
+dataobject_init_validate(PyObject *op, PyObject *args, PyObject *kwds)
+{
+    validator_object *vd = dataobject_get_validator(Py_TYPE(op));
+    int ret;
+
+    if (vd == NULL)
+        return -1;
+    Py_INCREF(vd);
+    ret = vd->base_init(op, args, kwds);
+    if (ret == 0)
+        ret = dataobject_validate(op, vd);
+    Py_DECREF(vd);
+    return ret;
+}
+
+#if PY_VERSION_HEX >= 0x030A0000
+static PyObject *
+dataobject_vectorcall_validate(PyObject *type, PyObject * const*args,
+                               size_t nargsf, PyObject *kwnames)
+{
+    validator_object *vd = dataobject_get_validator((PyTypeObject*)type);
+    PyObject *op;
+
+    if (vd == NULL)
+        return NULL;
+    Py_INCREF(vd);
+    op = vd->base_vectorcall(type, args, nargsf, kwnames);
+    if (op != NULL && dataobject_validate(op, vd) < 0)
+        Py_CLEAR(op);
+    Py_DECREF(vd);
+    return op;
+}
+#endif
+
+static PyObject *
+validator_from_plan(PyObject *plan, PyObject *names)
+{
+    validator_object *vd;
+    Py_ssize_t i, n;
+
+    if (!PyTuple_Check(plan)) {
+        PyErr_SetString(PyExc_TypeError, "validation plan should be a tuple");
+        return NULL;
+    }
+    n = PyTuple_GET_SIZE(plan);
+
+    vd = PyObject_GC_NewVar(validator_object, &PyValidator_Type, n);
+    if (vd == NULL)
+        return NULL;
+    Py_XINCREF(names);
+    vd->names = names;
+    vd->base_init = NULL;
+#if PY_VERSION_HEX >= 0x030A0000
+    vd->base_vectorcall = NULL;
+#endif
+    for (i = 0; i < n; i++) {
+        vd->specs[i].kind = VALIDATE_ANY;
+        vd->specs[i].optional = 0;
+        vd->specs[i].arg = NULL;
+    }
+
+    for (i = 0; i < n; i++) {
+        PyObject *spec = PyTuple_GET_ITEM(plan, i);
+        PyObject *kind, *arg;
+        validate_spec *s = vd->specs + i;
+        int k, optional;
+
+        if (!PyTuple_Check(spec) || PyTuple_GET_SIZE(spec) != 3) {
+            PyErr_SetString(PyExc_TypeError, "validation spec should be a tuple (kind, optional, arg)");
+            goto error;
+        }
+        kind = PyTuple_GET_ITEM(spec, 0);
+        optional = PyObject_IsTrue(PyTuple_GET_ITEM(spec, 1));
+        arg = PyTuple_GET_ITEM(spec, 2);
+        if (optional < 0)
+            goto error;
+
+        for (k = 0; validate_kind_names[k] != NULL; k++) {
+            if (PyUnicode_Check(kind) && PyUnicode_CompareWithASCIIString(kind, validate_kind_names[k]) == 0)
+                break;
+        }
+        if (validate_kind_names[k] == NULL) {
+            PyErr_Format(PyExc_ValueError, "invalid validation kind: %R", kind);
+            goto error;
+        }
+
+        s->kind = k;
+        s->optional = optional;
+        if (k == VALIDATE_DATAOBJECT || k == VALIDATE_INSTANCE) {
+            if (!PyType_Check(arg)) {
+                PyErr_Format(PyExc_TypeError, "%s validation requires a class", validate_kind_names[k]);
+                goto error;
+            }
+            Py_INCREF(arg);
+            s->arg = arg;
+        }
+        else if (k == VALIDATE_LITELIST) {
+            if (litelist_type == NULL) {
+                litelist_type = (PyTypeObject*)_PyObject_GetObject("recordclass._litelist", "litelist");
+                if (litelist_type == NULL)
+                    goto error;
+            }
+            if (arg != Py_None) {
+                PyObject *item_plan = PyTuple_Pack(1, arg);
+                if (item_plan == NULL)
+                    goto error;
+                s->arg = validator_from_plan(item_plan, NULL);
+                Py_DECREF(item_plan);
+                if (s->arg == NULL)
+                    goto error;
+            }
+        }
+    }
+
+    PyObject_GC_Track(vd);
+    return (PyObject*)vd;
+
+error:
+    Py_DECREF(vd);
+    return NULL;
+}
+
+static int
+validator_traverse(PyObject *o, visitproc visit, void *arg)
+{
+    validator_object *vd = (validator_object*)o;
+    Py_ssize_t i;
+
+    for (i = 0; i < Py_SIZE(vd); i++)
+        Py_VISIT(vd->specs[i].arg);
+    return 0;
+}
+
+static int
+validator_clear(PyObject *o)
+{
+    validator_object *vd = (validator_object*)o;
+    Py_ssize_t i;
+
+    for (i = 0; i < Py_SIZE(vd); i++) {
+        vd->specs[i].kind = VALIDATE_ANY;
+        Py_CLEAR(vd->specs[i].arg);
+    }
+    return 0;
+}
+
+static void
+validator_dealloc(PyObject *o)
+{
+    validator_object *vd = (validator_object*)o;
+
+    PyObject_GC_UnTrack(o);
+    validator_clear(o);
+    Py_CLEAR(vd->names);
+    PyObject_GC_Del(o);
+}
+
+static PyObject *
+validator_repr(PyObject *o)
+{
+    validator_object *vd = (validator_object*)o;
+    PyObject *parts, *sep, *s, *ret;
+    Py_ssize_t i;
+
+    parts = PyList_New(0);
+    if (parts == NULL)
+        return NULL;
+    for (i = 0; i < Py_SIZE(vd); i++) {
+        validate_spec *spec = vd->specs + i;
+
+        if (vd->names)
+            s = PyUnicode_FromFormat("%U: %s%s", PyTuple_GET_ITEM(vd->names, i),
+                                     validate_expected(spec), spec->optional ? " | None" : "");
+        else
+            s = PyUnicode_FromFormat("%s%s", validate_expected(spec), spec->optional ? " | None" : "");
+        if (s == NULL || PyList_Append(parts, s) < 0) {
+            Py_XDECREF(s);
+            Py_DECREF(parts);
+            return NULL;
+        }
+        Py_DECREF(s);
+    }
+    sep = PyUnicode_FromString(", ");
+    if (sep == NULL) {
+        Py_DECREF(parts);
+        return NULL;
+    }
+    s = PyUnicode_Join(sep, parts);
+    Py_DECREF(sep);
+    Py_DECREF(parts);
+    if (s == NULL)
+        return NULL;
+    ret = PyUnicode_FromFormat("validator(%U)", s);
+    Py_DECREF(s);
+    return ret;
+}
+
+static PyTypeObject PyValidator_Type = {
+    PyVarObject_HEAD_INIT(DEFERRED_ADDRESS(&PyType_Type), 0)
+    "recordclass._dataobject.validator", /*tp_name*/
+    sizeof(validator_object) - sizeof(validate_spec), /*tp_basicsize*/
+    sizeof(validate_spec), /*tp_itemsize*/
+    validator_dealloc, /*tp_dealloc*/
+    0, /*tp_print*/
+    0, /*tp_getattr*/
+    0, /*tp_setattr*/
+    0, /*reserved*/
+    validator_repr, /*tp_repr*/
+    0, /*tp_as_number*/
+    0, /*tp_as_sequence*/
+    0, /*tp_as_mapping*/
+    0, /*tp_hash*/
+    0, /*tp_call*/
+    0, /*tp_str*/
+    0, /*tp_getattro*/
+    0, /*tp_setattro*/
+    0, /*tp_as_buffer*/
+    Py_TPFLAGS_DEFAULT|Py_TPFLAGS_HAVE_GC, /*tp_flags*/
+    0, /*tp_doc*/
+    validator_traverse, /*tp_traverse*/
+    validator_clear, /*tp_clear*/
+    0, /*tp_richcompare*/
+    0, /*tp_weaklistoffset*/
+    0, /*tp_iter*/
+    0, /*tp_iternext*/
+    0, /*tp_methods*/
+    0, /*tp_members*/
+    0, /*tp_getset*/
+    0, /*tp_base*/
+    0, /*tp_dict*/
+    0, /*tp_descr_get*/
+    0, /*tp_descr_set*/
+    0, /*tp_dictoffset*/
+    0, /*tp_init*/
+    0, /*tp_alloc*/
+    0, /*tp_new*/
+    0, /*tp_free*/
+    0, /*tp_is_gc*/
+};
+
+///////////////////////// mapping views //////////////////////////////////
+
+static PyTypeObject PyDataObjectKeys_Type;
+static PyTypeObject PyDataObjectValues_Type;
+static PyTypeObject PyDataObjectItems_Type;
+
+// index of the field `key` by the table {name: index} of the mapping type or -1
+static Py_ssize_t
+dataobject_key_index(PyObject *op, PyObject *key)
+{
+    PyObject *index_table, *index;
+
+    index_table = PyDict_GetItemWithError(Py_TYPE(op)->tp_dict, __fields_index__name);
+    if (index_table == NULL)
+        return PyErr_Occurred() ? -2 : -1;
+
+    index = PyDict_GetItemWithError(index_table, key);
+    if (index == NULL)
+        return PyErr_Occurred() ? -2 : -1;
+
+    return PyLong_AsSsize_t(index);
+}
+
+static PyObject *
+dataobjectview_new(PyObject *op, PyTypeObject *tp)
+{
+    dataobjectview_object *v = PyObject_GC_New(dataobjectview_object, tp);
+
+    if (v == NULL)
+        return NULL;
+
+    Py_INCREF(op);
+    v->ob = op;
+    PyObject_GC_Track(v);
+    return (PyObject*)v;
+}
+
+static void
+dataobjectview_dealloc(PyObject *o)
+{
+    dataobjectview_object *v = (dataobjectview_object*)o;
+
+    PyObject_GC_UnTrack(o);
+    Py_CLEAR(v->ob);
+    PyObject_GC_Del(o);
+}
+
+static int
+dataobjectview_traverse(PyObject *o, visitproc visit, void *arg)
+{
+    Py_VISIT(((dataobjectview_object*)o)->ob);
+    return 0;
+}
+
+static Py_ssize_t
+dataobjectview_len(PyObject *o)
+{
+    return PyDataObject_LEN(((dataobjectview_object*)o)->ob);
+}
+
+static PyObject *
+dataobjectview_repr(PyObject *o)
+{
+    PyObject *lst, *ret;
+
+    lst = PySequence_List(o);
+    if (lst == NULL)
+        return NULL;
+    ret = PyUnicode_FromFormat("%s(%R)", _PyType_Name(Py_TYPE(o)), lst);
+    Py_DECREF(lst);
+    return ret;
+}
+
+static PyObject *
+dataobjectkeys_iter(PyObject *o)
+{
+    PyObject *fields, *it;
+
+    fields = PyObject_GetAttr((PyObject*)Py_TYPE(((dataobjectview_object*)o)->ob), __fields__name);
+    if (fields == NULL)
+        return NULL;
+    it = PyObject_GetIter(fields);
+    Py_DECREF(fields);
+    return it;
+}
+
+static int
+dataobjectkeys_contains(PyObject *o, PyObject *key)
+{
+    Py_ssize_t i = dataobject_key_index(((dataobjectview_object*)o)->ob, key);
+
+    if (i == -2)
+        return -1;
+    return i >= 0;
+}
+
+static PyObject *
+dataobjectvalues_iter(PyObject *o)
+{
+    return dataobject_iter(((dataobjectview_object*)o)->ob);
+}
+
+static int
+dataobjectvalues_contains(PyObject *o, PyObject *value)
+{
+    PyObject *op = ((dataobjectview_object*)o)->ob;
+    Py_ssize_t i, n = PyDataObject_LEN(op);
+
+    for (i = 0; i < n; i++) {
+        PyObject *v = PyDataObject_GET_VALUE(op, i);
+        int cmp;
+
+        Py_INCREF(v);
+        cmp = PyObject_RichCompareBool(v, value, Py_EQ);
+        Py_DECREF(v);
+        if (cmp != 0)
+            return cmp;
+    }
+    return 0;
+}
+
+static PyObject *
+dataobjectitems_iter(PyObject *o)
+{
+    PyObject *keys, *values, *it;
+
+    keys = dataobjectkeys_iter(o);
+    if (keys == NULL)
+        return NULL;
+    values = dataobjectvalues_iter(o);
+    if (values == NULL) {
+        Py_DECREF(keys);
+        return NULL;
+    }
+    it = PyObject_CallFunctionObjArgs((PyObject*)&PyZip_Type, keys, values, NULL);
+    Py_DECREF(keys);
+    Py_DECREF(values);
+    return it;
+}
+
+static int
+dataobjectitems_contains(PyObject *o, PyObject *item)
+{
+    PyObject *op = ((dataobjectview_object*)o)->ob;
+    PyObject *v;
+    Py_ssize_t i;
+    int cmp;
+
+    if (!PyTuple_Check(item) || PyTuple_GET_SIZE(item) != 2)
+        return 0;
+
+    i = dataobject_key_index(op, PyTuple_GET_ITEM(item, 0));
+    if (i == -2)
+        return -1;
+    if (i < 0)
+        return 0;
+
+    v = PyDataObject_GET_VALUE(op, i);
+    Py_INCREF(v);
+    cmp = PyObject_RichCompareBool(v, PyTuple_GET_ITEM(item, 1), Py_EQ);
+    Py_DECREF(v);
+    return cmp;
+}
+
+// keys and items views are set-like as the views of dict
+
+static int
+dataobjectview_is_setlike(PyObject *o)
+{
+    return PyAnySet_Check(o) ||
+           PyObject_TypeCheck(o, &PyDataObjectKeys_Type) ||
+           PyObject_TypeCheck(o, &PyDataObjectItems_Type) ||
+           PyObject_TypeCheck(o, &PyDictKeys_Type) ||
+           PyObject_TypeCheck(o, &PyDictItems_Type);
+}
+
+// 1 if all items of `self` are contained in `other`
+static int
+dataobjectview_contained_in(PyObject *self, PyObject *other)
+{
+    PyObject *it, *item;
+    int ok = 1;
+
+    it = PyObject_GetIter(self);
+    if (it == NULL)
+        return -1;
+    while ((item = PyIter_Next(it))) {
+        ok = PySequence_Contains(other, item);
+        Py_DECREF(item);
+        if (ok <= 0)
+            break;
+    }
+    Py_DECREF(it);
+    if (PyErr_Occurred())
+        return -1;
+    return ok;
+}
+
+static PyObject *
+dataobjectview_richcompare(PyObject *self, PyObject *other, int op)
+{
+    Py_ssize_t len_self, len_other;
+    int ok;
+
+    if (!dataobjectview_is_setlike(other))
+        Py_RETURN_NOTIMPLEMENTED;
+
+    len_self = PyObject_Size(self);
+    if (len_self < 0)
+        return NULL;
+    len_other = PyObject_Size(other);
+    if (len_other < 0)
+        return NULL;
+
+    switch (op) {
+    case Py_EQ:
+    case Py_NE:
+        ok = len_self == len_other;
+        if (ok)
+            ok = dataobjectview_contained_in(self, other);
+        if (ok < 0)
+            return NULL;
+        return PyBool_FromLong(op == Py_EQ ? ok : !ok);
+    case Py_LT:
+        ok = len_self < len_other;
+        if (ok)
+            ok = dataobjectview_contained_in(self, other);
+        break;
+    case Py_LE:
+        ok = len_self <= len_other;
+        if (ok)
+            ok = dataobjectview_contained_in(self, other);
+        break;
+    case Py_GT:
+        ok = len_self > len_other;
+        if (ok)
+            ok = dataobjectview_contained_in(other, self);
+        break;
+    case Py_GE:
+        ok = len_self >= len_other;
+        if (ok)
+            ok = dataobjectview_contained_in(other, self);
+        break;
+    default:
+        Py_RETURN_NOTIMPLEMENTED;
+    }
+    if (ok < 0)
+        return NULL;
+    return PyBool_FromLong(ok);
+}
+
+// set(left).<method>(right)
+static PyObject *
+dataobjectview_setop(PyObject *left, PyObject *right, const char *method)
+{
+    PyObject *result, *tmp;
+
+    result = PySet_New(left);
+    if (result == NULL)
+        return NULL;
+    tmp = PyObject_CallMethod(result, method, "O", right);
+    if (tmp == NULL) {
+        Py_DECREF(result);
+        return NULL;
+    }
+    Py_DECREF(tmp);
+    return result;
+}
+
+static PyObject *
+dataobjectview_sub(PyObject *left, PyObject *right)
+{
+    return dataobjectview_setop(left, right, "difference_update");
+}
+
+static PyObject *
+dataobjectview_and(PyObject *left, PyObject *right)
+{
+    return dataobjectview_setop(left, right, "intersection_update");
+}
+
+static PyObject *
+dataobjectview_or(PyObject *left, PyObject *right)
+{
+    return dataobjectview_setop(left, right, "update");
+}
+
+static PyObject *
+dataobjectview_xor(PyObject *left, PyObject *right)
+{
+    return dataobjectview_setop(left, right, "symmetric_difference_update");
+}
+
+static PyObject *
+dataobjectview_isdisjoint(PyObject *self, PyObject *other)
+{
+    PyObject *it, *item;
+
+    it = PyObject_GetIter(other);
+    if (it == NULL)
+        return NULL;
+    while ((item = PyIter_Next(it))) {
+        int contains = PySequence_Contains(self, item);
+
+        Py_DECREF(item);
+        if (contains < 0) {
+            Py_DECREF(it);
+            return NULL;
+        }
+        if (contains) {
+            Py_DECREF(it);
+            Py_RETURN_FALSE;
+        }
+    }
+    Py_DECREF(it);
+    if (PyErr_Occurred())
+        return NULL;
+    Py_RETURN_TRUE;
+}
+
+static PyNumberMethods dataobjectview_as_number = {
+    0,                                  /*nb_add*/
+    (binaryfunc)dataobjectview_sub,     /*nb_subtract*/
+    0,                                  /*nb_multiply*/
+    0,                                  /*nb_remainder*/
+    0,                                  /*nb_divmod*/
+    0,                                  /*nb_power*/
+    0,                                  /*nb_negative*/
+    0,                                  /*nb_positive*/
+    0,                                  /*nb_absolute*/
+    0,                                  /*nb_bool*/
+    0,                                  /*nb_invert*/
+    0,                                  /*nb_lshift*/
+    0,                                  /*nb_rshift*/
+    (binaryfunc)dataobjectview_and,     /*nb_and*/
+    (binaryfunc)dataobjectview_xor,     /*nb_xor*/
+    (binaryfunc)dataobjectview_or,      /*nb_or*/
+};
+
+static PyMethodDef dataobjectview_setlike_methods[] = {
+    {"isdisjoint", (PyCFunction)dataobjectview_isdisjoint, METH_O,
+     "Return True if the view and the given iterable have a null intersection."},
+    {0, 0, 0, 0}
+};
+
+static PySequenceMethods dataobjectkeys_as_sequence = {
+    dataobjectview_len,                 /* sq_length */
+    0,                                  /* sq_concat */
+    0,                                  /* sq_repeat */
+    0,                                  /* sq_item */
+    0,                                  /* sq_slice */
+    0,                                  /* sq_ass_item */
+    0,                                  /* sq_ass_slice */
+    dataobjectkeys_contains,            /* sq_contains */
+};
+
+static PySequenceMethods dataobjectvalues_as_sequence = {
+    dataobjectview_len,                 /* sq_length */
+    0,                                  /* sq_concat */
+    0,                                  /* sq_repeat */
+    0,                                  /* sq_item */
+    0,                                  /* sq_slice */
+    0,                                  /* sq_ass_item */
+    0,                                  /* sq_ass_slice */
+    dataobjectvalues_contains,          /* sq_contains */
+};
+
+static PySequenceMethods dataobjectitems_as_sequence = {
+    dataobjectview_len,                 /* sq_length */
+    0,                                  /* sq_concat */
+    0,                                  /* sq_repeat */
+    0,                                  /* sq_item */
+    0,                                  /* sq_slice */
+    0,                                  /* sq_ass_item */
+    0,                                  /* sq_ass_slice */
+    dataobjectitems_contains,           /* sq_contains */
+};
+
+#define DATAOBJECTVIEW_TYPE(name, as_number, as_sequence, richcompare, iter, methods) { \
+    PyVarObject_HEAD_INIT(DEFERRED_ADDRESS(&PyType_Type), 0) \
+    name, /*tp_name*/ \
+    sizeof(dataobjectview_object), /*tp_basicsize*/ \
+    0, /*tp_itemsize*/ \
+    dataobjectview_dealloc, /*tp_dealloc*/ \
+    0, /*tp_print*/ \
+    0, /*tp_getattr*/ \
+    0, /*tp_setattr*/ \
+    0, /*reserved*/ \
+    dataobjectview_repr, /*tp_repr*/ \
+    as_number, /*tp_as_number*/ \
+    as_sequence, /*tp_as_sequence*/ \
+    0, /*tp_as_mapping*/ \
+    0, /*tp_hash*/ \
+    0, /*tp_call*/ \
+    0, /*tp_str*/ \
+    0, /*tp_getattro*/ \
+    0, /*tp_setattro*/ \
+    0, /*tp_as_buffer*/ \
+    Py_TPFLAGS_DEFAULT|Py_TPFLAGS_HAVE_GC, /*tp_flags*/ \
+    0, /*tp_doc*/ \
+    dataobjectview_traverse, /*tp_traverse*/ \
+    0, /*tp_clear*/ \
+    richcompare, /*tp_richcompare*/ \
+    0, /*tp_weaklistoffset*/ \
+    iter, /*tp_iter*/ \
+    0, /*tp_iternext*/ \
+    methods, /*tp_methods*/ \
+}
+
+static PyTypeObject PyDataObjectKeys_Type =
+    DATAOBJECTVIEW_TYPE("recordclass._dataobject.dataobject_keys", &dataobjectview_as_number,
+                        &dataobjectkeys_as_sequence, dataobjectview_richcompare,
+                        dataobjectkeys_iter, dataobjectview_setlike_methods);
+static PyTypeObject PyDataObjectValues_Type =
+    DATAOBJECTVIEW_TYPE("recordclass._dataobject.dataobject_values", 0,
+                        &dataobjectvalues_as_sequence, 0,
+                        dataobjectvalues_iter, 0);
+static PyTypeObject PyDataObjectItems_Type =
+    DATAOBJECTVIEW_TYPE("recordclass._dataobject.dataobject_items", &dataobjectview_as_number,
+                        &dataobjectitems_as_sequence, dataobjectview_richcompare,
+                        dataobjectitems_iter, dataobjectview_setlike_methods);
+
+static PyObject *
+dataobject_keys(PyObject *op, PyObject *Py_UNUSED(ignored))
+{
+    return dataobjectview_new(op, &PyDataObjectKeys_Type);
+}
+
+static PyObject *
+dataobject_values(PyObject *op, PyObject *Py_UNUSED(ignored))
+{
+    return dataobjectview_new(op, &PyDataObjectValues_Type);
+}
+
+static PyObject *
+dataobject_items(PyObject *op, PyObject *Py_UNUSED(ignored))
+{
+    return dataobjectview_new(op, &PyDataObjectItems_Type);
+}
+
+static PyObject *
+dataobject_get_value(PyObject *op, PyObject *key, PyObject *deflt)
+{
+    PyObject *v;
+    Py_ssize_t i = dataobject_key_index(op, key);
+
+    if (i == -2)
+        return NULL;
+
+    if (i >= 0)
+        v = PyDataObject_GET_VALUE(op, i);
+    else {
+        PyTypeObject *type = Py_TYPE(op);
+
+        v = NULL;
+        if (type->tp_dictoffset) {
+            PyObject *dict = *PyDataObject_DICTPTR(type, op);
+            if (dict) {
+                v = PyDict_GetItemWithError(dict, key);
+                if (v == NULL && PyErr_Occurred())
+                    return NULL;
+            }
+        }
+        if (v == NULL)
+            v = deflt;
+    }
+
+    Py_INCREF(v);
+    return v;
+}
+
+#if PY_VERSION_HEX >= 0x03070000
+static PyObject *
+dataobject_get(PyObject *op, PyObject *const *args, Py_ssize_t nargs)
+{
+    if (nargs < 1 || nargs > 2) {
+        PyErr_SetString(PyExc_TypeError, "get expected 1 or 2 arguments");
+        return NULL;
+    }
+
+    return dataobject_get_value(op, args[0], nargs == 2 ? args[1] : Py_None);
+}
+#else
+static PyObject *
+dataobject_get(PyObject *op, PyObject *args)
+{
+    PyObject *key, *deflt = Py_None;
+
+    if (!PyArg_UnpackTuple(args, "get", 1, 2, &key, &deflt))
+        return NULL;
+
+    return dataobject_get_value(op, key, deflt);
+}
+#endif
+
+static int
+dataobject_mapping_contains(PyObject *op, PyObject *key)
+{
+    Py_ssize_t i = dataobject_key_index(op, key);
+
+    if (i == -2)
+        return -1;
+    return i >= 0;
+}
+
+static PyMethodDef dataobject_mapping_methods[] = {
+    {"keys",   (PyCFunction)dataobject_keys, METH_NOARGS, "D.keys() -> a set-like object providing a view on D's keys"},
+    {"values", (PyCFunction)dataobject_values, METH_NOARGS, "D.values() -> an object providing a view on D's values"},
+    {"items",  (PyCFunction)dataobject_items, METH_NOARGS, "D.items() -> a set-like object providing a view on D's items"},
+#if PY_VERSION_HEX >= 0x03070000
+    {"get",    (PyCFunction)(void(*)(void))dataobject_get, METH_FASTCALL, "D.get(k[,d]) -> D[k] if k in D, else d.  d defaults to None."},
+#else
+    {"get",    (PyCFunction)dataobject_get, METH_VARARGS, "D.get(k[,d]) -> D[k] if k in D, else d.  d defaults to None."},
+#endif
+    {0, 0, 0, 0}
+};
+
+//////////////////// datatype ////////////////////////////////////////////
+
+// static int _get_bool_value(PyObject *options, const char *name) {
+//         PyObject* b;
+
+//         b = PyMapping_GetItemString(options, name);
+//         if (b && PyObject_IsTrue(b))
+//             return 1;
+//         else
+//             return 0;
+// }
+
+
+
+//////////////////// module level functions //////////////////////////////
+
+
+
+PyDoc_STRVAR(_dataobject_type_init_doc,
+"Initialize dataobject subclass");
+
+static PyObject*
+_dataobject_type_init(PyObject *module, PyObject *args) {
+    PyObject *cls;
+
+    PyTypeObject *tp;
+    PyTypeObject *tp_base;
+    // int __init__, __new__;
+    PyObject *fields, *dict;
+    Py_ssize_t n_fields;
+
+    if (Py_SIZE(args) != 1) {
+        PyErr_SetString(PyExc_TypeError, "number of arguments != 1");
+        return NULL;
+    }
+
+    cls = PyTuple_GET_ITEM(args, 0);
+    tp = (PyTypeObject*)cls;
+    tp_base = tp->tp_base;
+
+    if ((tp_base != &PyDataObject_Type && !PyType_IsSubtype(tp_base, &PyDataObject_Type)) &&
+         (tp_base != &PyDataStruct_Type && !PyType_IsSubtype(tp_base, &PyDataStruct_Type))) {
+        PyErr_Format(PyExc_TypeError,
+                        "common base class %s should be subclass of dataobject or datastruct", tp_base->tp_name);
+        return NULL;
+    }
+
+    dict = tp->tp_dict;
+
+    fields = PyMapping_GetItemString(dict, "__fields__");
+    if (!fields){
+        PyErr_SetString(PyExc_TypeError, "__fields__ is missing");
+        return NULL;
+    }
+
+    if (PyTuple_Check(fields)) {
+        n_fields = PyTuple_GET_SIZE(fields);
+    } else {
+        n_fields = PyNumber_AsSsize_t(fields, PyExc_IndexError);
+        if (n_fields == -1 && PyErr_Occurred()) {
+            Py_DECREF(fields);
+            return NULL;
+        }
+        if (n_fields < 0) {
+            PyErr_SetString(PyExc_TypeError, "number of fields should not be negative");
+            return NULL;
+        }
+    }
+
+    Py_DECREF(fields);
+
+    #if PY_VERSION_HEX >= 0x030B0000
+            tp->tp_flags &= ~Py_TPFLAGS_MANAGED_DICT;
+    #endif
+
+    #if PY_VERSION_HEX >= 0x030C0000
             tp->tp_flags &= ~Py_TPFLAGS_MANAGED_WEAKREF;
             tp->tp_flags &= ~Py_TPFLAGS_PREHEADER;
     #endif
 
 
-    tp->tp_basicsize = sizeof(PyObject) + n_fields * sizeof(PyObject*);
-    tp->tp_itemsize = n_fields;
+    tp->tp_basicsize = sizeof(PyObject) + n_fields * sizeof(PyObject*);
+    tp->tp_itemsize = n_fields;
+
+    if (tp_base == &PyDataStruct_Type) {
+        tp->tp_dictoffset = 0;
+        tp->tp_weaklistoffset = 0;
+        tp->tp_flags &= ~Py_TPFLAGS_BASETYPE;
+    }
+    else {
+        tp->tp_dictoffset = tp_base->tp_dictoffset;
+        tp->tp_weaklistoffset = tp_base->tp_weaklistoffset;        
+    }
+
+
+// #if PY_VERSION_HEX >= 0x030A0000
+//         tp->tp_flags &= ~Py_TPFLAGS_IMMUTABLETYPE;
+// #endif
+
+    tp->tp_alloc = dataobject_alloc;
+
+    tp->tp_dealloc = dataobject_dealloc;
+    tp->tp_free = PyObject_Del;
+
+    tp->tp_flags |= Py_TPFLAGS_HEAPTYPE;
+
+    if (tp->tp_flags & Py_TPFLAGS_HAVE_GC)
+        tp->tp_flags &= ~Py_TPFLAGS_HAVE_GC;
+
+
+    if (tp_base->tp_hash)
+        tp->tp_hash = tp_base->tp_hash;
+
+    if (tp_base->tp_iter)
+        tp->tp_iter = tp_base->tp_iter;
+
+    tp->tp_traverse = NULL;
+    tp->tp_clear = NULL;
+    tp->tp_is_gc = NULL;
+
+// #if PY_VERSION_HEX >= 0x030A0000
+//     tp->tp_flags |= Py_TPFLAGS_HAVE_VECTORCALL|Py_TPFLAGS_IMMUTABLETYPE;
+//     tp->tp_vectorcall_offset = offsetof(PyTypeObject, tp_vectorcall);
+//     tp->tp_vectorcall = dataobject_vectorcall;
+// #endif
+
+    PyType_Modified(tp);
+
+    Py_RETURN_NONE;
+}
+
+static PyObject*
+_collection_protocol(PyObject *cls, PyObject *sequence, PyObject *mapping, PyObject *readonly) {
+    PyTypeObject *tp = (PyTypeObject*)cls;
+
+    int sq = PyObject_IsTrue(sequence);
+    int mp = PyObject_IsTrue(mapping);
+    int ro = PyObject_IsTrue(readonly);
+
+    PyTypeObject *tp_base = tp->tp_base;
+
+    // if ((tp_base != &PyDataObject_Type) && !PyType_IsSubtype(tp_base, &PyDataObject_Type)) {
+    //     PyErr_SetString(PyExc_TypeError, "the type should be dataobject or it's subtype");
+    //     return NULL;
+    // }
+
+    copy_mapping_methods(tp->tp_as_mapping, tp_base->tp_as_mapping);
+    copy_sequence_methods(tp->tp_as_sequence, tp_base->tp_as_sequence);
+
+    if (!mp && sq) {
+        if (ro) {
+            copy_sequence_methods(tp->tp_as_sequence, &dataobject_as_sequence_ro);
+            copy_mapping_methods(tp->tp_as_mapping, &dataobject_as_mapping_sq_ro);
+        } else {
+            copy_sequence_methods(tp->tp_as_sequence, &dataobject_as_sequence);
+            copy_mapping_methods(tp->tp_as_mapping, &dataobject_as_mapping_sq);
+        }
+#if PY_VERSION_HEX >= 0x030A0000
+        tp->tp_flags &= ~Py_TPFLAGS_SEQUENCE;
+#endif
+    }
+
+    if (mp && !sq) {
+        if (ro) {
+            copy_mapping_methods(tp->tp_as_mapping, &dataobject_as_mapping_ro);
+        } else {
+            copy_mapping_methods(tp->tp_as_mapping, &dataobject_as_mapping);
+        }
+#if PY_VERSION_HEX >= 0x030A0000
+        tp->tp_flags &= ~Py_TPFLAGS_MAPPING;
+#endif
+    }
+
+    if (mp && sq) {
+        if (ro) {
+            copy_mapping_methods(tp->tp_as_mapping, &dataobject_as_mapping2_ro);
+        } else {
+            copy_mapping_methods(tp->tp_as_mapping, &dataobject_as_mapping2);
+        }
+// #if PY_VERSION_HEX >= 0x030A0000
+//         tp->tp_flags &= ~Py_TPFLAGS_SEQUENCE;
+//         tp->tp_flags &= ~Py_TPFLAGS_MAPPING;
+// #endif
+    }
+
+//     if (mo) {
+//         if (ro) {
+//             copy_mapping_methods(tp->tp_as_mapping, &dataobject_as_mapping_ro);
+//         } else {
+//             copy_mapping_methods(tp->tp_as_mapping, &dataobject_as_mapping);
+//         }
+// #if PY_VERSION_HEX >= 0x030A0000
+//         tp->tp_flags &= ~Py_TPFLAGS_MAPPING;
+// #endif
+//     }
+
+    Py_RETURN_NONE;
+}
+
+PyDoc_STRVAR(_datatype_collection_mapping_doc,
+"");
+
+static PyObject *
+_datatype_collection_mapping(PyObject *module, PyObject *args) //, PyObject *kw)
+{
+    PyObject *cls, *sequence, *mapping, *readonly;
+
+    cls = PyTuple_GET_ITEM(args, 0);
+    sequence = PyTuple_GET_ITEM(args, 1);
+    mapping = PyTuple_GET_ITEM(args, 2);
+    readonly = PyTuple_GET_ITEM(args, 3);
+
+    return _collection_protocol(cls, sequence, mapping, readonly);
+}
+
+PyDoc_STRVAR(_datatype_from_basetype_hashable_doc,
+"");
+
+static PyObject*
+_datatype_from_basetype_hashable(PyObject *module, PyObject *cls) {
+    PyTypeObject *tp = (PyTypeObject*)cls;
+
+    PyObject *bases = tp->tp_bases;
+    Py_ssize_t i, n_bases = Py_SIZE(bases);
+    for (i=0; i<n_bases; i++) {
+        PyTypeObject *base = (PyTypeObject*)PyTuple_GetItem(bases, i);
+        if (base->tp_hash) {
+                tp->tp_hash = base->tp_hash;
+                Py_INCREF(Py_True);
+                return Py_True;
+        }
+    }
+    Py_INCREF(Py_False);
+    return Py_False;
+}
+
+PyDoc_STRVAR(_datatype_hashable_doc,
+"");
+
+static PyObject*
+_datatype_hashable(PyObject *module, PyObject *cls) {
+    PyTypeObject *tp = (PyTypeObject*)cls;
+
+    tp->tp_hash = dataobject_hash;
+    Py_RETURN_NONE;
+}
+
+
+PyDoc_STRVAR(_datatype_from_basetype_iterable_doc,
+"");
+
+static PyObject*
+_datatype_from_basetype_iterable(PyObject *module, PyObject *cls) {
+    PyTypeObject *tp = (PyTypeObject*)cls;
+
+    PyObject *bases = tp->tp_bases;
+    Py_ssize_t i, n_bases = Py_SIZE(bases);
+    for (i=0; i<n_bases; i++) {
+        PyTypeObject *base = (PyTypeObject*)PyTuple_GetItem(bases, i);
+        if (base->tp_iter) {
+            if (base->tp_iter == dataobject_iter) {
+                tp->tp_iter = base->tp_iter;
+                Py_INCREF(Py_True);
+                return Py_True;
+            }
+        }
+    }
+    Py_INCREF(Py_False);
+    return Py_False;
+}
+
+
+PyDoc_STRVAR(_datatype_iterable_doc,
+"");
+
+static PyObject*
+_datatype_iterable(PyObject *module, PyObject *cls) {
+    PyTypeObject *tp = (PyTypeObject*)cls;
+
+    tp->tp_iter = dataobject_iter;
+
+    Py_RETURN_NONE;
+}
+
+
+PyDoc_STRVAR(_datatype_use_dict_doc,
+"");
+
+static PyObject*
+_datatype_use_dict(PyObject *module, PyObject *cls) {
+    PyTypeObject *tp = (PyTypeObject*)cls;
+
+    // if (!PyObject_IsInstance(cls, (PyObject*)&PyType_Type)) {
+    //     PyErr_SetString(PyExc_TypeError, "argument is not a subtype of the type");
+    //     return NULL;
+    // }
+
+    if (!tp->tp_dictoffset) {
+        if (!tp->tp_weaklistoffset) {
+            tp->tp_dictoffset = tp->tp_basicsize;
+            tp->tp_basicsize += sizeof(PyObject*);
+        } else {
+            tp->tp_dictoffset = tp->tp_basicsize - sizeof(PyObject*);
+            tp->tp_weaklistoffset = tp->tp_basicsize;
+            tp->tp_basicsize += sizeof(PyObject*);
+        }
+    }
+
+    Py_RETURN_NONE;
+}
+
+PyDoc_STRVAR(_datatype_use_weakref_doc,
+"");
+
+static PyObject*
+_datatype_use_weakref(PyObject *module, PyObject *cls) {
+    PyTypeObject *tp = (PyTypeObject*)cls;
+    // if (!PyObject_IsInstance(cls, (PyObject*)&PyType_Type)) {
+    //     PyErr_SetString(PyExc_TypeError, "argument is not a subtype of the type");
+    //     return NULL;
+    // }
+
+    if (!tp->tp_weaklistoffset) {
+        if (!tp->tp_dictoffset) {
+            tp->tp_weaklistoffset = tp->tp_basicsize;
+            tp->tp_basicsize += sizeof(PyObject*);
+        } else {
+            tp->tp_weaklistoffset = tp->tp_basicsize;
+            tp->tp_basicsize += sizeof(PyObject*);
+        }
+    }
+
+    Py_RETURN_NONE;
+}
+
+// all assignments of the fields of the instances can track them again
+static int
+dataobject_stores_tracked(PyTypeObject *type)
+{
+    PyObject *fields;
+    Py_ssize_t i, n;
+
+    if (type->tp_dictoffset || type->tp_setattro != PyObject_GenericSetAttr)
+        return 0;
+    if (PyDict_GetItem(type->tp_dict, __inline__name))
+        return 0;
+
+    fields = PyDict_GetItem(type->tp_dict, __fields__name);
+    if (fields == NULL || !PyTuple_Check(fields))
+        return 0;
+
+    n = PyTuple_GET_SIZE(fields);
+    for (i = 0; i < n; i++) {
+        PyObject *d = _PyType_Lookup(type, PyTuple_GET_ITEM(fields, i));
+
+        if (d == NULL)
+            return 0;
+        if (Py_TYPE(d) == &PyMemberDescr_Type) {
+            if (!(((PyMemberDescrObject*)d)->d_member->flags & READONLY))
+                return 0;
+        }
+        else if (Py_TYPE(d) != &PyDataObjectProperty_Type)
+            return 0;
+    }
+    return 1;
+}
+
+PyDoc_STRVAR(_datatype_enable_gc_doc,
+"");
+
+static PyObject *
+_datatype_enable_gc(PyObject *module, PyObject *cls)
+{
+    PyTypeObject *type = (PyTypeObject*)cls;
+
+    // if (!PyObject_IsInstance(cls, (PyObject*)&PyType_Type)) {
+    //     PyErr_SetString(PyExc_TypeError, "Argument have to be an instance of type");
+    //     return NULL;
+    // }
+
+    type->tp_flags |= Py_TPFLAGS_HAVE_GC;
+    type->tp_traverse = dataobject_traverse;
+    type->tp_clear = dataobject_clear;
+
+    type->tp_dealloc = dataobject_dealloc_gc;
+    type->tp_alloc = dataobject_alloc_gc;
+    type->tp_free = PyObject_GC_Del;
+
+    if (dataobject_stores_tracked(type)) {
+        dataobjecttypeinfo_object *info = dataobject_typeinfo(type);
+
+        if (info == NULL)
+            return NULL;
+        info->flags |= DATAOBJECT_F_MAY_UNTRACK;
+    }
+
+    // PyType_Modified(type);
+
+    Py_RETURN_NONE;
+}
+
+PyDoc_STRVAR(_datatype_deep_dealloc_doc,
+"");
+
+static PyObject *
+_datatype_deep_dealloc(PyObject *module, PyObject *cls)
+{
+    PyTypeObject *type = (PyTypeObject*)cls;
+    int have_gc;
+
+    // if (!PyObject_IsInstance(cls, (PyObject*)&PyType_Type)) {
+    //     PyErr_SetString(PyExc_TypeError, "Argument have to be an instance of a type");
+    //     return NULL;
+    // }
+
+    have_gc = type->tp_flags & Py_TPFLAGS_HAVE_GC;
+
+    if (!have_gc) {
+        type->tp_finalize = dataobject_finalize;
+    }
+
+    Py_RETURN_NONE;
+}
+
+PyDoc_STRVAR(_datatype_vectorcall_doc,
+"Set the constructors of the class; the vectorcall one is specialized by the number of fields");
+
+static PyObject *
+_datatype_vectorcall(PyObject *module, PyObject *cls)
+{
+    PyTypeObject *tp = (PyTypeObject *)cls;
+
+    tp->tp_new = dataobject_new_basic;
+    tp->tp_init = dataobject_init_basic;
+
+#if PY_VERSION_HEX >= 0x030A0000
+    Py_ssize_t n_items = PyDataObject_NUMITEMS(tp);
+
+    tp->tp_vectorcall_offset = offsetof(PyTypeObject, tp_vectorcall);
+    if (n_items > 0 && n_items <= DATAOBJECT_VECTORCALL_MAXARITY)
+        tp->tp_vectorcall = dataobject_vectorcall_arity[n_items];
+    else
+        tp->tp_vectorcall = dataobject_vectorcall;
+    tp->tp_flags |= Py_TPFLAGS_HAVE_VECTORCALL;
+    // tp->tp_flags |= Py_TPFLAGS_IMMUTABLETYPE;
+    // printf("vc\n");
+#endif
+
+    Py_RETURN_NONE;
+}
+
+
+PyDoc_STRVAR(_datatype_validate_doc,
+"Install the validator compiled from the plan ((kind, optional, arg) for every field)");
+
+static PyObject *
+_datatype_validate(PyObject *module, PyObject *args)
+{
+    PyTypeObject *tp;
+    PyObject *plan, *names;
+    validator_object *vd;
+
+    if (!PyArg_ParseTuple(args, "O!O!:_datatype_validate", &PyType_Type, &tp, &PyTuple_Type, &plan))
+        return NULL;
+
+    names = PyDict_GetItemWithError(tp->tp_dict, __fields__name);
+    if (names == NULL || !PyTuple_Check(names)) {
+        if (!PyErr_Occurred())
+            PyErr_SetString(PyExc_TypeError, "validate=True requires named fields");
+        return NULL;
+    }
+    if (PyTuple_GET_SIZE(plan) != PyTuple_GET_SIZE(names) ||
+            PyTuple_GET_SIZE(plan) != PyDataObject_NUMITEMS(tp)) {
+        PyErr_SetString(PyExc_ValueError, "the validation plan doesn't match the fields");
+        return NULL;
+    }
+
+    vd = (validator_object*)validator_from_plan(plan, names);
+    if (vd == NULL)
+        return NULL;
+
+    // the wrappers inherited from the base are replaced by the base's original constructors
+    if (tp->tp_init == dataobject_init_validate) {
+        validator_object *base = dataobject_get_validator(tp->tp_base);
+        if (base == NULL) {
+            Py_DECREF(vd);
+            return NULL;
+        }
+        vd->base_init = base->base_init;
+    } else
+        vd->base_init = tp->tp_init;
+#if PY_VERSION_HEX >= 0x030A0000
+    if (tp->tp_vectorcall == dataobject_vectorcall_validate) {
+        validator_object *base = dataobject_get_validator(tp->tp_base);
+        if (base == NULL) {
+            Py_DECREF(vd);
+            return NULL;
+        }
+        vd->base_vectorcall = base->base_vectorcall;
+    } else
+        vd->base_vectorcall = tp->tp_vectorcall;
+#endif
+
+    if (PyDict_SetItem(tp->tp_dict, __validator__name, (PyObject*)vd) < 0) {
+        Py_DECREF(vd);
+        return NULL;
+    }
+
+    tp->tp_init = dataobject_init_validate;
+#if PY_VERSION_HEX >= 0x030A0000
+    if (vd->base_vectorcall != NULL)
+        tp->tp_vectorcall = dataobject_vectorcall_validate;
+#endif
+    Py_DECREF(vd);
+
+    Py_RETURN_NONE;
+}
+
+PyDoc_STRVAR(_datatype_categorical_doc,
+"");
+
+static PyObject *
+_datatype_categorical(PyObject *module, PyObject *cls)
+{
+    PyTypeObject *tp = (PyTypeObject*)cls;
+    PyObject *indices, *table;
+    dataobjecttypeinfo_object *info;
+    Py_ssize_t k, n, n_items = PyDataObject_NUMITEMS(tp);
+
+    indices = PyDict_GetItem(tp->tp_dict, __categorical_fields__name);
+    table = PyDict_GetItem(tp->tp_dict, __categorical_table__name);
+    if (!indices || !table) {
+        PyErr_SetString(PyExc_TypeError, "__categorical_fields__ or __categorical_table__ is missing");
+        return NULL;
+    }
+    if (!PyTuple_Check(indices)) {
+        PyErr_SetString(PyExc_TypeError, "__categorical_fields__ should be a tuple");
+        return NULL;
+    }
+    if (!PyDict_CheckExact(table)) {
+        PyErr_SetString(PyExc_TypeError, "__categorical_table__ should be a dict");
+        return NULL;
+    }
+
+    info = dataobject_typeinfo(tp);
+    if (info == NULL)
+        return NULL;
+    if (info->categorical_table) {
+        PyErr_SetString(PyExc_TypeError, "categorical fields of the class are already initialized");
+        return NULL;
+    }
+
+    // the indexes of the categorical fields for the construction and
+    // their bitmap for the item assignment
+    n = PyTuple_GET_SIZE(indices);
+    info->categorical_fields = PyMem_Malloc((n ? n : 1) * sizeof(Py_ssize_t));
+    info->categorical_mask = PyMem_Calloc((n_items + 7) / 8 + 1, 1);
+    if (info->categorical_fields == NULL || info->categorical_mask == NULL) {
+        PyErr_NoMemory();
+        return NULL;
+    }
+    for (k = 0; k < n; k++) {
+        Py_ssize_t i = PyLong_AsSsize_t(PyTuple_GET_ITEM(indices, k));
+
+        if (i == -1 && PyErr_Occurred())
+            return NULL;
+        if (i < 0 || i >= n_items) {
+            PyErr_Format(PyExc_IndexError, "index %zd of the categorical field out of range", i);
+            return NULL;
+        }
+        info->categorical_fields[k] = i;
+        info->categorical_mask[i >> 3] |= (unsigned char)(1 << (i & 7));
+    }
+    info->n_categorical = n;
+    Py_INCREF(table);
+    info->categorical_table = table;
+
+#if PY_VERSION_HEX >= 0x030A0000
+    if (dataobject_is_vectorcall(tp->tp_vectorcall))
+        tp->tp_vectorcall = dataobject_vectorcall_categorical;
+#endif
+    if (tp->tp_new == dataobject_new_basic)
+        tp->tp_new = dataobject_new_basic_categorical;
+    if (tp->tp_init == dataobject_init)
+        tp->tp_init = dataobject_init_categorical;
+    if (tp->tp_as_sequence->sq_ass_item == dataobject_sq_ass_item)
+        tp->tp_as_sequence->sq_ass_item = dataobject_sq_ass_item_categorical;
+    if (tp->tp_as_mapping->mp_ass_subscript == dataobject_mp_ass_subscript2)
+        tp->tp_as_mapping->mp_ass_subscript = dataobject_mp_ass_subscript2_categorical;
+    if (tp->tp_as_mapping->mp_ass_subscript == dataobject_mp_ass_subscript_sq)
+        tp->tp_as_mapping->mp_ass_subscript = dataobject_mp_ass_subscript_sq_categorical;
+
+    Py_RETURN_NONE;
+}
+
+PyDoc_STRVAR(_datatype_tail_doc,
+"Allocate the items of the Tail field (__tail__) inline after the fixed part of the instances");
+
+static PyObject *
+_datatype_tail(PyObject *module, PyObject *cls)
+{
+    PyTypeObject *tp = (PyTypeObject*)cls;
+    dataobjecttypeinfo_object *info;
+
+    if (!PyDict_GetItem(tp->tp_dict, __tail__name)) {
+        PyErr_SetString(PyExc_TypeError, "__tail__ is missing");
+        return NULL;
+    }
+    if (tp->tp_alloc != dataobject_alloc || tp->tp_dealloc != dataobject_dealloc) {
+        PyErr_SetString(PyExc_TypeError, "Tail field requires the default allocation of the instances");
+        return NULL;
+    }
+
+    info = dataobject_typeinfo(tp);
+    if (info == NULL)
+        return NULL;
+    info->layout |= DATAOBJECT_L_TAIL;
+
+    // the number of the items of the tail
+    tp->tp_basicsize += sizeof(Py_ssize_t);
+    tp->tp_alloc = dataobject_alloc_tail;
+
+    tp->tp_new = dataobject_new_tail;
+    tp->tp_init = dataobject_init_basic;
+#if PY_VERSION_HEX >= 0x030A0000
+    tp->tp_vectorcall_offset = offsetof(PyTypeObject, tp_vectorcall);
+    tp->tp_vectorcall = dataobject_vectorcall_tail;
+    tp->tp_flags |= Py_TPFLAGS_HAVE_VECTORCALL;
+#endif
+
+    if (tp->tp_as_sequence->sq_item == dataobject_sq_item)
+        tp->tp_as_sequence->sq_item = dataobject_sq_item_tail;
+    if (tp->tp_as_sequence->sq_ass_item == dataobject_sq_ass_item)
+        tp->tp_as_sequence->sq_ass_item = dataobject_sq_ass_item_tail;
+    if (tp->tp_as_mapping->mp_subscript == dataobject_mp_subscript_sq)
+        tp->tp_as_mapping->mp_subscript = dataobject_mp_subscript_sq_tail;
+    if (tp->tp_as_mapping->mp_ass_subscript == dataobject_mp_ass_subscript_sq)
+        tp->tp_as_mapping->mp_ass_subscript = dataobject_mp_ass_subscript_sq_tail;
+
+    // the layout with the tail can't be extended by the fields of a subclass
+    tp->tp_flags &= ~Py_TPFLAGS_BASETYPE;
+
+    Py_RETURN_NONE;
+}
+
+PyDoc_STRVAR(_datatype_inline_doc,
+"Construct the instances from the arguments of the Inline, Packed and sparse fields (__inline__)");
+
+static PyObject *
+_datatype_inline(PyObject *module, PyObject *cls)
+{
+    PyTypeObject *tp = (PyTypeObject*)cls;
+    PyObject *plan = PyDict_GetItem(tp->tp_dict, __inline__name);
+    dataobjecttypeinfo_object *info;
+    Py_ssize_t i, n_plan, pos = 0, n_words = 0, n_sparse = 0, n_inline = 0;
+
+    if (plan == NULL || !PyTuple_Check(plan)) {
+        PyErr_SetString(PyExc_TypeError, "__inline__ should be a tuple");
+        return NULL;
+    }
+
+    n_plan = PyTuple_GET_SIZE(plan);
+    for (i = 0; i < n_plan; i++) {
+        PyObject *e = PyTuple_GET_ITEM(plan, i);
+        PyObject *p;
+
+        if (!PyTuple_Check(e) || PyTuple_GET_SIZE(e) != 2 || !PyUnicode_Check(PyTuple_GET_ITEM(e, 0))) {
+            PyErr_SetString(PyExc_TypeError, "invalid item of __inline__");
+            return NULL;
+        }
+        p = PyTuple_GET_ITEM(e, 1);
+        if (p == Py_None)
+            pos++;
+        else if (Py_TYPE(p) == &PyInlineProperty_Type && ((inlineproperty_object*)p)->start == pos) {
+            pos += PyDataObject_NUMITEMS(((inlineproperty_object*)p)->type);
+            n_inline++;
+        }
+        else if (Py_TYPE(p) == &PyBitProperty_Type) {
+            if (((bitproperty_object*)p)->index >= n_words)
+                n_words = ((bitproperty_object*)p)->index + 1;
+        }
+        else if (Py_TYPE(p) == &PyDataObjectSparseProperty_Type && ((sparseproperty_object*)p)->index == i)
+            n_sparse++;
+        else {
+            PyErr_SetString(PyExc_TypeError, "invalid descriptor in __inline__");
+            return NULL;
+        }
+    }
+    if (pos != PyDataObject_NUMITEMS(tp)) {
+        PyErr_SetString(PyExc_TypeError, "__inline__ doesn't match the number of the fields");
+        return NULL;
+    }
+
+    info = dataobject_typeinfo(tp);
+    if (info == NULL)
+        return NULL;
+    if (info->plan) {
+        PyErr_SetString(PyExc_TypeError, "__inline__ of the class is already initialized");
+        return NULL;
+    }
+
+    if (n_sparse) {
+        Py_ssize_t offset = tp->tp_basicsize;
+
+        if (n_sparse != n_plan || n_words) {
+            PyErr_SetString(PyExc_TypeError, "all fields of the sparse record should be sparse");
+            return NULL;
+        }
+        if (tp->tp_alloc != dataobject_alloc || tp->tp_dealloc != dataobject_dealloc ||
+                offset != dataobject_bits_offset(tp)) {
+            PyErr_SetString(PyExc_TypeError, "sparse=True requires the default allocation of the instances");
+            return NULL;
+        }
+
+        // the presence bitmap and the pointer to the array of the values
+        tp->tp_basicsize += ((n_sparse + 63) / 64) * sizeof(uint64_t) + sizeof(PyObject**);
+        tp->tp_alloc = dataobject_alloc_sparse;
+        tp->tp_dealloc = dataobject_dealloc_sparse;
+        info->layout |= DATAOBJECT_L_SPARSE;
+        if (tp->tp_iter == dataobject_iter)
+            tp->tp_iter = dataobject_iter_plan;
+        for (i = 0; i < n_plan; i++)
+            ((sparseproperty_object*)PyTuple_GET_ITEM(PyTuple_GET_ITEM(plan, i), 1))->offset = offset;
+    }
+
+    if (n_words) {
+        Py_ssize_t offset = tp->tp_basicsize;
+
+        if ((tp->tp_alloc != dataobject_alloc && tp->tp_alloc != dataobject_alloc_gc) ||
+                offset != dataobject_bits_offset(tp)) {
+            PyErr_SetString(PyExc_TypeError, "Packed fields require the default allocation of the instances");
+            return NULL;
+        }
+
+        // the words of the packed fields
+        tp->tp_basicsize += n_words * sizeof(uint64_t);
+        tp->tp_alloc = dataobject_alloc_bits;
+        info->layout |= DATAOBJECT_L_PACKED;
+        if (tp->tp_iter == dataobject_iter)
+            tp->tp_iter = dataobject_iter_plan;
+        for (i = 0; i < n_plan; i++) {
+            PyObject *p = PyTuple_GET_ITEM(PyTuple_GET_ITEM(plan, i), 1);
+            if (Py_TYPE(p) == &PyBitProperty_Type)
+                ((bitproperty_object*)p)->offset = offset + ((bitproperty_object*)p)->index * sizeof(uint64_t);
+        }
+    }
+
+    if (n_inline)
+        info->layout |= DATAOBJECT_L_INLINE;
+    Py_INCREF(plan);
+    info->plan = plan;
+
+    tp->tp_new = dataobject_new_inline;
+    tp->tp_init = dataobject_init_basic;
+#if PY_VERSION_HEX >= 0x030A0000
+    tp->tp_vectorcall_offset = offsetof(PyTypeObject, tp_vectorcall);
+    tp->tp_vectorcall = dataobject_vectorcall_inline;
+    tp->tp_flags |= Py_TPFLAGS_HAVE_VECTORCALL;
+#endif
+
+    // the subclass would append the fields after the flattened ones
+    tp->tp_flags &= ~Py_TPFLAGS_BASETYPE;
+
+    Py_RETURN_NONE;
+}
+
+PyDoc_STRVAR(dataobject_tail_doc,
+"tail(ob) -- the items of the Tail field of the instance as a tuple");
+
+static PyObject *
+dataobject_tail(PyObject *module, PyObject *op)
+{
+    if (!DATAOBJECT_HAS_TAIL(Py_TYPE(op))) {
+        PyErr_Format(PyExc_TypeError, "%s has no Tail field", Py_TYPE(op)->tp_name);
+        return NULL;
+    }
+    return dataobject_tail_tuple(op);
+}
+
+PyDoc_STRVAR(_datatype_track_changes_doc,
+"Keep the bitmap of the changed fields in the words after the other parts of the instances");
+
+static PyObject *
+_datatype_track_changes(PyObject *module, PyObject *cls)
+{
+    PyTypeObject *tp = (PyTypeObject*)cls;
+    dataobjecttypeinfo_object *info;
+
+    if ((tp->tp_alloc != dataobject_alloc && tp->tp_alloc != dataobject_alloc_gc) ||
+            tp->tp_basicsize != dataobject_bits_offset(tp)) {
+        PyErr_SetString(PyExc_TypeError, "track_changes=True requires the default allocation of the instances");
+        return NULL;
+    }
+
+    info = dataobject_typeinfo(tp);
+    if (info == NULL)
+        return NULL;
+
+    tp->tp_basicsize += ((PyDataObject_NUMITEMS(tp) + 63) / 64) * sizeof(uint64_t);
+    tp->tp_alloc = dataobject_alloc_tracked;
+    info->layout |= DATAOBJECT_L_TRACKED;
+
+    // the fields of the subclass would be placed over the bitmap
+    tp->tp_flags &= ~Py_TPFLAGS_BASETYPE;
+
+    Py_RETURN_NONE;
+}
+
+PyDoc_STRVAR(_datatype_stats_doc,
+"");
+
+static PyObject *
+_datatype_stats(PyObject *module, PyObject *args)
+{
+    PyObject *cls;
+    Py_ssize_t gc_size = 0;
+    PyTypeObject *tp;
+    dataobjecttypeinfo_object *info;
+    dataobjectstats_object *stats;
+
+    if (!PyArg_ParseTuple(args, "O|n", &cls, &gc_size))
+        return NULL;
+
+    tp = (PyTypeObject*)cls;
+
+    info = dataobject_typeinfo(tp);
+    if (info == NULL)
+        return NULL;
+    if (info->stats) {
+        PyErr_SetString(PyExc_TypeError, "statistics of the class are already initialized");
+        return NULL;
+    }
+
+    stats = PyObject_New(dataobjectstats_object, &PyDataObjectStats_Type);
+    if (stats == NULL)
+        return NULL;
+
+    stats->live = 0;
+    stats->allocated = 0;
+    stats->peak = 0;
+    stats->size = tp->tp_basicsize;
+    if (tp->tp_flags & Py_TPFLAGS_HAVE_GC)
+        stats->size += gc_size;
+
+    if (PyDict_SetItem(tp->tp_dict, __stats__name, (PyObject*)stats) < 0) {
+        Py_DECREF(stats);
+        return NULL;
+    }
+    // the reference of the typeinfo
+    info->stats = stats;
+
+    if (tp->tp_alloc == dataobject_alloc && tp->tp_dealloc == dataobject_dealloc) {
+        tp->tp_alloc = dataobject_alloc_stats;
+        tp->tp_dealloc = dataobject_dealloc_stats;
+    }
+    else if (tp->tp_alloc == dataobject_alloc_gc && tp->tp_dealloc == dataobject_dealloc_gc) {
+        tp->tp_alloc = dataobject_alloc_gc_stats;
+        tp->tp_dealloc = dataobject_dealloc_gc_stats;
+    }
+
+    Py_RETURN_NONE;
+}
+
+PyDoc_STRVAR(_datatype_arena_doc,
+"");
+
+static PyObject *
+_datatype_arena(PyObject *module, PyObject *cls)
+{
+    PyTypeObject *tp = (PyTypeObject*)cls;
+
+    if (tp->tp_alloc != dataobject_alloc || tp->tp_dealloc != dataobject_dealloc) {
+        PyErr_SetString(PyExc_TypeError, "arena=True is not compatible with gc=True and stats=True");
+        return NULL;
+    }
+
+    tp->tp_alloc = dataobject_alloc_arena;
+    tp->tp_free = dataobject_free_arena;
+
+    Py_RETURN_NONE;
+}
+
+PyDoc_STRVAR(_datatype_deferred_dealloc_doc,
+"");
+
+static PyObject *
+_datatype_deferred_dealloc(PyObject *module, PyObject *cls)
+{
+    PyTypeObject *tp = (PyTypeObject*)cls;
+
+#ifdef Py_GIL_DISABLED
+    PyErr_SetString(PyExc_TypeError, "deferred_dealloc=True requires the GIL");
+    return NULL;
+#endif
+
+    if (tp->tp_dealloc == dataobject_dealloc)
+        tp->tp_dealloc = dataobject_dealloc_deferred;
+    else if (tp->tp_dealloc == dataobject_dealloc_gc)
+        tp->tp_dealloc = dataobject_dealloc_gc_deferred;
+    else if (tp->tp_dealloc == dataobject_dealloc_stats || tp->tp_dealloc == dataobject_dealloc_gc_stats) {
+        PyErr_SetString(PyExc_TypeError, "deferred_dealloc=True is not compatible with stats=True");
+        return NULL;
+    }
+    else if (tp->tp_dealloc == dataobject_dealloc_sparse) {
+        PyErr_SetString(PyExc_TypeError, "deferred_dealloc=True is not compatible with sparse=True");
+        return NULL;
+    }
+    else if (tp->tp_dealloc != dataobject_dealloc_deferred &&
+             tp->tp_dealloc != dataobject_dealloc_gc_deferred) {
+        PyErr_Format(PyExc_TypeError,
+                     "deferred_dealloc=True is not compatible with the deallocator of %s (or of its base)",
+                     tp->tp_name);
+        return NULL;
+    }
+
+    Py_RETURN_NONE;
+}
+
+PyDoc_STRVAR(drain_doc,
+"drain(budget=-1)\n"
+"--\n\n"
+"Release up to `budget` (all if negative) references queued by deallocation\n"
+"of the instances of deferred_dealloc=True classes. Return the number of released references.");
+
+static PyObject *
+drain(PyObject *module, PyObject *args)
+{
+    Py_ssize_t budget = -1;
 
-    if (tp_base == &PyDataStruct_Type) {
-        tp->tp_dictoffset = 0;
-        tp->tp_weaklistoffset = 0;
-        tp->tp_flags &= ~Py_TPFLAGS_BASETYPE;
+    if (!PyArg_ParseTuple(args, "|n:drain", &budget))
+        return NULL;
+
+    return PyLong_FromSsize_t(deferred_drain(budget));
+}
+
+PyDoc_STRVAR(deferred_pending_doc,
+"deferred_pending()\n"
+"--\n\n"
+"Return the number of references queued by deallocation of the instances of\n"
+"deferred_dealloc=True classes.");
+
+static PyObject *
+deferred_pending(PyObject *module, PyObject *unused)
+{
+    return PyLong_FromSsize_t(deferred_len);
+}
+
+PyDoc_STRVAR(_datatype_mapping_methods_doc,
+"");
+
+static PyObject *
+_datatype_mapping_methods(PyObject *module, PyObject *cls)
+{
+    PyTypeObject *tp = (PyTypeObject*)cls;
+    PyObject *fields, *index_table;
+    PyMethodDef *meth;
+    Py_ssize_t i, n;
+
+    fields = PyObject_GetAttr(cls, __fields__name);
+    if (fields == NULL)
+        return NULL;
+    if (!PyTuple_Check(fields)) {
+        PyErr_SetString(PyExc_TypeError, "__fields__ should be a tuple");
+        Py_DECREF(fields);
+        return NULL;
     }
-    else {
-        tp->tp_dictoffset = tp_base->tp_dictoffset;
-        tp->tp_weaklistoffset = tp_base->tp_weaklistoffset;        
+
+    index_table = PyDict_New();
+    if (index_table == NULL) {
+        Py_DECREF(fields);
+        return NULL;
+    }
+    n = PyTuple_GET_SIZE(fields);
+    for (i = 0; i < n; i++) {
+        PyObject *index = PyLong_FromSsize_t(i);
+        if (index == NULL || PyDict_SetItem(index_table, PyTuple_GET_ITEM(fields, i), index) < 0) {
+            Py_XDECREF(index);
+            Py_DECREF(index_table);
+            Py_DECREF(fields);
+            return NULL;
+        }
+        Py_DECREF(index);
     }
+    Py_DECREF(fields);
 
+    if (PyDict_SetItem(tp->tp_dict, __fields_index__name, index_table) < 0) {
+        Py_DECREF(index_table);
+        return NULL;
+    }
+    Py_DECREF(index_table);
 
-// #if PY_VERSION_HEX >= 0x030A0000
-//         tp->tp_flags &= ~Py_TPFLAGS_IMMUTABLETYPE;
-// #endif
+    // the methods defined in the class or in it's bases aren't replaced
+    for (meth = dataobject_mapping_methods; meth->ml_name != NULL; meth++) {
+        PyObject *name, *descr, *d;
 
-    tp->tp_alloc = dataobject_alloc;
+        name = PyUnicode_InternFromString(meth->ml_name);
+        if (name == NULL)
+            return NULL;
+        d = _PyType_Lookup(tp, name);
+        if (d != NULL && !(Py_TYPE(d) == &PyMethodDescr_Type &&
+                           ((PyMethodDescrObject*)d)->d_method == meth)) {
+            Py_DECREF(name);
+            continue;
+        }
+        descr = PyDescr_NewMethod(tp, meth);
+        if (descr == NULL || PyDict_SetItem(tp->tp_dict, name, descr) < 0) {
+            Py_XDECREF(descr);
+            Py_DECREF(name);
+            return NULL;
+        }
+        Py_DECREF(descr);
+        Py_DECREF(name);
+    }
 
-    tp->tp_dealloc = dataobject_dealloc;
-    tp->tp_free = PyObject_Del;
+    {
+        PyObject *name = PyUnicode_InternFromString("__contains__");
+        PyObject *d;
 
-    tp->tp_flags |= Py_TPFLAGS_HEAPTYPE;
+        if (name == NULL)
+            return NULL;
+        d = _PyType_Lookup(tp, name);
+        if (d == NULL)
+            tp->tp_as_sequence->sq_contains = dataobject_mapping_contains;
+        else {
+            // sq_contains was replaced by _datatype_collection_mapping, restore it
+            Py_INCREF(d);
+            if (PyType_Type.tp_setattro(cls, name, d) < 0) {
+                Py_DECREF(d);
+                Py_DECREF(name);
+                return NULL;
+            }
+            Py_DECREF(d);
+        }
+        Py_DECREF(name);
+    }
 
-    if (tp->tp_flags & Py_TPFLAGS_HAVE_GC)
-        tp->tp_flags &= ~Py_TPFLAGS_HAVE_GC;
+    Py_RETURN_NONE;
+}
+
+PyDoc_STRVAR(_datatype_immutable_doc,
+"");
 
+static PyObject *
+_datatype_immutable(PyObject *module, PyObject *cls)
+{
+#if PY_VERSION_HEX >= 0x030A0000
+    PyTypeObject *tp = (PyTypeObject*)cls;
 
-    if (tp_base->tp_hash)
-        tp->tp_hash = tp_base->tp_hash;
+    tp->tp_flags |= Py_TPFLAGS_IMMUTABLETYPE;
+#endif
 
-    if (tp_base->tp_iter)
-        tp->tp_iter = tp_base->tp_iter;
+    Py_RETURN_NONE;
+}
 
-    tp->tp_traverse = NULL;
-    tp->tp_clear = NULL;
-    tp->tp_is_gc = NULL;
+PyDoc_STRVAR(_datatype_copy_default_doc,
+"Set the constructor copying the default values and resolve their copy strategies (__default_copy__)");
 
-// #if PY_VERSION_HEX >= 0x030A0000
-//     tp->tp_flags |= Py_TPFLAGS_HAVE_VECTORCALL|Py_TPFLAGS_IMMUTABLETYPE;
-//     tp->tp_vectorcall_offset = offsetof(PyTypeObject, tp_vectorcall);
-//     tp->tp_vectorcall = dataobject_vectorcall;
-// #endif
+static PyObject *
+_datatype_copy_default(PyObject *module, PyObject *cls) //, PyObject *kw)
+{
+    PyTypeObject *tp = (PyTypeObject*)cls;
 
-    PyType_Modified(tp);
+    PyObject *default_vals, *copiers;
+    Py_ssize_t i, n;
+
+    tp->tp_new = dataobject_new_copy_default;
+    // tp->tp_init = dataobject_init_copy_default;
+
+    default_vals = PyDict_GetItemWithError(tp->tp_dict, __default_vals__name);
+    if (default_vals == NULL) {
+        if (PyErr_Occurred())
+            return NULL;
+        Py_RETURN_NONE;
+    }
+    if (!PyTuple_Check(default_vals)) {
+        PyErr_SetString(PyExc_TypeError, "__default_vals__ should be a tuple");
+        return NULL;
+    }
+
+    n = PyTuple_GET_SIZE(default_vals);
+    copiers = PyTuple_New(n);
+    if (copiers == NULL)
+        return NULL;
+    for (i = 0; i < n; i++)
+        PyTuple_SET_ITEM(copiers, i, dataobject_default_copier(PyTuple_GET_ITEM(default_vals, i)));
+
+    if (PyDict_SetItem(tp->tp_dict, __default_copy__name, copiers) < 0) {
+        Py_DECREF(copiers);
+        return NULL;
+    }
+    Py_DECREF(copiers);
 
     Py_RETURN_NONE;
 }
 
-static PyObject*
-_collection_protocol(PyObject *cls, PyObject *sequence, PyObject *mapping, PyObject *readonly) {
-    PyTypeObject *tp = (PyTypeObject*)cls;
+static PyObject *
+_astuple(PyObject *op)
+{
+    const Py_ssize_t n_items = PyDataObject_LEN(op);
+    const Py_ssize_t n = n_items + dataobject_tail_len(op);
+    // const Py_ssize_t nn = dataobject_len(op);
+    Py_ssize_t i;
 
-    int sq = PyObject_IsTrue(sequence);
-    int mp = PyObject_IsTrue(mapping);
-    int ro = PyObject_IsTrue(readonly);
+    if (DATAOBJECT_HAS_PLAN_VALUES(Py_TYPE(op)))
+        return inline_logical_args(op);
 
-    PyTypeObject *tp_base = tp->tp_base;
+    PyObject *tpl = PyTuple_New(n);
+    if (tpl == NULL)
+        return NULL;
+    for (i=0; i<n; i++) {
+        PyObject *v = dataobject_seq_get(op, n_items, i);
+        Py_INCREF(v);
+        PyTuple_SetItem(tpl, i, v);
+    }
+
+//     if (n == nn) goto TOEND;
+
+//     PyTypeObject *type = Py_TYPE(op);
+//     if (type->tp_dictoffset) {
+//         PyObject **dictptr = PyDataObject_DICTPTR(type, op);
+//         PyObject* dict = NULL;
+
+//         if (*dictptr)
+//             dict = *dictptr;
+
+//         if (dict != NULL) {
+//             PyObject *iter = PyObject_GetIter(dict);
+//             PyObject *key, *val;
+
+//             i = n;
+//             while (i < nn && (key = PyIter_Next(iter))) {
+//                 val = PyObject_GetItem(dict, key);
+//                 PyTuple_SetItem(tpl, i, val);
+//                 i++;
+//                 Py_DECREF(key);                
+//             }
+//         }
+//     }
+
+// TOEND:
+    return (PyObject*)tpl;
+}
+
+static PyObject *
+_asdict(PyObject *op)
+{
+    Py_ssize_t i;
+    PyObject *fn, *v;
+
+    PyObject *fields = PyObject_GetAttr((PyObject*)Py_TYPE(op), __fields__name);
+
+    if (!fields)
+        return NULL;
+
+    if (!PyTuple_Check(fields)) {
+        PyErr_SetString(PyExc_TypeError, "__fields__ should be a tuple");
+        Py_DECREF(fields);
+        return NULL;
+    }
+
+    const Py_ssize_t n = Py_SIZE(fields);
+    PyObject *dict = PyDict_New();
+
+    if (dict == NULL) {
+        Py_DECREF(fields);
+        return NULL;
+    }
+
+    for (i=0; i<n; i++) {
+        fn = PyTuple_GET_ITEM(fields, i);
+        v = PyDataObject_GET_VALUE(op, i);
+        if (PyDict_SetItem(dict, fn, v) < 0) {
+            Py_DECREF(dict);
+            Py_DECREF(fields);
+            return NULL;
+        }
+    }
+    Py_DECREF(fields);
+
+    if (DATAOBJECT_HAS_TAIL(Py_TYPE(op)) && dataobject_tail_to_dict(op, dict) < 0) {
+        Py_DECREF(dict);
+        return NULL;
+    }
+    if ((DATAOBJECT_HAS_BITS(Py_TYPE(op)) || DATAOBJECT_IS_SPARSE(Py_TYPE(op))) &&
+            dataobject_plan_to_dict(op, dict) < 0) {
+        Py_DECREF(dict);
+        return NULL;
+    }
+
+    return dict;
+}
+
+PyDoc_STRVAR(asdict_doc,
+"Convert object to dict");
+
+static PyObject *
+asdict(PyObject *module, PyObject *args)
+{
+    PyObject *op;
+    // PyTypeObject *type;
+
+    op = PyTuple_GET_ITEM(args, 0);
+    // type = Py_TYPE(op);
+
+    // if (type != &PyDataObject_Type &&
+    //     !PyType_IsSubtype(type, &PyDataObject_Type)) {
+    //         PyErr_SetString(PyExc_TypeError, "1st argument is not subclass of dataobject");
+    //         return NULL;
+    // }
+
+    return _asdict(op);
+}
+
+PyDoc_STRVAR(astuple_doc,
+"Convert object to a tuple");
+
+static PyObject *
+astuple(PyObject *module, PyObject *args)
+{
+    PyObject *op;
+    // PyTypeObject *type;
+
+    op = PyTuple_GET_ITEM(args, 0);
+    // type = Py_TYPE(op);
+
+    // PyTypeObject* tp_base = type->tp_base;
 
     // if ((tp_base != &PyDataObject_Type) && !PyType_IsSubtype(tp_base, &PyDataObject_Type)) {
-    //     PyErr_SetString(PyExc_TypeError, "the type should be dataobject or it's subtype");
-    //     return NULL;
+    //         PyErr_SetString(PyExc_TypeError, "1st argument is not subclass of dataobject");
+    //         return NULL;
     // }
 
-    copy_mapping_methods(tp->tp_as_mapping, tp_base->tp_as_mapping);
-    copy_sequence_methods(tp->tp_as_sequence, tp_base->tp_as_sequence);
+    return _astuple(op);
+}
+
+//////////////////// batch conversion ////////////////////////////////////
+
+// the fields of the row's type; it's cached in *ptype, *pfields while the type is the same
+static PyObject *
+rows_fields(PyObject *row, PyTypeObject **ptype, PyObject **pfields)
+{
+    PyTypeObject *tp = Py_TYPE(row);
+    PyObject *fields;
+
+    if (tp == *ptype)
+        return *pfields;
+
+    if (!PyType_IsSubtype(tp, &PyDataObject_Type) && !PyType_IsSubtype(tp, &PyDataStruct_Type)) {
+        PyErr_Format(PyExc_TypeError, "the row is not an instance of dataobject: %s", tp->tp_name);
+        return NULL;
+    }
+
+    fields = PyObject_GetAttr((PyObject*)tp, __fields__name);
+    if (fields == NULL)
+        return NULL;
+    if (!PyTuple_Check(fields)) {
+        PyErr_SetString(PyExc_TypeError, "__fields__ should be a tuple");
+        Py_DECREF(fields);
+        return NULL;
+    }
+
+    Py_XDECREF(*pfields);
+    *pfields = fields;
+    *ptype = tp;
+    return fields;
+}
+
+PyDoc_STRVAR(asdicts_doc,
+"asdicts(rows) -- list of dicts for the list of dataobjects");
+
+static PyObject *
+asdicts(PyObject *module, PyObject *rows)
+{
+    PyObject *seq, *ret, *template = NULL, *fields = NULL;
+    PyTypeObject *type = NULL;
+    Py_ssize_t i, j, n;
+
+    seq = PySequence_Fast(rows, "rows should be iterable");
+    if (seq == NULL)
+        return NULL;
+
+    n = PySequence_Fast_GET_SIZE(seq);
+    ret = PyList_New(n);
+    if (ret == NULL)
+        goto error;
 
-    if (!mp && sq) {
-        if (ro) {
-            copy_sequence_methods(tp->tp_as_sequence, &dataobject_as_sequence_ro);
-            copy_mapping_methods(tp->tp_as_mapping, &dataobject_as_mapping_sq_ro);
-        } else {
-            copy_sequence_methods(tp->tp_as_sequence, &dataobject_as_sequence);
-            copy_mapping_methods(tp->tp_as_mapping, &dataobject_as_mapping_sq);
+    for (i = 0; i < n; i++) {
+        PyObject *row = PySequence_Fast_GET_ITEM(seq, i);
+        PyTypeObject *last_type = type;
+        PyObject *d;
+        Py_ssize_t n_fields;
+
+        if (rows_fields(row, &type, &fields) == NULL)
+            goto error;
+        if (DATAOBJECT_HAS_PLAN_VALUES(type)) {
+            d = _asdict(row);
+            if (d == NULL)
+                goto error;
+            PyList_SET_ITEM(ret, i, d);
+            continue;
         }
-#if PY_VERSION_HEX >= 0x030A0000
-        tp->tp_flags &= ~Py_TPFLAGS_SEQUENCE;
-#endif
-    }
+        n_fields = PyTuple_GET_SIZE(fields);
 
-    if (mp && !sq) {
-        if (ro) {
-            copy_mapping_methods(tp->tp_as_mapping, &dataobject_as_mapping_ro);
-        } else {
-            copy_mapping_methods(tp->tp_as_mapping, &dataobject_as_mapping);
+        // the dicts are copied from the template with the same keys,
+        // so they are allocated with the final size and the hashes of the keys are reused
+        if (type != last_type || template == NULL) {
+            Py_XDECREF(template);
+            template = PyDict_New();
+            if (template == NULL)
+                goto error;
+            for (j = 0; j < n_fields; j++) {
+                if (PyDict_SetItem(template, PyTuple_GET_ITEM(fields, j), Py_None) < 0)
+                    goto error;
+            }
         }
-#if PY_VERSION_HEX >= 0x030A0000
-        tp->tp_flags &= ~Py_TPFLAGS_MAPPING;
-#endif
-    }
 
-    if (mp && sq) {
-        if (ro) {
-            copy_mapping_methods(tp->tp_as_mapping, &dataobject_as_mapping2_ro);
-        } else {
-            copy_mapping_methods(tp->tp_as_mapping, &dataobject_as_mapping2);
+        d = PyDict_Copy(template);
+        if (d == NULL)
+            goto error;
+        PyList_SET_ITEM(ret, i, d);
+
+        for (j = 0; j < n_fields; j++) {
+            if (PyDict_SetItem(d, PyTuple_GET_ITEM(fields, j), PyDataObject_GET_VALUE(row, j)) < 0)
+                goto error;
         }
-// #if PY_VERSION_HEX >= 0x030A0000
-//         tp->tp_flags &= ~Py_TPFLAGS_SEQUENCE;
-//         tp->tp_flags &= ~Py_TPFLAGS_MAPPING;
-// #endif
+        if (DATAOBJECT_HAS_TAIL(type) && dataobject_tail_to_dict(row, d) < 0)
+            goto error;
     }
 
-//     if (mo) {
-//         if (ro) {
-//             copy_mapping_methods(tp->tp_as_mapping, &dataobject_as_mapping_ro);
-//         } else {
-//             copy_mapping_methods(tp->tp_as_mapping, &dataobject_as_mapping);
-//         }
-// #if PY_VERSION_HEX >= 0x030A0000
-//         tp->tp_flags &= ~Py_TPFLAGS_MAPPING;
-// #endif
-//     }
+    Py_XDECREF(template);
+    Py_XDECREF(fields);
+    Py_DECREF(seq);
+    return ret;
 
-    Py_RETURN_NONE;
+error:
+    Py_XDECREF(template);
+    Py_XDECREF(fields);
+    Py_XDECREF(ret);
+    Py_DECREF(seq);
+    return NULL;
 }
 
-PyDoc_STRVAR(_datatype_collection_mapping_doc,
-"");
+PyDoc_STRVAR(astuples_doc,
+"astuples(rows) -- list of tuples for the list of dataobjects");
 
 static PyObject *
-_datatype_collection_mapping(PyObject *module, PyObject *args) //, PyObject *kw)
+astuples(PyObject *module, PyObject *rows)
 {
-    PyObject *cls, *sequence, *mapping, *readonly;
+    PyObject *seq, *ret;
+    Py_ssize_t i, j, n;
 
-    cls = PyTuple_GET_ITEM(args, 0);
-    sequence = PyTuple_GET_ITEM(args, 1);
-    mapping = PyTuple_GET_ITEM(args, 2);
-    readonly = PyTuple_GET_ITEM(args, 3);
+    seq = PySequence_Fast(rows, "rows should be iterable");
+    if (seq == NULL)
+        return NULL;
 
-    return _collection_protocol(cls, sequence, mapping, readonly);
-}
+    n = PySequence_Fast_GET_SIZE(seq);
+    ret = PyList_New(n);
+    if (ret == NULL) {
+        Py_DECREF(seq);
+        return NULL;
+    }
 
-PyDoc_STRVAR(_datatype_from_basetype_hashable_doc,
-"");
+    for (i = 0; i < n; i++) {
+        PyObject *row = PySequence_Fast_GET_ITEM(seq, i);
+        PyTypeObject *tp = Py_TYPE(row);
+        PyObject *t;
+        Py_ssize_t n_fields;
+
+        if (tp->tp_base != &PyDataObject_Type && tp->tp_base != &PyDataStruct_Type &&
+                !PyType_IsSubtype(tp, &PyDataObject_Type) && !PyType_IsSubtype(tp, &PyDataStruct_Type)) {
+            PyErr_Format(PyExc_TypeError, "the row is not an instance of dataobject: %s", tp->tp_name);
+            Py_DECREF(ret);
+            Py_DECREF(seq);
+            return NULL;
+        }
 
-static PyObject*
-_datatype_from_basetype_hashable(PyObject *module, PyObject *cls) {
-    PyTypeObject *tp = (PyTypeObject*)cls;
+        if (DATAOBJECT_HAS_PLAN_VALUES(tp)) {
+            t = inline_logical_args(row);
+            if (t == NULL) {
+                Py_DECREF(ret);
+                Py_DECREF(seq);
+                return NULL;
+            }
+            PyList_SET_ITEM(ret, i, t);
+            continue;
+        }
 
-    PyObject *bases = tp->tp_bases;
-    Py_ssize_t i, n_bases = Py_SIZE(bases);
-    for (i=0; i<n_bases; i++) {
-        PyTypeObject *base = (PyTypeObject*)PyTuple_GetItem(bases, i);
-        if (base->tp_hash) {
-                tp->tp_hash = base->tp_hash;
-                Py_INCREF(Py_True);
-                return Py_True;
+        n_fields = PyDataObject_LEN(row);
+        t = PyTuple_New(n_fields + dataobject_tail_len(row));
+        if (t == NULL) {
+            Py_DECREF(ret);
+            Py_DECREF(seq);
+            return NULL;
+        }
+        for (j = 0; j < Py_SIZE(t); j++) {
+            PyObject *v = dataobject_seq_get(row, n_fields, j);
+            Py_INCREF(v);
+            PyTuple_SET_ITEM(t, j, v);
         }
+        PyList_SET_ITEM(ret, i, t);
     }
-    Py_INCREF(Py_False);
-    return Py_False;
+
+    Py_DECREF(seq);
+    return ret;
 }
 
-PyDoc_STRVAR(_datatype_hashable_doc,
-"");
+//////////////////// diff and patch ////////////////////////////////////
 
-static PyObject*
-_datatype_hashable(PyObject *module, PyObject *cls) {
-    PyTypeObject *tp = (PyTypeObject*)cls;
+// The patch is the tuple of the pairs (index, value) of the fields of the new record,
+// which differ from the fields of the old record. It's a plain tuple, so it can be pickled
+// and stored along with the records.
 
-    tp->tp_hash = dataobject_hash;
-    Py_RETURN_NONE;
+static int
+dataobject_check_diffable(PyObject *a, PyObject *b)
+{
+    PyTypeObject *tp = Py_TYPE(a);
+
+    if (!PyType_IsSubtype(tp, &PyDataObject_Type) && !PyType_IsSubtype(tp, &PyDataStruct_Type)) {
+        PyErr_Format(PyExc_TypeError, "the object is not an instance of dataobject: %s", tp->tp_name);
+        return -1;
+    }
+    if (b && Py_TYPE(b) != tp) {
+        PyErr_Format(PyExc_TypeError, "the objects have different types: %s and %s",
+                     tp->tp_name, Py_TYPE(b)->tp_name);
+        return -1;
+    }
+    // the values outside of the slots of the fields
+    if (DATAOBJECT_HAS_TAIL(tp) || DATAOBJECT_HAS_BITS(tp) || DATAOBJECT_IS_SPARSE(tp)) {
+        PyErr_Format(PyExc_TypeError, "%s has Tail, Packed or sparse fields", tp->tp_name);
+        return -1;
+    }
+    return 0;
 }
 
+static PyObject *
+dataobject_diff_items(PyObject *a, PyObject *b)
+{
+    const Py_ssize_t n = PyDataObject_LEN(a);
+    PyObject **a_items = PyDataObject_ITEMS(a);
+    PyObject **b_items = PyDataObject_ITEMS(b);
+    PyObject *ret;
+    Py_ssize_t i, k = 0;
 
-PyDoc_STRVAR(_datatype_from_basetype_iterable_doc,
-"");
+    ret = PyTuple_New(n);
+    if (ret == NULL)
+        return NULL;
 
-static PyObject*
-_datatype_from_basetype_iterable(PyObject *module, PyObject *cls) {
-    PyTypeObject *tp = (PyTypeObject*)cls;
+    for (i = 0; i < n; i++) {
+        PyObject *a_v = PyDataObject_VALUE(a_items[i]), *b_v = PyDataObject_VALUE(b_items[i]);
+        PyObject *pair, *index;
+        int eq;
+
+        if (a_v == b_v)
+            continue;
+        eq = PyObject_RichCompareBool(a_v, b_v, Py_EQ);
+        if (eq < 0)
+            goto error;
+        if (eq)
+            continue;
 
-    PyObject *bases = tp->tp_bases;
-    Py_ssize_t i, n_bases = Py_SIZE(bases);
-    for (i=0; i<n_bases; i++) {
-        PyTypeObject *base = (PyTypeObject*)PyTuple_GetItem(bases, i);
-        if (base->tp_iter) {
-            if (base->tp_iter == dataobject_iter) {
-                tp->tp_iter = base->tp_iter;
-                Py_INCREF(Py_True);
-                return Py_True;
-            }
+        index = PyLong_FromSsize_t(i);
+        if (index == NULL)
+            goto error;
+        pair = PyTuple_New(2);
+        if (pair == NULL) {
+            Py_DECREF(index);
+            goto error;
         }
+        PyTuple_SET_ITEM(pair, 0, index);
+        Py_INCREF(b_v);
+        PyTuple_SET_ITEM(pair, 1, b_v);
+        PyTuple_SET_ITEM(ret, k++, pair);
     }
-    Py_INCREF(Py_False);
-    return Py_False;
-}
 
+    if (_PyTuple_Resize(&ret, k) < 0)
+        return NULL;
+    return ret;
 
-PyDoc_STRVAR(_datatype_iterable_doc,
-"");
+error:
+    Py_DECREF(ret);
+    return NULL;
+}
 
-static PyObject*
-_datatype_iterable(PyObject *module, PyObject *cls) {
-    PyTypeObject *tp = (PyTypeObject*)cls;
+PyDoc_STRVAR(dataobject_diff_doc,
+"diff(a, b) -- tuple of the pairs (index, value) of the fields of b, which are not equal to the fields of a");
 
-    tp->tp_iter = dataobject_iter;
+static PyObject *
+dataobject_diff(PyObject *module, PyObject *args)
+{
+    PyObject *a, *b;
 
-    Py_RETURN_NONE;
-}
+    if (!PyArg_UnpackTuple(args, "diff", 2, 2, &a, &b))
+        return NULL;
+    if (dataobject_check_diffable(a, b) < 0)
+        return NULL;
 
+    return dataobject_diff_items(a, b);
+}
 
-PyDoc_STRVAR(_datatype_use_dict_doc,
-"");
+PyDoc_STRVAR(dataobject_diffs_doc,
+"diffs(rows_a, rows_b) -- list of diff(a, b) for the aligned lists of dataobjects");
 
-static PyObject*
-_datatype_use_dict(PyObject *module, PyObject *cls) {
-    PyTypeObject *tp = (PyTypeObject*)cls;
+static PyObject *
+dataobject_diffs(PyObject *module, PyObject *args)
+{
+    PyObject *rows_a, *rows_b, *seq_a, *seq_b, *ret = NULL;
+    Py_ssize_t i, n;
 
-    // if (!PyObject_IsInstance(cls, (PyObject*)&PyType_Type)) {
-    //     PyErr_SetString(PyExc_TypeError, "argument is not a subtype of the type");
-    //     return NULL;
-    // }
+    if (!PyArg_UnpackTuple(args, "diffs", 2, 2, &rows_a, &rows_b))
+        return NULL;
 
-    if (!tp->tp_dictoffset) {
-        if (!tp->tp_weaklistoffset) {
-            tp->tp_dictoffset = tp->tp_basicsize;
-            tp->tp_basicsize += sizeof(PyObject*);
-        } else {
-            tp->tp_dictoffset = tp->tp_basicsize - sizeof(PyObject*);
-            tp->tp_weaklistoffset = tp->tp_basicsize;
-            tp->tp_basicsize += sizeof(PyObject*);
-        }
+    seq_a = PySequence_Fast(rows_a, "rows should be iterable");
+    if (seq_a == NULL)
+        return NULL;
+    seq_b = PySequence_Fast(rows_b, "rows should be iterable");
+    if (seq_b == NULL) {
+        Py_DECREF(seq_a);
+        return NULL;
     }
 
-    Py_RETURN_NONE;
-}
+    n = PySequence_Fast_GET_SIZE(seq_a);
+    if (PySequence_Fast_GET_SIZE(seq_b) != n) {
+        PyErr_SetString(PyExc_ValueError, "the lists of the rows have different lengths");
+        goto done;
+    }
 
-PyDoc_STRVAR(_datatype_use_weakref_doc,
-"");
+    ret = PyList_New(n);
+    if (ret == NULL)
+        goto done;
 
-static PyObject*
-_datatype_use_weakref(PyObject *module, PyObject *cls) {
-    PyTypeObject *tp = (PyTypeObject*)cls;
-    // if (!PyObject_IsInstance(cls, (PyObject*)&PyType_Type)) {
-    //     PyErr_SetString(PyExc_TypeError, "argument is not a subtype of the type");
-    //     return NULL;
-    // }
+    for (i = 0; i < n; i++) {
+        PyObject *a = PySequence_Fast_GET_ITEM(seq_a, i);
+        PyObject *b = PySequence_Fast_GET_ITEM(seq_b, i);
+        PyObject *d;
 
-    if (!tp->tp_weaklistoffset) {
-        if (!tp->tp_dictoffset) {
-            tp->tp_weaklistoffset = tp->tp_basicsize;
-            tp->tp_basicsize += sizeof(PyObject*);
-        } else {
-            tp->tp_weaklistoffset = tp->tp_basicsize;
-            tp->tp_basicsize += sizeof(PyObject*);
+        if (dataobject_check_diffable(a, b) < 0) {
+            Py_CLEAR(ret);
+            goto done;
         }
+        d = dataobject_diff_items(a, b);
+        if (d == NULL) {
+            Py_CLEAR(ret);
+            goto done;
+        }
+        PyList_SET_ITEM(ret, i, d);
     }
 
-    Py_RETURN_NONE;
+done:
+    Py_DECREF(seq_a);
+    Py_DECREF(seq_b);
+    return ret;
 }
 
-PyDoc_STRVAR(_datatype_enable_gc_doc,
-"");
-
-static PyObject *
-_datatype_enable_gc(PyObject *module, PyObject *cls)
+// the pairs (index, value) of the patch with the index of the field
+static int
+dataobject_patch_index(PyObject *op, PyObject *pair, Py_ssize_t *pindex)
 {
-    PyTypeObject *type = (PyTypeObject*)cls;
+    Py_ssize_t index;
 
-    // if (!PyObject_IsInstance(cls, (PyObject*)&PyType_Type)) {
-    //     PyErr_SetString(PyExc_TypeError, "Argument have to be an instance of type");
-    //     return NULL;
-    // }
+    if (!PyTuple_Check(pair) || PyTuple_GET_SIZE(pair) != 2) {
+        PyErr_SetString(PyExc_TypeError, "patch should contain the pairs (index, value)");
+        return -1;
+    }
+    index = PyLong_AsSsize_t(PyTuple_GET_ITEM(pair, 0));
+    if (index == -1 && PyErr_Occurred())
+        return -1;
+    if (index < 0 || index >= PyDataObject_LEN(op)) {
+        PyErr_Format(PyExc_IndexError, "index %zd out of range", index);
+        return -1;
+    }
+    *pindex = index;
+    return 0;
+}
 
-    type->tp_flags |= Py_TPFLAGS_HAVE_GC;
-    type->tp_traverse = dataobject_traverse;
-    type->tp_clear = dataobject_clear;
+// the object itself can be patched only if the type is mutable and the patched fields
+// aren't readonly (as for the inplace replacer)
+static int
+dataobject_check_patch_inplace(PyObject *op, PyObject *seq)
+{
+    PyTypeObject *type = Py_TYPE(op);
+    PyObject *fields;
+    Py_ssize_t i, n = PySequence_Fast_GET_SIZE(seq);
 
-    type->tp_dealloc = dataobject_dealloc_gc;
-    type->tp_alloc = dataobject_alloc_gc;
-    type->tp_free = PyObject_GC_Del;
+#if PY_VERSION_HEX >= 0x030A0000
+    if (type->tp_flags & Py_TPFLAGS_IMMUTABLETYPE) {
+        PyErr_Format(PyExc_TypeError, "%s is immutable type", type->tp_name);
+        return -1;
+    }
+#endif
 
-    // PyType_Modified(type);
+    fields = PyDict_GetItem(type->tp_dict, __fields__name);
+    if (fields == NULL || !PyTuple_Check(fields)) {
+        PyErr_SetString(PyExc_TypeError, "__fields__ should be a tuple");
+        return -1;
+    }
 
-    Py_RETURN_NONE;
-}
+    for (i = 0; i < n; i++) {
+        PyObject *name;
+        Py_ssize_t index;
 
-PyDoc_STRVAR(_datatype_deep_dealloc_doc,
-"");
+        if (dataobject_patch_index(op, PySequence_Fast_GET_ITEM(seq, i), &index) < 0)
+            return -1;
+        name = PyTuple_GET_ITEM(fields, index);
+        if (dataobject_is_readonly_field(type, name)) {
+            PyErr_Format(PyExc_TypeError, "field %U is readonly", name);
+            return -1;
+        }
+    }
+    return 0;
+}
 
-static PyObject *
-_datatype_deep_dealloc(PyObject *module, PyObject *cls)
+// assign the values of the patch through dataobject_ass_item, so they are validated and
+// the changed fields are marked
+static int
+dataobject_apply_patch(PyObject *op, PyObject *patch, int inplace)
 {
-    PyTypeObject *type = (PyTypeObject*)cls;
-    int have_gc;
+    PyObject *seq;
+    Py_ssize_t i, n;
 
-    // if (!PyObject_IsInstance(cls, (PyObject*)&PyType_Type)) {
-    //     PyErr_SetString(PyExc_TypeError, "Argument have to be an instance of a type");
-    //     return NULL;
-    // }
+    seq = PySequence_Fast(patch, "patch should be iterable");
+    if (seq == NULL)
+        return -1;
 
-    have_gc = type->tp_flags & Py_TPFLAGS_HAVE_GC;
+    if (inplace && dataobject_check_patch_inplace(op, seq) < 0)
+        goto error;
 
-    if (!have_gc) {
-        type->tp_finalize = dataobject_finalize;
+    n = PySequence_Fast_GET_SIZE(seq);
+    for (i = 0; i < n; i++) {
+        PyObject *pair = PySequence_Fast_GET_ITEM(seq, i);
+        Py_ssize_t index;
+
+        if (dataobject_patch_index(op, pair, &index) < 0)
+            goto error;
+        if (dataobject_ass_item(op, index, PyTuple_GET_ITEM(pair, 1)) < 0)
+            goto error;
     }
+    Py_DECREF(seq);
 
-    Py_RETURN_NONE;
+    return dataobject_intern_categorical(op);
+
+error:
+    Py_DECREF(seq);
+    return -1;
 }
 
-PyDoc_STRVAR(_datatype_vectorcall_doc,
-"");
+PyDoc_STRVAR(dataobject_patch_doc,
+"patch(ob, patch, inplace=False) -- copy of ob with the values of the patch;\n"
+"ob is updated itself if inplace=True (the readonly fields and the immutable types can't be patched)");
 
 static PyObject *
-_datatype_vectorcall(PyObject *module, PyObject *cls)
+dataobject_patch(PyObject *module, PyObject *args, PyObject *kw)
 {
-    PyTypeObject *tp = (PyTypeObject *)cls;
+    static char *kwlist[] = {"ob", "patch", "inplace", NULL};
+    PyObject *op, *patch, *new_op;
+    int inplace = 0;
 
-    tp->tp_new = dataobject_new_basic;
-    tp->tp_init = dataobject_init_basic;
+    if (!PyArg_ParseTupleAndKeywords(args, kw, "OO|p:patch", kwlist, &op, &patch, &inplace))
+        return NULL;
+    if (dataobject_check_diffable(op, NULL) < 0)
+        return NULL;
 
-#if PY_VERSION_HEX >= 0x030A0000
-    tp->tp_vectorcall_offset = offsetof(PyTypeObject, tp_vectorcall);
-    tp->tp_vectorcall = dataobject_vectorcall;
-    tp->tp_flags |= Py_TPFLAGS_HAVE_VECTORCALL;
-    // tp->tp_flags |= Py_TPFLAGS_IMMUTABLETYPE;
-    // printf("vc\n");
-#endif
+    if (inplace) {
+        if (dataobject_apply_patch(op, patch, 1) < 0)
+            return NULL;
+        Py_RETURN_NONE;
+    }
 
-    Py_RETURN_NONE;
+    new_op = dataobject_copy(op);
+    if (new_op == NULL)
+        return NULL;
+    if (dataobject_apply_patch(new_op, patch, 0) < 0) {
+        Py_DECREF(new_op);
+        return NULL;
+    }
+    return new_op;
 }
 
+static PyObject *array_type = NULL;
+
+#define PACK_INT(ctype, min, max) { \
+        long long x = PyLong_AsLongLong(v); \
+        if (x == -1 && PyErr_Occurred()) \
+            return -1; \
+        if (x < (min) || x > (max)) { \
+            PyErr_Format(PyExc_OverflowError, "value %lld is out of range of '%c'", x, code); \
+            return -1; \
+        } \
+        *(ctype*)p = (ctype)x; \
+        return 0; \
+    }
 
-PyDoc_STRVAR(_datatype_immutable_doc,
-"");
+#define PACK_UINT(ctype, max) { \
+        unsigned long long x = PyLong_AsUnsignedLongLong(v); \
+        if (x == (unsigned long long)-1 && PyErr_Occurred()) \
+            return -1; \
+        if (x > (max)) { \
+            PyErr_Format(PyExc_OverflowError, "value %llu is out of range of '%c'", x, code); \
+            return -1; \
+        } \
+        *(ctype*)p = (ctype)x; \
+        return 0; \
+    }
 
-static PyObject *
-_datatype_immutable(PyObject *module, PyObject *cls)
+// store the value `v` as an item of the array with the type code `code`
+static int
+column_pack(char code, char *p, PyObject *v)
 {
-#if PY_VERSION_HEX >= 0x030A0000
-    PyTypeObject *tp = (PyTypeObject*)cls;
-
-    tp->tp_flags |= Py_TPFLAGS_IMMUTABLETYPE;
-#endif
-
-    Py_RETURN_NONE;
+    switch (code) {
+    case 'b': PACK_INT(signed char, SCHAR_MIN, SCHAR_MAX)
+    case 'B': PACK_UINT(unsigned char, UCHAR_MAX)
+    case 'h': PACK_INT(short, SHRT_MIN, SHRT_MAX)
+    case 'H': PACK_UINT(unsigned short, USHRT_MAX)
+    case 'i': PACK_INT(int, INT_MIN, INT_MAX)
+    case 'I': PACK_UINT(unsigned int, UINT_MAX)
+    case 'l': PACK_INT(long, LONG_MIN, LONG_MAX)
+    case 'L': PACK_UINT(unsigned long, ULONG_MAX)
+    case 'q': PACK_INT(long long, LLONG_MIN, LLONG_MAX)
+    case 'Q': PACK_UINT(unsigned long long, ULLONG_MAX)
+    case 'f':
+    case 'd': {
+        double x = PyFloat_AsDouble(v);
+        if (x == -1.0 && PyErr_Occurred())
+            return -1;
+        if (code == 'f')
+            *(float*)p = (float)x;
+        else
+            *(double*)p = x;
+        return 0;
+    }
+    }
+    PyErr_Format(PyExc_ValueError, "unsupported type code of the column: '%c'", code);
+    return -1;
 }
 
-PyDoc_STRVAR(_datatype_copy_default_doc,
-"");
+#undef PACK_INT
+#undef PACK_UINT
 
+// array.array(dtype) of n uninitialized items
 static PyObject *
-_datatype_copy_default(PyObject *module, PyObject *cls) //, PyObject *kw)
+column_array(PyObject *dtype, Py_ssize_t n)
 {
-    PyTypeObject *tp = (PyTypeObject*)cls;
+    PyObject *arr, *data, *ret, *size;
+    Py_ssize_t itemsize;
 
-    tp->tp_new = dataobject_new_copy_default;
-    // tp->tp_init = dataobject_init_copy_default;
+    if (array_type == NULL) {
+        array_type = _PyObject_GetObject("array", "array");
+        if (array_type == NULL)
+            return NULL;
+    }
 
-    Py_RETURN_NONE;
+    arr = PyObject_CallFunctionObjArgs(array_type, dtype, NULL);
+    if (arr == NULL)
+        return NULL;
+    size = PyObject_GetAttrString(arr, "itemsize");
+    Py_DECREF(arr);
+    if (size == NULL)
+        return NULL;
+    itemsize = PyLong_AsSsize_t(size);
+    Py_DECREF(size);
+    if (itemsize == -1 && PyErr_Occurred())
+        return NULL;
+
+    data = PyBytes_FromStringAndSize(NULL, n * itemsize);
+    if (data == NULL)
+        return NULL;
+    ret = PyObject_CallFunctionObjArgs(array_type, dtype, data, NULL);
+    Py_DECREF(data);
+    return ret;
 }
 
-static PyObject *
-_astuple(PyObject *op)
+// fill the columns `cols` by the fields `names` of the rows:
+// lists or array.array if the dtype isn't None
+static int
+rows_columns(PyObject *seq, PyObject *names, PyObject **cols, PyObject *const *dtypes)
 {
-    const Py_ssize_t n = PyDataObject_LEN(op);
-    // const Py_ssize_t nn = dataobject_len(op);
-    Py_ssize_t i;
+    PyTypeObject *type = NULL;
+    Py_ssize_t i, k, n, n_names = PyTuple_GET_SIZE(names);
+    Py_ssize_t *index;
+    Py_buffer *views;
+
+    index = PyMem_Malloc(n_names * sizeof(Py_ssize_t));
+    views = PyMem_Calloc(n_names + 1, sizeof(Py_buffer));
+    if (index == NULL || views == NULL) {
+        PyMem_Free(index);
+        PyMem_Free(views);
+        PyErr_NoMemory();
+        return -1;
+    }
 
-    PyObject *tpl = PyTuple_New(n);
-    for (i=0; i<n; i++) {
-        PyObject *v = PyDataObject_GET_ITEM(op, i);
-        Py_INCREF(v);
-        PyTuple_SetItem(tpl, i, v);
+    n = PySequence_Fast_GET_SIZE(seq);
+    for (k = 0; k < n_names; k++) {
+        if (dtypes[k] == Py_None)
+            cols[k] = PyList_New(n);
+        else {
+            cols[k] = column_array(dtypes[k], n);
+            if (cols[k] && PyObject_GetBuffer(cols[k], &views[k], PyBUF_WRITABLE|PyBUF_FORMAT) < 0)
+                Py_CLEAR(cols[k]);
+        }
+        if (cols[k] == NULL)
+            goto error;
     }
 
-//     if (n == nn) goto TOEND;
+    for (i = 0; i < n; i++) {
+        PyObject *row = PySequence_Fast_GET_ITEM(seq, i);
+        PyTypeObject *tp = Py_TYPE(row);
 
-//     PyTypeObject *type = Py_TYPE(op);
-//     if (type->tp_dictoffset) {
-//         PyObject **dictptr = PyDataObject_DICTPTR(type, op);
-//         PyObject* dict = NULL;
+        if (tp != type) {
+            if (!PyType_IsSubtype(tp, &PyDataObject_Type) && !PyType_IsSubtype(tp, &PyDataStruct_Type)) {
+                PyErr_Format(PyExc_TypeError, "the row is not an instance of dataobject: %s", tp->tp_name);
+                goto error;
+            }
+            if (dataobject_field_indexes(tp, names, index) < 0)
+                goto error;
+            type = tp;
+        }
 
-//         if (*dictptr)
-//             dict = *dictptr;
+        for (k = 0; k < n_names; k++) {
+            PyObject *v = PyDataObject_GET_VALUE(row, index[k]);
+            Py_buffer *view = &views[k];
 
-//         if (dict != NULL) {
-//             PyObject *iter = PyObject_GetIter(dict);
-//             PyObject *key, *val;
+            if (view->obj == NULL) {
+                Py_INCREF(v);
+                PyList_SET_ITEM(cols[k], i, v);
+            }
+            else if (column_pack(view->format[0], (char*)view->buf + i * view->itemsize, v) < 0)
+                goto error;
+        }
+    }
 
-//             i = n;
-//             while (i < nn && (key = PyIter_Next(iter))) {
-//                 val = PyObject_GetItem(dict, key);
-//                 PyTuple_SetItem(tpl, i, val);
-//                 i++;
-//                 Py_DECREF(key);                
-//             }
-//         }
-//     }
+    for (k = 0; k < n_names; k++) {
+        if (views[k].obj)
+            PyBuffer_Release(&views[k]);
+    }
+    PyMem_Free(views);
+    PyMem_Free(index);
+    return 0;
 
-// TOEND:
-    return (PyObject*)tpl;
+error:
+    for (k = 0; k < n_names; k++) {
+        if (views[k].obj)
+            PyBuffer_Release(&views[k]);
+        Py_CLEAR(cols[k]);
+    }
+    PyMem_Free(views);
+    PyMem_Free(index);
+    return -1;
 }
 
+PyDoc_STRVAR(column_doc,
+"column(rows, name, dtype=None) -- list of the values of the field `name` of the dataobjects\n"
+"(or array.array if `dtype` is the type code of the array module)");
+
 static PyObject *
-_asdict(PyObject *op)
+column(PyObject *module, PyObject *args, PyObject *kw)
 {
-    Py_ssize_t i;
-    PyObject *fn, *v;
+    static char *kwlist[] = {"rows", "name", "dtype", NULL};
+    PyObject *rows, *name, *dtype = Py_None, *seq, *names, *col = NULL;
 
-    PyObject *fields = PyObject_GetAttrString((PyObject*)Py_TYPE(op), "__fields__");
-
-    if (!fields)
+    if (!PyArg_ParseTupleAndKeywords(args, kw, "OU|O:column", kwlist, &rows, &name, &dtype))
         return NULL;
 
-    if (!PyObject_IsInstance(fields, (PyObject*)&PyTuple_Type)) {
-        PyErr_SetString(PyExc_TypeError, "__fields__ should be a tuple");
+    seq = PySequence_Fast(rows, "rows should be iterable");
+    if (seq == NULL)
+        return NULL;
+    names = PyTuple_Pack(1, name);
+    if (names == NULL) {
+        Py_DECREF(seq);
         return NULL;
     }
 
-    const Py_ssize_t n = Py_SIZE(fields);
-    PyObject *dict = PyDict_New();
-
-    if (n == 0) {
-        Py_DECREF(fields);
-        return dict;
-    }
-
-    for (i=0; i<n; i++) {
-        fn = PyTuple_GET_ITEM(fields, i);
-        Py_INCREF(fn);
-        v = PyDataObject_GET_ITEM(op, i);
-        Py_INCREF(v);
-        PyDict_SetItem(dict, fn, v);
-    }
+    rows_columns(seq, names, &col, &dtype);
 
-    Py_DECREF(fields);
-    return dict;
+    Py_DECREF(names);
+    Py_DECREF(seq);
+    return col;
 }
 
-PyDoc_STRVAR(asdict_doc,
-"Convert object to dict");
+PyDoc_STRVAR(columns_doc,
+"columns(rows, *names, dtypes=None) -- tuple of the columns of the fields `names` of the dataobjects;\n"
+"`dtypes` is a type code of the array module for all columns or a sequence of them (or None)");
 
 static PyObject *
-asdict(PyObject *module, PyObject *args)
+columns(PyObject *module, PyObject *args, PyObject *kw)
 {
-    PyObject *op;
-    // PyTypeObject *type;
-
-    op = PyTuple_GET_ITEM(args, 0);
-    // type = Py_TYPE(op);
-
-    // if (type != &PyDataObject_Type &&
-    //     !PyType_IsSubtype(type, &PyDataObject_Type)) {
-    //         PyErr_SetString(PyExc_TypeError, "1st argument is not subclass of dataobject");
-    //         return NULL;
-    // }
+    PyObject *seq, *names, *ret = NULL, *dtypes = Py_None, *dtypes_seq = NULL;
+    PyObject **cols, **dts;
+    Py_ssize_t k, n_names;
 
-    return _asdict(op);
-}
+    if (PyTuple_GET_SIZE(args) < 1) {
+        PyErr_SetString(PyExc_TypeError, "columns(rows, *names) expected rows");
+        return NULL;
+    }
+    if (kw && PyDict_GET_SIZE(kw)) {
+        dtypes = PyDict_GetItemString(kw, "dtypes");
+        if (dtypes == NULL || PyDict_GET_SIZE(kw) > 1) {
+            PyErr_SetString(PyExc_TypeError, "columns() got an unexpected keyword argument");
+            return NULL;
+        }
+    }
 
-PyDoc_STRVAR(astuple_doc,
-"Convert object to a tuple");
+    names = PyTuple_GetSlice(args, 1, PyTuple_GET_SIZE(args));
+    if (names == NULL)
+        return NULL;
+    n_names = PyTuple_GET_SIZE(names);
 
-static PyObject *
-astuple(PyObject *module, PyObject *args)
-{
-    PyObject *op;
-    // PyTypeObject *type;
+    seq = PySequence_Fast(PyTuple_GET_ITEM(args, 0), "rows should be iterable");
+    if (seq == NULL) {
+        Py_DECREF(names);
+        return NULL;
+    }
 
-    op = PyTuple_GET_ITEM(args, 0);
-    // type = Py_TYPE(op);
+    cols = PyMem_Calloc(2 * n_names + 1, sizeof(PyObject*));
+    if (cols == NULL) {
+        PyErr_NoMemory();
+        goto done;
+    }
+    dts = cols + n_names;
 
-    // PyTypeObject* tp_base = type->tp_base;
+    if (dtypes == Py_None || PyUnicode_Check(dtypes)) {
+        for (k = 0; k < n_names; k++)
+            dts[k] = dtypes;
+    }
+    else {
+        dtypes_seq = PySequence_Fast(dtypes, "dtypes should be a str or a sequence");
+        if (dtypes_seq == NULL)
+            goto done;
+        if (PySequence_Fast_GET_SIZE(dtypes_seq) != n_names) {
+            PyErr_SetString(PyExc_TypeError, "the number of dtypes should be equal to the number of names");
+            goto done;
+        }
+        for (k = 0; k < n_names; k++)
+            dts[k] = PySequence_Fast_GET_ITEM(dtypes_seq, k);
+    }
 
-    // if ((tp_base != &PyDataObject_Type) && !PyType_IsSubtype(tp_base, &PyDataObject_Type)) {
-    //         PyErr_SetString(PyExc_TypeError, "1st argument is not subclass of dataobject");
-    //         return NULL;
-    // }
+    if (rows_columns(seq, names, cols, dts) < 0)
+        goto done;
 
-    return _astuple(op);
+    ret = PyTuple_New(n_names);
+    if (ret == NULL) {
+        for (k = 0; k < n_names; k++)
+            Py_DECREF(cols[k]);
+        goto done;
+    }
+    for (k = 0; k < n_names; k++)
+        PyTuple_SET_ITEM(ret, k, cols[k]);
+
+done:
+    PyMem_Free(cols);
+    Py_XDECREF(dtypes_seq);
+    Py_DECREF(seq);
+    Py_DECREF(names);
+    return ret;
 }
 
 PyDoc_STRVAR(dataobject_make_doc,
@@ -2648,6 +9132,11 @@ dataobject_make(PyObject *module, PyObject *type_args, PyObject *kw)
     Py_XDECREF(args);
     Py_DECREF(type);
 
+    if (dataobject_intern_categorical(ret) < 0) {
+        Py_DECREF(ret);
+        return NULL;
+    }
+
     return ret;
 }
 
@@ -2666,6 +9155,10 @@ dataobject_clone(PyObject *module, PyObject *args0, PyObject *kw)
     if (kw) {
         if (_dataobject_update(new_ob, kw, 1) < 0)
             return NULL;
+        if (dataobject_intern_categorical(new_ob) < 0) {
+            Py_DECREF(new_ob);
+            return NULL;
+        }
     }
 
     return new_ob;
@@ -2690,7 +9183,8 @@ dataobject_update(PyObject *module, PyObject *args, PyObject *kw)
     while ((key = PyIter_Next(iter))) {
         val = PyObject_GetItem(kw, key);
         if (PyObject_SetAttr(op, key, val) < 0) {
-            PyErr_Format(PyExc_TypeError, "Invalid kwarg: %U not in __fields__", key);
+            if (PyErr_ExceptionMatches(PyExc_AttributeError))
+                PyErr_Format(PyExc_TypeError, "Invalid kwarg: %U not in __fields__", key);
             Py_DECREF(val);
             Py_DECREF(key);
             Py_DECREF(iter);
@@ -2762,23 +9256,37 @@ member_new(PyObject *module, PyObject *args)
         return NULL;
     }
 
+    if (!PyUnicode_Check(name)) {
+        PyErr_SetString(PyExc_TypeError, "Name should be a string");
+        return NULL;
+    }
+
+    mdef = (PyMemberDef*)PyMem_Malloc(sizeof(PyMemberDef));
+    if (mdef == NULL) {
+        PyErr_NoMemory();
+        return NULL;
+    }
+
     descr = (PyMemberDescrObject*)PyType_GenericAlloc(&PyMemberDescr_Type, 0);
     if (descr == NULL) {
-        PyErr_SetString(PyExc_ValueError, "Memory error when allocate memory for PyMemberDescrObject");
+        PyMem_Free(mdef);
         return NULL;
     }
 
+    // the name is borrowed from args, so it's interned after incref
+    Py_INCREF(name);
+    PyUnicode_InternInPlace(&name);
     Py_INCREF(type);
     descr->d_common.d_type = type;
-    PyUnicode_InternInPlace(&name);
     descr->d_common.d_name = name;
-    Py_INCREF(name);
     descr->d_common.d_qualname = NULL;
 
-    mdef = (PyMemberDef*)malloc(sizeof(PyMemberDef));
+    // The layout of the __slots__ member (T_OBJECT_EX at the absolute offset, no extra flags)
+    // is required for LOAD_ATTR_SLOT/STORE_ATTR_SLOT specializations
     mdef->name = PyUnicode_AsUTF8(name);
     if (mdef->name == NULL) {
-        PyErr_SetString(PyExc_ValueError, "Can not convert unicode string to char*");
+        PyMem_Free(mdef);
+        Py_DECREF(descr);
         return NULL;
     }
     mdef->type = T_OBJECT_EX;
@@ -2790,7 +9298,6 @@ member_new(PyObject *module, PyObject *args)
     mdef->doc = NULL;
 
     descr->d_member = mdef;
-    Py_INCREF(descr);
     return (PyObject*)descr;
 }
 
@@ -2829,6 +9336,64 @@ _is_readonly_member(PyObject *module, PyObject *args)
 PyDoc_STRVAR(is_readonly_member_doc,
 "Test property for readonly");
 
+PyDoc_STRVAR(constructor_counts_doc,
+"constructor_counts(reset=False) -> dict\n\n\
+Counts of the branches taken by the constructors of the types {cls: {name: count}}:\n\
+calls, positional (all fields are passed by position), defaults (default values are used),\n\
+factory (calls of Factory), factory_ns (time of these calls), kwargs (keyword arguments are passed),\n\
+dict_fallback (keyword arguments assigned through __dict__).\n\
+If reset is true, then the counts are set to zero after the snapshot.\n\
+Available only if recordclass is built with RECORDCLASS_INSTRUMENT defined.");
+
+static PyObject *
+constructor_counts(PyObject *module, PyObject *args, PyObject *kw)
+{
+    static char *kwlist[] = {"reset", NULL};
+    int reset = 0;
+
+    if (!PyArg_ParseTupleAndKeywords(args, kw, "|p:constructor_counts", kwlist, &reset))
+        return NULL;
+
+#ifdef RECORDCLASS_INSTRUMENT
+    PyObject *result = PyDict_New();
+    PyObject *type, *capsule;
+    Py_ssize_t pos = 0;
+
+    if (result == NULL)
+        return NULL;
+
+    if (instrument_dict == NULL)
+        return result;
+
+    while (PyDict_Next(instrument_dict, &pos, &type, &capsule)) {
+        instrument_counts *ic = (instrument_counts*)PyCapsule_GetPointer(capsule, NULL);
+        PyObject *counts = Py_BuildValue("{s:n,s:n,s:n,s:n,s:L,s:n,s:n}",
+                                         "calls", ic->calls,
+                                         "positional", ic->positional,
+                                         "defaults", ic->defaults,
+                                         "factory", ic->factory,
+                                         "factory_ns", ic->factory_ns,
+                                         "kwargs", ic->kwargs,
+                                         "dict_fallback", ic->dict_fallback);
+        if (counts == NULL || PyDict_SetItem(result, type, counts) < 0) {
+            Py_XDECREF(counts);
+            Py_DECREF(result);
+            return NULL;
+        }
+        Py_DECREF(counts);
+
+        if (reset)
+            memset(ic, 0, sizeof(instrument_counts));
+    }
+
+    return result;
+#else
+    PyErr_SetString(PyExc_RuntimeError,
+                    "recordclass is built without RECORDCLASS_INSTRUMENT");
+    return NULL;
+#endif
+}
+
 //////////////////////////////////////////////////
 
 PyDoc_STRVAR(dataobjectmodule_doc,
@@ -2837,6 +9402,17 @@ PyDoc_STRVAR(dataobjectmodule_doc,
 static PyMethodDef dataobjectmodule_methods[] = {
     {"asdict", asdict, METH_VARARGS, asdict_doc},
     {"astuple", astuple, METH_VARARGS, astuple_doc},
+    {"asdicts", asdicts, METH_O, asdicts_doc},
+    {"astuples", astuples, METH_O, astuples_doc},
+    {"tail", dataobject_tail, METH_O, dataobject_tail_doc},
+    {"changed_fields", dataobject_changed_fields, METH_O, dataobject_changed_fields_doc},
+    {"changes", dataobject_changes, METH_O, dataobject_changes_doc},
+    {"reset_changes", dataobject_reset_changes_func, METH_O, dataobject_reset_changes_doc},
+    {"diff", dataobject_diff, METH_VARARGS, dataobject_diff_doc},
+    {"diffs", dataobject_diffs, METH_VARARGS, dataobject_diffs_doc},
+    {"patch", (PyCFunction)dataobject_patch, METH_VARARGS | METH_KEYWORDS, dataobject_patch_doc},
+    {"column", (PyCFunction)column, METH_VARARGS | METH_KEYWORDS, column_doc},
+    {"columns", (PyCFunction)columns, METH_VARARGS | METH_KEYWORDS, columns_doc},
     {"_datatype_collection_mapping", _datatype_collection_mapping, METH_VARARGS, _datatype_collection_mapping_doc},
     {"_datatype_from_basetype_hashable", _datatype_from_basetype_hashable, METH_O, _datatype_from_basetype_hashable_doc},
     {"_datatype_hashable", _datatype_hashable, METH_O, _datatype_hashable_doc},
@@ -2847,8 +9423,17 @@ static PyMethodDef dataobjectmodule_methods[] = {
     {"_datatype_enable_gc", _datatype_enable_gc, METH_O, _datatype_enable_gc_doc},
     {"_datatype_deep_dealloc", _datatype_deep_dealloc, METH_O, _datatype_deep_dealloc_doc},
     {"_datatype_vectorcall", _datatype_vectorcall, METH_O, _datatype_vectorcall_doc},
+    {"_datatype_validate", _datatype_validate, METH_VARARGS, _datatype_validate_doc},
     {"_datatype_immutable", _datatype_immutable, METH_O, _datatype_immutable_doc},
     {"_datatype_copy_default", _datatype_copy_default, METH_O, _datatype_copy_default_doc},
+    {"_datatype_categorical", _datatype_categorical, METH_O, _datatype_categorical_doc},
+    {"_datatype_tail", _datatype_tail, METH_O, _datatype_tail_doc},
+    {"_datatype_inline", _datatype_inline, METH_O, _datatype_inline_doc},
+    {"_datatype_track_changes", _datatype_track_changes, METH_O, _datatype_track_changes_doc},
+    {"_datatype_stats", _datatype_stats, METH_VARARGS, _datatype_stats_doc},
+    {"_datatype_arena", _datatype_arena, METH_O, _datatype_arena_doc},
+    {"_datatype_mapping_methods", _datatype_mapping_methods, METH_O, _datatype_mapping_methods_doc},
+    {"_datatype_deferred_dealloc", _datatype_deferred_dealloc, METH_O, _datatype_deferred_dealloc_doc},
     // {"new", (PyCFunction)dataobject_new_instance, METH_VARARGS | METH_KEYWORDS, dataobject_new_doc},
     {"make", (PyCFunction)dataobject_make, METH_VARARGS | METH_KEYWORDS, dataobject_make_doc},
     {"clone", (PyCFunction)dataobject_clone, METH_VARARGS | METH_KEYWORDS, dataobject_clone_doc},
@@ -2857,6 +9442,9 @@ static PyMethodDef dataobjectmodule_methods[] = {
     {"_pytype_modified", (PyCFunction)_pytype_modified, METH_VARARGS , _pytype_modified_doc},
     {"member_new", member_new, METH_VARARGS, member_new_doc},
     {"_is_readonly_member", _is_readonly_member, METH_VARARGS, is_readonly_member_doc},
+    {"drain", drain, METH_VARARGS, drain_doc},
+    {"deferred_pending", deferred_pending, METH_NOARGS, deferred_pending_doc},
+    {"constructor_counts", (PyCFunction)constructor_counts, METH_VARARGS | METH_KEYWORDS, constructor_counts_doc},
     {0, 0, 0, 0}
 };
 
@@ -2906,8 +9494,50 @@ PyInit__dataobject(void)
     if (PyType_Ready(&PyDataObjectProperty_Type) < 0)
         Py_FatalError("Can't initialize dataobjectproperty type");
 
+    if (PyType_Ready(&PyInlineProperty_Type) < 0)
+        Py_FatalError("Can't initialize inlineproperty type");
+
+    if (PyType_Ready(&PyInlineProxy_Type) < 0)
+        Py_FatalError("Can't initialize inlineproxy type");
+
+    if (PyType_Ready(&PyBitProperty_Type) < 0)
+        Py_FatalError("Can't initialize bitproperty type");
+
+    if (PyType_Ready(&PyDataObjectSparseProperty_Type) < 0)
+        Py_FatalError("Can't initialize sparseproperty type");
+
+    if (PyType_Ready(&PyDataObjectStats_Type) < 0)
+        Py_FatalError("Can't initialize dataobjectstats type");
+
+    if (PyType_Ready(&PyDataObjectTypeInfo_Type) < 0)
+        Py_FatalError("Can't initialize typeinfo type");
+
+    if (PyType_Ready(&PyArena_Type) < 0)
+        Py_FatalError("Can't initialize arena type");
+
+    if (!PyThread_tss_is_created(&current_arena_key) && PyThread_tss_create(&current_arena_key) != 0)
+        Py_FatalError("Can't create the key of the current arena");
+
     if (PyType_Ready(&PyFactory_Type) < 0)
         Py_FatalError("Can't initialize Factory type");
+
+    if (PyType_Ready(&PyFieldGetter_Type) < 0)
+        Py_FatalError("Can't initialize fieldgetter type");
+
+    if (PyType_Ready(&PyReplacer_Type) < 0)
+        Py_FatalError("Can't initialize replacer type");
+
+    if (PyType_Ready(&PyValidator_Type) < 0)
+        Py_FatalError("Can't initialize validator type");
+
+    if (PyType_Ready(&PyDataObjectKeys_Type) < 0)
+        Py_FatalError("Can't initialize dataobject_keys type");
+
+    if (PyType_Ready(&PyDataObjectValues_Type) < 0)
+        Py_FatalError("Can't initialize dataobject_values type");
+
+    if (PyType_Ready(&PyDataObjectItems_Type) < 0)
+        Py_FatalError("Can't initialize dataobject_items type");
     
     Py_INCREF(&PyDataObject_Type);
     PyModule_AddObject(m, "dataobject", (PyObject *)&PyDataObject_Type);
@@ -2921,8 +9551,29 @@ PyInit__dataobject(void)
     Py_INCREF(&PyDataObjectProperty_Type);
     PyModule_AddObject(m, "dataobjectproperty", (PyObject *)&PyDataObjectProperty_Type);
 
+    Py_INCREF(&PyInlineProperty_Type);
+    PyModule_AddObject(m, "inlineproperty", (PyObject *)&PyInlineProperty_Type);
+
+    Py_INCREF(&PyBitProperty_Type);
+    PyModule_AddObject(m, "bitproperty", (PyObject *)&PyBitProperty_Type);
+
+    Py_INCREF(&PyDataObjectSparseProperty_Type);
+    PyModule_AddObject(m, "sparseproperty", (PyObject *)&PyDataObjectSparseProperty_Type);
+
     Py_INCREF(&PyFactory_Type);
     PyModule_AddObject(m, "Factory", (PyObject *)&PyFactory_Type);
+
+    Py_INCREF(&PyArena_Type);
+    PyModule_AddObject(m, "arena", (PyObject *)&PyArena_Type);
+
+    Py_INCREF(&PyFieldGetter_Type);
+    PyModule_AddObject(m, "fieldgetter", (PyObject *)&PyFieldGetter_Type);
+
+#ifdef RECORDCLASS_INSTRUMENT
+    PyModule_AddIntConstant(m, "INSTRUMENT", 1);
+#else
+    PyModule_AddIntConstant(m, "INSTRUMENT", 0);
+#endif
     
     // pydataobject_make = PyObject_GetAttrString(m, "make");
     // Py_INCREF(pydataobject_make);
@@ -2935,6 +9586,30 @@ PyInit__dataobject(void)
     if (__fields__name == NULL)
         return NULL;
 
+    __fields_index__name = PyUnicode_InternFromString("__fields_index__");
+    if (__fields_index__name == NULL)
+        return NULL;
+
+    __default_copy__name = PyUnicode_InternFromString("__default_copy__");
+    if (__default_copy__name == NULL)
+        return NULL;
+
+    __copy__name = PyUnicode_InternFromString("__copy__");
+    if (__copy__name == NULL)
+        return NULL;
+
+    __validator__name = PyUnicode_InternFromString("__validator__");
+    if (__validator__name == NULL)
+        return NULL;
+
+    __tail__name = PyUnicode_InternFromString("__tail__");
+    if (__tail__name == NULL)
+        return NULL;
+
+    __inline__name = PyUnicode_InternFromString("__inline__");
+    if (__inline__name == NULL)
+        return NULL;
+
     __dict__name = PyUnicode_FromString("__dict__");
     if (__dict__name == NULL)
         return NULL;
@@ -2951,6 +9626,19 @@ PyInit__dataobject(void)
     if (__init__name == NULL)
         return NULL;
 
+    __categorical_fields__name = PyUnicode_FromString("__categorical_fields__");
+    if (__categorical_fields__name == NULL)
+        return NULL;
+
+    __categorical_table__name = PyUnicode_FromString("__categorical_table__");
+    if (__categorical_table__name == NULL)
+        return NULL;
+
+
+    __stats__name = PyUnicode_FromString("__stats__");
+    if (__stats__name == NULL)
+        return NULL;
+
     empty_tuple = PyTuple_New(0);
 
     return m;
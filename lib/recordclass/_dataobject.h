@@ -3,17 +3,161 @@ typedef struct {
     PyObject *ob_items[1];
 } PyDataStruct;
 
+enum {
+    FACTORY_CALL = 0,
+    FACTORY_LIST,
+    FACTORY_DICT,
+    FACTORY_SET,
+};
+
 struct PyFactoryObject {
   PyObject_HEAD
   PyObject *factory;
+  int kind;
 };
 
 typedef struct {
     PyObject_HEAD
     Py_ssize_t index;
     int readonly;
+    PyObject *table;
 } dataobjectproperty_object;
 
+typedef struct {
+    PyObject_HEAD
+    Py_ssize_t start;       /* index of the first slot of the embedded datastruct */
+    PyTypeObject *type;     /* the datastruct class */
+    int proxy;
+    int readonly;
+} inlineproperty_object;
+
+typedef struct {
+    PyObject_HEAD
+    PyObject *ob;
+    inlineproperty_object *prop;
+} inlineproxy_object;
+
+typedef struct {
+    PyObject_HEAD
+    Py_ssize_t index;
+    Py_ssize_t offset;
+    int shift;
+    int readonly;
+    uint64_t mask;
+    uint64_t default_code;
+    PyObject *values;
+    Py_ssize_t start;
+    Py_ssize_t step;
+    Py_ssize_t count;
+} bitproperty_object;
+
+typedef struct {
+    PyObject_HEAD
+    Py_ssize_t index;
+    Py_ssize_t offset;
+    PyObject *default_value;
+    int readonly;
+} sparseproperty_object;
+
+typedef struct {
+    PyObject_HEAD
+    Py_ssize_t live;
+    Py_ssize_t allocated;
+    Py_ssize_t peak;
+    Py_ssize_t size;
+} dataobjectstats_object;
+
+// C-level information of the class, which is set up by _datatype_* functions
+// at the creation of the class and is kept in tp_cache of the type
+// (CPython doesn't use tp_cache, but releases it in type_dealloc)
+typedef struct {
+    PyObject_HEAD
+    int flags;
+    // the parts of the instances besides the slots of the fields (DATAOBJECT_L_*)
+    // and the plan (__inline__) of the classes with Inline, Packed or sparse fields
+    int layout;
+    PyObject *plan;
+    // the categorical fields: the intern table of the class (__categorical_table__),
+    // the indexes of the fields and the bitmap of the indexes (see _datatype_categorical)
+    PyObject *categorical_table;
+    Py_ssize_t *categorical_fields;
+    Py_ssize_t n_categorical;
+    unsigned char *categorical_mask;
+    // the allocation statistics of the class with stats=True (__stats__)
+    dataobjectstats_object *stats;
+} dataobjecttypeinfo_object;
+
+#define DATAOBJECT_F_MAY_UNTRACK (1 << 0)
+
+// the items of the Tail field after the fixed part (see _datatype_tail)
+#define DATAOBJECT_L_TAIL (1 << 0)
+// the fields of Inline datastructs flattened into the slots (see _datatype_inline)
+#define DATAOBJECT_L_INLINE (1 << 1)
+// the words of Packed fields after the fields, __dict__ and __weakref__
+#define DATAOBJECT_L_PACKED (1 << 2)
+// the presence bitmap and the array of the values of sparse=True class
+#define DATAOBJECT_L_SPARSE (1 << 3)
+// the bitmap of the changed fields of track_changes=True class
+#define DATAOBJECT_L_TRACKED (1 << 4)
+// the layouts described by the plan
+#define DATAOBJECT_L_PLAN (DATAOBJECT_L_INLINE | DATAOBJECT_L_PACKED | DATAOBJECT_L_SPARSE)
+
+typedef struct {
+    PyObject_VAR_HEAD
+    PyTypeObject *type;
+    PyObject *names;
+    int as_litetuple;
+#if PY_VERSION_HEX >= 0x030A0000
+    vectorcallfunc vectorcall;
+#endif
+    Py_ssize_t index[1];
+} fieldgetter_object;
+
+typedef struct {
+    PyObject_VAR_HEAD
+    PyTypeObject *type;
+    PyObject *names;
+    int inplace;
+    int categorical;
+#if PY_VERSION_HEX >= 0x030A0000
+    vectorcallfunc vectorcall;
+#endif
+    Py_ssize_t index[1];
+} replacer_object;
+
+typedef struct {
+    PyObject_HEAD
+    PyObject *ob;
+} dataobjectview_object;
+
+enum {
+    VALIDATE_ANY = 0,
+    VALIDATE_INT,
+    VALIDATE_FLOAT,
+    VALIDATE_STR,
+    VALIDATE_BYTES,
+    VALIDATE_BOOL,
+    VALIDATE_DATAOBJECT,
+    VALIDATE_INSTANCE,
+    VALIDATE_LITELIST,
+};
+
+typedef struct {
+    int kind;
+    int optional;
+    PyObject *arg;  /* the class for DATAOBJECT/INSTANCE, the validator of the items for LITELIST */
+} validate_spec;
+
+typedef struct {
+    PyObject_VAR_HEAD
+    PyObject *names;
+    initproc base_init;
+#if PY_VERSION_HEX >= 0x030A0000
+    vectorcallfunc base_vectorcall;
+#endif
+    validate_spec specs[1];
+} validator_object;
+
 
 #define PyDataObject_ITEMS(op) (PyObject**)(((PyDataStruct*)op)->ob_items)
 
@@ -23,6 +167,11 @@ typedef struct {
 #define PyDataObject_GET_ITEM(op, i) (((PyDataStruct*)(op))->ob_items[(i)])
 #define PyDataObject_SET_ITEM(op, i, v) (((PyDataStruct*)(op))->ob_items[(i)]=(v)) 
 
+// `del ob.x` of the member descriptor of the field leaves NULL in the slot;
+// the readers of the values other than the attribute take it as None
+#define PyDataObject_VALUE(v) ((v) ? (v) : Py_None)
+#define PyDataObject_GET_VALUE(op, i) PyDataObject_VALUE(PyDataObject_GET_ITEM(op, i))
+
 #define PyDataObject_DICTPTR(type, op) ((PyObject**)((char*)(op) + (type)->tp_dictoffset))
 #define PyDataObject_WEAKLISTPTR(type, op) ((PyObject**)((char*)op + type->tp_weaklistoffset))
 #define PyDataObject_HAS_DICT(type) (type->tp_dictoffset != 0)
@@ -0,0 +1,845 @@
+// The MIT License (MIT)
+
+// Copyright (c) «2015-2023» «Shibzukhov Zaur, szport at gmail dot com»
+
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software - recordclass library - and associated documentation files
+// (the "Software"), to deal in the Software without restriction, including
+// without limitation the rights to use, copy, modify, merge, publish, distribute,
+// sublicense, and/or sell copies of the Software, and to permit persons to whom
+// the Software is furnished to do so, subject to the following conditions:
+
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+
+#ifdef Py_LIMITED_API
+#undef Py_LIMITED_API
+#endif
+
+#define PY_SSIZE_T_CLEAN
+#include "Python.h"
+
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+
+// The parsing of a byte range into native values is performed without GIL
+// (so it can run on the worker threads in parallel). The result is a chunk
+// object, which creates the instances of the class later (with GIL).
+// The state of the parser is local to the call. The float values are located
+// without GIL and converted by PyOS_string_to_double (locale independent) on the
+// same thread after the GIL is acquired again (its caches require the GIL).
+
+#if PY_VERSION_HEX < 0x03080000
+#define PyObject_Vectorcall(func, args, nargs, kwnames) _PyObject_FastCall((func), (args), (nargs))
+#elif PY_VERSION_HEX < 0x03090000
+#define PyObject_Vectorcall _PyObject_Vectorcall
+#endif
+
+#define CELL_VALUE 0
+#define CELL_NULL 1
+#define CELL_ESCAPED 2
+
+typedef struct {
+    union {
+        long long i;
+        unsigned long long u;
+        double f;
+        struct {
+            Py_ssize_t offset;
+            Py_ssize_t size;
+        } span;
+    } v;
+    char state;
+} ingest_cell;
+
+typedef struct {
+    PyObject_HEAD
+    Py_buffer view;
+    Py_ssize_t n_rows;
+    Py_ssize_t n_fields;
+    char *kinds;
+    ingest_cell *cells;
+    char quotechar;
+} PyIngestChunkObject;
+
+static PyTypeObject PyIngestChunk_Type;
+
+typedef struct {
+    ingest_cell *cells;
+    Py_ssize_t n_rows;
+    Py_ssize_t capacity;
+    Py_ssize_t n_fields;
+    Py_ssize_t error_pos;
+    const char *error;
+} ingest_state;
+
+static ingest_cell *
+ingest_new_row(ingest_state *st)
+{
+    if (st->n_rows == st->capacity) {
+        Py_ssize_t capacity = st->capacity ? 2 * st->capacity : 1024;
+        ingest_cell *cells = (ingest_cell*)PyMem_RawRealloc(st->cells,
+                               capacity * st->n_fields * sizeof(ingest_cell));
+        if (cells == NULL) {
+            st->error = "out of memory";
+            return NULL;
+        }
+        st->cells = cells;
+        st->capacity = capacity;
+    }
+    return st->cells + (st->n_rows++) * st->n_fields;
+}
+
+/////////////////////// text converters (without GIL) ////////////////////
+
+static int
+is_space(char c)
+{
+    return c == ' ' || c == '\t';
+}
+
+static void
+strip_spaces(const char **p, const char **end)
+{
+    while (*p < *end && is_space(**p))
+        (*p)++;
+    while (*end > *p && is_space((*end)[-1]))
+        (*end)--;
+}
+
+static const char *
+text_to_int(const char *p, const char *end, ingest_cell *cell)
+{
+    unsigned long long val = 0, limit = (unsigned long long)LLONG_MAX;
+    int negative = 0;
+
+    strip_spaces(&p, &end);
+    if (p == end) {
+        cell->state = CELL_NULL;
+        return NULL;
+    }
+    if (*p == '-' || *p == '+') {
+        negative = (*p == '-');
+        if (negative)
+            limit += 1;
+        p++;
+    }
+    if (p == end)
+        return "invalid integer";
+    for (; p < end; p++) {
+        unsigned int d = (unsigned char)*p - '0';
+        if (d > 9)
+            return "invalid integer";
+        if (val > (limit - d) / 10)
+            return "integer is out of range";
+        val = val * 10 + d;
+    }
+    cell->v.i = negative ? (long long)(0 - val) : (long long)val;
+    cell->state = CELL_VALUE;
+    return NULL;
+}
+
+// the span of the value, which is converted by text_convert_floats
+static const char *
+text_to_float(const char *base, const char *p, const char *end, ingest_cell *cell)
+{
+    strip_spaces(&p, &end);
+    if (p == end) {
+        cell->state = CELL_NULL;
+        return NULL;
+    }
+    if (end - p >= 64)
+        return "invalid float";
+    cell->v.span.offset = p - base;
+    cell->v.span.size = end - p;
+    cell->state = CELL_VALUE;
+    return NULL;
+}
+
+static int
+text_equal(const char *p, Py_ssize_t size, const char *s)
+{
+    Py_ssize_t i;
+
+    for (i = 0; i < size; i++) {
+        char c = p[i];
+        if (s[i] == 0)
+            return 0;
+        if (c >= 'A' && c <= 'Z')
+            c += 'a' - 'A';
+        if (c != s[i])
+            return 0;
+    }
+    return s[i] == 0;
+}
+
+static const char *
+text_to_bool(const char *p, const char *end, ingest_cell *cell)
+{
+    Py_ssize_t size;
+
+    strip_spaces(&p, &end);
+    size = end - p;
+    if (size == 0) {
+        cell->state = CELL_NULL;
+        return NULL;
+    }
+    if (text_equal(p, size, "1") || text_equal(p, size, "true"))
+        cell->v.i = 1;
+    else if (text_equal(p, size, "0") || text_equal(p, size, "false"))
+        cell->v.i = 0;
+    else
+        return "invalid bool";
+    cell->state = CELL_VALUE;
+    return NULL;
+}
+
+static const char *
+text_convert(char kind, const char *base, const char *p, const char *end, int escaped, ingest_cell *cell)
+{
+    switch (kind) {
+    case 'i':
+        return text_to_int(p, end, cell);
+    case 'f':
+        return text_to_float(base, p, end, cell);
+    case '?':
+        return text_to_bool(p, end, cell);
+    default:
+        cell->v.span.offset = p - base;
+        cell->v.span.size = end - p;
+        cell->state = escaped ? CELL_ESCAPED : CELL_VALUE;
+        return NULL;
+    }
+}
+
+// with GIL: replace the spans of the float values by the values
+static void
+text_convert_floats(ingest_state *st, const char *base, const char *kinds)
+{
+    Py_ssize_t n_fields = st->n_fields;
+    Py_ssize_t n = st->n_rows * n_fields, k;
+    char buf[64];
+
+    for (k = 0; k < n; k++) {
+        ingest_cell *cell = st->cells + k;
+        Py_ssize_t offset, size;
+        double x;
+
+        if (kinds[k % n_fields] != 'f' || cell->state != CELL_VALUE)
+            continue;
+
+        offset = cell->v.span.offset;
+        size = cell->v.span.size;
+        memcpy(buf, base + offset, size);
+        buf[size] = 0;
+        x = PyOS_string_to_double(buf, NULL, NULL);
+        if (x == -1.0 && PyErr_Occurred()) {
+            st->error = PyErr_ExceptionMatches(PyExc_MemoryError) ? "out of memory" : "invalid float";
+            st->error_pos = offset;
+            PyErr_Clear();
+            return;
+        }
+        cell->v.f = x;
+    }
+}
+
+/////////////////////// csv parser (without GIL) /////////////////////////
+
+static void
+parse_csv(ingest_state *st, const char *base, Py_ssize_t start, Py_ssize_t stop,
+          char delimiter, char quotechar, const char *kinds,
+          const Py_ssize_t *field_of_column, Py_ssize_t n_columns)
+{
+    const char *p = base + start;
+    const char *end = base + stop;
+    Py_ssize_t n_fields = st->n_fields;
+
+    while (p < end) {
+        const char *line = p;
+        ingest_cell *row;
+        Py_ssize_t col = 0, n_filled = 0;
+
+        if (*p == '\n') {
+            p++;
+            continue;
+        }
+        if (*p == '\r' && (p + 1 == end || p[1] == '\n')) {
+            p += (p + 1 == end) ? 1 : 2;
+            continue;
+        }
+
+        row = ingest_new_row(st);
+        if (row == NULL)
+            return;
+
+        for (;;) {
+            const char *f_start, *f_end;
+            int escaped = 0, at_eol;
+
+            if (quotechar && p < end && *p == quotechar) {
+                f_start = ++p;
+                for (;;) {
+                    if (p == end) {
+                        st->error = "unterminated quoted field";
+                        st->error_pos = line - base;
+                        return;
+                    }
+                    if (*p == quotechar) {
+                        if (p + 1 < end && p[1] == quotechar) {
+                            escaped = 1;
+                            p += 2;
+                            continue;
+                        }
+                        break;
+                    }
+                    p++;
+                }
+                f_end = p++;
+                if (p < end && *p != delimiter && *p != '\n' && *p != '\r') {
+                    st->error = "unexpected character after quoted field";
+                    st->error_pos = line - base;
+                    return;
+                }
+            } else {
+                f_start = p;
+                while (p < end && *p != delimiter && *p != '\n')
+                    p++;
+                f_end = p;
+                if (f_end > f_start && f_end[-1] == '\r' && (p == end || *p == '\n'))
+                    f_end--;
+            }
+
+            if (col < n_columns) {
+                Py_ssize_t i = field_of_column[col];
+                if (i >= 0) {
+                    const char *error = text_convert(kinds[i], base, f_start, f_end, escaped, row + i);
+                    if (error) {
+                        st->error = error;
+                        st->error_pos = f_start - base;
+                        return;
+                    }
+                    n_filled++;
+                }
+            }
+            col++;
+
+            if (p < end && *p == '\r')
+                p++;
+            at_eol = (p == end || *p == '\n');
+            if (p < end)
+                p++;
+            if (at_eol)
+                break;
+        }
+
+        if (n_filled != n_fields) {
+            st->error = "too few columns in the row";
+            st->error_pos = line - base;
+            return;
+        }
+    }
+}
+
+/////////////////////// binary parser (without GIL) //////////////////////
+
+typedef struct {
+    Py_ssize_t offset;
+    Py_ssize_t size;
+    char kind;
+} binary_field;
+
+static void
+parse_binary(ingest_state *st, const char *base, Py_ssize_t start, Py_ssize_t stop,
+             Py_ssize_t record_size, const binary_field *layout, int swap)
+{
+    const char *p = base + start;
+    const char *end = base + stop;
+    Py_ssize_t n_fields = st->n_fields;
+
+    if ((stop - start) % record_size) {
+        st->error = "the size of the range is not multiple of the record size";
+        st->error_pos = start;
+        return;
+    }
+
+    for (; p < end; p += record_size) {
+        ingest_cell *row = ingest_new_row(st);
+        Py_ssize_t i;
+
+        if (row == NULL)
+            return;
+
+        for (i = 0; i < n_fields; i++) {
+            const binary_field *fd = layout + i;
+            const unsigned char *q = (const unsigned char*)p + fd->offset;
+            ingest_cell *cell = row + i;
+            unsigned char buf[8];
+            unsigned long long u = 0;
+            Py_ssize_t k;
+
+            cell->state = CELL_VALUE;
+            if (fd->kind == 'b') {
+                cell->v.span.offset = (const char*)q - base;
+                cell->v.span.size = fd->size;
+                continue;
+            }
+
+            if (swap) {
+                for (k = 0; k < fd->size; k++)
+                    buf[k] = q[fd->size - 1 - k];
+            } else
+                memcpy(buf, q, fd->size);
+
+            switch (fd->kind) {
+            case 'f':
+                if (fd->size == 4) {
+                    float x;
+                    memcpy(&x, buf, 4);
+                    cell->v.f = x;
+                } else
+                    memcpy(&cell->v.f, buf, 8);
+                break;
+            case 'i':
+            case 'u':
+            case '?':
+                {
+                    uint8_t b1; uint16_t b2; uint32_t b4; uint64_t b8;
+                    switch (fd->size) {
+                    case 1: memcpy(&b1, buf, 1); u = b1; break;
+                    case 2: memcpy(&b2, buf, 2); u = b2; break;
+                    case 4: memcpy(&b4, buf, 4); u = b4; break;
+                    default: memcpy(&b8, buf, 8); u = b8; break;
+                    }
+                }
+                if (fd->kind == 'i' && fd->size < 8 && (u >> (8 * fd->size - 1)) & 1)
+                    u |= ~0ULL << (8 * fd->size);
+                if (fd->kind == '?')
+                    u = (u != 0);
+                cell->v.u = u;
+                break;
+            }
+        }
+    }
+}
+
+/////////////////////// chunk //////////////////////////////////////////
+
+static PyIngestChunkObject *
+chunk_new(PyObject *source)
+{
+    PyIngestChunkObject *chunk = PyObject_New(PyIngestChunkObject, &PyIngestChunk_Type);
+
+    if (chunk == NULL)
+        return NULL;
+
+    chunk->n_rows = 0;
+    chunk->n_fields = 0;
+    chunk->kinds = NULL;
+    chunk->cells = NULL;
+    chunk->quotechar = 0;
+    if (PyObject_GetBuffer(source, &chunk->view, PyBUF_SIMPLE) < 0) {
+        chunk->view.obj = NULL;
+        Py_DECREF(chunk);
+        return NULL;
+    }
+    return chunk;
+}
+
+static void
+chunk_dealloc(PyIngestChunkObject *chunk)
+{
+    if (chunk->view.obj)
+        PyBuffer_Release(&chunk->view);
+    PyMem_RawFree(chunk->cells);
+    PyMem_Free(chunk->kinds);
+    PyObject_Del(chunk);
+}
+
+static Py_ssize_t
+chunk_len(PyIngestChunkObject *chunk)
+{
+    return chunk->n_rows;
+}
+
+static PyObject *
+chunk_unescape(PyIngestChunkObject *chunk, const char *p, Py_ssize_t size, char kind)
+{
+    char *buf = (char*)PyMem_Malloc(size ? size : 1);
+    Py_ssize_t i, n = 0;
+    PyObject *ret;
+
+    if (buf == NULL)
+        return PyErr_NoMemory();
+
+    for (i = 0; i < size; i++) {
+        buf[n++] = p[i];
+        if (p[i] == chunk->quotechar && i + 1 < size && p[i+1] == chunk->quotechar)
+            i++;
+    }
+    if (kind == 'b')
+        ret = PyBytes_FromStringAndSize(buf, n);
+    else
+        ret = PyUnicode_DecodeUTF8(buf, n, "strict");
+    PyMem_Free(buf);
+    return ret;
+}
+
+static PyObject *
+chunk_value(PyIngestChunkObject *chunk, char kind, ingest_cell *cell)
+{
+    const char *base = (const char*)chunk->view.buf;
+
+    if (cell->state == CELL_NULL)
+        Py_RETURN_NONE;
+
+    switch (kind) {
+    case 'i':
+        return PyLong_FromLongLong(cell->v.i);
+    case 'u':
+        return PyLong_FromUnsignedLongLong(cell->v.u);
+    case 'f':
+        return PyFloat_FromDouble(cell->v.f);
+    case '?':
+        return PyBool_FromLong((long)cell->v.i);
+    default:
+        if (cell->state == CELL_ESCAPED)
+            return chunk_unescape(chunk, base + cell->v.span.offset, cell->v.span.size, kind);
+        if (kind == 'b')
+            return PyBytes_FromStringAndSize(base + cell->v.span.offset, cell->v.span.size);
+        return PyUnicode_DecodeUTF8(base + cell->v.span.offset, cell->v.span.size, "strict");
+    }
+}
+
+PyDoc_STRVAR(chunk_build_doc,
+"C.build(cls) -- create the list of the instances of cls from the parsed rows");
+
+static PyObject *
+chunk_build(PyIngestChunkObject *chunk, PyObject *cls)
+{
+    Py_ssize_t n_fields = chunk->n_fields;
+    Py_ssize_t row, i;
+    PyObject **values;
+    PyObject *result;
+
+    values = (PyObject**)PyMem_Calloc(n_fields ? n_fields : 1, sizeof(PyObject*));
+    if (values == NULL)
+        return PyErr_NoMemory();
+
+    result = PyList_New(chunk->n_rows);
+    if (result == NULL)
+        goto done;
+
+    for (row = 0; row < chunk->n_rows; row++) {
+        ingest_cell *cells = chunk->cells + row * n_fields;
+        PyObject *ob;
+
+        for (i = 0; i < n_fields; i++) {
+            values[i] = chunk_value(chunk, chunk->kinds[i], cells + i);
+            if (values[i] == NULL) {
+                while (i-- > 0)
+                    Py_CLEAR(values[i]);
+                Py_CLEAR(result);
+                goto done;
+            }
+        }
+
+        ob = PyObject_Vectorcall(cls, values, n_fields, NULL);
+        for (i = 0; i < n_fields; i++)
+            Py_CLEAR(values[i]);
+        if (ob == NULL) {
+            Py_CLEAR(result);
+            goto done;
+        }
+        PyList_SET_ITEM(result, row, ob);
+    }
+
+done:
+    PyMem_Free(values);
+    return result;
+}
+
+static PyMethodDef chunk_methods[] = {
+    {"build", (PyCFunction)chunk_build, METH_O, chunk_build_doc},
+    {NULL}
+};
+
+static PySequenceMethods chunk_as_sequence = {
+    (lenfunc)chunk_len,                       /* sq_length */
+};
+
+PyDoc_STRVAR(chunk_doc,
+"Rows of a byte range parsed into native values");
+
+static PyTypeObject PyIngestChunk_Type = {
+    PyVarObject_HEAD_INIT(NULL, 0)
+    .tp_name = "recordclass._ingest.chunk",
+    .tp_basicsize = sizeof(PyIngestChunkObject),
+    .tp_dealloc = (destructor)chunk_dealloc,
+    .tp_as_sequence = &chunk_as_sequence,
+    .tp_flags = Py_TPFLAGS_DEFAULT,
+    .tp_doc = chunk_doc,
+    .tp_methods = chunk_methods,
+};
+
+static int
+chunk_check_range(PyIngestChunkObject *chunk, Py_ssize_t start, Py_ssize_t stop)
+{
+    if (start < 0 || stop < start || stop > chunk->view.len) {
+        PyErr_Format(PyExc_ValueError, "invalid byte range [%zd, %zd)", start, stop);
+        return -1;
+    }
+    return 0;
+}
+
+static PyObject *
+chunk_finish(PyIngestChunkObject *chunk, ingest_state *st)
+{
+    chunk->cells = st->cells;
+    chunk->n_rows = st->n_rows;
+    if (st->error) {
+        if (strcmp(st->error, "out of memory") == 0)
+            PyErr_NoMemory();
+        else
+            PyErr_Format(PyExc_ValueError, "%s at offset %zd", st->error, st->error_pos);
+        Py_DECREF(chunk);
+        return NULL;
+    }
+    return (PyObject*)chunk;
+}
+
+//////////////////// module level functions //////////////////////////////
+
+PyDoc_STRVAR(_parse_csv_doc,
+"_parse_csv(source, start, stop, delimiter, quotechar, kinds, columns) -> chunk\n\n\
+Parse the rows of csv text in the byte range [start, stop) of the source buffer.\n\
+kinds is a string with the kind ('i', 'f', '?', 's', 'b') of each field and\n\
+columns is a tuple with the column index of each field.");
+
+static PyObject *
+_parse_csv(PyObject *module, PyObject *args)
+{
+    PyObject *source, *columns;
+    Py_ssize_t start, stop, i, n_fields, n_columns = 0;
+    const char *delimiter, *quotechar, *kinds;
+    Py_ssize_t delimiter_size, quotechar_size, kinds_size;
+    Py_ssize_t *field_of_column = NULL;
+    PyIngestChunkObject *chunk;
+    ingest_state st = {NULL, 0, 0, 0, 0, NULL};
+
+    if (!PyArg_ParseTuple(args, "Onns#s#s#O!", &source, &start, &stop,
+                          &delimiter, &delimiter_size, &quotechar, &quotechar_size,
+                          &kinds, &kinds_size, &PyTuple_Type, &columns))
+        return NULL;
+
+    if (delimiter_size != 1 || quotechar_size > 1) {
+        PyErr_SetString(PyExc_ValueError, "delimiter and quotechar should be one character strings");
+        return NULL;
+    }
+    n_fields = PyTuple_GET_SIZE(columns);
+    if (kinds_size != n_fields) {
+        PyErr_SetString(PyExc_ValueError, "kinds and columns should have the same length");
+        return NULL;
+    }
+
+    chunk = chunk_new(source);
+    if (chunk == NULL)
+        return NULL;
+    if (chunk_check_range(chunk, start, stop) < 0)
+        goto error;
+
+    chunk->n_fields = n_fields;
+    chunk->quotechar = quotechar_size ? quotechar[0] : 0;
+    chunk->kinds = (char*)PyMem_Malloc(n_fields ? n_fields : 1);
+    if (chunk->kinds == NULL) {
+        PyErr_NoMemory();
+        goto error;
+    }
+    memcpy(chunk->kinds, kinds, n_fields);
+
+    for (i = 0; i < n_fields; i++) {
+        Py_ssize_t col = PyLong_AsSsize_t(PyTuple_GET_ITEM(columns, i));
+        if (col < 0) {
+            if (!PyErr_Occurred())
+                PyErr_SetString(PyExc_ValueError, "column index should not be negative");
+            goto error;
+        }
+        if (!strchr("if?sb", kinds[i])) {
+            PyErr_Format(PyExc_ValueError, "invalid kind '%c'", kinds[i]);
+            goto error;
+        }
+        if (col >= n_columns)
+            n_columns = col + 1;
+    }
+
+    field_of_column = (Py_ssize_t*)PyMem_Malloc((n_columns ? n_columns : 1) * sizeof(Py_ssize_t));
+    if (field_of_column == NULL) {
+        PyErr_NoMemory();
+        goto error;
+    }
+    for (i = 0; i < n_columns; i++)
+        field_of_column[i] = -1;
+    for (i = 0; i < n_fields; i++) {
+        Py_ssize_t col = PyLong_AsSsize_t(PyTuple_GET_ITEM(columns, i));
+        if (field_of_column[col] >= 0) {
+            PyErr_SetString(PyExc_ValueError, "the column is used for several fields");
+            goto error;
+        }
+        field_of_column[col] = i;
+    }
+
+    st.n_fields = n_fields;
+
+    Py_BEGIN_ALLOW_THREADS
+    parse_csv(&st, (const char*)chunk->view.buf, start, stop,
+              delimiter[0], chunk->quotechar, chunk->kinds, field_of_column, n_columns);
+    Py_END_ALLOW_THREADS
+
+    if (st.error == NULL)
+        text_convert_floats(&st, (const char*)chunk->view.buf, chunk->kinds);
+
+    PyMem_Free(field_of_column);
+    return chunk_finish(chunk, &st);
+
+error:
+    PyMem_Free(field_of_column);
+    Py_DECREF(chunk);
+    return NULL;
+}
+
+PyDoc_STRVAR(_parse_binary_doc,
+"_parse_binary(source, start, stop, record_size, layout, swap) -> chunk\n\n\
+Parse the fixed size records in the byte range [start, stop) of the source buffer.\n\
+layout is a tuple of (offset, kind, size) of each field, where kind is one of\n\
+'i' (signed), 'u' (unsigned), 'f' (float), '?' (bool), 'b' (bytes).");
+
+static PyObject *
+_parse_binary(PyObject *module, PyObject *args)
+{
+    PyObject *source, *layout;
+    Py_ssize_t start, stop, record_size, i, n_fields;
+    int swap;
+    binary_field *fields = NULL;
+    PyIngestChunkObject *chunk;
+    ingest_state st = {NULL, 0, 0, 0, 0, NULL};
+
+    if (!PyArg_ParseTuple(args, "OnnnO!p", &source, &start, &stop, &record_size,
+                          &PyTuple_Type, &layout, &swap))
+        return NULL;
+
+    if (record_size <= 0) {
+        PyErr_SetString(PyExc_ValueError, "record size should be positive");
+        return NULL;
+    }
+
+    chunk = chunk_new(source);
+    if (chunk == NULL)
+        return NULL;
+    if (chunk_check_range(chunk, start, stop) < 0)
+        goto error;
+
+    n_fields = PyTuple_GET_SIZE(layout);
+    chunk->n_fields = n_fields;
+    chunk->kinds = (char*)PyMem_Malloc(n_fields ? n_fields : 1);
+    fields = (binary_field*)PyMem_Malloc((n_fields ? n_fields : 1) * sizeof(binary_field));
+    if (chunk->kinds == NULL || fields == NULL) {
+        PyErr_NoMemory();
+        goto error;
+    }
+
+    for (i = 0; i < n_fields; i++) {
+        binary_field *fd = fields + i;
+        const char *kind;
+        int valid;
+
+        if (!PyArg_ParseTuple(PyTuple_GET_ITEM(layout, i), "nsn", &fd->offset, &kind, &fd->size))
+            goto error;
+        fd->kind = kind[0];
+        switch (fd->kind) {
+        case 'i': case 'u': case '?':
+            valid = fd->size == 1 || fd->size == 2 || fd->size == 4 || fd->size == 8;
+            break;
+        case 'f':
+            valid = fd->size == 4 || fd->size == 8;
+            break;
+        case 'b':
+            valid = fd->size >= 0;
+            break;
+        default:
+            valid = 0;
+        }
+        if (!valid || kind[1] != 0 || fd->offset < 0 || fd->offset + fd->size > record_size) {
+            PyErr_Format(PyExc_ValueError, "invalid layout of the field %zd", i);
+            goto error;
+        }
+        chunk->kinds[i] = fd->kind;
+    }
+
+    st.n_fields = n_fields;
+
+    Py_BEGIN_ALLOW_THREADS
+    parse_binary(&st, (const char*)chunk->view.buf, start, stop, record_size, fields, swap);
+    Py_END_ALLOW_THREADS
+
+    PyMem_Free(fields);
+    return chunk_finish(chunk, &st);
+
+error:
+    PyMem_Free(fields);
+    Py_DECREF(chunk);
+    return NULL;
+}
+
+PyDoc_STRVAR(ingestmodule_doc,
+"_ingest module provide parsing of csv/binary data into native values without GIL.");
+
+static PyMethodDef ingestmodule_methods[] = {
+    {"_parse_csv", _parse_csv, METH_VARARGS, _parse_csv_doc},
+    {"_parse_binary", _parse_binary, METH_VARARGS, _parse_binary_doc},
+    {0, 0, 0, 0}
+};
+
+static struct PyModuleDef ingestmodule = {
+    PyModuleDef_HEAD_INIT,
+    "recordclass._ingest",
+    ingestmodule_doc,
+    -1,
+    ingestmodule_methods,
+    NULL,
+    NULL,
+    NULL,
+    NULL
+};
+
+PyMODINIT_FUNC
+PyInit__ingest(void)
+{
+    PyObject *m;
+
+    m = PyState_FindModule(&ingestmodule);
+    if (m) {
+        Py_INCREF(m);
+        return m;
+    }
+
+    m = PyModule_Create(&ingestmodule);
+    if (m == NULL)
+        return NULL;
+
+    if (PyType_Ready(&PyIngestChunk_Type) < 0)
+        Py_FatalError("Can't initialize chunk type");
+
+#ifdef Py_GIL_DISABLED
+    PyUnstable_Module_SetGIL(m, Py_MOD_GIL_NOT_USED);
+#endif
+
+    return m;
+}
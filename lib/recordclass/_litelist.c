@@ -560,7 +560,7 @@ litelist_sizeof(PyLiteListObject *self)
 {
     Py_ssize_t res;
 
-    res = PyLiteList_Type.tp_basicsize + Py_SIZE(self) * sizeof(PyObject*);
+    res = PyLiteList_Type.tp_basicsize + self->allocated * sizeof(PyObject*);
     return PyLong_FromSsize_t(res);
 }
 
@@ -810,6 +810,9 @@ static PyMethodDef litelist_methods[] = {
     {"__bool__", (PyCFunction)litelist_bool, METH_NOARGS, litelist_bool_doc},
     {"__sizeof__",      (PyCFunction)litelist_sizeof, METH_NOARGS, litelist_sizeof_doc},     
     {"__reduce__", (PyCFunction)litelist_reduce, METH_NOARGS, litelist_reduce_doc},
+#if PY_VERSION_HEX >= 0x03090000
+    {"__class_getitem__", Py_GenericAlias, METH_O|METH_CLASS, PyDoc_STR("See PEP 585")},
+#endif
     {NULL}
 };
 
@@ -0,0 +1,648 @@
+// Copyright (c) «2015-2023» «Shibzukhov Zaur, szport at gmail dot com»
+
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software - recordclass library - and associated documentation files
+// (the "Software"), to deal in the Software without restriction, including
+// without limitation the rights to use, copy, modify, merge, publish, distribute,
+// sublicense, and/or sell copies of the Software, and to permit persons to whom
+// the Software is furnished to do so, subject to the following conditions:
+
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+
+#ifdef Py_LIMITED_API
+#undef Py_LIMITED_API
+#endif
+
+#include "Python.h"
+#include "_dataobject.h"
+
+#include <string.h>
+
+static PyTypeObject *dataobject_type;
+static PyTypeObject *datastruct_type;
+static PyTypeObject *litelist_type;
+static PyTypeObject *litetuple_type;
+static PyTypeObject *mutabletuple_type;
+static PyTypeObject *sparseproperty_type;
+static PyObject *sys_getsizeof;
+static Py_ssize_t gc_head_size;
+
+static PyObject *
+get_module_object(const char *modname, const char *attrname)
+{
+    PyObject *mod, *ob;
+
+    mod = PyImport_ImportModule(modname);
+    if (mod == NULL)
+        return NULL;
+    ob = PyObject_GetAttrString(mod, attrname);
+    Py_DECREF(mod);
+    return ob;
+}
+
+//////////////////////// pointer tables ////////////////////////////////
+
+// Open addressing hash tables with pointers as keys:
+// the set of visited objects and the table of the types.
+
+static inline size_t
+ptr_hash(void *key)
+{
+    size_t h = (size_t)key;
+    // the pointers are aligned, so mix the high bits into the low ones
+    h ^= h >> 4;
+    h *= (size_t)0x9E3779B97F4A7C15ULL;
+    return h ^ (h >> 29);
+}
+
+typedef struct {
+    void **keys;
+    size_t mask;
+    size_t used;
+} ptr_set;
+
+static int
+ptr_set_init(ptr_set *t, size_t capacity)
+{
+    t->keys = PyMem_Calloc(capacity, sizeof(void*));
+    if (t->keys == NULL) {
+        PyErr_NoMemory();
+        return -1;
+    }
+    t->mask = capacity - 1;
+    t->used = 0;
+    return 0;
+}
+
+// Returns 1 if the key is added, 0 if it is already in the set, -1 on memory error
+static int
+ptr_set_add(ptr_set *t, void *key)
+{
+    size_t j;
+
+    if (2 * (t->used + 1) > t->mask + 1) {
+        void **old = t->keys;
+        size_t i, old_capacity = t->mask + 1;
+
+        if (ptr_set_init(t, old_capacity * 2) < 0) {
+            t->keys = old;
+            return -1;
+        }
+        for (i = 0; i < old_capacity; i++) {
+            if (old[i]) {
+                j = ptr_hash(old[i]) & t->mask;
+                while (t->keys[j])
+                    j = (j + 1) & t->mask;
+                t->keys[j] = old[i];
+                t->used++;
+            }
+        }
+        PyMem_Free(old);
+    }
+
+    j = ptr_hash(key) & t->mask;
+    while (t->keys[j]) {
+        if (t->keys[j] == key)
+            return 0;
+        j = (j + 1) & t->mask;
+    }
+    t->keys[j] = key;
+    t->used++;
+    return 1;
+}
+
+// The way to compute the size of the instances of the type and to walk their referents
+
+enum {
+    SIZE_FIXED,     // size is constant
+    SIZE_METHOD,    // C implementation of __sizeof__ + extra
+    SIZE_GETSIZEOF, // sys.getsizeof
+};
+
+enum {
+    WALK_NONE,
+    WALK_DATAOBJECT,
+    WALK_DATAOBJECT_TAIL,   // the items of the Tail field follow the fixed part
+    WALK_DATAOBJECT_SPARSE, // the values of the sparse fields are in the separate array
+    WALK_TUPLE,
+    WALK_LIST,
+    WALK_DICT,
+    WALK_SET,
+};
+
+typedef struct {
+    PyTypeObject *type;
+    int size_kind;
+    int walk_kind;
+    Py_ssize_t size;
+    PyCFunction sizeof_func;
+    Py_ssize_t n_words;     // the words of the presence bitmap of the sparse record
+    Py_ssize_t count;
+    Py_ssize_t total;
+} type_entry;
+
+typedef struct {
+    type_entry *entries;
+    size_t mask;
+    size_t used;
+} type_table;
+
+static PyObject *__sizeof__name;
+static PyObject *__tail__name;
+static PyObject *__inline__name;
+static PyCFunction object_sizeof_func;
+
+static int
+type_table_init(type_table *t, size_t capacity)
+{
+    t->entries = PyMem_Calloc(capacity, sizeof(type_entry));
+    if (t->entries == NULL) {
+        PyErr_NoMemory();
+        return -1;
+    }
+    t->mask = capacity - 1;
+    t->used = 0;
+    return 0;
+}
+
+static PyCFunction
+c_sizeof_func(PyTypeObject *type)
+{
+    PyObject *descr = _PyType_Lookup(type, __sizeof__name);
+
+    if (descr && Py_TYPE(descr) == &PyMethodDescr_Type) {
+        PyMethodDef *meth = ((PyMethodDescrObject*)descr)->d_method;
+        if ((meth->ml_flags & (METH_VARARGS | METH_KEYWORDS | METH_O | METH_NOARGS)) == METH_NOARGS)
+            return meth->ml_meth;
+    }
+    return NULL;
+}
+
+// The number of the words of the presence bitmap if all fields in __inline__ are sparse, else 0
+static Py_ssize_t
+sparse_n_words(PyTypeObject *type)
+{
+    PyObject *plan = PyDict_GetItem(type->tp_dict, __inline__name);
+    Py_ssize_t i, n;
+
+    if (plan == NULL || !PyTuple_Check(plan) || (n = PyTuple_GET_SIZE(plan)) == 0)
+        return 0;
+    for (i = 0; i < n; i++) {
+        PyObject *e = PyTuple_GET_ITEM(plan, i);
+        if (!PyTuple_Check(e) || PyTuple_GET_SIZE(e) != 2 ||
+                Py_TYPE(PyTuple_GET_ITEM(e, 1)) != sparseproperty_type)
+            return 0;
+    }
+    return (n + 63) / 64;
+}
+
+static void
+type_entry_fill(type_entry *e, PyTypeObject *type)
+{
+    Py_ssize_t gc_size = PyType_IS_GC(type) ? gc_head_size : 0;
+    PyCFunction func;
+
+    e->type = type;
+
+    if (PyType_IsSubtype(type, dataobject_type) || PyType_IsSubtype(type, datastruct_type))
+        e->walk_kind = WALK_DATAOBJECT;
+    else if (PyType_IsSubtype(type, &PyTuple_Type) ||
+             PyType_IsSubtype(type, litetuple_type) || PyType_IsSubtype(type, mutabletuple_type))
+        e->walk_kind = WALK_TUPLE;
+    else if (PyType_IsSubtype(type, &PyList_Type) || PyType_IsSubtype(type, litelist_type))
+        // litelist has the layout of list
+        e->walk_kind = WALK_LIST;
+    else if (PyType_IsSubtype(type, &PyDict_Type))
+        e->walk_kind = WALK_DICT;
+    else if (PyType_IsSubtype(type, &PySet_Type) || PyType_IsSubtype(type, &PyFrozenSet_Type))
+        e->walk_kind = WALK_SET;
+    else
+        e->walk_kind = WALK_NONE;
+
+    e->size_kind = SIZE_GETSIZEOF;
+    if (e->walk_kind == WALK_DATAOBJECT) {
+        if (PyDict_GetItem(type->tp_dict, __tail__name) && (func = c_sizeof_func(type))) {
+            e->walk_kind = WALK_DATAOBJECT_TAIL;
+            e->size_kind = SIZE_METHOD;
+            e->size = gc_size;
+            e->sizeof_func = func;
+            return;
+        }
+        if ((e->n_words = sparse_n_words(type)) && (func = c_sizeof_func(type))) {
+            e->walk_kind = WALK_DATAOBJECT_SPARSE;
+            e->size_kind = SIZE_METHOD;
+            e->size = gc_size;
+            e->sizeof_func = func;
+            return;
+        }
+        e->size_kind = SIZE_FIXED;
+        e->size = type->tp_basicsize + gc_size;
+        return;
+    }
+
+    // the objects with additional pre-header or with own tp_is_gc are left for sys.getsizeof
+    if (type->tp_is_gc)
+        return;
+#if PY_VERSION_HEX >= 0x030B0000
+    if (type->tp_flags & Py_TPFLAGS_MANAGED_DICT)
+        return;
+#endif
+#if PY_VERSION_HEX >= 0x030C0000
+    if (type->tp_flags & Py_TPFLAGS_MANAGED_WEAKREF)
+        return;
+#endif
+
+    func = c_sizeof_func(type);
+    if (func == NULL)
+        return;
+    if (func == object_sizeof_func && type->tp_itemsize == 0) {
+        e->size_kind = SIZE_FIXED;
+        e->size = type->tp_basicsize + gc_size;
+    }
+    else {
+        e->size_kind = SIZE_METHOD;
+        e->size = gc_size;
+        e->sizeof_func = func;
+    }
+}
+
+// Returns the entry of the type or NULL on memory error
+static type_entry *
+type_table_get(type_table *t, PyTypeObject *type)
+{
+    size_t j;
+
+    if (2 * (t->used + 1) > t->mask + 1) {
+        type_entry *old = t->entries;
+        size_t i, old_capacity = t->mask + 1;
+
+        if (type_table_init(t, old_capacity * 2) < 0) {
+            t->entries = old;
+            return NULL;
+        }
+        for (i = 0; i < old_capacity; i++) {
+            if (old[i].type) {
+                j = ptr_hash(old[i].type) & t->mask;
+                while (t->entries[j].type)
+                    j = (j + 1) & t->mask;
+                t->entries[j] = old[i];
+                t->used++;
+            }
+        }
+        PyMem_Free(old);
+    }
+
+    j = ptr_hash(type) & t->mask;
+    while (t->entries[j].type) {
+        if (t->entries[j].type == type)
+            return &t->entries[j];
+        j = (j + 1) & t->mask;
+    }
+    type_entry_fill(&t->entries[j], type);
+    t->used++;
+    return &t->entries[j];
+}
+
+//////////////////////// deep_sizeof /////////////////////////////////////
+
+typedef struct {
+    PyObject **items;
+    Py_ssize_t size;
+    Py_ssize_t allocated;
+} obj_stack;
+
+static int
+obj_stack_push(obj_stack *stack, PyObject *op)
+{
+    if (stack->size == stack->allocated) {
+        Py_ssize_t allocated = stack->allocated ? 2 * stack->allocated : 256;
+        PyObject **items = PyMem_Realloc(stack->items, allocated * sizeof(PyObject*));
+        if (items == NULL) {
+            PyErr_NoMemory();
+            return -1;
+        }
+        stack->items = items;
+        stack->allocated = allocated;
+    }
+    Py_INCREF(op);
+    stack->items[stack->size++] = op;
+    return 0;
+}
+
+static void
+obj_stack_clear(obj_stack *stack)
+{
+    while (stack->size)
+        Py_DECREF(stack->items[--stack->size]);
+    PyMem_Free(stack->items);
+    stack->items = NULL;
+}
+
+static Py_ssize_t
+object_sizeof(type_entry *e, PyObject *op)
+{
+    PyObject *res;
+    Py_ssize_t size;
+
+    switch (e->size_kind) {
+    case SIZE_FIXED:
+        return e->size;
+    case SIZE_METHOD:
+        res = e->sizeof_func(op, NULL);
+        break;
+    default:
+#if PY_VERSION_HEX >= 0x03090000
+        res = PyObject_CallOneArg(sys_getsizeof, op);
+#else
+        res = PyObject_CallFunctionObjArgs(sys_getsizeof, op, NULL);
+#endif
+    }
+    if (res == NULL)
+        return -1;
+    size = PyLong_AsSsize_t(res);
+    Py_DECREF(res);
+    if (size < 0)
+        return -1;
+    if (e->size_kind == SIZE_METHOD)
+        size += e->size;
+    return size;
+}
+
+static int
+push_items(obj_stack *stack, PyObject **items, Py_ssize_t n)
+{
+    Py_ssize_t i;
+
+    for (i = 0; i < n; i++) {
+        PyObject *v = items[i];
+        if (v && obj_stack_push(stack, v) < 0)
+            return -1;
+    }
+    return 0;
+}
+
+// The presence bitmap and the pointer to the array of the values end the sparse record
+static int
+push_sparse_values(obj_stack *stack, type_entry *e, PyObject *op)
+{
+    char *end = (char*)op + Py_TYPE(op)->tp_basicsize - sizeof(PyObject**);
+    uint64_t *bitmap = (uint64_t*)end - e->n_words;
+    Py_ssize_t i, n = 0;
+
+    for (i = 0; i < e->n_words; i++) {
+        uint64_t x = bitmap[i];
+        for (; x; x &= x - 1)
+            n++;
+    }
+    return push_items(stack, *(PyObject***)end, n);
+}
+
+static int
+push_referents(obj_stack *stack, type_entry *e, PyObject *op)
+{
+    PyTypeObject *type = Py_TYPE(op);
+
+    switch (e->walk_kind) {
+    case WALK_DATAOBJECT_TAIL: {
+        char *tail = (char*)op + type->tp_basicsize;
+        Py_ssize_t n_tail = *(Py_ssize_t*)(tail - sizeof(Py_ssize_t));
+
+        if (push_items(stack, (PyObject**)tail, n_tail) < 0)
+            return -1;
+    }
+    /* fall through */
+    case WALK_DATAOBJECT_SPARSE:
+    case WALK_DATAOBJECT:
+        if (e->walk_kind == WALK_DATAOBJECT_SPARSE && push_sparse_values(stack, e, op) < 0)
+            return -1;
+        if (push_items(stack, PyDataObject_ITEMS(op), PyDataObject_LEN(op)) < 0)
+            return -1;
+        if (type->tp_dictoffset) {
+            PyObject *dict = *PyDataObject_DICTPTR(type, op);
+            if (dict && obj_stack_push(stack, dict) < 0)
+                return -1;
+        }
+        break;
+    case WALK_TUPLE:
+        return push_items(stack, ((PyTupleObject*)op)->ob_item, Py_SIZE(op));
+    case WALK_LIST:
+        return push_items(stack, ((PyListObject*)op)->ob_item, Py_SIZE(op));
+    case WALK_DICT: {
+        PyObject *key, *val;
+        Py_ssize_t pos = 0;
+
+        while (PyDict_Next(op, &pos, &key, &val)) {
+            if (obj_stack_push(stack, key) < 0 || obj_stack_push(stack, val) < 0)
+                return -1;
+        }
+        break;
+    }
+    case WALK_SET: {
+        PyObject *it = PyObject_GetIter(op);
+        PyObject *v;
+
+        if (it == NULL)
+            return -1;
+        while ((v = PyIter_Next(it))) {
+            int ret = obj_stack_push(stack, v);
+            Py_DECREF(v);
+            if (ret < 0) {
+                Py_DECREF(it);
+                return -1;
+            }
+        }
+        Py_DECREF(it);
+        if (PyErr_Occurred())
+            return -1;
+        break;
+    }
+    }
+    return 0;
+}
+
+PyDoc_STRVAR(deep_sizeof_doc,
+"deep_sizeof(ob, by_type=False) -> int or dict\n\n\
+Size in bytes of the object and all objects reachable from it through the fields of dataobjects,\n\
+items of litelist, litetuple, mutabletuple, tuple, list, set and keys/values of dict (including __dict__).\n\
+Every object is counted only once. Other objects are counted by sys.getsizeof and are not walked.\n\
+If by_type is true, then dict {type: (count, size)} is returned.");
+
+static PyObject *
+deep_sizeof(PyObject *module, PyObject *args, PyObject *kw)
+{
+    static char *kwlist[] = {"ob", "by_type", NULL};
+    PyObject *ob;
+    int by_type = 0;
+    ptr_set visited;
+    type_table types;
+    obj_stack stack = {NULL, 0, 0};
+    Py_ssize_t total = 0;
+    PyObject *result = NULL;
+
+    if (!PyArg_ParseTupleAndKeywords(args, kw, "O|p:deep_sizeof", kwlist, &ob, &by_type))
+        return NULL;
+
+    if (ptr_set_init(&visited, 1024) < 0)
+        return NULL;
+    if (type_table_init(&types, 64) < 0) {
+        PyMem_Free(visited.keys);
+        return NULL;
+    }
+
+    if (obj_stack_push(&stack, ob) < 0)
+        goto done;
+
+    while (stack.size) {
+        PyObject *op = stack.items[--stack.size];
+        type_entry *e;
+        Py_ssize_t size;
+        int added = ptr_set_add(&visited, op);
+
+        if (added <= 0) {
+            Py_DECREF(op);
+            if (added < 0)
+                goto done;
+            continue;
+        }
+
+        e = type_table_get(&types, Py_TYPE(op));
+        if (e == NULL) {
+            Py_DECREF(op);
+            goto done;
+        }
+
+        size = object_sizeof(e, op);
+        if (size < 0 || push_referents(&stack, e, op) < 0) {
+            Py_DECREF(op);
+            goto done;
+        }
+        total += size;
+        e->count++;
+        e->total += size;
+        Py_DECREF(op);
+    }
+
+    if (by_type) {
+        size_t i;
+
+        result = PyDict_New();
+        if (result == NULL)
+            goto done;
+        for (i = 0; i <= types.mask; i++) {
+            type_entry *e = &types.entries[i];
+            PyObject *val;
+
+            if (e->type == NULL)
+                continue;
+            val = Py_BuildValue("(nn)", e->count, e->total);
+            if (val == NULL || PyDict_SetItem(result, (PyObject*)e->type, val) < 0) {
+                Py_XDECREF(val);
+                Py_CLEAR(result);
+                goto done;
+            }
+            Py_DECREF(val);
+        }
+    }
+    else
+        result = PyLong_FromSsize_t(total);
+
+done:
+    obj_stack_clear(&stack);
+    PyMem_Free(visited.keys);
+    PyMem_Free(types.entries);
+    return result;
+}
+
+PyDoc_STRVAR(sizeofmodule_doc,
+"Deep sizeof of object graphs of recordclass types.");
+
+static PyMethodDef sizeofmodule_methods[] = {
+    {"deep_sizeof", (PyCFunction)deep_sizeof, METH_VARARGS | METH_KEYWORDS, deep_sizeof_doc},
+    {0, 0, 0, 0}
+};
+
+static struct PyModuleDef sizeofmodule = {
+    PyModuleDef_HEAD_INIT,
+    "recordclass._sizeof",
+    sizeofmodule_doc,
+    -1,
+    sizeofmodule_methods,
+    NULL,
+    NULL,
+    NULL,
+    NULL
+};
+
+PyMODINIT_FUNC
+PyInit__sizeof(void)
+{
+    PyObject *m, *t, *res;
+
+    m = PyState_FindModule(&sizeofmodule);
+    if (m) {
+        Py_INCREF(m);
+        return m;
+    }
+
+    m = PyModule_Create(&sizeofmodule);
+    if (m == NULL)
+        return NULL;
+
+    dataobject_type = (PyTypeObject*)get_module_object("recordclass._dataobject", "dataobject");
+    if (dataobject_type == NULL)
+        return NULL;
+    datastruct_type = (PyTypeObject*)get_module_object("recordclass._dataobject", "datastruct");
+    if (datastruct_type == NULL)
+        return NULL;
+    litelist_type = (PyTypeObject*)get_module_object("recordclass._litelist", "litelist");
+    if (litelist_type == NULL)
+        return NULL;
+    litetuple_type = (PyTypeObject*)get_module_object("recordclass._litetuple", "litetuple");
+    if (litetuple_type == NULL)
+        return NULL;
+    mutabletuple_type = (PyTypeObject*)get_module_object("recordclass._litetuple", "mutabletuple");
+    if (mutabletuple_type == NULL)
+        return NULL;
+    sparseproperty_type = (PyTypeObject*)get_module_object("recordclass._dataobject", "sparseproperty");
+    if (sparseproperty_type == NULL)
+        return NULL;
+    sys_getsizeof = get_module_object("sys", "getsizeof");
+    if (sys_getsizeof == NULL)
+        return NULL;
+
+    __sizeof__name = PyUnicode_InternFromString("__sizeof__");
+    if (__sizeof__name == NULL)
+        return NULL;
+    object_sizeof_func = c_sizeof_func(&PyBaseObject_Type);
+
+    __tail__name = PyUnicode_InternFromString("__tail__");
+    if (__tail__name == NULL)
+        return NULL;
+    __inline__name = PyUnicode_InternFromString("__inline__");
+    if (__inline__name == NULL)
+        return NULL;
+
+    // size of the GC header: sys.getsizeof(()) - ().__sizeof__()
+    t = PyTuple_New(0);
+    if (t == NULL)
+        return NULL;
+    res = PyObject_CallFunctionObjArgs(sys_getsizeof, t, NULL);
+    if (res == NULL) {
+        Py_DECREF(t);
+        return NULL;
+    }
+    gc_head_size = PyLong_AsSsize_t(res) - Py_TYPE(t)->tp_basicsize;
+    Py_DECREF(res);
+    Py_DECREF(t);
+
+    return m;
+}
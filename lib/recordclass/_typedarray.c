@@ -0,0 +1,858 @@
+// The MIT License (MIT)
+
+// Copyright (c) «2015-2023» «Shibzukhov Zaur, szport at gmail dot com»
+
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software - recordclass library - and associated documentation files
+// (the "Software"), to deal in the Software without restriction, including
+// without limitation the rights to use, copy, modify, merge, publish, distribute,
+// sublicense, and/or sell copies of the Software, and to permit persons to whom
+// the Software is furnished to do so, subject to the following conditions:
+
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+
+#ifdef Py_LIMITED_API
+#undef Py_LIMITED_API
+#endif
+
+#include "Python.h"
+#include <stdint.h>
+#include <string.h>
+
+#define DEFERRED_ADDRESS(addr) 0
+
+#if !defined(Py_SET_TYPE)
+#define Py_SET_TYPE(ob, type) (((PyObject*)(ob))->ob_type) = (type)
+#endif
+
+#if !defined(Py_TYPE)
+#define Py_TYPE(ob) ((PyObject*)(ob))->ob_type
+#endif
+
+// The values are stored inline just after the object's header.
+// The number of the items is kept in tp_itemsize of the type
+// (as for dataobject), the item type is defined by the sq_item slot.
+
+#define PyTypedArray_DATA(op) ((char*)(op) + sizeof(PyObject))
+#define PyTypedArray_LEN(op) (Py_TYPE(op)->tp_itemsize)
+
+static PyTypeObject PyTypedArray_Type;
+
+/////////////////////// value converters ///////////////////////////////
+
+static int
+conv_long_range(PyObject *v, long *x, long min, long max)
+{
+    long val = PyLong_AsLong(v);
+
+    if (val == -1 && PyErr_Occurred())
+        return -1;
+    if (val < min || val > max) {
+        PyErr_Format(PyExc_OverflowError, "value %ld is out of range [%ld, %ld]", val, min, max);
+        return -1;
+    }
+    *x = val;
+    return 0;
+}
+
+#define CONV_SMALL_INT(name, ctype, min, max) \
+static inline int \
+conv_##name(PyObject *v, ctype *x) \
+{ \
+    long val; \
+    if (conv_long_range(v, &val, (min), (max)) < 0) \
+        return -1; \
+    *x = (ctype)val; \
+    return 0; \
+}
+
+CONV_SMALL_INT(int8, signed char, SCHAR_MIN, SCHAR_MAX)
+CONV_SMALL_INT(uint8, unsigned char, 0, UCHAR_MAX)
+CONV_SMALL_INT(int16, short, SHRT_MIN, SHRT_MAX)
+CONV_SMALL_INT(uint16, unsigned short, 0, USHRT_MAX)
+CONV_SMALL_INT(int32, int, INT_MIN, INT_MAX)
+
+static inline int
+conv_uint32(PyObject *v, unsigned int *x)
+{
+    unsigned long val = PyLong_AsUnsignedLong(v);
+
+    if (val == (unsigned long)-1 && PyErr_Occurred())
+        return -1;
+    if (val > UINT_MAX) {
+        PyErr_SetString(PyExc_OverflowError, "value is out of range of unsigned int");
+        return -1;
+    }
+    *x = (unsigned int)val;
+    return 0;
+}
+
+static inline int
+conv_long(PyObject *v, long *x)
+{
+    long val = PyLong_AsLong(v);
+
+    if (val == -1 && PyErr_Occurred())
+        return -1;
+    *x = val;
+    return 0;
+}
+
+static inline int
+conv_ulong(PyObject *v, unsigned long *x)
+{
+    unsigned long val = PyLong_AsUnsignedLong(v);
+
+    if (val == (unsigned long)-1 && PyErr_Occurred())
+        return -1;
+    *x = val;
+    return 0;
+}
+
+static inline int
+conv_longlong(PyObject *v, long long *x)
+{
+    long long val = PyLong_AsLongLong(v);
+
+    if (val == -1 && PyErr_Occurred())
+        return -1;
+    *x = val;
+    return 0;
+}
+
+static inline int
+conv_ulonglong(PyObject *v, unsigned long long *x)
+{
+    unsigned long long val = PyLong_AsUnsignedLongLong(v);
+
+    if (val == (unsigned long long)-1 && PyErr_Occurred())
+        return -1;
+    *x = val;
+    return 0;
+}
+
+static inline int
+conv_float(PyObject *v, float *x)
+{
+    double val = PyFloat_AsDouble(v);
+
+    if (val == -1.0 && PyErr_Occurred())
+        return -1;
+    *x = (float)val;
+    return 0;
+}
+
+static inline int
+conv_double(PyObject *v, double *x)
+{
+    double val = PyFloat_AsDouble(v);
+
+    if (val == -1.0 && PyErr_Occurred())
+        return -1;
+    *x = val;
+    return 0;
+}
+
+static inline int
+conv_bool(PyObject *v, unsigned char *x)
+{
+    int val = PyObject_IsTrue(v);
+
+    if (val < 0)
+        return -1;
+    *x = (unsigned char)val;
+    return 0;
+}
+
+#define int8_to_py(x) PyLong_FromLong(x)
+#define uint8_to_py(x) PyLong_FromLong(x)
+#define int16_to_py(x) PyLong_FromLong(x)
+#define uint16_to_py(x) PyLong_FromLong(x)
+#define int32_to_py(x) PyLong_FromLong(x)
+#define uint32_to_py(x) PyLong_FromUnsignedLong(x)
+#define long_to_py(x) PyLong_FromLong(x)
+#define ulong_to_py(x) PyLong_FromUnsignedLong(x)
+#define longlong_to_py(x) PyLong_FromLongLong(x)
+#define ulonglong_to_py(x) PyLong_FromUnsignedLongLong(x)
+#define float_to_py(x) PyFloat_FromDouble(x)
+#define double_to_py(x) PyFloat_FromDouble(x)
+#define bool_to_py(x) PyBool_FromLong(x)
+
+/////////////////////// item access ////////////////////////////////////
+
+#define TYPEDARRAY_ITEM_FUNCS(name, ctype) \
+static PyObject * \
+typedarray_get_##name(const char *p) \
+{ \
+    return name##_to_py(*(const ctype*)p); \
+} \
+\
+static int \
+typedarray_set_##name(char *p, PyObject *v) \
+{ \
+    ctype x; \
+    if (conv_##name(v, &x) < 0) \
+        return -1; \
+    *(ctype*)p = x; \
+    return 0; \
+} \
+\
+static PyObject * \
+typedarray_item_##name(PyObject *op, Py_ssize_t i) \
+{ \
+    const Py_ssize_t n = PyTypedArray_LEN(op); \
+    if (i < 0) \
+        i += n; \
+    if (i < 0 || i >= n) { \
+        PyErr_Format(PyExc_IndexError, "index %zd out of range", i); \
+        return NULL; \
+    } \
+    return name##_to_py(((const ctype*)PyTypedArray_DATA(op))[i]); \
+} \
+\
+static int \
+typedarray_ass_item_##name(PyObject *op, Py_ssize_t i, PyObject *v) \
+{ \
+    const Py_ssize_t n = PyTypedArray_LEN(op); \
+    ctype x; \
+    if (v == NULL) { \
+        PyErr_SetString(PyExc_TypeError, "the item can't be deleted"); \
+        return -1; \
+    } \
+    if (i < 0) \
+        i += n; \
+    if (i < 0 || i >= n) { \
+        PyErr_Format(PyExc_IndexError, "index %zd out of range", i); \
+        return -1; \
+    } \
+    if (conv_##name(v, &x) < 0) \
+        return -1; \
+    ((ctype*)PyTypedArray_DATA(op))[i] = x; \
+    return 0; \
+}
+
+TYPEDARRAY_ITEM_FUNCS(int8, signed char)
+TYPEDARRAY_ITEM_FUNCS(uint8, unsigned char)
+TYPEDARRAY_ITEM_FUNCS(int16, short)
+TYPEDARRAY_ITEM_FUNCS(uint16, unsigned short)
+TYPEDARRAY_ITEM_FUNCS(int32, int)
+TYPEDARRAY_ITEM_FUNCS(uint32, unsigned int)
+TYPEDARRAY_ITEM_FUNCS(long, long)
+TYPEDARRAY_ITEM_FUNCS(ulong, unsigned long)
+TYPEDARRAY_ITEM_FUNCS(longlong, long long)
+TYPEDARRAY_ITEM_FUNCS(ulonglong, unsigned long long)
+TYPEDARRAY_ITEM_FUNCS(float, float)
+TYPEDARRAY_ITEM_FUNCS(double, double)
+TYPEDARRAY_ITEM_FUNCS(bool, unsigned char)
+
+typedef struct {
+    const char *format;
+    Py_ssize_t size;
+    PyObject* (*get)(const char *p);
+    int (*set)(char *p, PyObject *v);
+    ssizeargfunc sq_item;
+    ssizeobjargproc sq_ass_item;
+} typedarray_dtype;
+
+#define TYPEDARRAY_DTYPE(code, name, ctype) \
+    {code, sizeof(ctype), typedarray_get_##name, typedarray_set_##name, \
+     typedarray_item_##name, typedarray_ass_item_##name}
+
+// format codes are the same as in the struct module (native size and alignment)
+static typedarray_dtype typedarray_dtypes[] = {
+    TYPEDARRAY_DTYPE("b", int8, signed char),
+    TYPEDARRAY_DTYPE("B", uint8, unsigned char),
+    TYPEDARRAY_DTYPE("h", int16, short),
+    TYPEDARRAY_DTYPE("H", uint16, unsigned short),
+    TYPEDARRAY_DTYPE("i", int32, int),
+    TYPEDARRAY_DTYPE("I", uint32, unsigned int),
+    TYPEDARRAY_DTYPE("l", long, long),
+    TYPEDARRAY_DTYPE("L", ulong, unsigned long),
+    TYPEDARRAY_DTYPE("q", longlong, long long),
+    TYPEDARRAY_DTYPE("Q", ulonglong, unsigned long long),
+    TYPEDARRAY_DTYPE("f", float, float),
+    TYPEDARRAY_DTYPE("d", double, double),
+    TYPEDARRAY_DTYPE("?", bool, unsigned char),
+    {NULL}
+};
+
+static typedarray_dtype *
+typedarray_dtype_by_format(const char *format)
+{
+    typedarray_dtype *dt;
+
+    for (dt = typedarray_dtypes; dt->format; dt++) {
+        if (strcmp(dt->format, format) == 0)
+            return dt;
+    }
+    return NULL;
+}
+
+static typedarray_dtype *
+typedarray_dtype_of(PyTypeObject *tp)
+{
+    typedarray_dtype *dt;
+    ssizeargfunc sq_item = tp->tp_as_sequence->sq_item;
+
+    for (dt = typedarray_dtypes; dt->format; dt++) {
+        if (dt->sq_item == sq_item)
+            return dt;
+    }
+    PyErr_Format(PyExc_TypeError, "%s is not initialized typed array class", tp->tp_name);
+    return NULL;
+}
+
+/////////////////////// typedarray /////////////////////////////////////
+
+static PyObject *
+typedarray_alloc(PyTypeObject *type, Py_ssize_t unused)
+{
+    PyObject *op = (PyObject*)PyObject_Malloc(type->tp_basicsize);
+
+    if (op == NULL)
+        return PyErr_NoMemory();
+
+    memset(op, 0, type->tp_basicsize);
+    PyObject_Init(op, type);
+#if PY_VERSION_HEX < 0x03080000
+    if (type->tp_flags & Py_TPFLAGS_HEAPTYPE)
+        Py_INCREF(type);
+#endif
+    return op;
+}
+
+static void
+typedarray_dealloc(PyObject *op)
+{
+    PyTypeObject *type = Py_TYPE(op);
+
+    if (type->tp_weaklistoffset)
+        PyObject_ClearWeakRefs(op);
+
+    type->tp_free(op);
+
+    if (type->tp_flags & Py_TPFLAGS_HEAPTYPE)
+        Py_DECREF(type);
+}
+
+static int
+typedarray_fill(PyObject *op, PyObject *const *args, Py_ssize_t n_args)
+{
+    PyTypeObject *type = Py_TYPE(op);
+    typedarray_dtype *dt;
+    char *data = PyTypedArray_DATA(op);
+    Py_ssize_t i;
+
+    if (n_args > PyTypedArray_LEN(op)) {
+        PyErr_SetString(PyExc_TypeError,
+            "the number of the arguments greater than the number of items");
+        return -1;
+    }
+
+    dt = typedarray_dtype_of(type);
+    if (dt == NULL)
+        return -1;
+
+    for (i = 0; i < n_args; i++) {
+        if (dt->set(data, args[i]) < 0)
+            return -1;
+        data += dt->size;
+    }
+    return 0;
+}
+
+static PyObject *
+typedarray_new(PyTypeObject *type, PyObject *args, PyObject *kwds)
+{
+    PyObject *op;
+
+    if (kwds && PyDict_GET_SIZE(kwds)) {
+        PyErr_SetString(PyExc_TypeError, "keyword arguments are not allowed");
+        return NULL;
+    }
+
+    op = type->tp_alloc(type, 0);
+    if (op == NULL)
+        return NULL;
+
+    if (typedarray_fill(op, ((PyTupleObject*)args)->ob_item, Py_SIZE(args)) < 0) {
+        Py_DECREF(op);
+        return NULL;
+    }
+    return op;
+}
+
+#if PY_VERSION_HEX >= 0x030A0000
+static PyObject *
+typedarray_vectorcall(PyObject *type0, PyObject *const *args,
+                      size_t nargsf, PyObject *kwnames)
+{
+    PyTypeObject *type = (PyTypeObject*)type0;
+    PyObject *op;
+
+    if (kwnames && PyTuple_GET_SIZE(kwnames)) {
+        PyErr_SetString(PyExc_TypeError, "keyword arguments are not allowed");
+        return NULL;
+    }
+
+    op = type->tp_alloc(type, 0);
+    if (op == NULL)
+        return NULL;
+
+    if (typedarray_fill(op, args, PyVectorcall_NARGS(nargsf)) < 0) {
+        Py_DECREF(op);
+        return NULL;
+    }
+    return op;
+}
+#endif
+
+static Py_ssize_t
+typedarray_len(PyObject *op)
+{
+    return PyTypedArray_LEN(op);
+}
+
+// The slots of the base class: the slot wrappers __getitem__ and __setitem__ are
+// created by type() before _typedarray_type_init sets the slots of the class
+// for its dtype, so the inherited wrappers use these ones
+static PyObject *
+typedarray_item(PyObject *op, Py_ssize_t i)
+{
+    typedarray_dtype *dt = typedarray_dtype_of(Py_TYPE(op));
+
+    if (dt == NULL)
+        return NULL;
+    return dt->sq_item(op, i);
+}
+
+static int
+typedarray_ass_item(PyObject *op, Py_ssize_t i, PyObject *v)
+{
+    PyTypeObject *type = Py_TYPE(op);
+    typedarray_dtype *dt = typedarray_dtype_of(type);
+
+    if (dt == NULL)
+        return -1;
+    if (type->tp_as_sequence->sq_ass_item == NULL) {
+        PyErr_Format(PyExc_TypeError, "'%s' object does not support item assignment", type->tp_name);
+        return -1;
+    }
+    return dt->sq_ass_item(op, i, v);
+}
+
+static PyObject *
+typedarray_tuple(PyObject *op)
+{
+    typedarray_dtype *dt = typedarray_dtype_of(Py_TYPE(op));
+    const char *data = PyTypedArray_DATA(op);
+    Py_ssize_t i, n = PyTypedArray_LEN(op);
+    PyObject *tpl;
+
+    if (dt == NULL)
+        return NULL;
+
+    tpl = PyTuple_New(n);
+    if (tpl == NULL)
+        return NULL;
+
+    for (i = 0; i < n; i++) {
+        PyObject *v = dt->get(data);
+        if (v == NULL) {
+            Py_DECREF(tpl);
+            return NULL;
+        }
+        PyTuple_SET_ITEM(tpl, i, v);
+        data += dt->size;
+    }
+    return tpl;
+}
+
+static PyObject *
+typedarray_richcompare(PyObject *v, PyObject *w, int op)
+{
+    PyObject *tv, *tw, *ret;
+
+    if (Py_TYPE(v) != Py_TYPE(w))
+        Py_RETURN_NOTIMPLEMENTED;
+
+    if (op == Py_EQ || op == Py_NE) {
+        const Py_ssize_t size = Py_TYPE(v)->tp_basicsize - sizeof(PyObject);
+        typedarray_dtype *dt = typedarray_dtype_of(Py_TYPE(v));
+        int eq;
+
+        if (dt == NULL)
+            return NULL;
+        // floats need the comparison of the values (nan != nan, 0.0 == -0.0)
+        if (dt->format[0] != 'f' && dt->format[0] != 'd' && !Py_TYPE(v)->tp_weaklistoffset) {
+            eq = memcmp(PyTypedArray_DATA(v), PyTypedArray_DATA(w), size) == 0;
+            if (op == Py_NE)
+                eq = !eq;
+            return PyBool_FromLong(eq);
+        }
+    }
+
+    tv = typedarray_tuple(v);
+    if (tv == NULL)
+        return NULL;
+    tw = typedarray_tuple(w);
+    if (tw == NULL) {
+        Py_DECREF(tv);
+        return NULL;
+    }
+    ret = PyObject_RichCompare(tv, tw, op);
+    Py_DECREF(tv);
+    Py_DECREF(tw);
+    return ret;
+}
+
+static Py_hash_t
+typedarray_hash(PyObject *op)
+{
+    PyObject *tpl = typedarray_tuple(op);
+    Py_hash_t h;
+
+    if (tpl == NULL)
+        return -1;
+    h = PyObject_Hash(tpl);
+    Py_DECREF(tpl);
+    return h;
+}
+
+static int
+typedarray_getbuffer(PyObject *op, Py_buffer *view, int flags)
+{
+    PyTypeObject *type = Py_TYPE(op);
+    typedarray_dtype *dt;
+    int readonly = type->tp_as_sequence->sq_ass_item == NULL;
+
+    if (view == NULL) {
+        PyErr_SetString(PyExc_BufferError, "view==NULL argument is obsolete");
+        return -1;
+    }
+
+    dt = typedarray_dtype_of(type);
+    if (dt == NULL)
+        return -1;
+
+    if ((flags & PyBUF_WRITABLE) == PyBUF_WRITABLE && readonly) {
+        PyErr_SetString(PyExc_BufferError, "object is not writable");
+        return -1;
+    }
+
+    view->obj = op;
+    Py_INCREF(op);
+    view->buf = PyTypedArray_DATA(op);
+    view->len = PyTypedArray_LEN(op) * dt->size;
+    view->readonly = readonly;
+    view->itemsize = dt->size;
+    view->ndim = 1;
+    view->format = NULL;
+    view->shape = NULL;
+    view->strides = NULL;
+    view->suboffsets = NULL;
+    view->internal = NULL;
+
+    if ((flags & PyBUF_FORMAT) == PyBUF_FORMAT)
+        view->format = (char*)dt->format;
+    if ((flags & PyBUF_ND) == PyBUF_ND)
+        view->shape = &type->tp_itemsize;
+    if ((flags & PyBUF_STRIDES) == PyBUF_STRIDES)
+        view->strides = &dt->size;
+
+    return 0;
+}
+
+static PyBufferProcs typedarray_as_buffer = {
+    (getbufferproc)typedarray_getbuffer,   /* bf_getbuffer */
+    0,                                     /* bf_releasebuffer */
+};
+
+static PySequenceMethods typedarray_as_sequence = {
+    (lenfunc)typedarray_len,                  /* sq_length */
+    0,                                        /* sq_concat */
+    0,                                        /* sq_repeat */
+    (ssizeargfunc)typedarray_item,            /* sq_item */
+    0,                                        /* sq_slice */
+    (ssizeobjargproc)typedarray_ass_item,     /* sq_ass_item */
+    0,                                        /* sq_ass_slice */
+    0,                                        /* sq_contains */
+};
+
+static PyObject *
+typedarray_iter(PyObject *op)
+{
+    return PySeqIter_New(op);
+}
+
+PyDoc_STRVAR(typedarray_copy_doc,
+"T.__copy__() -- copy of T");
+
+static PyObject *
+typedarray_copy(PyObject *op, PyObject *Py_UNUSED(ignore))
+{
+    PyTypeObject *type = Py_TYPE(op);
+    typedarray_dtype *dt = typedarray_dtype_of(type);
+    PyObject *new_op;
+
+    if (dt == NULL)
+        return NULL;
+
+    new_op = type->tp_alloc(type, 0);
+    if (new_op == NULL)
+        return NULL;
+
+    memcpy(PyTypedArray_DATA(new_op), PyTypedArray_DATA(op),
+           PyTypedArray_LEN(op) * dt->size);
+    return new_op;
+}
+
+PyDoc_STRVAR(typedarray_reduce_doc,
+"T.__reduce__()");
+
+static PyObject *
+typedarray_reduce(PyObject *op, PyObject *Py_UNUSED(ignore))
+{
+    PyObject *args = typedarray_tuple(op);
+    PyObject *result;
+
+    if (args == NULL)
+        return NULL;
+    result = PyTuple_Pack(2, Py_TYPE(op), args);
+    Py_DECREF(args);
+    return result;
+}
+
+PyDoc_STRVAR(typedarray_sizeof_doc,
+"T.__sizeof__() -- size of T");
+
+static PyObject *
+typedarray_sizeof(PyObject *op, PyObject *Py_UNUSED(ignore))
+{
+    return PyLong_FromSsize_t(Py_TYPE(op)->tp_basicsize);
+}
+
+static PyMethodDef typedarray_methods[] = {
+    {"__copy__",      (PyCFunction)typedarray_copy, METH_NOARGS, typedarray_copy_doc},
+    {"__reduce__",    (PyCFunction)typedarray_reduce, METH_NOARGS, typedarray_reduce_doc},
+    {"__sizeof__",    (PyCFunction)typedarray_sizeof, METH_NOARGS, typedarray_sizeof_doc},
+    {NULL}
+};
+
+static PyObject *
+typedarray_format(PyObject *cls, void *unused)
+{
+    typedarray_dtype *dt = typedarray_dtype_of((PyTypeObject*)cls);
+
+    if (dt == NULL)
+        return NULL;
+    return PyUnicode_FromString(dt->format);
+}
+
+PyDoc_STRVAR(typedarray_doc,
+"typedarray(...) --> fixed size array of native values");
+
+static PyTypeObject PyTypedArray_Type = {
+    PyVarObject_HEAD_INIT(DEFERRED_ADDRESS(&PyType_Type), 0)
+    "recordclass._typedarray.typedarray",   /* tp_name */
+    sizeof(PyObject),                       /* tp_basicsize */
+    0,                                      /* tp_itemsize */
+    /* methods */
+    (destructor)typedarray_dealloc,         /* tp_dealloc */
+    0,                                      /* tp_vectorcall_offset */
+    0,                                      /* tp_getattr */
+    0,                                      /* tp_setattr */
+    0,                                      /* tp_reserved */
+    0,                                      /* tp_repr */
+    0,                                      /* tp_as_number */
+    &typedarray_as_sequence,                /* tp_as_sequence */
+    0,                                      /* tp_as_mapping */
+    PyObject_HashNotImplemented,            /* tp_hash */
+    0,                                      /* tp_call */
+    0,                                      /* tp_str */
+    0,                                      /* tp_getattro */
+    0,                                      /* tp_setattro */
+    &typedarray_as_buffer,                  /* tp_as_buffer */
+#if PY_VERSION_HEX >= 0x030A0000
+    Py_TPFLAGS_DEFAULT|Py_TPFLAGS_BASETYPE|Py_TPFLAGS_SEQUENCE,
+#else
+    Py_TPFLAGS_DEFAULT|Py_TPFLAGS_BASETYPE,
+#endif
+                                            /* tp_flags */
+    typedarray_doc,                         /* tp_doc */
+    0,                                      /* tp_traverse */
+    0,                                      /* tp_clear */
+    typedarray_richcompare,                 /* tp_richcompare */
+    0,                                      /* tp_weaklistoffset*/
+    typedarray_iter,                        /* tp_iter */
+    0,                                      /* tp_iternext */
+    typedarray_methods,                     /* tp_methods */
+    0,                                      /* tp_members */
+    0,                                      /* tp_getset */
+    0,                                      /* tp_base */
+    0,                                      /* tp_dict */
+    0,                                      /* tp_descr_get */
+    0,                                      /* tp_descr_set */
+    0,                                      /* tp_dictoffset */
+    0,                                      /* tp_init */
+    typedarray_alloc,                       /* tp_alloc */
+    typedarray_new,                         /* tp_new */
+    PyObject_Del,                           /* tp_free */
+    0,                                      /* tp_is_gc */
+#if PY_VERSION_HEX >= 0x030A0000
+    .tp_vectorcall = typedarray_vectorcall,
+#endif
+};
+
+//////////////////// module level functions //////////////////////////////
+
+PyDoc_STRVAR(_typedarray_type_init_doc,
+"Initialize typedarray subclass: _typedarray_type_init(cls, n, format, readonly, hashable, use_weakref)");
+
+static PyObject *
+_typedarray_type_init(PyObject *module, PyObject *args)
+{
+    PyObject *cls;
+    PyTypeObject *tp;
+    const char *format;
+    Py_ssize_t n, size;
+    int readonly, hashable, use_weakref;
+    typedarray_dtype *dt;
+
+    if (!PyArg_ParseTuple(args, "Onsppp", &cls, &n, &format, &readonly, &hashable, &use_weakref))
+        return NULL;
+
+    if (!PyType_Check(cls) || !PyType_IsSubtype((PyTypeObject*)cls, &PyTypedArray_Type)) {
+        PyErr_SetString(PyExc_TypeError, "the class should be subclass of typedarray");
+        return NULL;
+    }
+    tp = (PyTypeObject*)cls;
+
+    if (n < 0) {
+        PyErr_SetString(PyExc_ValueError, "number of items should not be negative");
+        return NULL;
+    }
+
+    dt = typedarray_dtype_by_format(format);
+    if (dt == NULL) {
+        PyErr_Format(PyExc_ValueError, "unsupported dtype: '%s'", format);
+        return NULL;
+    }
+
+    size = sizeof(PyObject) + n * dt->size;
+
+    tp->tp_itemsize = n;
+    if (use_weakref) {
+        size = (size + sizeof(PyObject*) - 1) / sizeof(PyObject*) * sizeof(PyObject*);
+        tp->tp_weaklistoffset = size;
+        size += sizeof(PyObject*);
+    } else
+        tp->tp_weaklistoffset = 0;
+    tp->tp_basicsize = size;
+    tp->tp_dictoffset = 0;
+
+#if PY_VERSION_HEX >= 0x030B0000
+    tp->tp_flags &= ~Py_TPFLAGS_MANAGED_DICT;
+#endif
+#if PY_VERSION_HEX >= 0x030C0000
+    tp->tp_flags &= ~Py_TPFLAGS_MANAGED_WEAKREF;
+    tp->tp_flags &= ~Py_TPFLAGS_PREHEADER;
+#endif
+    tp->tp_flags &= ~Py_TPFLAGS_BASETYPE;
+    if (tp->tp_flags & Py_TPFLAGS_HAVE_GC)
+        tp->tp_flags &= ~Py_TPFLAGS_HAVE_GC;
+
+    tp->tp_alloc = typedarray_alloc;
+    tp->tp_dealloc = typedarray_dealloc;
+    tp->tp_free = PyObject_Del;
+    tp->tp_traverse = NULL;
+    tp->tp_clear = NULL;
+    tp->tp_is_gc = NULL;
+    tp->tp_new = typedarray_new;
+#if PY_VERSION_HEX >= 0x030A0000
+    // tp_vectorcall of the type is used for the call of the type itself
+    tp->tp_vectorcall = typedarray_vectorcall;
+#endif
+
+    tp->tp_as_sequence->sq_length = typedarray_len;
+    tp->tp_as_sequence->sq_item = dt->sq_item;
+    tp->tp_as_sequence->sq_ass_item = readonly ? NULL : dt->sq_ass_item;
+    tp->tp_as_buffer->bf_getbuffer = typedarray_getbuffer;
+    tp->tp_as_buffer->bf_releasebuffer = NULL;
+
+    if (hashable || readonly)
+        tp->tp_hash = typedarray_hash;
+    else
+        tp->tp_hash = PyObject_HashNotImplemented;
+
+    PyType_Modified(tp);
+
+    Py_RETURN_NONE;
+}
+
+PyDoc_STRVAR(_typedarray_format_doc,
+"Format (in the sense of struct module) of the items of typedarray subclass");
+
+static PyObject *
+_typedarray_format(PyObject *module, PyObject *cls)
+{
+    if (!PyType_Check(cls)) {
+        PyErr_SetString(PyExc_TypeError, "argument should be a type");
+        return NULL;
+    }
+    return typedarray_format(cls, NULL);
+}
+
+PyDoc_STRVAR(typedarraymodule_doc,
+"_typedarray module provide `typedarray` class.");
+
+static PyMethodDef typedarraymodule_methods[] = {
+    {"_typedarray_type_init", _typedarray_type_init, METH_VARARGS, _typedarray_type_init_doc},
+    {"_typedarray_format", _typedarray_format, METH_O, _typedarray_format_doc},
+    {0, 0, 0, 0}
+};
+
+static struct PyModuleDef typedarraymodule = {
+    PyModuleDef_HEAD_INIT,
+    "recordclass._typedarray",
+    typedarraymodule_doc,
+    -1,
+    typedarraymodule_methods,
+    NULL,
+    NULL,
+    NULL,
+    NULL
+};
+
+PyMODINIT_FUNC
+PyInit__typedarray(void)
+{
+    PyObject *m;
+
+    m = PyState_FindModule(&typedarraymodule);
+    if (m) {
+        Py_INCREF(m);
+        return m;
+    }
+
+    m = PyModule_Create(&typedarraymodule);
+    if (m == NULL)
+        return NULL;
+
+    if (PyType_Ready(&PyTypedArray_Type) < 0)
+        Py_FatalError("Can't initialize typedarray type");
+
+    Py_INCREF(&PyTypedArray_Type);
+    PyModule_AddObject(m, "typedarray", (PyObject *)&PyTypedArray_Type);
+
+    return m;
+}
@@ -32,7 +32,14 @@ int_type = type(1)
     
 def make_arrayclass(typename, n_fields, *, namespace=None, 
              use_weakref=False, hashable=False, readonly=False, gc=False,
-             module=None, immutable_type=False):
+             module=None, immutable_type=False, dtype=None):
+    """Create array class with fixed number of items.
+
+    If `dtype` (format character of `struct` module: 'b', 'B', 'h', 'H', 'i', 'I',
+    'l', 'L', 'q', 'Q', 'f', 'd', '?') is specified then the items are stored inline
+    as native values and the instances support buffer protocol (PEP 3118).
+    The missing items of the typed array are zero (not None as for untyped one).
+    """
 
     from ._dataobject import dataobject
     from .datatype import datatype
@@ -40,6 +47,19 @@ def make_arrayclass(typename, n_fields, *, namespace=None,
     if not isinstance(n_fields, int_type):
         raise TypeError("argument fields is not integer")
 
+    if module is None:
+        try:
+            module = _sys._getframe(1).f_globals.get('__name__', '__main__')
+        except (AttributeError, ValueError):
+            pass
+
+    if dtype is not None:
+        if gc:
+            raise TypeError("typed array class can't support cyclic garbage collection")
+        return _make_typed_arrayclass(typename, n_fields, dtype, namespace=namespace,
+                                      use_weakref=use_weakref, hashable=hashable,
+                                      readonly=readonly, module=module)
+
     bases = (dataobject,)
 
     typename = _intern(typename)
@@ -58,12 +78,6 @@ def make_arrayclass(typename, n_fields, *, namespace=None,
     ns['__repr__'] = __repr__
     ns['__str__'] = __repr__    
 
-    if module is None:
-        try:
-            module = _sys._getframe(1).f_globals.get('__name__', '__main__')
-        except (AttributeError, ValueError):
-            pass
-
     ns['__module__'] = module
 
     cls = datatype(typename, bases, ns,
@@ -72,3 +86,31 @@ def make_arrayclass(typename, n_fields, *, namespace=None,
                    gc=gc, fast_new=True, immutable_type=immutable_type)
 
     return cls
+
+def _make_typed_arrayclass(typename, n_items, dtype, *, namespace=None,
+                           use_weakref=False, hashable=False, readonly=False, module=None):
+
+    from ._typedarray import typedarray, _typedarray_type_init
+
+    typename = _intern(typename)
+
+    if namespace is None:
+        ns = {}
+    else:
+        ns = namespace
+
+    def __repr__(_self):
+        return typename + '(' + \
+               ', '.join(repr(o) for o in _self) + ')'
+    __repr__.__qual_name__ =  f'{typename}.__repr__' 
+    ns['__repr__'] = __repr__
+    ns['__str__'] = __repr__    
+
+    ns['__slots__'] = ()
+    ns['__module__'] = module
+    ns['__dtype__'] = dtype
+
+    cls = type(typename, (typedarray,), ns)
+    _typedarray_type_init(cls, n_items, dtype, readonly, hashable, use_weakref)
+
+    return cls
@@ -37,7 +37,8 @@ def make_dataclass(typename, fields, defaults=None, *, bases=None, namespace=Non
                    use_dict=False, use_weakref=False, hashable=False,
                    sequence=False, mapping=False, iterable=False, readonly=False, invalid_names=(),
                    deep_dealloc=False, module=None, fast_new=True, rename=False, gc=False, 
-                   immutable_type=False, copy_default=False, match=None):
+                   immutable_type=False, copy_default=False, match=None, stats=False, arena=False,
+                   deferred_dealloc=False, validate=False, sparse=False, track_changes=False):
 
     """Returns a new class with named fields and small memory footprint.
 
@@ -91,7 +92,9 @@ def make_dataclass(typename, fields, defaults=None, *, bases=None, namespace=Non
                    use_dict=use_dict, use_weakref=use_weakref,
                    gc=gc, fast_new=fast_new,
                    hashable=hashable, immutable_type=immutable_type, 
-                   copy_default=copy_default, match=match)
+                   copy_default=copy_default, match=match, stats=stats, arena=arena,
+                   deferred_dealloc=deferred_dealloc, validate=validate, sparse=sparse,
+                   track_changes=track_changes)
 
     return cls
 
@@ -31,6 +31,9 @@ _PY310 = _sys.version_info[:2] >= (3, 10)
 _PY311 = _sys.version_info[:2] >= (3, 11)
     
 import typing
+import weakref as _weakref
+import types as _types
+from types import MemberDescriptorType as _MemberDescriptorType
 if _PY37:
     def _is_classvar(a_type):
         return (a_type is typing.ClassVar
@@ -49,13 +52,280 @@ def _matching_annotations_and_defaults(annotations, defaults):
             if first_default:
                 raise TypeError('A field without default value appears after a field with default value')
                 
-_ds_cache = {}
-_ds_ro_cache = {}
+_protected_names = {'__fields__', '__defaults__', '__annotations__',
+                    '__categorical_fields__', '__categorical_table__', '__stats__',
+                    '__fields_index__', '__default_copy__', '__validator__', '__tail__',
+                    '__inline__'}
 
 MATCH = object()
 
 class Field(dict):
     pass
+
+class Categorical:
+    """
+    Marker of the field with dictionary-encoded str values: `Annotated[str, Categorical]`.
+    Equal str values assigned to such fields share a single object from the intern table of the class.
+    """
+
+def _is_categorical(tp):
+    for m in getattr(tp, '__metadata__', ()):
+        if m is Categorical or isinstance(m, Categorical):
+            return True
+    return False
+
+class Tail:
+    """
+    Marker of the trailing variable-length field: `items: Tail[T]`.
+    The items are allocated inline after the fields of the instance. They are passed to the
+    constructor by position after the fields or by the name of the field as an iterable, and
+    the field returns them as a tuple. The class with Tail field can't be subclassed.
+    """
+    def __init__(self, type=object):
+        self.type = type
+
+    def __class_getitem__(cls, tp):
+        return cls(tp)
+
+    def __repr__(self):
+        return "Tail[%s]" % _type2str(self.type)
+
+def _is_tail(tp):
+    return tp is Tail or isinstance(tp, Tail)
+
+class Inline:
+    """
+    Marker of the datastruct field stored by value: `price: Inline[Money]` or `Inline[Money, 'proxy']`.
+    The fields of the datastruct are stored as the fields `<name>_<field>` of the instance.
+    The field returns a copy of the datastruct (or a proxy to these fields with access='proxy')
+    and accepts the datastruct or a tuple of its values. The class with Inline fields can't be subclassed.
+    """
+    def __init__(self, type, access='copy'):
+        if access not in ('copy', 'proxy'):
+            raise ValueError("access should be 'copy' or 'proxy'")
+        self.type = type
+        self.access = access
+
+    def __class_getitem__(cls, args):
+        if type(args) is tuple:
+            return cls(*args)
+        return cls(args)
+
+    def __repr__(self):
+        if self.access == 'copy':
+            return "Inline[%s]" % _type2str(self.type)
+        return "Inline[%s, %r]" % (_type2str(self.type), self.access)
+
+def _is_inline(tp):
+    return isinstance(tp, Inline)
+
+_types_type = type
+_BITS_WORD = 64
+
+class Packed:
+    """
+    Marker of the field stored in the bits of a hidden word: `flag: Packed[bool]`,
+    `color: Packed[Color]` (Enum) or `level: Packed[range(8)]`.
+    The fields take only the bits for the index of the value, and the values are checked on assignment.
+    The default value is the first value when it isn't specified. The class with Packed fields can't be subclassed.
+    """
+    def __init__(self, type=bool):
+        import enum
+        if type is bool:
+            values = (False, True)
+        elif isinstance(type, range):
+            values = type
+        elif isinstance(type, _types_type) and issubclass(type, enum.Enum):
+            values = tuple(type)
+        else:
+            raise TypeError("Packed field requires bool, Enum subclass or range")
+        if not values:
+            raise TypeError("Packed field requires non empty values")
+        self.type = type
+        self.values = values
+        self.width = (len(values) - 1).bit_length() or 1
+
+    def __class_getitem__(cls, tp):
+        return cls(tp)
+
+    def __repr__(self):
+        if isinstance(self.type, range):
+            return "Packed[%r]" % (self.type,)
+        return "Packed[%s]" % _type2str(self.type)
+
+def _is_packed(tp):
+    return isinstance(tp, Packed)
+
+def _expand_inline(fields, fields_dict, defaults_dict, ns):
+    """
+    Replace the Inline fields by the fields of their datastructs, remove the Packed fields
+    from the slots and put their descriptors into the namespace
+    """
+    from ._dataobject import datastruct, inlineproperty, bitproperty, astuple
+
+    new_fields = []
+    plan = []
+    words = []
+    for fn in fields:
+        fd = fields_dict[fn]
+        tp = fd.get('type', None)
+        if _is_packed(tp):
+            # the first word with the free bits
+            for index, used in enumerate(words):
+                if used + tp.width <= _BITS_WORD:
+                    break
+            else:
+                index = len(words)
+                words.append(0)
+            default = fd['default'] if 'default' in fd else tp.values[0]
+            ds = bitproperty(index, words[index], tp.values, default, fd.get('readonly', False))
+            words[index] += tp.width
+            plan.append((fn, ds))
+            del fields_dict[fn]
+            defaults_dict.pop(fn, None)
+            ns[fn] = ds
+            continue
+        if not _is_inline(tp):
+            new_fields.append(fn)
+            plan.append((fn, None))
+            continue
+
+        S = tp.type
+        if not (isinstance(S, type) and issubclass(S, datastruct)):
+            raise TypeError(f"Inline field '{fn}' requires a subclass of datastruct")
+        if '__tail__' in S.__dict__:
+            raise TypeError(f"Inline field '{fn}' can not contain Tail field")
+        sub_fields = S.__fields__
+        sub_hints = S.__dict__.get('__annotations__', {})
+        if 'default' in fd:
+            val = fd['default']
+            if type(val) is S:
+                val = astuple(val)
+            elif type(val) is not tuple or len(val) != len(sub_fields):
+                raise TypeError(f"default value of Inline field '{fn}' should be {S.__name__} or tuple")
+            sub_defaults = dict(zip(sub_fields, val))
+        else:
+            sub_defaults = S.__defaults__
+        readonly = fd.get('readonly', False)
+
+        ds = inlineproperty(len(new_fields), S, tp.access == 'proxy', readonly)
+        plan.append((fn, ds))
+        for sub in sub_fields:
+            name = f"{fn}_{sub}"
+            if name in fields_dict or name in ns:
+                raise TypeError(f"field '{name}' of Inline field '{fn}' is already defined")
+            f = fields_dict[name] = Field()
+            if sub in sub_hints:
+                f['type'] = sub_hints[sub]
+            if sub in sub_defaults:
+                f['default'] = defaults_dict[name] = sub_defaults[sub]
+            if readonly:
+                f['readonly'] = True
+            new_fields.append(name)
+
+        del fields_dict[fn]
+        defaults_dict.pop(fn, None)
+        ns[fn] = ds
+
+    ns['__inline__'] = tuple(plan)
+    return tuple(new_fields)
+
+def _expand_sparse(fields, fields_dict, defaults_dict, ns):
+    "Put the descriptors of the fields of the sparse record into the namespace instead of the slots"
+    from ._dataobject import sparseproperty
+
+    plan = []
+    for i, fn in enumerate(fields):
+        fd = fields_dict.pop(fn)
+        tp = fd.get('type', None)
+        if _is_inline(tp) or _is_packed(tp):
+            raise TypeError("sparse=True is not compatible with Inline and Packed fields")
+        if _is_categorical(tp):
+            raise TypeError("sparse=True is not compatible with Categorical fields")
+        ds = sparseproperty(i, fd.get('default', None), fd.get('readonly', False))
+        plan.append((fn, ds))
+        defaults_dict.pop(fn, None)
+        ns[fn] = ds
+
+    ns['__inline__'] = tuple(plan)
+    return ()
+
+def categorical_size(cls):
+    "Number of the values in the intern table of the categorical fields of the class"
+    table = cls.__dict__.get('__categorical_table__', None)
+    if table is None:
+        return 0
+    return len(table)
+
+def categorical_reset(cls):
+    """Clear the intern table of the categorical fields of the class.
+    The table keeps every distinct value assigned to the categorical fields,
+    so it's the way to release them; the values of the existing instances are kept,
+    but they are no longer identical to the values interned after the reset."""
+    table = cls.__dict__.get('__categorical_table__', None)
+    if table is not None:
+        table.clear()
+
+_stats_classes = _weakref.WeakSet()
+
+def stats_snapshot():
+    "Allocation statistics `{cls: cls.__stats__()}` of all alive classes created with `stats=True`"
+    return {cls:cls.__stats__() for cls in list(_stats_classes)}
+
+_drain_registered = False
+
+def _register_drain():
+    # release the queued references of deferred_dealloc=True instances at exit
+    global _drain_registered
+    if not _drain_registered:
+        import atexit
+        from ._dataobject import drain
+        atexit.register(drain)
+        _drain_registered = True
+
+_NoneType = type(None)
+
+def _validation_spec(tp):
+    "Compile the annotation into (kind, optional, arg) of the validator"
+    from ._dataobject import dataobject
+    from ._litelist import litelist
+
+    optional = False
+    if hasattr(tp, '__metadata__'):             # Annotated[T, ...]
+        tp = tp.__origin__
+    origin = getattr(tp, '__origin__', None)
+    if origin is typing.Union or (_PY310 and type(tp) is _types.UnionType):
+        args = [a for a in tp.__args__ if a is not _NoneType]
+        if len(args) != 1 or len(args) == len(tp.__args__):
+            return ('any', False, None)
+        optional = True
+        tp = args[0]
+        if hasattr(tp, '__metadata__'):
+            tp = tp.__origin__
+        origin = getattr(tp, '__origin__', None)
+
+    if tp in (int, float, str, bytes, bool):
+        return (tp.__name__, optional, None)
+    if origin is litelist:
+        return ('litelist', optional, _validation_spec(tp.__args__[0]))
+    if tp is litelist:
+        return ('litelist', optional, None)
+    if isinstance(tp, type) and tp is not object and origin is None:
+        if issubclass(tp, dataobject):
+            return ('dataobject', optional, tp)
+        return ('instance', optional, tp)
+    return ('any', False, None)
+
+def _validation_plan(cls):
+    "Specs of the validator for the fields of the class (the annotations may be strings)"
+    try:
+        if _sys.version_info[:2] >= (3, 9):
+            hints = typing.get_type_hints(cls, include_extras=True)
+        else:
+            hints = typing.get_type_hints(cls)
+    except Exception:
+        hints = getattr(cls, '__annotations__', {})
+    return tuple(_validation_spec(hints.get(fn, typing.Any)) for fn in cls.__fields__)
                 
 class datatype(type):
     """
@@ -65,14 +335,14 @@ class datatype(type):
                 gc=False, fast_new=True, readonly=False, iterable=False,
                 deep_dealloc=False, sequence=False, mapping=False,
                 use_dict=False, use_weakref=False, hashable=False, 
-                immutable_type=False, copy_default=False, match=None):
+                immutable_type=False, copy_default=False, match=None, stats=False,
+                arena=False, deferred_dealloc=False, validate=False, sparse=False,
+                track_changes=False):
 
         from .utils import check_name, collect_info_from_bases
         from ._dataobject import dataobject, datastruct
-        from ._dataobject import dataobjectproperty
+        from ._dataobject import dataobjectproperty, member_new, tail as tail_items
         from sys import intern as _intern
-        if _PY311:
-            from ._dataobject import member_new
 
         options = {}
         if gc:
@@ -97,6 +367,18 @@ class datatype(type):
             options['use_weakref'] = use_weakref
         if copy_default:
             options['copy_default'] = copy_default
+        if stats:
+            options['stats'] = stats
+        if arena:
+            options['arena'] = arena
+        if deferred_dealloc:
+            options['deferred_dealloc'] = deferred_dealloc
+        if validate:
+            options['validate'] = validate
+        if sparse:
+            options['sparse'] = sparse
+        if track_changes:
+            options['track_changes'] = track_changes
         
         if _PY311 and immutable_type:
             options['immutable_type'] = immutable_type
@@ -157,6 +439,22 @@ class datatype(type):
         else:
             fields = [_intern(check_name(fn)) for fn in fields]
 
+        tail = None
+        inline = ()
+        if has_fields:
+            tails = [fn for fn in fields if _is_tail(annotations.get(fn, None))]
+            if tails:
+                tail = tails[0]
+                if len(tails) > 1 or tail != fields[-1]:
+                    raise TypeError('Tail field should be the last field')
+                if tail in ns:
+                    raise TypeError('Tail field can not have default value')
+                if not fast_new:
+                    raise TypeError('Tail field requires fast_new=True')
+                fields.remove(tail)
+                fields_dict.pop(tail, None)
+                ns['__tail__'] = tail
+
         if sequence:
             options['sequence'] = True
         if mapping:
@@ -230,11 +528,26 @@ class datatype(type):
                 copy_default = options.get('copy_default', False)
                 gc = options.get('gc', False)
                 iterable = options.get('iterable', False)
+                stats = options.get('stats', False)
+                arena = options.get('arena', False)
+                deferred_dealloc = options.get('deferred_dealloc', False)
+                validate = options.get('validate', False)
                 defaults_dict = {fn:fd['default'] for fn,fd in fields_dict.items() if 'default' in fd} 
                 annotations = {fn:fd['type'] for fn,fd in fields_dict.items() if 'type' in fd} 
 
             fields = tuple(fields)
 
+            if sparse or any(_is_inline(fd.get('type', None)) or _is_packed(fd.get('type', None))
+                             for fd in fields_dict.values()):
+                if not fast_new:
+                    raise TypeError('Inline and Packed fields and sparse=True require fast_new=True')
+                inline = fields
+                if sparse:
+                    fields = _expand_sparse(fields, fields_dict, defaults_dict, ns)
+                else:
+                    fields = _expand_inline(fields, fields_dict, defaults_dict, ns)
+                annotations = {fn:fields_dict[fn]['type'] for fn in fields if 'type' in fields_dict[fn]}
+
             if is_datastruct and use_dict:
                 raise TypeError('datastruct subclasses can not have __dict__')
 
@@ -268,59 +581,78 @@ class datatype(type):
                 if match:
                     ns['__match_args__'] = match
 
+                # the patterns of the class with Inline fields match the datastructs
+                match_fields = inline or fields
                 if '__match_args__' in ns:
                     match_args = ns['__match_args__']
                     n_match = len(match_args)
-                    if n_match > len(fields) or fields[:n_match] != match_args:
-                        print(match_args, fields[:n_match])
+                    if n_match > len(match_fields) or match_fields[:n_match] != match_args:
                         raise TypeError(f"__match_args__ is not valid")
                 else:
-                    ns['__match_args__'] = fields
+                    ns['__match_args__'] = match_fields
 
             if '__doc__' not in ns:
                 ns['__doc__'] = _make_cls_doc(typename, fields, annotations, default_vals, use_dict)
         
-        ns['__options__'] = options
+        categorical = ()
+        if has_fields:
+            categorical = tuple(i for i, fn in enumerate(fields)
+                                if _is_categorical(fields_dict[fn].get('type', None)))
+        if categorical:
+            table = {}
+            for i in categorical:
+                fd = fields_dict[fields[i]]
+                fd['categorical'] = True
+                val = fd.get('default', None)
+                if type(val) is str:
+                    table[val] = val
+            ns['__categorical_fields__'] = categorical
+            ns['__categorical_table__'] = table
+            options['categorical'] = True
 
-        if has_fields and not _PY311:
-            for i, name in enumerate(fields):
-                fd = fields_dict[name]
-                fd_readonly = fd.get('readonly', False)
-                if fd_readonly:
-                    ds = _ds_ro_cache.get(i, None)
-                else:
-                    ds = _ds_cache.get(i, None)
-                if ds is None:
-                    if fd_readonly:
-                        ds = dataobjectproperty(i, True)
-                    else:
-                        ds = dataobjectproperty(i, False)
-                ns[name] = ds
+        ns['__options__'] = options
 
         cls = type.__new__(metatype, typename, bases, ns)
 
-        if has_fields and _PY311:
+        # Fields are plain member descriptors (T_OBJECT_EX at the offset of the item),
+        # so the specializing interpreter treats them as __slots__ (LOAD_ATTR_SLOT/STORE_ATTR_SLOT)
+        # and 3.10 uses its LOAD_ATTR cache for slots. Categorical fields need interning on store.
+        if has_fields:
             for i, name in enumerate(fields):
                 fd = fields_dict[name]
                 fd_readonly = fd.get('readonly', False)
-                if fd_readonly:
+                if fd.get('categorical', False):
+                    ds = dataobjectproperty(i, fd_readonly, table)
+                elif validate or track_changes:
+                    # the assigned values are checked (or the field is marked as changed) by the setter
+                    ds = dataobjectproperty(i, fd_readonly)
+                elif fd_readonly:
                     ds = member_new(cls, name, i, 1)
                 else:
                     ds = member_new(cls, name, i, 0)
                 setattr(cls, name, ds)
+            if tail:
+                setattr(cls, tail, property(tail_items))
 
         cls.__configure__(sequence=sequence, mapping=mapping, readonly=readonly,
                           hashable=hashable, iterable=iterable, use_dict=use_dict,
                           use_weakref=use_weakref, gc=gc, deep_dealloc=deep_dealloc,
                           immutable_type=immutable_type, copy_default=copy_default,
+                          categorical=bool(categorical), stats=stats, arena=arena,
+                          deferred_dealloc=deferred_dealloc, validate=validate,
+                          tail=tail, inline=bool(inline), track_changes=track_changes,
                          )
+        if stats:
+            _stats_classes.add(cls)
 
         return cls
 
     def __configure__(cls,  gc=False, fast_new=True, readonly=False, iterable=False,
                             deep_dealloc=False, sequence=False, mapping=False,
                             use_dict=False, use_weakref=False, hashable=False, 
-                            mapping_only=False, immutable_type=False, copy_default=False):
+                            mapping_only=False, immutable_type=False, copy_default=False,
+                            categorical=False, stats=False, arena=False, deferred_dealloc=False,
+                            validate=False, tail=None, inline=False, track_changes=False):
 
         import recordclass._dataobject as _dataobject
         from .utils import _have_pyinit, _have_pynew
@@ -341,6 +673,8 @@ class datatype(type):
         _dataobject._dataobject_type_init(cls)
 
         _dataobject._datatype_collection_mapping(cls, sequence, mapping, readonly)
+        if mapping or hasattr(cls, '__fields_index__'):
+            _dataobject._datatype_mapping_methods(cls)
         if hashable:
             _dataobject._datatype_hashable(cls)
         else:
@@ -361,6 +695,45 @@ class datatype(type):
             _dataobject._datatype_vectorcall(cls)
         if copy_default and not is_pyinit and not is_pynew:
             _dataobject._datatype_copy_default(cls)
+        if categorical:
+            _dataobject._datatype_categorical(cls)
+        if tail:
+            if gc or mapping or deep_dealloc or copy_default or categorical or arena or \
+                    deferred_dealloc or validate or stats or is_pyinit or is_pynew:
+                raise TypeError("Tail field is not compatible with gc, mapping, deep_dealloc, copy_default, "
+                                "categorical, arena, deferred_dealloc, validate, stats, __init__ and __new__")
+            _dataobject._datatype_tail(cls)
+        if inline:
+            if tail or copy_default or categorical or validate or is_pyinit or is_pynew:
+                raise TypeError("Inline and Packed fields are not compatible with Tail field, copy_default, "
+                                "categorical, validate, __init__ and __new__")
+            packed = any(type(ds) is _dataobject.bitproperty for _, ds in cls.__inline__)
+            if packed and (sequence or mapping or arena or stats):
+                raise TypeError("Packed fields are not compatible with sequence, mapping, arena=True and stats=True")
+            sparse = any(type(ds) is _dataobject.sparseproperty for _, ds in cls.__inline__)
+            if sparse and (gc or deep_dealloc or sequence or mapping or arena or deferred_dealloc or stats):
+                raise TypeError("sparse=True is not compatible with gc, deep_dealloc, sequence, mapping, "
+                                "arena, deferred_dealloc and stats")
+            _dataobject._datatype_inline(cls)
+        if track_changes:
+            if tail or inline or arena or stats or is_pyinit or is_pynew:
+                raise TypeError("track_changes=True is not compatible with Tail, Inline and Packed fields, "
+                                "sparse, arena, stats, __init__ and __new__")
+            _dataobject._datatype_track_changes(cls)
+        if arena:
+            if gc or stats:
+                raise TypeError("arena=True is not compatible with gc=True and stats=True")
+            _dataobject._datatype_arena(cls)
+        if deferred_dealloc:
+            if stats:
+                raise TypeError("deferred_dealloc=True is not compatible with stats=True")
+            _dataobject._datatype_deferred_dealloc(cls)
+            _register_drain()
+        if validate:
+            _dataobject._datatype_validate(cls, _validation_plan(cls))
+        if stats:
+            from .utils import headgc_size
+            _dataobject._datatype_stats(cls, headgc_size)
         if _PY311 and immutable_type:
             _dataobject._datatype_immutable(cls)
         _dataobject._pytype_modified(cls)
@@ -369,12 +742,13 @@ class datatype(type):
         from ._dataobject import dataobjectproperty
         if name in cls.__dict__:
             o = getattr(cls, name)
-            if type(o) is dataobjectproperty or name in {'__fields__', '__defaults__', '__annotations__'}:
+            if type(o) is dataobjectproperty or name in _protected_names or \
+                    type(o) is _MemberDescriptorType:
                 raise AttributeError(f"Attribute {name} of the class {cls.__name__} can't be deleted")
         type.__delattr__(cls, name)
 
     def __setattr__(cls, name, ob):
-        if name in {'__fields__', '__defaults__', '__annotations__'}:
+        if name in _protected_names:
             raise AttributeError(f"Attribute {name} of the class {cls.__name__} can't be modified")
         type.__setattr__(cls, name, ob)
 
@@ -38,11 +38,11 @@ def make_dictclass(typename, keys, defaults=None, *, bases=None, namespace=None,
     'Point(x, y)'
     >>> p = Point(1, 2)                 # instantiate with positional args or keywords
     """
-    from ._dataobject import dataobject, astuple, asdict
+    from ._dataobject import dataobject, astuple, asdict, update as _update
     from .datatype import datatype
     import sys as _sys
 
-    keys, annotations, defaults = process_fields(keys, defaults, False, ())
+    keys, annotations, defaults, _ = process_fields(keys, defaults, False, ())
     typename = check_name(typename)
     
     if namespace is None:
@@ -65,39 +65,17 @@ def make_dictclass(typename, keys, defaults=None, *, bases=None, namespace=None,
     if readonly:
         raise TypeError('Immutable type can not support dict-like interface')
 
-    def keys(self):
-        return iter(self.__fields__)
-
-    def values(self):
-        return iter(self)
-
-    def items(self):
-        for key in self.__fields__:
-            yield key, self[key]
-
+    # keys, values, items, get and __contains__ are implemented in _dataobject
     def update(self, d):
-        return update(self, d)
-
-    def get(self, key, default=None):
-        try:
-            return self[key]
-        except KeyError:
-            return default
-
-    def __contains__(self, key):
-        return (key in self.__fields__)
+        return _update(self, **d)
 
     ns.update({
-        'keys': keys, 
-        'items': items, 
-        'values': values, 
-        'get': get,
         'update': update,
     })
 
     if bases:
         base0 = bases[0]
-        if not isinstance(base0, dataobject):
+        if not issubclass(base0, dataobject):
             raise TypeError("First base class should be subclass of dataobject")
     else:
         bases = (dataobject,)
@@ -136,6 +114,6 @@ class DictclassStorage:
         key = (name, keys)
         cls = self._storage.get(key, None)
         if cls is None:
-            cls = make_datadict(name, keys, defaults, **kw)
+            cls = make_dictclass(name, keys, defaults, **kw)
             self._storage[key] = cls
         return cls
@@ -5,6 +5,11 @@ from recordclass.test.test_arrayclass import *
 from recordclass.test.test_dataobject import *
 from recordclass.test.test_litelist import *
 from recordclass.test.test_litetuple import *
+from recordclass.test.test_arrow import *
+from recordclass.test.test_ingest import *
+from recordclass.test.test_benchmark import *
+from recordclass.test.test_sizeof import *
+from recordclass.test.test_dictclass import *
 
 import sys
 _PY36 = sys.version_info[:2] >= (3, 6)
@@ -15,6 +15,7 @@ else:
 
 
 TPickle1 = make_arrayclass("TPickle1", 3)
+TPickle2 = make_arrayclass("TPickle2", 3, dtype='d')
 
 class arrayobjectTest(unittest.TestCase):
 
@@ -216,6 +217,111 @@ class arrayobjectTest(unittest.TestCase):
                 q = loads(tmp)
                 self.assertEqual(p, q)
 
+    def test_typed(self):
+        A = make_arrayclass("A", 3, dtype='d')
+        a = A(1, 2.5)
+        self.assertEqual(tuple(a), (1.0, 2.5, 0.0))
+        self.assertEqual(len(a), 3)
+        a[2] = 3
+        a[-3] = -1
+        self.assertEqual(list(a), [-1.0, 2.5, 3.0])
+        self.assertEqual(repr(a), "A(-1.0, 2.5, 3.0)")
+        self.assertEqual(sys.getsizeof(a), pyobject_size + 3*8)
+        with self.assertRaises(IndexError):
+            a[3]
+        with self.assertRaises(TypeError):
+            a[0] = 'x'
+        with self.assertRaises(TypeError):
+            A(1, 2, 3, 4)
+        with self.assertRaises(TypeError):
+            A(x=1)
+
+    def test_typed_slot_wrappers(self):
+        A = make_arrayclass("A", 2, dtype='d')
+        a = A(1)
+        self.assertEqual(a.__getitem__(0), 1.0)
+        self.assertEqual(a.__getitem__(1), 0.0)
+        a.__setitem__(1, 2)
+        self.assertEqual(a.__getitem__(-1), 2.0)
+        with self.assertRaises(IndexError):
+            a.__getitem__(2)
+        B = make_arrayclass("B", 2, dtype='b', readonly=True)
+        b = B(1, 2)
+        self.assertEqual(b.__getitem__(1), 2)
+        with self.assertRaises(TypeError):
+            b.__setitem__(0, 3)
+
+    def test_typed_ints(self):
+        A = make_arrayclass("A", 2, dtype='b')
+        a = A(-128, 127)
+        self.assertEqual(tuple(a), (-128, 127))
+        with self.assertRaises(OverflowError):
+            a[0] = 128
+        B = make_arrayclass("B", 2, dtype='?')
+        self.assertEqual(tuple(B(1, 0)), (True, False))
+
+    def test_typed_dtype(self):
+        with self.assertRaises(ValueError):
+            make_arrayclass("A", 2, dtype='x')
+        with self.assertRaises(TypeError):
+            make_arrayclass("A", 2, dtype='d', gc=True)
+
+    def test_typed_buffer(self):
+        A = make_arrayclass("A", 3, dtype='i')
+        a = A(1, 2, 3)
+        m = memoryview(a)
+        self.assertEqual(m.format, 'i')
+        self.assertEqual(m.shape, (3,))
+        self.assertEqual(m.itemsize, 4)
+        self.assertFalse(m.readonly)
+        self.assertEqual(m.tolist(), [1, 2, 3])
+        m[1] = 10
+        self.assertEqual(a[1], 10)
+        m.release()
+        import array
+        self.assertEqual(bytes(a), array.array('i', [1, 10, 3]).tobytes())
+
+    def test_typed_readonly(self):
+        A = make_arrayclass("A", 2, dtype='d', readonly=True)
+        a = A(1, 2)
+        with self.assertRaises(TypeError):
+            a[0] = 3
+        m = memoryview(a)
+        self.assertTrue(m.readonly)
+        self.assertEqual(hash(a), hash((1.0, 2.0)))
+
+    def test_typed_compare(self):
+        A = make_arrayclass("A", 2, dtype='l', hashable=True)
+        self.assertEqual(A(1, 2), A(1, 2))
+        self.assertNotEqual(A(1, 2), A(1, 3))
+        self.assertTrue(A(1, 2) < A(1, 3))
+        self.assertEqual(len({A(1, 2), A(1, 2)}), 1)
+        B = make_arrayclass("B", 1, dtype='d')
+        self.assertNotEqual(B(float('nan')), B(float('nan')))
+        with self.assertRaises(TypeError):
+            hash(B(1))
+
+    def test_typed_weakref(self):
+        A = make_arrayclass("A", 3, dtype='h', use_weakref=True)
+        a = A(1, 2, 3)
+        r = weakref.ref(a)
+        self.assertIs(r(), a)
+        self.assertEqual(A(1, 2, 3), a)
+        del a
+        self.assertIsNone(r())
+
+    def test_typed_copy_pickle(self):
+        p = TPickle2(10, 20, 30)
+        self.assertEqual(copy.copy(p), p)
+        for protocol in range(-1, pickle.HIGHEST_PROTOCOL + 1):
+            self.assertEqual(pickle.loads(pickle.dumps(p, protocol)), p)
+
+    def test_typed_no_subclass(self):
+        A = make_arrayclass("A", 2, dtype='d')
+        with self.assertRaises(TypeError):
+            class B(A):
+                pass
+
 #     def test_pickle4(self):
 #         p = TPickleV1(10, 20, 30)
 #         for module in (pickle,):
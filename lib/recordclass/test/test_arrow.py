@@ -0,0 +1,199 @@
+import unittest
+from typing import Optional
+
+from recordclass import dataobject
+from recordclass.tools.arrow import to_arrow, columns_to_arrow, from_arrow, arrow_formats
+
+class Row(dataobject):
+    id: int
+    name: str
+    score: float
+    flag: bool
+    data: Optional[bytes]
+
+class ArrowTest(unittest.TestCase):
+
+    def test_formats(self):
+        self.assertEqual(arrow_formats(Row), ('l', 'u', 'g', 'b', 'z'))
+
+    def test_formats_unsupported(self):
+        class A(dataobject):
+            x: list
+        with self.assertRaises(TypeError):
+            arrow_formats(A)
+
+    def test_capsules(self):
+        schema, array = to_arrow([Row(1, 'a', 1.0, True, b'')])
+        self.assertEqual(type(schema).__name__, 'PyCapsule')
+        self.assertIn('arrow_schema', repr(schema))
+        self.assertIn('arrow_array', repr(array))
+
+    def test_roundtrip(self):
+        rows = [Row(i, str(i)*i, i/2, i % 2 == 0, bytes(i)) for i in range(100)]
+        rows2 = from_arrow(Row, to_arrow(rows))
+        self.assertEqual(rows, rows2)
+
+    def test_roundtrip_nulls(self):
+        rows = [Row(None, 'a', 1.5, None, None), Row(2, None, None, False, b'x')]
+        rows2 = from_arrow(Row, to_arrow(rows))
+        self.assertEqual(rows, rows2)
+
+    def test_roundtrip_empty(self):
+        self.assertEqual(from_arrow(Row, to_arrow([], Row)), [])
+
+    def test_columns(self):
+        columns = {'id':[1, 2], 'name':['a', 'b'], 'score':[0.5, 1.5],
+                   'flag':[True, False], 'data':[None, b'b']}
+        rows = from_arrow(Row, columns_to_arrow(Row, columns))
+        self.assertEqual(rows, [Row(1, 'a', 0.5, True, None), Row(2, 'b', 1.5, False, b'b')])
+
+    def test_columns_length(self):
+        with self.assertRaises(ValueError):
+            columns_to_arrow(Row, [[1, 2], ['a'], [0.5], [True], [None]])
+
+    def test_import_by_name(self):
+        class B(dataobject):
+            name: str
+            id: int
+        rows = from_arrow(B, to_arrow([Row(1, 'a', 1.0, True, b'')]))
+        self.assertEqual(rows, [B('a', 1)])
+
+    def test_import_missing_column(self):
+        class C(dataobject):
+            id: int
+            other: int
+        with self.assertRaises(TypeError):
+            from_arrow(C, to_arrow([Row(1, 'a', 1.0, True, b'')]))
+
+    def test_bad_row(self):
+        class D(dataobject):
+            id: int
+        with self.assertRaises(TypeError):
+            to_arrow([Row(1, 'a', 1.0, True, b''), D(1)])
+
+    def test_bad_value(self):
+        with self.assertRaises(TypeError):
+            to_arrow([Row('x', 'a', 1.0, True, b'')])
+
+    def test_sparse(self):
+        class Sp(dataobject, sparse=True):
+            a: int = None
+            b: str = None
+        with self.assertRaisesRegex(TypeError, 'sparse'):
+            to_arrow([Sp(a=1, b='x')])
+        with self.assertRaisesRegex(TypeError, 'sparse'):
+            from_arrow(Sp, to_arrow([Row(1, 'a', 1.0, True, b'')]))
+
+    def test_packed(self):
+        from recordclass import Packed
+        class Pk(dataobject):
+            name: str
+            flag: Packed[bool]
+            lvl: Packed[range(8)] = 0
+        with self.assertRaisesRegex(TypeError, 'Packed'):
+            to_arrow([Pk('a', True, 3)])
+        with self.assertRaisesRegex(TypeError, 'Packed'):
+            from_arrow(Pk, to_arrow([Row(1, 'a', 1.0, True, b'')]))
+
+    def test_tail(self):
+        from recordclass import Tail
+        class Tl(dataobject):
+            name: str
+            vals: Tail[float]
+        with self.assertRaisesRegex(TypeError, 'Tail'):
+            to_arrow([Tl('a', 1.0, 2.0)])
+        with self.assertRaisesRegex(TypeError, 'Tail'):
+            from_arrow(Tl, to_arrow([Row(1, 'a', 1.0, True, b'')]))
+
+    def test_inline(self):
+        from recordclass import datastruct, Inline
+        class Money(datastruct):
+            amount: float
+            currency: str
+        class Tr(dataobject):
+            price: Inline[Money]
+            qty: int = 0
+        with self.assertRaisesRegex(TypeError, 'Inline'):
+            to_arrow([Tr(Money(1.5, 'USD'), 2)])
+        with self.assertRaisesRegex(TypeError, 'Inline'):
+            from_arrow(Tr, to_arrow([Row(1, 'a', 1.0, True, b'')]))
+
+    def test_malformed_array(self):
+        import ctypes
+        class ArrowArray(ctypes.Structure):
+            pass
+        ArrowArray._fields_ = [
+            ('length', ctypes.c_int64), ('null_count', ctypes.c_int64), ('offset', ctypes.c_int64),
+            ('n_buffers', ctypes.c_int64), ('n_children', ctypes.c_int64),
+            ('buffers', ctypes.POINTER(ctypes.c_void_p)),
+            ('children', ctypes.POINTER(ctypes.POINTER(ArrowArray))),
+            ('dictionary', ctypes.c_void_p), ('release', ctypes.c_void_p), ('private_data', ctypes.c_void_p)]
+        get_pointer = ctypes.pythonapi.PyCapsule_GetPointer
+        get_pointer.restype = ctypes.c_void_p
+        get_pointer.argtypes = [ctypes.py_object, ctypes.c_char_p]
+
+        schema, array = to_arrow([Row(1, 'a', 1.0, True, b''), Row(2, 'b', 2.0, False, b'x')])
+        parent = ArrowArray.from_address(get_pointer(array, b'arrow_array'))
+        id_col = parent.children[0].contents
+        name_col = parent.children[1].contents
+
+        for ob, attr, value in [(id_col, 'length', 1), (id_col, 'offset', -1), (parent, 'offset', 1),
+                                (id_col, 'n_buffers', 1), (name_col, 'n_buffers', 2), (parent, 'length', -1)]:
+            saved = getattr(ob, attr)
+            setattr(ob, attr, value)
+            with self.assertRaises(ValueError):
+                from_arrow(Row, (schema, array))
+            setattr(ob, attr, saved)
+
+        for col, i in [(id_col, 1), (name_col, 2)]:
+            saved = col.buffers[i]
+            col.buffers[i] = None
+            with self.assertRaises(ValueError):
+                from_arrow(Row, (schema, array))
+            col.buffers[i] = saved
+
+        self.assertEqual(len(from_arrow(Row, (schema, array))), 2)
+
+    def test_dictionary_encoded(self):
+        import ctypes
+        class ArrowSchema(ctypes.Structure):
+            pass
+        ArrowSchema._fields_ = [
+            ('format', ctypes.c_char_p), ('name', ctypes.c_char_p), ('metadata', ctypes.c_char_p),
+            ('flags', ctypes.c_int64), ('n_children', ctypes.c_int64),
+            ('children', ctypes.POINTER(ctypes.POINTER(ArrowSchema))),
+            ('dictionary', ctypes.c_void_p), ('release', ctypes.c_void_p), ('private_data', ctypes.c_void_p)]
+        get_pointer = ctypes.pythonapi.PyCapsule_GetPointer
+        get_pointer.restype = ctypes.c_void_p
+        get_pointer.argtypes = [ctypes.py_object, ctypes.c_char_p]
+
+        schema, array = to_arrow([Row(1, 'a', 1.0, True, b'')])
+        parent = ArrowSchema.from_address(get_pointer(schema, b'arrow_schema'))
+        name_col = parent.children[1].contents
+        # the column of the indices into the dictionary of the strings
+        name_col.dictionary = ctypes.addressof(name_col)
+        with self.assertRaisesRegex(TypeError, 'dictionary'):
+            from_arrow(Row, (schema, array))
+        name_col.dictionary = None
+        self.assertEqual(from_arrow(Row, (schema, array)), [Row(1, 'a', 1.0, True, b'')])
+
+    def test_not_dataobject(self):
+        from recordclass._arrow import _export_rows, _import_rows
+        class P:
+            __fields__ = ('id',)
+        with self.assertRaises(TypeError):
+            _export_rows(P, [P()], ('l',))
+        with self.assertRaises(TypeError):
+            _import_rows(P, *to_arrow([Row(1, 'a', 1.0, True, b'')]))
+
+    def test_arrow_c_array_protocol(self):
+        rows = [Row(1, 'a', 1.0, True, b'')]
+        class Batch:
+            def __arrow_c_array__(self, requested_schema=None):
+                return to_arrow(rows)
+        self.assertEqual(from_arrow(Row, Batch()), rows)
+
+def main():
+    suite = unittest.TestSuite()
+    suite.addTest(unittest.makeSuite(ArrowTest))
+    return suite
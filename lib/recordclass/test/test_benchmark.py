@@ -0,0 +1,43 @@
+import sys
+import unittest
+
+from recordclass.tools.benchmark import run, run_specialization, compare
+
+class BenchmarkTest(unittest.TestCase):
+
+    def test_run(self):
+        results = run(number=10, repeat=1, select=['new.', 'dealloc.'], memory=False, gc_pauses=False,
+                      specialization=False)
+        self.assertIn('meta', results)
+        self.assertIn('new.positional', results['timings'])
+        self.assertIn('dealloc.tree.gc', results['timings'])
+        self.assertNotIn('getattr', results['timings'])
+        self.assertNotIn('memory', results)
+
+    def test_specialization(self):
+        results = run_specialization(warmup=100, number=10, repeat=1)
+        self.assertIn('plain', results)
+        if sys.version_info[:2] >= (3, 11):
+            for name, info in results.items():
+                self.assertTrue(info['specialized'], (name, info))
+            self.assertEqual(results['plain']['load'], 'LOAD_ATTR_SLOT')
+            self.assertNotIn('store', results['readonly'])
+        else:
+            self.assertIn('slots_ratio', results['plain'])
+
+    def test_compare_specialization(self):
+        base = {'specialization': {'a': {'specialized': True}, 'b': {'specialized': False}}}
+        new = {'specialization': {'a': {'specialized': False}, 'b': {'specialized': True}}}
+        rows = {(kind, name): regression for kind, name, *_, regression in compare(base, new)}
+        self.assertEqual(rows, {('spec', 'a'): True, ('spec', 'b'): False})
+
+    def test_compare(self):
+        base = {'timings': {'a': 100.0, 'b': 100.0}, 'memory': {'x': 40.0}}
+        new = {'timings': {'a': 105.0, 'b': 150.0, 'c': 1.0}, 'memory': {'x': 48.0}}
+        rows = {(kind, name): regression for kind, name, *_, regression in compare(base, new, 0.1)}
+        self.assertEqual(rows, {('time', 'a'): False, ('time', 'b'): True, ('memory', 'x'): True})
+
+def main():
+    suite = unittest.TestSuite()
+    suite.addTest(unittest.makeSuite(BenchmarkTest))
+    return suite
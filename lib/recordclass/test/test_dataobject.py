@@ -5,6 +5,8 @@ import re
 import sys
 import gc
 import weakref
+import itertools
+import typing
 
 from recordclass import make_dataclass, make_arrayclass, dataobject, make, clone, update
 from recordclass import datatype, asdict, astuple, join_dataclasses
@@ -18,6 +20,10 @@ else:
 TPickle2 = make_dataclass("TPickle2", ('x','y','z'))
 TPickle3 = make_dataclass("TPickle3", ('x','y','z'), use_dict=True)
 
+if sys.version_info >= (3, 9):
+    from recordclass import Categorical
+    TPickleCat = make_dataclass("TPickleCat", [('id', int), ('country', typing.Annotated[str, Categorical])])
+
 ##########################################################################
         
 class DataobjectTest(unittest.TestCase):
@@ -656,6 +662,25 @@ class DataobjectTest(unittest.TestCase):
     #     with self.assertRaises(AttributeError):        
     #         delattr(A, 'x')
 
+    def test_del_field_value(self):
+        A = make_dataclass("A", 'x y', sequence=True, hashable=True)
+        a = A(1, 2)
+        del a.x
+        with self.assertRaises(AttributeError):
+            a.x
+        self.assertEqual(repr(a), "A(x=None, y=2)")
+        self.assertEqual(a, A(None, 2))
+        self.assertEqual(hash(a), hash(A(None, 2)))
+        self.assertEqual((a[0], list(a), astuple(a), asdict(a)), (None, [None, 2], (None, 2), {'x':None, 'y':2}))
+        self.assertEqual(a.__reduce__(), (A, (None, 2)))
+        b = copy.copy(a)
+        with self.assertRaises(AttributeError):
+            b.x
+        with self.assertRaises(TypeError):
+            del a[1]
+        a.x = 3
+        self.assertEqual(a, A(3, 2))
+
     # def test_del_value(self):
     #     A = make_dataclass("A", 'x y')
     #     a = A(1, 2)
@@ -931,8 +956,1349 @@ class DataobjectTest(unittest.TestCase):
             a['x'] = 100
         with self.assertRaises(TypeError):        
             a['y'] = 200
-            
+
+def _s(*parts):
+    # equal but not identical str object
+    return ''.join(parts)
+
+@unittest.skipIf(sys.version_info < (3, 9), "typing.Annotated is required")
+class CategoricalTest(unittest.TestCase):
+
+    def make_class(self, **kw):
+        from typing import Annotated
+        from recordclass import Categorical
+        class A(dataobject, **kw):
+            id: int
+            country: Annotated[str, Categorical]
+            status: Annotated[str, Categorical] = 'new'
+        return A
+
+    def test_vectorcall(self):
+        from recordclass import categorical_size
+        A = self.make_class()
+        a = A(1, _s('R', 'U'))
+        b = A(2, _s('R', 'U'), status=_s('ne', 'w'))
+        self.assertIs(a.country, b.country)
+        self.assertIs(a.status, b.status)
+        self.assertEqual(categorical_size(A), 2)
+        self.assertEqual(a, A(1, 'RU'))
+
+    def test_setattr_update(self):
+        from recordclass import categorical_size
+        A = self.make_class()
+        a = A(1, 'DE')
+        a.country = _s('F', 'R')
+        b = A(2, 'X')
+        update(b, country=_s('F', 'R'))
+        self.assertIs(a.country, b.country)
+        c = clone(a, country=_s('D', 'E'))
+        d = make(A, (3, _s('D', 'E')))
+        self.assertIs(c.country, d.country)
+        self.assertEqual(categorical_size(A), 4)
+
+    def test_non_str(self):
+        A = self.make_class()
+        a = A(1, None)
+        a.country = 1
+        self.assertEqual(a.country, 1)
+
+    def test_sequence(self):
+        A = self.make_class(sequence=True)
+        a = A(1, 'x')
+        a[1] = _s('U', 'S')
+        self.assertIs(a[1], A(2, _s('U', 'S')).country)
+        a[-1] = _s('ne', 'w')
+        self.assertIs(a.status, A(3, 'x').status)
+        a[0] = _s('U', 'S')
+        self.assertIsNot(a[0], a[1])
+
+    def test_mapping(self):
+        A = self.make_class(mapping=True)
+        a = A(1, 'x')
+        a['country'] = _s('U', 'S')
+        self.assertIs(a.country, A(2, _s('U', 'S')).country)
+
+    def test_copy_default(self):
+        A = self.make_class(copy_default=True)
+        self.assertIs(A(1, _s('U', 'S')).country, A(2, _s('U', 'S')).country)
+
+    def test_subclass(self):
+        A = self.make_class()
+        class B(A):
+            x: int = 0
+        from recordclass import categorical_size
+        self.assertIs(B(1, _s('U', 'S')).country, B(2, _s('U', 'S')).country)
+        self.assertEqual(categorical_size(A), 1)
+
+    def test_pickle(self):
+        a = TPickleCat(1, _s('U', 'S'))
+        self.assertIs(copy.copy(a).country, a.country)
+        for protocol in range(pickle.HIGHEST_PROTOCOL + 1):
+            b = pickle.loads(pickle.dumps(a, protocol))
+            self.assertEqual(b, a)
+            self.assertIs(b.country, a.country)
+
+    def test_reset(self):
+        from recordclass import categorical_size, categorical_reset
+        A = self.make_class(sequence=True)
+        a = A(1, _s('U', 'S'))
+        self.assertEqual(categorical_size(A), 2)
+        categorical_reset(A)
+        self.assertEqual(categorical_size(A), 0)
+        b = A(2, _s('U', 'S'))
+        self.assertIsNot(b.country, a.country)
+        self.assertEqual(b.country, a.country)
+        b[1] = _s('U', 'S')
+        self.assertIs(A(3, _s('U', 'S')).country, b.country)
+        self.assertEqual(categorical_size(A), 2)
+
+    def test_readonly(self):
+        A = self.make_class(readonly=True)
+        a = A(1, 'x')
+        with self.assertRaises(AttributeError):
+            a.country = 'y'
+
+class StatsTest(unittest.TestCase):
+
+    def test_counters(self):
+        class A(dataobject, stats=True):
+            x: int
+            y: int
+        lst = [A(i, i) for i in range(10)]
+        del lst[5:]
+        st = A.__stats__()
+        self.assertEqual(st['live'], 5)
+        self.assertEqual(st['allocated'], 10)
+        self.assertEqual(st['peak'], 10)
+        self.assertEqual(st['bytes'], 5 * sys.getsizeof(lst[0]))
+        self.assertEqual(st['peak_bytes'], 10 * sys.getsizeof(lst[0]))
+        del lst
+        self.assertEqual(A.__stats__()['live'], 0)
+
+    def test_gc(self):
+        class A(dataobject, stats=True, gc=True):
+            x: object
+        a = A(None)
+        a.x = a
+        self.assertEqual(A.__stats__()['bytes'], sys.getsizeof(a))
+        del a
+        gc.collect()
+        self.assertEqual(A.__stats__()['live'], 0)
+        self.assertEqual(A.__stats__()['allocated'], 1)
+
+    def test_copy_reset(self):
+        A = make_dataclass('A', 'x y', stats=True)
+        a = A(1, 2)
+        b = copy.copy(a)
+        c = clone(a, x=3)
+        d = make(A, (5, 6))
+        self.assertEqual(A.__stats__()['allocated'], 4)
+        del b, c, d
+        A.__stats__.reset()
+        st = A.__stats__()
+        self.assertEqual((st['live'], st['allocated'], st['peak']), (1, 0, 1))
+
+    def test_subclass_snapshot(self):
+        from recordclass import stats_snapshot
+        class A(dataobject, stats=True):
+            x: int
+        class B(A):
+            y: int
+        a, b = A(1), B(1, 2)
+        self.assertEqual(A.__stats__()['live'], 1)
+        self.assertEqual(B.__stats__()['live'], 1)
+        snapshot = stats_snapshot()
+        self.assertEqual(snapshot[A]['live'], 1)
+        self.assertEqual(snapshot[B]['live'], 1)
+
+    def test_disabled(self):
+        class A(dataobject):
+            x: int
+        self.assertFalse(hasattr(A, '__stats__'))
+
+@unittest.skipIf(is_pypy, "gc.is_tracked is not supported")
+class GCUntrackTest(unittest.TestCase):
+
+    # the setters of the fields of validate=True classes track the instance again
+    def make_class(self, **kw):
+        class A(dataobject, gc=True, validate=True, **kw):
+            x: object
+            y: object = 'a'
+        return A
+
+    def test_untrack_atomic(self):
+        A = self.make_class()
+        self.assertFalse(gc.is_tracked(A(1, 2.0)))
+        self.assertFalse(gc.is_tracked(A(1)))
+        self.assertFalse(gc.is_tracked(A(x=1, y=(1, 'a'))))
+        self.assertTrue(gc.is_tracked(A([])))
+        self.assertTrue(gc.is_tracked(A(1, y={})))
+        self.assertTrue(gc.is_tracked(A(1, ([],))))
+
+    def test_track_on_assign(self):
+        A = self.make_class(sequence=True)
+        a = A(1)
+        a.x = 2
+        self.assertFalse(gc.is_tracked(a))
+        a.x = []
+        self.assertTrue(gc.is_tracked(a))
+        b = A(1)
+        b[1] = {}
+        self.assertTrue(gc.is_tracked(b))
+        c = A(1)
+        update(c, y=[])
+        self.assertTrue(gc.is_tracked(c))
+        d = A(1)
+        object.__setattr__(d, 'x', [])
+        self.assertTrue(gc.is_tracked(d))
+
+    def test_readonly(self):
+        class R(dataobject, gc=True, readonly=True):
+            x: object
+            y: object = 'a'
+        self.assertFalse(gc.is_tracked(R(1)))
+        self.assertTrue(gc.is_tracked(R(1, [])))
+
+    def test_cycle_collected(self):
+        A = self.make_class(use_weakref=True)
+        a = A(1)
+        self.assertFalse(gc.is_tracked(a))
+        a.y = a
+        self.assertTrue(gc.is_tracked(a))
+        r = weakref.ref(a)
+        del a
+        gc.collect()
+        self.assertIsNone(r())
+
+    def test_not_untracked(self):
+        A = self.make_class(use_dict=True)
+        self.assertTrue(gc.is_tracked(A(1)))
+        # the specialized store into the slot of the member can't track the instance
+        class C(dataobject, gc=True):
+            x: object
+        self.assertTrue(gc.is_tracked(C(1)))
+        class B(dataobject, gc=True):
+            x: int
+            def __setattr__(self, name, val):
+                object.__setattr__(self, name, val)
+        self.assertTrue(gc.is_tracked(B(1)))
+
+    def test_subclass(self):
+        A = self.make_class()
+        class B(A):
+            z: object = 0
+        b = B(1)
+        self.assertFalse(gc.is_tracked(b))
+        b.z = []
+        self.assertTrue(gc.is_tracked(b))
+        class C(dataobject, gc=True, readonly=True):
+            x: object
+        class D(C, readonly=False):
+            y: object = 0
+        self.assertFalse(gc.is_tracked(C(1)))
+        self.assertTrue(gc.is_tracked(D(1)))
+
+class ArenaTest(unittest.TestCase):
+
+    def make_class(self, **kw):
+        class A(dataobject, arena=True, **kw):
+            x: object
+            y: object = None
+        return A
+
+    def test_allocation(self):
+        from recordclass import arena
+        A = self.make_class()
+        with arena() as a:
+            lst = [A(i, str(i)) for i in range(100000)]
+            b = copy.copy(lst[1])
+        self.assertEqual(a.n_objects, 100001)
+        self.assertGreater(a.n_blocks, 1)
+        self.assertEqual(b, A(1, '1'))
+        self.assertEqual([x.x for x in lst], list(range(100000)))
+        del lst
+        self.assertEqual(b.y, '1')
+
+    def test_escape(self):
+        from recordclass import arena
+        A = self.make_class(use_dict=True, use_weakref=True)
+        with arena():
+            a = A(1, [1, 2])
+            a.z = 3
+            r = weakref.ref(a)
+        del arena
+        self.assertEqual((a.x, a.y, a.z), (1, [1, 2], 3))
+        self.assertIs(r(), a)
+        del a
+        self.assertIsNone(r())
+
+    def test_outside(self):
+        from recordclass import arena
+        A = self.make_class()
+        a = A(1)
+        with arena() as ar:
+            b = A(2)
+        self.assertEqual(ar.n_objects, 1)
+        del a, b
+
+    def test_nested(self):
+        from recordclass import arena
+        A = self.make_class()
+        class B(A):
+            z: int = 0
+        outer, inner = arena(), arena()
+        with outer:
+            a = A(1)
+            with inner:
+                b = B(2)
+                with self.assertRaises(RuntimeError):
+                    with inner:
+                        pass
+            c = A(3)
+        self.assertEqual((outer.n_objects, inner.n_objects), (2, 1))
+        with self.assertRaises(RuntimeError):
+            with outer:
+                inner.__exit__(None, None, None)
+
+    def test_threads(self):
+        import threading
+        from recordclass import arena
+        A = self.make_class()
+        barrier = threading.Barrier(2, timeout=10)
+        arenas, errors = [arena(), arena()], []
+        # the second thread enters its region after the first one and exits it later
+        def run(k):
+            try:
+                if k == 1:
+                    barrier.wait()
+                with arenas[k]:
+                    if k == 0:
+                        barrier.wait()
+                    barrier.wait()
+                    lst = [A(i) for i in range(10 * (k + 1))]
+                    if k == 1:
+                        barrier.wait()
+                if k == 0:
+                    barrier.wait()
+            except Exception as e:
+                errors.append(e)
+                barrier.abort()
+        threads = [threading.Thread(target=run, args=(k,)) for k in range(2)]
+        for t in threads:
+            t.start()
+        for t in threads:
+            t.join()
+        self.assertEqual(errors, [])
+        self.assertEqual((arenas[0].n_objects, arenas[1].n_objects), (10, 20))
+
+    def test_not_compatible(self):
+        with self.assertRaises(TypeError):
+            self.make_class(gc=True)
+        with self.assertRaises(TypeError):
+            self.make_class(stats=True)
+
+class DeferredDeallocTest(unittest.TestCase):
+
+    def setUp(self):
+        from recordclass import drain
+        drain()
+
+    def make_tree(self, C, depth, leaves):
+        if depth == 0:
+            leaf = Leaf()
+            leaves.append(weakref.ref(leaf))
+            return C(None, None, leaf)
+        return C(self.make_tree(C, depth-1, leaves), self.make_tree(C, depth-1, leaves), None)
+
+    def make_class(self, **kw):
+        class Node(dataobject, deferred_dealloc=True, **kw):
+            left: object
+            right: object
+            value: object
+        return Node
+
+    def test_drain(self):
+        from recordclass import drain, deferred_pending
+        Node = self.make_class()
+        leaves = []
+        t = self.make_tree(Node, 6, leaves)
+        del t
+        n = deferred_pending()
+        self.assertTrue(0 < n < 2**7 - 2 + 2**6)
+        self.assertEqual(drain(3), 3)
+        self.assertTrue(any(r() is not None for r in leaves))
+        while deferred_pending():
+            drain(10)
+        self.assertTrue(all(r() is None for r in leaves))
+        self.assertEqual(drain(), 0)
+
+    def test_shared(self):
+        from recordclass import deferred_pending
+        Node = self.make_class()
+        leaf = Leaf()
+        a = Node(None, None, leaf)
+        del a
+        self.assertEqual(deferred_pending(), 0)
+
+    def test_drain_on_construction(self):
+        from recordclass import deferred_pending
+        Node = self.make_class()
+        leaves = []
+        t = self.make_tree(Node, 4, leaves)
+        a = Node(None, None, None)
+        del t
+        n = deferred_pending()
+        self.assertTrue(n > 0)
+        # the deallocation doesn't release the queued references
+        del a
+        self.assertEqual(deferred_pending(), n)
+        b = Node(None, None, None)
+        self.assertNotEqual(deferred_pending(), n)
+        for i in range(100):
+            Node(None, None, None)
+        self.assertEqual(deferred_pending(), 0)
+        self.assertTrue(all(r() is None for r in leaves))
+
+    def test_gc_and_dict(self):
+        from recordclass import drain
+        Node = self.make_class(gc=True, use_dict=True)
+        class Child(Node):
+            pass
+        leaf = Leaf()
+        r = weakref.ref(leaf)
+        a = Child(None, None, None)
+        a.z = [leaf]
+        a.left = a
+        del a, leaf
+        gc.collect()
+        drain()
+        self.assertIsNone(r())
+
+    def test_not_compatible(self):
+        from recordclass import _dataobject
+        with self.assertRaises(TypeError):
+            self.make_class(stats=True)
+        class S(dataobject, stats=True):
+            x: int
+        with self.assertRaisesRegex(TypeError, 'stats=True'):
+            _dataobject._datatype_deferred_dealloc(S)
+        class P(dataobject, sparse=True):
+            x: int
+        with self.assertRaisesRegex(TypeError, 'sparse=True'):
+            _dataobject._datatype_deferred_dealloc(P)
+
+class Leaf:
+    pass
+
+class FGPoint(dataobject):
+    x: int
+    y: int
+    z: int = 0
+
+class FieldGetterTest(unittest.TestCase):
+
+    def test_values(self):
+        from recordclass import fieldgetter, litetuple
+        p = FGPoint(1, 2, 3)
+        self.assertEqual(fieldgetter(FGPoint, 'y')(p), 2)
+        self.assertEqual(fieldgetter(FGPoint, 'z', 'x')(p), (3, 1))
+        self.assertIs(type(fieldgetter(FGPoint, 'z', 'x')(p)), tuple)
+        t = fieldgetter(FGPoint, 'x', 'y', litetuple=True)(p)
+        self.assertIs(type(t), litetuple)
+        self.assertEqual(tuple(t), (1, 2))
+        self.assertEqual(repr(fieldgetter(FGPoint, 'x', 'y')), "fieldgetter(FGPoint, 'x', 'y')")
+
+    def test_key(self):
+        from recordclass import fieldgetter
+        rows = [FGPoint(i % 3, -i, i) for i in range(10)]
+        key = fieldgetter(FGPoint, 'x', 'y')
+        self.assertEqual(sorted(rows, key=key), sorted(rows, key=lambda p: (p.x, p.y)))
+        self.assertIs(min(rows, key=fieldgetter(FGPoint, 'y')), rows[-1])
+        self.assertIs(max(rows, key=fieldgetter(FGPoint, 'z')), rows[-1])
+        key = fieldgetter(FGPoint, 'x')
+        groups = {k:len(list(g)) for k, g in itertools.groupby(sorted(rows, key=key), key=key)}
+        self.assertEqual(groups, {0:4, 1:3, 2:3})
+
+    def test_subclass(self):
+        from recordclass import fieldgetter
+        class Q(FGPoint):
+            w: int = 4
+        q = Q(1, 2)
+        self.assertEqual(fieldgetter(FGPoint, 'y', 'z')(q), (2, 0))
+        self.assertEqual(fieldgetter(Q, 'w', 'x')(q), (4, 1))
+        with self.assertRaises(TypeError):
+            fieldgetter(Q, 'w')(FGPoint(1, 2))
+
+    def test_errors(self):
+        from recordclass import fieldgetter
+        with self.assertRaises(TypeError):
+            fieldgetter(FGPoint)
+        with self.assertRaises(TypeError):
+            fieldgetter(FGPoint, 'a')
+        with self.assertRaises(TypeError):
+            fieldgetter(tuple, 'x')
+        with self.assertRaises(TypeError):
+            fieldgetter(FGPoint, 'x')((1, 2))
+        with self.assertRaises(TypeError):
+            fieldgetter(FGPoint, 'x')()
+
+    def test_pickle(self):
+        from recordclass import fieldgetter
+        f = pickle.loads(pickle.dumps(fieldgetter(FGPoint, 'y', 'x')))
+        self.assertEqual(f(FGPoint(1, 2)), (2, 1))
+
+class ReplacerTest(unittest.TestCase):
+
+    def test_copy(self):
+        class A(dataobject, use_dict=True):
+            id: int
+            balance: int
+            ts: int = 0
+        a = A(1, 100)
+        a.note = 'x'
+        r = A.__replacer__('balance', 'ts')
+        b = r(a, 200, 5)
+        self.assertEqual(b, A(1, 200, 5))
+        self.assertEqual(b.note, 'x')
+        self.assertEqual(a, A(1, 100, 0))
+        self.assertEqual(repr(r), "A.__replacer__('balance', 'ts')")
+
+    def test_inplace(self):
+        class A(dataobject):
+            id: int
+            balance: int
+        a = A(1, 100)
+        r = A.__replacer__('balance', inplace=True)
+        self.assertIsNone(r(a, 50))
+        self.assertEqual(a, A(1, 50))
+
+    def test_readonly(self):
+        class A(dataobject, readonly=True):
+            id: int
+            balance: int
+        a = A(1, 100)
+        self.assertEqual(A.__replacer__('balance')(a, 5), A(1, 5))
+        with self.assertRaises(TypeError):
+            A.__replacer__('balance', inplace=True)
+
+    @unittest.skipIf(sys.version_info < (3, 9), "typing.Annotated is required")
+    def test_categorical(self):
+        from typing import Annotated
+        from recordclass import Categorical
+        class A(dataobject):
+            id: int
+            country: Annotated[str, Categorical]
+        a = A(1, 'RU')
+        b = A.__replacer__('country')(a, ''.join(['R', 'U']))
+        self.assertIs(b.country, a.country)
+        A.__replacer__('country', inplace=True)(a, ''.join(['U', 'S']))
+        self.assertIs(a.country, A(2, 'US').country)
+
+    def test_gc(self):
+        class A(dataobject, gc=True, validate=True):
+            x: object
+        a = A(1)
+        self.assertFalse(gc.is_tracked(a))
+        A.__replacer__('x', inplace=True)(a, [])
+        self.assertTrue(gc.is_tracked(a))
+
+    def test_subclass_and_errors(self):
+        class A(dataobject):
+            x: int
+            y: int
+        class B(A):
+            z: int = 3
+        r = A.__replacer__('y')
+        self.assertEqual(r(B(1, 2), 5), B(1, 5, 3))
+        with self.assertRaises(TypeError):
+            A.__replacer__('w')
+        with self.assertRaises(TypeError):
+            A.__replacer__()
+        with self.assertRaises(TypeError):
+            r(A(1, 2))
+        with self.assertRaises(TypeError):
+            r(A(1, 2), 3, 4)
+        with self.assertRaises(TypeError):
+            B.__replacer__('z')(A(1, 2), 3)
+
+class BatchTest(unittest.TestCase):
+
+    def make_rows(self):
+        class R(dataobject):
+            a: int
+            b: float
+            c: str = 'x'
+        class S(R):
+            d: int = 0
+        return R, S, [R(1, 0.5), S(2, 1.5, 'y', 3), R(3, 2.5, 'z')]
+
+    def test_asdicts(self):
+        from recordclass import asdicts
+        R, S, rows = self.make_rows()
+        self.assertEqual(asdicts(rows), [asdict(r) for r in rows])
+        self.assertEqual(asdicts(iter(rows)), [asdict(r) for r in rows])
+        self.assertEqual(asdicts([]), [])
+
+    def test_astuples(self):
+        from recordclass import astuples
+        R, S, rows = self.make_rows()
+        self.assertEqual(astuples(rows), [astuple(r) for r in rows])
+
+    def test_column(self):
+        from recordclass import column, columns
+        from array import array
+        R, S, rows = self.make_rows()
+        self.assertEqual(column(rows, 'c'), ['x', 'y', 'z'])
+        self.assertEqual(column(rows, 'a', 'q'), array('q', [1, 2, 3]))
+        self.assertEqual(column(rows, 'b', dtype='d'), array('d', [0.5, 1.5, 2.5]))
+        self.assertEqual(columns(rows, 'c', 'a'), (['x', 'y', 'z'], [1, 2, 3]))
+        self.assertEqual(columns(rows, 'a', 'b', dtypes='d'), (array('d', [1, 2, 3]), array('d', [0.5, 1.5, 2.5])))
+        self.assertEqual(columns(rows, 'c', 'a', dtypes=[None, 'b']), (['x', 'y', 'z'], array('b', [1, 2, 3])))
+        self.assertEqual(columns(rows), ())
+
+    def test_errors(self):
+        from recordclass import asdicts, astuples, column, columns
+        R, S, rows = self.make_rows()
+        with self.assertRaises(TypeError):
+            asdicts(rows + [(1, 2)])
+        with self.assertRaises(TypeError):
+            astuples([1])
+        with self.assertRaises(TypeError):
+            column(rows, 'd')
+        with self.assertRaises(TypeError):
+            columns(rows, 'a', 'b', dtypes=['d'])
+        with self.assertRaises(TypeError):
+            column(rows, 'c', 'd')
+        with self.assertRaises(OverflowError):
+            column([R(1000, 0)], 'a', 'b')
+        with self.assertRaises(ValueError):
+            column(rows, 'a', 'u')
+
+from recordclass import _dataobject
+
+class ConstructorCountsTest(unittest.TestCase):
+
+    @unittest.skipIf(_dataobject.INSTRUMENT, "recordclass is built with RECORDCLASS_INSTRUMENT")
+    def test_not_instrumented(self):
+        from recordclass import constructor_counts
+        with self.assertRaises(RuntimeError):
+            constructor_counts()
+
+    @unittest.skipIf(not _dataobject.INSTRUMENT, "recordclass is built without RECORDCLASS_INSTRUMENT")
+    def test_counts(self):
+        from recordclass import constructor_counts, Factory
+        class A(dataobject, use_dict=True):
+            x: int
+            y: list = Factory(list)
+        constructor_counts(reset=True)
+        A(1, [])
+        A(1)
+        A(1, y=[])
+        A(x=1, z=2)
+        counts = constructor_counts(reset=True)[A]
+        self.assertEqual(counts['calls'], 4)
+        self.assertEqual(counts['positional'], 1)
+        self.assertEqual(counts['defaults'], 3)
+        self.assertEqual(counts['factory'], 3)
+        self.assertGreater(counts['factory_ns'], 0)
+        self.assertEqual(counts['kwargs'], 2)
+        self.assertEqual(counts['dict_fallback'], 1)
+        self.assertEqual(constructor_counts()[A]['calls'], 0)
+
+    @unittest.skipIf(not _dataobject.INSTRUMENT, "recordclass is built without RECORDCLASS_INSTRUMENT")
+    def test_nested_factory(self):
+        from recordclass import constructor_counts, Factory
+        class B(dataobject):
+            x: int = 0
+        class A(dataobject):
+            b: B = Factory(B)
+            c: B = Factory(B)
+        constructor_counts(reset=True)
+        A()
+        counts = constructor_counts()
+        self.assertEqual(counts[A]['factory'], 2)
+        self.assertEqual(counts[B]['factory'], 0)
+        self.assertEqual(counts[B]['calls'], 2)
+
+class ArityConstructorTest(unittest.TestCase):
+
+    def make_class(self, n, **kw):
+        fields = tuple('f%s' % i for i in range(n))
+        return make_dataclass('A%s' % n, fields, **kw), fields
+
+    def test_positional(self):
+        for n in range(1, 11):
+            A, fields = self.make_class(n)
+            args = tuple(range(n))
+            a = A(*args)
+            self.assertEqual(astuple(a), args)
+            self.assertEqual(A(*[str(i) for i in args]).f0, '0')
+            with self.assertRaises(TypeError):
+                A(*range(n+1))
+
+    def test_slow_path(self):
+        for n in range(1, 9):
+            A, fields = self.make_class(n, defaults={'f%s' % (n-1): -1})
+            args = tuple(range(n))
+            self.assertEqual(astuple(A(*args[:-1])), args[:-1] + (-1,))
+            self.assertEqual(astuple(A(*args[:-1], **{fields[-1]: 7})), args[:-1] + (7,))
+            self.assertEqual(astuple(A(**dict(zip(fields, args)))), args)
+            with self.assertRaises(TypeError):
+                A(*args, z=1)
+
+    def test_refcounts(self):
+        A, fields = self.make_class(4)
+        o = object()
+        rc = sys.getrefcount(o)
+        a = A(o, o, o, o)
+        self.assertEqual(sys.getrefcount(o), rc + 4)
+        del a
+        self.assertEqual(sys.getrefcount(o), rc)
+
+    def test_options(self):
+        class G(dataobject, gc=True, readonly=True):
+            x: object
+            y: object
+        self.assertFalse(gc.is_tracked(G(1, 2)))
+        self.assertTrue(gc.is_tracked(G(1, [])))
+        if sys.version_info >= (3, 9):
+            from recordclass import Categorical
+            from typing import Annotated
+            class C(dataobject):
+                x: Annotated[str, Categorical]
+                y: int
+            self.assertIs(C(_s('R', 'U'), 1).x, C(_s('R', 'U'), 2).x)
+        class S(G):
+            z: object
+        s = S(1, 2, [])
+        self.assertEqual(astuple(s), (1, 2, []))
+        self.assertTrue(gc.is_tracked(s))
+
+class VPoint(dataobject, validate=True):
+    x: int
+    y: float
+    name: str = ''
+    tag: 'typing.Optional[bytes]' = None
+
+class VLine(dataobject, validate=True, sequence=True):
+    a: VPoint
+    b: VPoint
+    closed: bool = False
+
+class ValidateTest(unittest.TestCase):
+
+    def test_check_and_coerce(self):
+        p = VPoint(1, 2, tag=bytearray(b'ab'))
+        self.assertEqual(astuple(p), (1, 2.0, '', b'ab'))
+        self.assertIs(type(p.y), float)
+        self.assertIs(type(p.tag), bytes)
+        self.assertIs(type(VPoint(3.0, 1.5).x), int)
+        for args in [('1', 2.0), (1, 'a'), (True, 1.0), (1.5, 1.0), (1, 1.0, b'x'), (1, 1.0, '', 'x')]:
+            with self.assertRaises(TypeError):
+                VPoint(*args)
+        with self.assertRaises(TypeError):
+            VPoint(1, 2.0, name=1)
+
+    def test_nested(self):
+        line = VLine((0, 1), {'x': 2, 'y': 3})
+        self.assertEqual(line.a, VPoint(0, 1.0))
+        self.assertEqual(line.b, VPoint(2, 3.0))
+        with self.assertRaises(TypeError):
+            VLine(VPoint(0, 1), 1)
+        with self.assertRaises(TypeError):
+            VLine(VPoint(0, 1), ('x', 1))
+        with self.assertRaises(TypeError):
+            VLine(VPoint(0, 1), VPoint(0, 1), 1)
+
+    def test_assignment(self):
+        p = VPoint(1, 2.0)
+        p.x = 2.0
+        self.assertIs(type(p.x), int)
+        with self.assertRaises(TypeError):
+            p.y = 'a'
+        update(p, name='p')
+        self.assertEqual(p.name, 'p')
+        with self.assertRaises(TypeError):
+            update(p, x='a')
+        self.assertEqual(p.x, 2)
+        line = VLine(p, p)
+        line[2] = True
+        with self.assertRaises(TypeError):
+            line[2] = 1
+        line[0] = (5, 5)
+        self.assertEqual(line.a, VPoint(5, 5.0))
+        r = VPoint.__replacer__('x')
+        self.assertEqual(r(p, 7.0).x, 7)
+        with self.assertRaises(TypeError):
+            r(p, 'a')
+
+    @unittest.skipIf(sys.version_info < (3, 9), "litelist[T] is supported since 3.9")
+    def test_litelist(self):
+        from recordclass import litelist
+        class A(dataobject, validate=True):
+            ints: litelist[int]
+            points: litelist[VPoint] = litelist([])
+            any: litelist = litelist([])
+        l = litelist([1, 2])
+        a = A(l)
+        self.assertIs(a.ints, l)
+        a = A([1, 2.0], [(0, 1)], (1, 'a'))
+        self.assertEqual(a.ints, litelist([1, 2]))
+        self.assertEqual(a.points, litelist([VPoint(0, 1.0)]))
+        self.assertEqual(a.any, litelist([1, 'a']))
+        with self.assertRaises(TypeError):
+            A(litelist([1, 'a']))
+        with self.assertRaises(TypeError):
+            A(1)
+
+    def test_subclass_and_init(self):
+        class S(VPoint):
+            z: int = 0
+        self.assertEqual(S(1, 2, z=3.0).z, 3)
+        self.assertIs(type(S(1, 2).y), float)
+        with self.assertRaises(TypeError):
+            S(1, 2, z='a')
+        class I(dataobject, validate=True):
+            a: int
+            def __init__(self, a):
+                self.a = a
+        self.assertIs(type(I(1.0).a), int)
+        with self.assertRaises(TypeError):
+            I('a')
+
+    def test_any_and_pickle(self):
+        class A(dataobject, validate=True):
+            a: object
+            b: 'typing.Union[int, str]'
+            c: list
+        a = A(None, 'x', [])
+        with self.assertRaises(TypeError):
+            A(None, 'x', ())
+        p = VPoint(1, 2.0, 'x')
+        self.assertEqual(pickle.loads(pickle.dumps(p)), p)
+        self.assertEqual(repr(VPoint.__validator__),
+                         'validator(x: int, y: float, name: str, tag: bytes | None)')
+
+from recordclass import Tail, datastruct, asdicts, astuples, deep_sizeof
+
+class Samples(dataobject, sequence=True):
+    name: str
+    rate: int = 1
+    values: Tail[float]
+
+class TailTest(unittest.TestCase):
+
+    def test_constructor(self):
+        a = Samples('a', 2, 1.0, 2.0, 3.0)
+        self.assertEqual(a.values, (1.0, 2.0, 3.0))
+        self.assertEqual(Samples('a', values=[1.0]).values, (1.0,))
+        self.assertEqual(Samples('a', values=iter([1.0])), Samples('a', 1, 1.0))
+        self.assertEqual(Samples(name='a').values, ())
+        self.assertEqual(Samples('a').rate, 1)
+        self.assertEqual(repr(Samples('a', 2, 1.0)), "Samples(name='a', rate=2, values=(1.0,))")
+        with self.assertRaises(TypeError):
+            Samples('a', 2, 1.0, values=[2.0])
+        with self.assertRaises(TypeError):
+            Samples('a', values=1)
+        with self.assertRaises(TypeError):
+            Samples('a', other=1)
+
+    def test_sequence(self):
+        a = Samples('a', 2, 1.0, 2.0)
+        self.assertEqual(len(a), 4)
+        self.assertEqual(list(a), ['a', 2, 1.0, 2.0])
+        self.assertEqual(a[2], 1.0)
+        self.assertEqual(a[-1], 2.0)
+        a[3] = 5.0
+        a[0] = 'b'
+        self.assertEqual(astuple(a), ('b', 2, 1.0, 5.0))
+        with self.assertRaises(IndexError):
+            a[4]
+        with self.assertRaises(IndexError):
+            a[-5] = 1.0
+        with self.assertRaises(AttributeError):
+            a.values = ()
+
+    def test_layout(self):
+        a = Samples('a', 2, *[i + 0.5 for i in range(10)])
+        b = Samples('a', 2)
+        self.assertEqual(sys.getsizeof(a) - sys.getsizeof(b), 10 * ref_size)
+        self.assertEqual(sys.getsizeof(b), pyobject_size + 2 * ref_size + pyssize)
+        self.assertEqual(deep_sizeof(a) - deep_sizeof(b), 10 * (ref_size + sys.getsizeof(0.5)))
+        self.assertFalse(gc.is_tracked(a))
+        with self.assertRaises(TypeError):
+            class B(Samples):
+                pass
+
+    def test_copy_pickle_and_conversion(self):
+        a = Samples('a', 2, 1.0, 2.0)
+        self.assertEqual(copy.copy(a), a)
+        self.assertEqual(clone(a, rate=3).values, (1.0, 2.0))
+        self.assertEqual(pickle.loads(pickle.dumps(a)), a)
+        self.assertEqual(asdict(a), {'name':'a', 'rate':2, 'values':(1.0, 2.0)})
+        self.assertEqual(asdicts([a]), [asdict(a)])
+        self.assertEqual(astuples([a]), [astuple(a)])
+        self.assertNotEqual(a, Samples('a', 2, 1.0))
+        self.assertLess(Samples('a', 2, 1.0), a)
+
+    def test_datastruct_and_options(self):
+        class Tags(datastruct, hashable=True):
+            key: int
+            tags: Tail[str]
+        self.assertEqual(hash(Tags(1, 'x', 'y')), hash(Tags(1, 'x', 'y')))
+        self.assertEqual(Tags(1, 'x').tags, ('x',))
+        class D(dataobject, use_dict=True, use_weakref=True):
+            items: Tail[int]
+        d = D(1, 2, z=3)
+        self.assertEqual((d.items, d.z), ((1, 2), 3))
+        self.assertIs(weakref.ref(d)(), d)
+        with self.assertRaises(TypeError):
+            class G(dataobject, gc=True):
+                items: Tail[int]
+        with self.assertRaises(TypeError):
+            class L(dataobject):
+                items: Tail[int]
+                x: int
+
+from recordclass import Inline
+
+class Money(datastruct):
+    amount: float
+    currency: str = 'USD'
+
+class Venue(datastruct):
+    id: int
+
+class Trade(dataobject):
+    price: Inline[Money]
+    venue: Inline[Venue, 'proxy']
+    qty: int = 0
+
+class InlineTest(unittest.TestCase):
+
+    def test_layout(self):
+        self.assertEqual(Trade.__fields__, ('price_amount', 'price_currency', 'venue_id', 'qty'))
+        self.assertEqual(Trade.__defaults__, {'price_currency': 'USD', 'qty': 0})
+        t = Trade(Money(1.5), Venue(7), 3)
+        self.assertEqual(astuple(t), (1.5, 'USD', 7, 3))
+        self.assertEqual((t.price_amount, t.venue_id), (1.5, 7))
+        self.assertEqual(repr(t), "Trade(price=Money(amount=1.5, currency='USD'), venue=Venue(id=7), qty=3)")
+        if sys.version_info >= (3, 10):
+            self.assertEqual(Trade.__match_args__, ('price', 'venue', 'qty'))
+
+    def test_constructor(self):
+        self.assertEqual(Trade((1.5, 'EUR'), (7,)), Trade(Money(1.5, 'EUR'), Venue(7)))
+        t = Trade(price=Money(2.0), qty=5)
+        self.assertEqual((t.price, t.qty), (Money(2.0, 'USD'), 5))
+        self.assertEqual(Trade(venue_id=3).venue_id, 3)
+        with self.assertRaises(TypeError):
+            Trade(1.5)
+        with self.assertRaises(TypeError):
+            Trade(Money(1.5), Venue(7), 3, 4)
+
+    def test_copy_and_proxy(self):
+        t = Trade(Money(1.5), Venue(7))
+        p = t.price
+        p.amount = 9.0
+        self.assertEqual(t.price_amount, 1.5)
+        t.price = (2.0, 'EUR')
+        self.assertEqual(t.price, Money(2.0, 'EUR'))
+        v = t.venue
+        v.id = 8
+        self.assertEqual(t.venue_id, 8)
+        self.assertEqual(v, Venue(8))
+        self.assertEqual(copy.copy(v), Venue(8))
+        t.venue = Venue(9)
+        self.assertEqual(v.id, 9)
+        with self.assertRaises(TypeError):
+            t.price = Venue(1)
+        with self.assertRaises(AttributeError):
+            v.name = 'x'
+
+    def test_update_and_pickle(self):
+        t = Trade(Money(1.5), Venue(7), 3)
+        update(t, price=Money(3.0, 'GBP'))
+        self.assertEqual(t.price, Money(3.0, 'GBP'))
+        self.assertEqual(clone(t, qty=4).qty, 4)
+        self.assertEqual(pickle.loads(pickle.dumps(t)), t)
+
+    def test_nested_and_options(self):
+        class Leg(datastruct):
+            price: Inline[Money]
+            side: int
+        class Order(dataobject, readonly=True):
+            leg: Inline[Leg, 'proxy']
+            tag: str = ''
+        o = Order(Leg(Money(1.0), 1))
+        self.assertEqual(Order.__fields__, ('leg_price_amount', 'leg_price_currency', 'leg_side', 'tag'))
+        self.assertEqual(o.leg.price, Money(1.0))
+        with self.assertRaises(AttributeError):
+            o.leg = Leg(Money(2.0), 1)
+        with self.assertRaises(AttributeError):
+            o.leg.side = 2
+        with self.assertRaises(TypeError):
+            class A(Trade):
+                pass
+        with self.assertRaises(TypeError):
+            class B(dataobject):
+                x: Inline[int]
+        with self.assertRaises(TypeError):
+            class C(dataobject):
+                price: Inline[Money]
+                price_amount: float
+
+import enum
+from recordclass import Packed
+
+class Color(enum.Enum):
+    RED = 1
+    GREEN = 2
+    BLUE = 3
+
+class Event(dataobject, hashable=True):
+    name: str
+    active: Packed[bool]
+    color: Packed[Color] = Color.GREEN
+    level: Packed[range(-4, 12, 2)] = 0
+    n: int = 0
+
+class PackedTest(unittest.TestCase):
+
+    def test_layout(self):
+        self.assertEqual(Event.__fields__, ('name', 'n'))
+        self.assertEqual(sys.getsizeof(Event('a')), sys.getsizeof(make_dataclass('E2', 'name n')('a', 0)) + 8)
+        class Flags(dataobject):
+            __annotations__ = {'f%s' % i: Packed[bool] for i in range(70)}
+        self.assertEqual((Flags.f63.index, Flags.f64.index, Flags.f64.shift), (0, 1, 0))
+        f = Flags(*[i % 3 == 0 for i in range(70)])
+        self.assertEqual([getattr(f, 'f%s' % i) for i in range(70)], [i % 3 == 0 for i in range(70)])
+
+    def test_constructor_and_defaults(self):
+        e = Event('a', True)
+        self.assertEqual((e.active, e.color, e.level, e.n), (True, Color.GREEN, 0, 0))
+        self.assertEqual(Event('b').active, False)
+        e = Event('x', level=2, color=Color.RED, active=True)
+        self.assertEqual(repr(e), "Event(name='x', active=True, color=<Color.RED: 1>, level=2, n=0)")
+        self.assertEqual(asdict(e), {'name': 'x', 'n': 0, 'active': True, 'color': Color.RED, 'level': 2})
+        with self.assertRaises(TypeError):
+            Event('a', 1)
+        with self.assertRaises(TypeError):
+            Event('a', z=1)
+
+    def test_assign(self):
+        e = Event('a')
+        e.color = Color.BLUE
+        e.level = 10
+        e.active = True
+        self.assertEqual((e.active, e.color, e.level), (True, Color.BLUE, 10))
+        with self.assertRaises(ValueError):
+            e.level = 3
+        with self.assertRaises(ValueError):
+            e.level = 12
+        with self.assertRaises(TypeError):
+            e.color = 1
+        with self.assertRaises(AttributeError):
+            del e.active
+        update(e, level=-4)
+        self.assertEqual(e.level, -4)
+
+    def test_compare_copy_pickle(self):
+        self.assertEqual(Event('a', True), Event('a', True))
+        self.assertNotEqual(Event('a', True), Event('a', False))
+        self.assertLess(Event('a', False), Event('a', True))
+        self.assertEqual(hash(Event('a', level=2)), hash(Event('a', level=2)))
+        e = Event('a', True, Color.BLUE, 8)
+        self.assertEqual(copy.copy(e), e)
+        self.assertEqual(pickle.loads(pickle.dumps(e)), e)
+        self.assertEqual(clone(e, active=False).level, 8)
+
+    def test_options(self):
+        class R(dataobject, readonly=True):
+            on: Packed[bool]
+        with self.assertRaises(AttributeError):
+            R(True).on = False
+        self.assertEqual(R(on=True).on, True)
+        class G(dataobject, gc=True, use_dict=True):
+            x: object
+            on: Packed[bool]
+        g = G([], True)
+        g.z = 1
+        self.assertEqual((g.on, g.z), (True, 1))
+        with self.assertRaises(TypeError):
+            class A(dataobject, arena=True):
+                on: Packed[bool]
+        with self.assertRaises(TypeError):
+            class B(Event):
+                pass
+        with self.assertRaises(TypeError):
+            class C(dataobject):
+                x: Packed[int]
+
+    def test_inline_and_packed(self):
+        from recordclass import Inline
+        class T(dataobject):
+            price: Inline[Money]
+            on: Packed[bool]
+            n: int = 0
+        t = T(Money(1.5), True, 2)
+        self.assertEqual(repr(t), "T(price=Money(amount=1.5, currency='USD'), on=True, n=2)")
+        self.assertEqual(asdict(t), {'price_amount': 1.5, 'price_currency': 'USD', 'n': 2, 'on': True})
+        self.assertEqual(copy.copy(t), t)
+        t.on = False
+        self.assertEqual(T(Money(1.5), n=2), t)
+
+    def test_tuples_and_dicts(self):
+        from recordclass import asdicts, astuples
+        class Pk(dataobject, iterable=True):
+            name: str
+            flag: Packed[bool]
+            lvl: Packed[range(8)] = 0
+        p = Pk('a', True, 3)
+        self.assertEqual(len(p), 3)
+        self.assertEqual(tuple(p), ('a', True, 3))
+        self.assertEqual(astuple(p), ('a', True, 3))
+        self.assertEqual(astuples([p]), [('a', True, 3)])
+        self.assertEqual(asdicts([p]), [{'name': 'a', 'flag': True, 'lvl': 3}])
+        self.assertEqual(asdicts([p]), [asdict(p)])
+        with self.assertRaises(TypeError):
+            class S(dataobject, sequence=True):
+                on: Packed[bool]
+
+Vendor = datatype('Vendor', (dataobject,),
+                  {'__module__': __name__,
+                   '__annotations__': {'f%s' % i: object for i in range(100)},
+                   'f99': 0},
+                  sparse=True, iterable=True)
+
+class SparseTest(unittest.TestCase):
+
+    def test_layout(self):
+        self.assertEqual(Vendor.__fields__, ())
+        v = Vendor(f3=1, f70='x')
+        self.assertEqual((v.f0, v.f3, v.f70, v.f99), (None, 1, 'x', 0))
+        self.assertEqual(sys.getsizeof(v), sys.getsizeof(Vendor()) + 2 * ref_size)
+        self.assertLess(sys.getsizeof(Vendor()), pyobject_size + 4 * ref_size)
+
+    def test_assign(self):
+        v = Vendor(1, 2)
+        size = sys.getsizeof(v)
+        v.f50 = 'a'
+        v.f1 = None
+        v.f99 = 1
+        self.assertEqual(sys.getsizeof(v), size + ref_size)
+        self.assertEqual([(i, x) for i, x in enumerate(v) if x is not None], [(0, 1), (50, 'a'), (99, 1)])
+        v.f50 = None
+        v.f99 = 0
+        self.assertEqual(sys.getsizeof(v), size - ref_size)
+        update(v, f10=10)
+        self.assertEqual(v.f10, 10)
+        with self.assertRaises(AttributeError):
+            del v.f10
+        with self.assertRaises(TypeError):
+            Vendor(z=1)
+
+    def test_compare_copy_pickle(self):
+        v = Vendor(1, f64=[2], f98='x')
+        self.assertEqual(v, Vendor(1, f64=[2], f98='x'))
+        self.assertNotEqual(v, Vendor(1, f64=[2]))
+        self.assertEqual(list(v), [getattr(v, 'f%s' % i) for i in range(100)])
+        self.assertEqual(asdict(v)['f64'], [2])
+        self.assertEqual(copy.copy(v), v)
+        self.assertEqual(clone(v, f1=5).f1, 5)
+        self.assertEqual(pickle.loads(pickle.dumps(v)), v)
+
+    def test_tuples_and_dicts(self):
+        from recordclass import asdicts, astuples
+        class Sp(dataobject, sparse=True, iterable=True):
+            a: int = None
+            b: str = None
+        s = Sp(a=1, b='x')
+        self.assertEqual(len(s), 2)
+        self.assertEqual(len(Sp(b=2)), len(tuple(Sp(b=2))))
+        self.assertEqual(astuple(s), (1, 'x'))
+        self.assertEqual(astuple(Sp(b='y')), (None, 'y'))
+        self.assertEqual(astuples([s, Sp()]), [(1, 'x'), (None, None)])
+        self.assertEqual(asdicts([s, Sp()]), [{'a': 1, 'b': 'x'}, {'a': None, 'b': None}])
+        self.assertEqual(asdicts([s]), [asdict(s)])
+        self.assertEqual(len(Vendor(f3=1)), 100)
+
+    def test_options(self):
+        class P(dataobject, sparse=True, readonly=True, use_dict=True):
+            a: int = 0
+            b: str = None
+        p = P(1, b='x')
+        p.z = 2
+        self.assertEqual(repr(p), "P(a=1, b='x')")
+        self.assertEqual(hash(P(1)), hash(P(1)))
+        self.assertLess(P(1), P(2))
+        with self.assertRaises(AttributeError):
+            p.a = 2
+        with self.assertRaises(TypeError):
+            class G(dataobject, sparse=True, gc=True):
+                a: int
+        with self.assertRaises(TypeError):
+            class S(dataobject, sparse=True, sequence=True):
+                a: int
+        with self.assertRaises(TypeError):
+            class B(P):
+                pass
+
+    @unittest.skipIf(sys.version_info < (3, 9), "typing.Annotated is required")
+    def test_categorical(self):
+        from typing import Annotated
+        from recordclass import Categorical
+        with self.assertRaisesRegex(TypeError, 'Categorical'):
+            class C(dataobject, sparse=True):
+                a: Annotated[str, Categorical] = None
+
+from recordclass import changed_fields, changes, reset_changes
+
+class User(dataobject, track_changes=True, sequence=True):
+    id: int
+    name: str
+    email: str = None
+
+class TrackChangesTest(unittest.TestCase):
+
+    def test_constructor(self):
+        self.assertEqual(changed_fields(User(1, 'a')), ())
+        self.assertEqual(changed_fields(User(1, name='a', email='b')), ())
+        self.assertEqual(sys.getsizeof(User(1, 'a')), pyobject_size + 3 * ref_size + 8)
+        with self.assertRaises(TypeError):
+            changes(make_dataclass('A', 'x')(1))
+
+    def test_assign(self):
+        u = User(1, 'a')
+        u.name = 'b'
+        u[2] = 'c'
+        self.assertEqual(changed_fields(u), ('name', 'email'))
+        self.assertEqual(changes(u), {'name': 'b', 'email': 'c'})
+        reset_changes(u)
+        self.assertEqual(changes(u), {})
+        update(u, id=2)
+        self.assertEqual(changes(u), {'id': 2})
+        reset_changes(u)
+        User.__replacer__('name', inplace=True)(u, 'd')
+        self.assertEqual(changes(u), {'name': 'd'})
+
+    def test_copy(self):
+        u = User(1, 'a')
+        u.id = 2
+        # the new objects are clean
+        u2 = copy.copy(u)
+        self.assertEqual(u2, u)
+        self.assertEqual(changed_fields(u2), ())
+        self.assertEqual(changed_fields(pickle.loads(pickle.dumps(u))), ())
+        self.assertEqual(changed_fields(u), ('id',))
+        # only the fields assigned by clone are changed
+        self.assertEqual(changes(clone(u, email='e')), {'email': 'e'})
+
+    def test_options(self):
+        W = make_dataclass('W', ['f%s' % i for i in range(130)], track_changes=True, gc=True)
+        w = W()
+        w.f129 = 1
+        w.f64 = 2
+        w.f0 = 3
+        self.assertEqual(changed_fields(w), ('f0', 'f64', 'f129'))
+        class V(dataobject, track_changes=True, validate=True):
+            x: int
+        v = V(1)
+        with self.assertRaises(TypeError):
+            v.x = '2'
+        self.assertEqual(changes(v), {})
+        v.x = 2
+        self.assertEqual(changes(v), {'x': 2})
+        with self.assertRaises(TypeError):
+            class B(User):
+                pass
+        with self.assertRaises(TypeError):
+            class A(dataobject, track_changes=True, arena=True):
+                x: int
+
+from recordclass import diff, diffs, patch
+
+class DiffPatchTest(unittest.TestCase):
+
+    def test_diff(self):
+        class A(dataobject):
+            x: int
+            y: object
+            z: str = 'a'
+        y = [1]
+        self.assertEqual(diff(A(1, y), A(1, y)), ())
+        self.assertEqual(diff(A(1, [1]), A(1, [1], 'b')), ((2, 'b'),))
+        self.assertEqual(diff(A(1, 2), A(3, 2.0)), ((0, 3),))
+        with self.assertRaises(TypeError):
+            diff(A(1, 2), make_dataclass('B', 'x y z')(1, 2, 'a'))
+        with self.assertRaises(TypeError):
+            diff(A(1, 2), (1, 2, 'a'))
+
+    def test_patch(self):
+        A = make_dataclass('A', 'x y z', defaults=('a',))
+        a, b = A(1, 2), A(1, 3, 'b')
+        p = diff(a, b)
+        self.assertEqual(pickle.loads(pickle.dumps(p)), p)
+        self.assertEqual(patch(a, p), b)
+        self.assertEqual(a, A(1, 2))
+        self.assertIsNone(patch(a, p, inplace=True))
+        self.assertEqual(a, b)
+        with self.assertRaises(IndexError):
+            patch(a, ((3, 1),))
+        with self.assertRaises(TypeError):
+            patch(a, (1,))
+
+    def test_patch_readonly(self):
+        class R(dataobject, readonly=True, hashable=True):
+            x: int
+        a = R(1)
+        d = {a: 'v'}
+        self.assertEqual(patch(a, ((0, 2),)), R(2))
+        with self.assertRaises(TypeError):
+            patch(a, ((0, 2),), inplace=True)
+        self.assertEqual(a, R(1))
+        self.assertEqual(d[R(1)], 'v')
+        class F(dataobject, readonly=('y',)):
+            x: int
+            y: int
+        f = F(1, 2)
+        with self.assertRaises(TypeError):
+            patch(f, ((0, 3), (1, 4)), inplace=True)
+        self.assertEqual(f, F(1, 2))
+        patch(f, ((0, 3),), inplace=True)
+        self.assertEqual(f, F(3, 2))
+
+    def test_patch_tracked(self):
+        class A(dataobject, track_changes=True):
+            x: int
+            y: int
+        a = A(1, 2)
+        patch(a, diff(a, A(1, 3)), inplace=True)
+        self.assertEqual(changes(a), {'y': 3})
+
+    def test_diffs(self):
+        A = make_dataclass('A', 'x y')
+        self.assertEqual(diffs([A(1, 2), A(3, 4)], [A(1, 2), A(3, 5)]), [(), ((1, 5),)])
+        with self.assertRaises(ValueError):
+            diffs([A(1, 2)], [])
+
 def main():
     suite = unittest.TestSuite()
     suite.addTest(unittest.makeSuite(DataobjectTest))
+    suite.addTest(unittest.makeSuite(CategoricalTest))
+    suite.addTest(unittest.makeSuite(StatsTest))
+    suite.addTest(unittest.makeSuite(GCUntrackTest))
+    suite.addTest(unittest.makeSuite(ArenaTest))
+    suite.addTest(unittest.makeSuite(DeferredDeallocTest))
+    suite.addTest(unittest.makeSuite(FieldGetterTest))
+    suite.addTest(unittest.makeSuite(ReplacerTest))
+    suite.addTest(unittest.makeSuite(BatchTest))
+    suite.addTest(unittest.makeSuite(ConstructorCountsTest))
+    suite.addTest(unittest.makeSuite(ArityConstructorTest))
+    suite.addTest(unittest.makeSuite(ValidateTest))
+    suite.addTest(unittest.makeSuite(TailTest))
+    suite.addTest(unittest.makeSuite(InlineTest))
+    suite.addTest(unittest.makeSuite(PackedTest))
+    suite.addTest(unittest.makeSuite(SparseTest))
+    suite.addTest(unittest.makeSuite(TrackChangesTest))
+    suite.addTest(unittest.makeSuite(DiffPatchTest))
     return suite
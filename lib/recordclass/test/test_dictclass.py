@@ -0,0 +1,116 @@
+import unittest
+import sys
+import gc
+import weakref
+
+from recordclass import make_dictclass, dataobject
+
+class dictclassTest(unittest.TestCase):
+
+    def test_keys_values_items(self):
+        D = make_dictclass('D', 'a b c')
+        d = D(1, 2, 3)
+        self.assertEqual(list(d.keys()), ['a', 'b', 'c'])
+        self.assertEqual(list(d.values()), [1, 2, 3])
+        self.assertEqual(list(d.items()), [('a', 1), ('b', 2), ('c', 3)])
+        self.assertEqual(len(d.keys()), 3)
+        self.assertEqual(len(d.values()), 3)
+        self.assertEqual(len(d.items()), 3)
+        self.assertEqual(repr(d.keys()), "dataobject_keys(['a', 'b', 'c'])")
+        self.assertEqual(dict(d), {'a':1, 'b':2, 'c':3})
+
+    def test_views_are_live(self):
+        D = make_dictclass('D', 'a b')
+        d = D(1, 2)
+        items = d.items()
+        d['a'] = 10
+        self.assertEqual(list(items), [('a', 10), ('b', 2)])
+
+    def test_contains(self):
+        D = make_dictclass('D', 'a b')
+        d = D(1, 2)
+        self.assertTrue('a' in d)
+        self.assertFalse('z' in d)
+        self.assertFalse(1 in d)
+        self.assertTrue('b' in d.keys())
+        self.assertTrue(2 in d.values())
+        self.assertFalse(3 in d.values())
+        self.assertTrue(('a', 1) in d.items())
+        self.assertFalse(('a', 2) in d.items())
+        self.assertFalse(('z', 1) in d.items())
+        self.assertFalse('a' in d.items())
+        with self.assertRaises(TypeError):
+            [] in d
+
+    def test_setlike_views(self):
+        D = make_dictclass('D', 'a b')
+        d = D(1, 2)
+        self.assertEqual(d.keys(), {'a', 'b'})
+        self.assertEqual(d.keys(), {'a': 0, 'b': 0}.keys())
+        self.assertNotEqual(d.keys(), {'a'})
+        self.assertNotEqual(d.keys(), ['a', 'b'])
+        self.assertTrue(d.keys() > {'a'})
+        self.assertTrue(d.keys() <= {'a', 'b', 'c'})
+        self.assertEqual(d.keys() & {'a', 'z'}, {'a'})
+        self.assertEqual({'a', 'z'} & d.keys(), {'a'})
+        self.assertEqual(d.keys() | {'z'}, {'a', 'b', 'z'})
+        self.assertEqual(d.keys() - {'a'}, {'b'})
+        self.assertEqual(['a', 'z'] - d.keys(), {'z'})
+        self.assertEqual(d.keys() ^ {'a', 'z'}, {'b', 'z'})
+        self.assertTrue(d.keys().isdisjoint(['z']))
+        self.assertFalse(d.keys().isdisjoint(['b']))
+        self.assertEqual(d.items(), {('a', 1), ('b', 2)})
+        self.assertEqual(d.items() & {('a', 1), ('b', 3)}, {('a', 1)})
+        self.assertEqual(d.items(), {'a': 1, 'b': 2}.items())
+
+    def test_get(self):
+        D = make_dictclass('D', 'a b')
+        d = D(1, 2)
+        self.assertEqual(d.get('b'), 2)
+        self.assertIsNone(d.get('z'))
+        self.assertEqual(d.get('z', 0), 0)
+        self.assertEqual(d.get(1, 0), 0)
+
+    def test_update(self):
+        D = make_dictclass('D', 'a b')
+        d = D(1, 2)
+        d.update({'a':5})
+        self.assertEqual(dict(d), {'a':5, 'b':2})
+
+    def test_mapping_subclass(self):
+        class A(dataobject, mapping=True):
+            x: int
+            y: int
+        class B(A):
+            z: int = 3
+        b = B(1, 2)
+        self.assertEqual(list(b.items()), [('x', 1), ('y', 2), ('z', 3)])
+        self.assertTrue('z' in b)
+        self.assertEqual(b.get('z'), 3)
+        self.assertFalse('z' in A(1, 2))
+
+    def test_user_methods(self):
+        class A(dataobject, mapping=True):
+            x: int
+            def get(self, key, default=None):
+                return 'user'
+            def __contains__(self, key):
+                return True
+        a = A(1)
+        self.assertEqual(a.get('x'), 'user')
+        self.assertTrue('z' in a)
+        self.assertEqual(list(a.keys()), ['x'])
+
+    def test_gc(self):
+        D = make_dictclass('D', 'a')
+        d = D(1)
+        r = weakref.ref(type(d))
+        v = d.values()
+        self.assertTrue(gc.is_tracked(v))
+        del d, v, D
+        gc.collect()
+
+def main():
+    suite = unittest.TestSuite()
+    suite.addTest(unittest.makeSuite(dictclassTest))
+    return suite
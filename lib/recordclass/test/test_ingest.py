@@ -0,0 +1,140 @@
+import unittest
+import os
+import struct
+import tempfile
+from typing import Optional
+
+from recordclass import dataobject, make_arrayclass
+from recordclass.tools.ingest import read_csv, read_binary
+
+class Row(dataobject):
+    id: int
+    name: str
+    score: Optional[float]
+    flag: bool
+    data: bytes
+
+class IngestTest(unittest.TestCase):
+
+    def test_csv(self):
+        text = b'id,name,score,flag,data\n1,a,0.5,true,x\n2,"b,""c""",,0,\r\n\n-3,,1e3,False,"z"\n'
+        chunks = list(read_csv(text, Row))
+        self.assertEqual(sum(chunks, []), [
+            Row(1, 'a', 0.5, True, b'x'),
+            Row(2, 'b,"c"', None, False, b''),
+            Row(-3, '', 1000.0, False, b'z'),
+        ])
+
+    def test_csv_header_order(self):
+        text = b'flag,data,name,extra,id,score\n1,x,a,?,10,2.5\n'
+        rows = sum(read_csv(text, Row), [])
+        self.assertEqual(rows, [Row(10, 'a', 2.5, True, b'x')])
+
+    def test_csv_no_header(self):
+        class A(dataobject):
+            x: int
+            y: str
+        rows = sum(read_csv(b'1;a\n2;b', A, header=False, delimiter=';'), [])
+        self.assertEqual(rows, [A(1, 'a'), A(2, 'b')])
+
+    def test_csv_chunks(self):
+        class A(dataobject):
+            x: int
+            y: float
+        n = 10000
+        text = ''.join(f'{i},{i/4}\n' for i in range(n)).encode()
+        chunks = list(read_csv(text, A, header=False, chunk_size=1000, workers=4))
+        self.assertGreater(len(chunks), 1)
+        rows = sum(chunks, [])
+        self.assertEqual(rows, [A(i, i/4) for i in range(n)])
+
+    def test_csv_file(self):
+        class A(dataobject):
+            x: int
+            y: str
+        fd, path = tempfile.mkstemp(suffix='.csv')
+        try:
+            with os.fdopen(fd, 'wb') as f:
+                f.write(b'x,y\n1,a\n2,b\n')
+            rows = sum(read_csv(path, A), [])
+            self.assertEqual(rows, [A(1, 'a'), A(2, 'b')])
+        finally:
+            os.remove(path)
+
+    def test_csv_errors(self):
+        class A(dataobject):
+            x: int
+            y: int
+        with self.assertRaises(ValueError):
+            list(read_csv(b'1,b\n', A, header=False))
+        with self.assertRaises(ValueError):
+            list(read_csv(b'1\n', A, header=False))
+        with self.assertRaises(ValueError):
+            list(read_csv(b'99999999999999999999,1\n', A, header=False))
+        with self.assertRaises(TypeError):
+            list(read_csv(b'x,z\n1,2\n', A))
+
+    def test_csv_float(self):
+        class A(dataobject):
+            x: float
+        rows = sum(read_csv(b'1.5\n-inf\n 2e-3 \n', A, header=False), [])
+        self.assertEqual(rows, [A(1.5), A(float('-inf')), A(0.002)])
+        for text in (b'1.5.0\n', b'1.5x\n', b'0x10\n', b'1_0\n'):
+            with self.assertRaises(ValueError):
+                list(read_csv(text, A, header=False))
+
+    def test_lazy_open(self):
+        class A(dataobject):
+            x: int
+        path = os.path.join(tempfile.gettempdir(), 'recordclass-missing.csv')
+        it = read_csv(path, A)
+        with self.assertRaises(FileNotFoundError):
+            next(it)
+        fd, path = tempfile.mkstemp(suffix='.csv')
+        try:
+            with os.fdopen(fd, 'wb') as f:
+                f.write(b'x\n1\n2\n')
+            it = read_csv(path, A, chunk_size=1, workers=1)
+            self.assertEqual(next(it), [A(1)])
+            it.close()
+            self.assertEqual(sum(read_csv(path, A), []), [A(1), A(2)])
+        finally:
+            os.remove(path)
+
+    def test_binary(self):
+        class A(dataobject):
+            x: int
+            y: float
+            z: bytes
+            w: bool
+        fmt = '<hd3s?'
+        data = b''.join(struct.pack(fmt, i - 5, i / 2, b'abc', i % 2) for i in range(100))
+        rows = sum(read_binary(data, A, fmt, chunk_size=64, workers=3), [])
+        self.assertEqual(rows, [A(i - 5, i / 2, b'abc', bool(i % 2)) for i in range(100)])
+
+    def test_binary_native_arrayclass(self):
+        A = make_arrayclass('A', 3)
+        fmt = 'bQ2xf'
+        data = b''.join(struct.pack(fmt, -1, 2**64-1, 1.5) for i in range(3))
+        rows = sum(read_binary(data, A, fmt), [])
+        self.assertEqual([tuple(a) for a in rows], [(-1, 2**64-1, 1.5)] * 3)
+
+    def test_binary_big_endian(self):
+        class A(dataobject):
+            x: int
+            y: int
+        data = struct.pack('>iI', -7, 7)
+        self.assertEqual(sum(read_binary(data, A, '>iI'), []), [A(-7, 7)])
+
+    def test_binary_errors(self):
+        class A(dataobject):
+            x: int
+        with self.assertRaises(ValueError):
+            list(read_binary(b'123', A, 'i'))
+        with self.assertRaises(TypeError):
+            read_binary(b'1234', A, 'hh')
+
+def main():
+    suite = unittest.TestSuite()
+    suite.addTest(unittest.makeSuite(IngestTest))
+    return suite
@@ -0,0 +1,75 @@
+import unittest
+import sys
+
+from recordclass import dataobject, litelist, litetuple, mutabletuple, deep_sizeof
+
+class Node(dataobject):
+    value: object
+    next: object = None
+
+class NodeGC(dataobject, gc=True):
+    value: object
+    next: object = None
+
+class Item(dataobject, use_dict=True):
+    name: str
+
+class SizeofTest(unittest.TestCase):
+
+    def test_dataobject(self):
+        v = 1.5
+        a = Node(v)
+        self.assertEqual(deep_sizeof(a), sys.getsizeof(a) + sys.getsizeof(v) + sys.getsizeof(None))
+
+    def test_shared(self):
+        v = 'x' * 100
+        a = Node(v, Node(v))
+        self.assertEqual(deep_sizeof(a),
+                         2 * sys.getsizeof(a) + sys.getsizeof(v) + sys.getsizeof(None))
+
+    def test_cycle(self):
+        a = NodeGC(1)
+        a.next = a
+        self.assertEqual(deep_sizeof(a), sys.getsizeof(a) + sys.getsizeof(1))
+
+    def test_dict(self):
+        a = Item('a')
+        a.x = 2.5
+        expected = (sys.getsizeof(a) + sys.getsizeof('a') + sys.getsizeof(a.__dict__) +
+                    sys.getsizeof('x') + sys.getsizeof(2.5))
+        self.assertEqual(deep_sizeof(a), expected)
+
+    def test_containers(self):
+        items = [Node(float(i)) for i in range(3)]
+        for lst in (list(items), tuple(items), litelist(items), litetuple(*items), mutabletuple(*items)):
+            expected = (sys.getsizeof(lst) + sum(sys.getsizeof(x) + sys.getsizeof(x.value) for x in items) +
+                        sys.getsizeof(None))
+            self.assertEqual(deep_sizeof(lst), expected, type(lst))
+
+    def test_litelist_sizeof(self):
+        lst = litelist([])
+        for i in range(100):
+            lst.append(i)
+        self.assertGreaterEqual(lst.__sizeof__(), litelist([]).__sizeof__() + 100 * (sys.getsizeof((1,)) - sys.getsizeof(())))
+
+    def test_sparse(self):
+        class Sp(dataobject, sparse=True):
+            a: int = None
+            b: str = None
+        v, s = 10**30, 'x' * 1000
+        a = Sp(a=v, b=s)
+        self.assertEqual(deep_sizeof(a), sys.getsizeof(a) + sys.getsizeof(v) + sys.getsizeof(s))
+        self.assertEqual(deep_sizeof(Sp()), sys.getsizeof(Sp()))
+
+    def test_by_type(self):
+        items = [Node(i, NodeGC(float(i))) for i in range(5)]
+        report = deep_sizeof(items, by_type=True)
+        self.assertEqual(report[Node], (5, 5 * sys.getsizeof(items[0])))
+        self.assertEqual(report[NodeGC], (5, 5 * sys.getsizeof(items[0].next)))
+        self.assertEqual(report[list], (1, sys.getsizeof(items)))
+        self.assertEqual(sum(size for _, size in report.values()), deep_sizeof(items))
+
+def main():
+    suite = unittest.TestSuite()
+    suite.addTest(unittest.makeSuite(SizeofTest))
+    return suite
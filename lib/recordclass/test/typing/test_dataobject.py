@@ -1238,6 +1238,78 @@ class DataObjectTest3(unittest.TestCase):
         self.assertEqual(a.l, [])
         self.assertNotEqual(id(a.l), id(b.l))
 
+    def test_Factory_containers(self):
+        from recordclass import Factory
+        class L(list):
+            pass
+        class A(dataobject):
+            l: list = Factory(list)
+            d: dict = Factory(dict)
+            s: set = Factory(set)
+            sub: list = Factory(L)
+            n: int = Factory(int)
+
+        a = A()
+        b = A()
+        self.assertEqual((a.l, a.d, a.s, a.sub, a.n), ([], {}, set(), [], 0))
+        self.assertIs(type(a.sub), L)
+        self.assertIsNot(a.l, b.l)
+        self.assertIsNot(a.d, b.d)
+        self.assertIsNot(a.s, b.s)
+        with self.assertRaises(TypeError):
+            Factory()
+        with self.assertRaises(TypeError):
+            Factory(list, dict)
+
+    def test_copy_default_strategies(self):
+        from recordclass import Factory
+        class C:
+            copies = 0
+            def __copy__(self):
+                C.copies += 1
+                return C()
+        class K:
+            @classmethod
+            def __copy__(cls):
+                return 'copied'
+        c0, k0, t0 = C(), K(), (1, [])
+        class A(dataobject, copy_default=True):
+            l: list = [1]
+            d: dict = {1: 2}
+            s: set = {1}
+            f: list = Factory(list)
+            c: C = c0
+            k: K = k0
+            t: tuple = t0
+            n: object = None
+
+        self.assertIn('__default_copy__', A.__dict__)
+        a = A()
+        self.assertEqual((a.l, a.d, a.s, a.f), ([1], {1: 2}, {1}, []))
+        self.assertIsNot(a.l, A().l)
+        self.assertIsNot(a.d, A().d)
+        self.assertIsNot(a.s, A().s)
+        self.assertIsInstance(a.c, C)
+        self.assertIsNot(a.c, c0)
+        self.assertEqual(C.copies, 4)
+        self.assertEqual(a.k, 'copied')
+        self.assertIs(a.t, t0)
+        self.assertIsNone(a.n)
+        self.assertEqual(A(None, None, None).f, [])
+        with self.assertRaises(AttributeError):
+            A.__default_copy__ = ()
+
+    def test_copy_default_error(self):
+        from recordclass import Factory
+        def fail():
+            raise ValueError
+        class A(dataobject, copy_default=True):
+            l: list = []
+            x: object = Factory(fail)
+            y: list = []
+        with self.assertRaises(TypeError):
+            A()
+
 
 def main():
     suite = unittest.TestSuite()
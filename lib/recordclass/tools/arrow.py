@@ -0,0 +1,111 @@
+# coding: utf-8
+
+# The MIT License (MIT)
+
+# Copyright (c) «2015-2023» «Shibzukhov Zaur, szport at gmail dot com»
+
+# Permission is hereby granted, free of charge, to any person obtaining a copy
+# of this software - recordclass library - and associated documentation files
+# (the "Software"), to deal in the Software without restriction, including
+# without limitation the rights to use, copy, modify, merge, publish, distribute,
+# sublicense, and/or sell copies of the Software, and to permit persons to whom
+# the Software is furnished to do so, subject to the following conditions:
+
+# The above copyright notice and this permission notice shall be included in
+# all copies or substantial portions of the Software.
+
+# THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+# IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+# FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+# AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+# LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+# OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+# THE SOFTWARE.
+
+"""
+Export/import of dataobjects through Arrow C Data Interface.
+
+The result of the export is a pair of `arrow_schema`/`arrow_array` capsules
+of a struct array with a child array for each field. It can be consumed
+by any library supporting Arrow PyCapsule interface, for example:
+
+    >>> batch = pyarrow.RecordBatch._import_from_c_capsule(*to_arrow(rows))
+"""
+
+from recordclass._arrow import _export_rows, _export_columns, _import_rows, _check_layout
+import typing
+
+__all__ = 'to_arrow', 'columns_to_arrow', 'from_arrow', 'arrow_formats'
+
+_NoneType = type(None)
+
+_type_formats = {
+    int: 'l',
+    float: 'g',
+    bool: 'b',
+    str: 'u',
+    bytes: 'z',
+}
+
+_name_formats = {tp.__name__:fmt for tp, fmt in _type_formats.items()}
+
+def _arrow_format(tp):
+    if isinstance(tp, str):
+        fmt = _name_formats.get(tp, None)
+    else:
+        fmt = _type_formats.get(tp, None)
+    if fmt is not None:
+        return fmt
+
+    origin = getattr(tp, '__origin__', None)
+    if origin is typing.Union:
+        args = [a for a in tp.__args__ if a is not _NoneType]
+        if len(args) == 1:
+            return _arrow_format(args[0])
+    elif getattr(tp, '__metadata__', None) is not None:
+        # typing.Annotated
+        return _arrow_format(origin)
+
+    return None
+
+def arrow_formats(cls):
+    "Arrow format strings of the fields of the class `cls` resolved from `__annotations__`"
+    _check_layout(cls)
+    fields = cls.__fields__
+    if type(fields) is not tuple:
+        raise TypeError(f"{cls.__name__} has no named fields")
+    annotations = cls.__annotations__
+    formats = []
+    for fn in fields:
+        tp = annotations.get(fn, None)
+        fmt = _arrow_format(tp)
+        if fmt is None:
+            raise TypeError(f"field {fn}:{tp!r} can't be mapped to arrow type")
+        formats.append(fmt)
+    return tuple(formats)
+
+def to_arrow(rows, cls=None):
+    """Export a list of instances of `cls` into a pair of
+    (`arrow_schema`, `arrow_array`) capsules."""
+    if cls is None:
+        if not rows:
+            raise TypeError("cls is required for empty list of rows")
+        cls = type(rows[0])
+    return _export_rows(cls, rows, arrow_formats(cls))
+
+def columns_to_arrow(cls, columns):
+    """Export a columnar batch into a pair of (`arrow_schema`, `arrow_array`) capsules.
+    `columns` is a sequence of columns in the order of the fields or
+    a mapping of the field names to columns."""
+    if hasattr(columns, 'keys'):
+        columns = [columns[fn] for fn in cls.__fields__]
+    return _export_columns(cls, columns, arrow_formats(cls))
+
+def from_arrow(cls, data):
+    """Create a list of instances of `cls` from a pair of (`arrow_schema`, `arrow_array`)
+    capsules or from an object supporting `__arrow_c_array__` protocol.
+    The columns are matched with the fields by name."""
+    if hasattr(data, '__arrow_c_array__'):
+        data = data.__arrow_c_array__()
+    schema, array = data
+    return _import_rows(cls, schema, array)
@@ -0,0 +1,568 @@
+# coding: utf-8
+
+# The MIT License (MIT)
+
+# Copyright (c) «2015-2023» «Shibzukhov Zaur, szport at gmail dot com»
+
+# Permission is hereby granted, free of charge, to any person obtaining a copy
+# of this software - recordclass library - and associated documentation files
+# (the "Software"), to deal in the Software without restriction, including
+# without limitation the rights to use, copy, modify, merge, publish, distribute,
+# sublicense, and/or sell copies of the Software, and to permit persons to whom
+# the Software is furnished to do so, subject to the following conditions:
+
+# The above copyright notice and this permission notice shall be included in
+# all copies or substantial portions of the Software.
+
+# THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+# IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+# FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+# AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+# LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+# OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+# THE SOFTWARE.
+
+"""
+Benchmark suite for recordclass.
+
+It measures the time of the operations (ns per operation), the memory
+per object (tracemalloc), the peak RSS of the process and GC pauses
+for the classes with `gc=False`/`gc=True` and the state of the attribute
+access specialization for the fields. The results are saved as JSON
+and can be compared with the baseline in order to find regressions:
+
+    python -m recordclass.tools.benchmark -o new.json
+    python -m recordclass.tools.benchmark --compare base.json new.json
+    python -m recordclass.tools.benchmark --baseline base.json    # run and compare
+"""
+
+from recordclass import dataobject, litelist, litetuple, mutabletuple
+from recordclass import clone, Factory
+from recordclass.tools.perfcounts import Point, PointGC, PointSlots, PointNT, PointMap
+from timeit import Timer
+import copy
+import dis
+import gc
+import json
+import pickle
+import platform
+import sys
+import time
+import tracemalloc
+
+__all__ = 'run', 'run_specialization', 'compare', 'main'
+
+class PointKw(dataobject):
+    x: int
+    y: int
+    z: int
+
+class PointDefaults(dataobject):
+    x: int
+    y: int = 0
+    z: int = 0
+
+class PointFactory(dataobject):
+    x: int
+    y: list = Factory(list)
+    z: dict = Factory(dict)
+
+class PointHash(dataobject, hashable=True):
+    x: int
+    y: int
+    z: int
+
+class Node(dataobject):
+    left: object
+    right: object
+
+class NodeGC(dataobject, gc=True):
+    left: object
+    right: object
+
+# the instances with atomic values are untracked by cyclic GC
+class PointGCReadonly(dataobject, gc=True, readonly=True):
+    x: int
+    y: int
+    z: int
+
+def _tree(cls, depth):
+    if depth == 0:
+        return None
+    return cls(_tree(cls, depth-1), _tree(cls, depth-1))
+
+_benchmarks = []
+
+def bench(name):
+    """Register the function returning (statement, setup) callables as the benchmark `name`.
+    If setup is not None then it's called before each single execution of the statement."""
+    def register(func):
+        _benchmarks.append((name, func))
+        return func
+    return register
+
+## construction
+
+@bench('new.positional')
+def _():
+    return lambda: Point(1, 2, 3), None
+
+@bench('new.positional.gc')
+def _():
+    return lambda: PointGC(1, 2, 3), None
+
+@bench('new.keyword')
+def _():
+    return lambda: PointKw(x=1, y=2, z=3), None
+
+@bench('new.defaults')
+def _():
+    return lambda: PointDefaults(1), None
+
+@bench('new.factory')
+def _():
+    return lambda: PointFactory(1), None
+
+@bench('new.slots')
+def _():
+    return lambda: PointSlots(1, 2, 3), None
+
+@bench('new.namedtuple')
+def _():
+    return lambda: PointNT(1, 2, 3), None
+
+## attributes
+
+@bench('getattr')
+def _():
+    p = Point(1, 2, 3)
+    return lambda: p.x, None
+
+@bench('setattr')
+def _():
+    p = Point(1, 2, 3)
+    def f():
+        p.x = 1
+    return f, None
+
+@bench('getkey.mapping')
+def _():
+    p = PointMap(1, 2, 3)
+    return lambda: p['x'], None
+
+@bench('getitem')
+def _():
+    p = Point(1, 2, 3)
+    return lambda: p[1], None
+
+@bench('setitem')
+def _():
+    p = Point(1, 2, 3)
+    def f():
+        p[1] = 1
+    return f, None
+
+## protocols
+
+@bench('iterate')
+def _():
+    p = Point(1, 2, 3)
+    def f():
+        for x in p:
+            pass
+    return f, None
+
+@bench('hash')
+def _():
+    p = PointHash(1, 2, 3)
+    return lambda: hash(p), None
+
+@bench('compare.eq')
+def _():
+    p, q = Point(1, 2, 3), Point(1, 2, 3)
+    return lambda: p == q, None
+
+@bench('compare.lt')
+def _():
+    p, q = Point(1, 2, 3), Point(1, 2, 4)
+    return lambda: p < q, None
+
+@bench('copy')
+def _():
+    p = Point(1, 2, 3)
+    return lambda: copy.copy(p), None
+
+@bench('clone')
+def _():
+    p = Point(1, 2, 3)
+    return lambda: clone(p, y=0), None
+
+@bench('pickle.dumps')
+def _():
+    p = Point(1, 2, 3)
+    return lambda: pickle.dumps(p, -1), None
+
+@bench('pickle.loads')
+def _():
+    s = pickle.dumps(Point(1, 2, 3), -1)
+    return lambda: pickle.loads(s), None
+
+## litelist/litetuple
+
+@bench('litetuple.new')
+def _():
+    return lambda: litetuple(1, 2, 3), None
+
+@bench('litetuple.getitem')
+def _():
+    t = litetuple(1, 2, 3)
+    return lambda: t[1], None
+
+@bench('mutabletuple.setitem')
+def _():
+    t = mutabletuple(1, 2, 3)
+    def f():
+        t[1] = 1
+    return f, None
+
+@bench('litelist.new')
+def _():
+    return lambda: litelist([1, 2, 3]), None
+
+@bench('litelist.append')
+def _():
+    lst = litelist([])
+    def f():
+        lst.append(1)
+    return f, None
+
+@bench('litelist.getitem')
+def _():
+    lst = litelist([1, 2, 3])
+    return lambda: lst[1], None
+
+## dealloc
+
+def _dealloc(cls, depth):
+    trees = []
+    def setup():
+        trees.append(_tree(cls, depth))
+    def f():
+        trees.pop()
+    return f, setup
+
+@bench('dealloc.tree')
+def _():
+    return _dealloc(Node, 12)
+
+@bench('dealloc.tree.gc')
+def _():
+    return _dealloc(NodeGC, 12)
+
+def _time(func, setup, number, repeat):
+    # with setup the statement is executed once per setup call
+    if setup is None:
+        timer = Timer(func)
+        return min(timer.repeat(repeat, number)) / number * 1e9
+
+    best = None
+    for _ in range(repeat):
+        setup()
+        t0 = time.perf_counter()
+        func()
+        dt = time.perf_counter() - t0
+        if best is None or dt < best:
+            best = dt
+    return best * 1e9
+
+def run_timings(number=100000, repeat=5, select=None):
+    "Time the registered benchmarks: {name: ns_per_operation}"
+    timings = {}
+    for name, func in _benchmarks:
+        if select and not any(name.startswith(s) for s in select):
+            continue
+        stmt, setup = func()
+        timings[name] = _time(stmt, setup, number, repeat)
+    return timings
+
+_memory_cases = {
+    'dataobject': lambda i: Point(i, i, i),
+    'dataobject.gc': lambda i: PointGC(i, i, i),
+    'class+slots': lambda i: PointSlots(i, i, i),
+    'namedtuple': lambda i: PointNT(i, i, i),
+    'litetuple': lambda i: litetuple(i, i, i),
+    'mutabletuple': lambda i: mutabletuple(i, i, i),
+    'litelist': lambda i: litelist([i, i, i]),
+}
+
+def run_memory(n=100000):
+    "tracemalloc bytes per object: {name: bytes}"
+    memory = {}
+    values = list(range(n))
+    for name, make in _memory_cases.items():
+        gc.collect()
+        tracemalloc.start()
+        try:
+            before = tracemalloc.get_traced_memory()[0]
+            objects = [make(i) for i in values]
+            after = tracemalloc.get_traced_memory()[0]
+        finally:
+            tracemalloc.stop()
+        # the list of the objects is not counted
+        memory[name] = (after - before - sys.getsizeof(objects)) / n
+        del objects
+    return memory
+
+def run_gc(n=200000):
+    "GC pauses during creation of n objects and the time of full collection (ms)"
+    results = {}
+    for name, cls in (('gc=False', Point), ('gc=True', PointGC), ('gc=True,readonly', PointGCReadonly)):
+        pauses = []
+        start = [0.0]
+        def callback(phase, info):
+            if phase == 'start':
+                start[0] = time.perf_counter()
+            else:
+                pauses.append(time.perf_counter() - start[0])
+
+        gc.collect()
+        gc.callbacks.append(callback)
+        try:
+            objects = [cls(i, i, i) for i in range(n)]
+        finally:
+            gc.callbacks.remove(callback)
+        t0 = time.perf_counter()
+        gc.collect()
+        collect = time.perf_counter() - t0
+        del objects
+
+        results[name] = {
+            'collections': len(pauses),
+            'pause_total_ms': sum(pauses) * 1e3,
+            'pause_max_ms': max(pauses) * 1e3 if pauses else 0.0,
+            'collect_ms': collect * 1e3,
+        }
+    return results
+
+# {case: (options, store is expected to be specialized)}
+_specialization_cases = {
+    'plain': ({}, True),
+    'gc': ({'gc': True}, True),
+    'gc+readonly': ({'gc': True, 'readonly': True}, False),
+    'use_dict': ({'use_dict': True}, True),
+    'use_weakref': ({'use_weakref': True}, True),
+    'use_dict+use_weakref': ({'use_dict': True, 'use_weakref': True}, True),
+    'gc+use_dict': ({'gc': True, 'use_dict': True}, True),
+    'readonly': ({'readonly': True}, False),
+    'mapping': ({'mapping': True}, True),
+    'subclass': (None, True),
+}
+
+_ADAPTIVE = sys.version_info[:2] >= (3, 11)
+
+_probe_source = """
+def load(a):
+    return a.x
+def store(a, v):
+    a.x = v
+"""
+
+def _probe_functions():
+    # every case needs its own code objects: the specialization is stored in the code
+    ns = {}
+    exec(_probe_source, ns)
+    return ns['load'], ns['store']
+
+def _attr_opname(func):
+    for instr in dis.get_instructions(func, adaptive=True):
+        if 'ATTR' in instr.opname:
+            return instr.opname
+
+def _specialization_class(options):
+    if options is None:
+        class Base(dataobject):
+            x: int
+            y: int
+        class P(Base):
+            z: int = 0
+        return P
+    class P(dataobject, **options):
+        x: int
+        y: int
+    return P
+
+def run_specialization(warmup=1000, number=100000, repeat=5):
+    """Check that the field access is specialized as the access to __slots__.
+    Since 3.11 it's the opnames of LOAD_ATTR/STORE_ATTR after the warmup (from the adaptive
+    bytecode) and the flag `specialized` (for the operations expected to be specialized), otherwise it's the ratio of the time of the field
+    reading to the time of the reading of __slots__ attribute: {case: info}"""
+    results = {}
+    slots_load, _ = _probe_functions()
+    slots = PointSlots(1, 2, 3)
+    slots_time = None
+    for name, (options, store_expected) in _specialization_cases.items():
+        cls = _specialization_class(options)
+        load, store = _probe_functions()
+        a = cls(1, 2)
+        readonly = bool(options and options.get('readonly'))
+        for _ in range(warmup):
+            load(a)
+            if not readonly:
+                store(a, 1)
+        if _ADAPTIVE:
+            info = {'load': _attr_opname(load)}
+            if not readonly:
+                info['store'] = _attr_opname(store)
+            ops = [info['load']]
+            if store_expected:
+                ops.append(info['store'])
+            info['specialized'] = all(op.endswith('_SLOT') for op in ops)
+        else:
+            if slots_time is None:
+                slots_time = _time(lambda: slots_load(slots), None, number, repeat)
+            t = _time(lambda: load(a), None, number, repeat)
+            info = {'load_ns': t, 'slots_ratio': t / slots_time}
+        results[name] = info
+    return results
+
+def peak_rss_kb():
+    "Peak resident set size of the process in KB (None if it's unknown)"
+    try:
+        import resource
+    except ImportError:
+        return None
+    rss = resource.getrusage(resource.RUSAGE_SELF).ru_maxrss
+    if sys.platform == 'darwin':
+        rss //= 1024
+    return rss
+
+def run(number=100000, repeat=5, select=None, memory=True, gc_pauses=True, specialization=True):
+    "Run the benchmark suite and return the results as a dict"
+    import recordclass
+
+    results = {
+        'meta': {
+            'recordclass': recordclass.__version__,
+            'python': sys.version,
+            'implementation': platform.python_implementation(),
+            'platform': platform.platform(),
+            'time': time.strftime('%Y-%m-%dT%H:%M:%S'),
+            'number': number,
+            'repeat': repeat,
+        },
+        'timings': run_timings(number, repeat, select),
+    }
+    if memory:
+        results['memory'] = run_memory()
+    if gc_pauses:
+        results['gc'] = run_gc()
+    if specialization:
+        results['specialization'] = run_specialization(number=number, repeat=repeat)
+    results['peak_rss_kb'] = peak_rss_kb()
+    return results
+
+def compare(base, new, threshold=0.1):
+    """Compare the results `new` with the baseline `base`.
+    Return the list of (kind, name, base_value, new_value, ratio, is_regression).
+    The timing is regression if it is greater than baseline more than by `threshold` (relative),
+    the memory per object is regression if it is greater than baseline."""
+    rows = []
+    for name, t in new.get('timings', {}).items():
+        t0 = base.get('timings', {}).get(name)
+        if t0 is None:
+            continue
+        ratio = t / t0 if t0 else float('inf')
+        rows.append(('time', name, t0, t, ratio, ratio > 1 + threshold))
+    for name, m in new.get('memory', {}).items():
+        m0 = base.get('memory', {}).get(name)
+        if m0 is None:
+            continue
+        ratio = m / m0 if m0 else float('inf')
+        # the memory per object is quite exact, so 1 byte of noise is allowed
+        rows.append(('memory', name, m0, m, ratio, m > m0 + 1))
+    for name, g in new.get('gc', {}).items():
+        g0 = base.get('gc', {}).get(name)
+        if g0 is None:
+            continue
+        t0, t = g0['pause_total_ms'], g['pause_total_ms']
+        ratio = t / t0 if t0 else (1.0 if not t else float('inf'))
+        rows.append(('gc', name, t0, t, ratio, ratio > 1 + threshold))
+    for name, sp in new.get('specialization', {}).items():
+        sp0 = base.get('specialization', {}).get(name)
+        if sp0 is None or 'specialized' not in sp or 'specialized' not in sp0:
+            continue
+        # it's regression if the access to the fields is no longer specialized
+        v0, v = float(sp0['specialized']), float(sp['specialized'])
+        rows.append(('spec', name, v0, v, v / v0 if v0 else 1.0, v < v0))
+    return rows
+
+def format_results(results):
+    lines = []
+    for name, t in results.get('timings', {}).items():
+        lines.append(f"{name:<24} {t:10.1f} ns")
+    for name, m in results.get('memory', {}).items():
+        lines.append(f"{'memory.' + name:<24} {m:10.1f} bytes/object")
+    for name, g in results.get('gc', {}).items():
+        lines.append(f"{'gc.' + name:<24} {g['pause_total_ms']:10.2f} ms in {g['collections']} collections "
+                     f"(max {g['pause_max_ms']:.2f} ms, full collect {g['collect_ms']:.2f} ms)")
+    for name, sp in results.get('specialization', {}).items():
+        if 'specialized' in sp:
+            ops = ' '.join(sp[op] for op in ('load', 'store') if op in sp)
+            mark = '' if sp['specialized'] else 'NOT SPECIALIZED'
+            lines.append(f"{'spec.' + name:<24} {ops} {mark}")
+        else:
+            lines.append(f"{'spec.' + name:<24} {sp['load_ns']:10.1f} ns ({sp['slots_ratio']:.2f}x of __slots__)")
+    if results.get('peak_rss_kb') is not None:
+        lines.append(f"{'peak_rss':<24} {results['peak_rss_kb']:10d} KB")
+    return '\n'.join(lines)
+
+def format_comparison(rows):
+    lines = []
+    for kind, name, v0, v, ratio, regression in rows:
+        mark = 'REGRESSION' if regression else ''
+        lines.append(f"{kind:<7} {name:<24} {v0:12.2f} {v:12.2f} {ratio:7.2f}x {mark}")
+    return '\n'.join(lines)
+
+def main(argv=None):
+    import argparse
+
+    parser = argparse.ArgumentParser(prog='python -m recordclass.tools.benchmark',
+                                     description='Benchmark suite for recordclass')
+    parser.add_argument('-o', '--output', help='save the results into JSON file')
+    parser.add_argument('--baseline', help='compare the results with the baseline JSON file')
+    parser.add_argument('--compare', nargs=2, metavar=('BASE', 'NEW'),
+                        help='compare two JSON files without running the benchmarks')
+    parser.add_argument('--threshold', type=float, default=0.1,
+                        help='relative slowdown considered as regression (default 0.1)')
+    parser.add_argument('-n', '--number', type=int, default=100000)
+    parser.add_argument('-r', '--repeat', type=int, default=5)
+    parser.add_argument('-b', '--bench', action='append', help='run only the benchmarks with the prefix')
+    parser.add_argument('--no-memory', action='store_true')
+    parser.add_argument('--no-gc', action='store_true')
+    parser.add_argument('--no-spec', action='store_true')
+    args = parser.parse_args(argv)
+
+    if args.compare:
+        with open(args.compare[0]) as f:
+            base = json.load(f)
+        with open(args.compare[1]) as f:
+            new = json.load(f)
+    else:
+        new = run(args.number, args.repeat, args.bench,
+                  memory=not args.no_memory, gc_pauses=not args.no_gc,
+                  specialization=not args.no_spec)
+        print(format_results(new))
+        if args.output:
+            with open(args.output, 'w') as f:
+                json.dump(new, f, indent=2)
+        if not args.baseline:
+            return 0
+        with open(args.baseline) as f:
+            base = json.load(f)
+
+    rows = compare(base, new, args.threshold)
+    print(format_comparison(rows))
+    return 1 if any(row[-1] for row in rows) else 0
+
+if __name__ == '__main__':
+    sys.exit(main())
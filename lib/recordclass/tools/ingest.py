@@ -0,0 +1,286 @@
+# coding: utf-8
+
+# The MIT License (MIT)
+
+# Copyright (c) «2015-2023» «Shibzukhov Zaur, szport at gmail dot com»
+
+# Permission is hereby granted, free of charge, to any person obtaining a copy
+# of this software - recordclass library - and associated documentation files
+# (the "Software"), to deal in the Software without restriction, including
+# without limitation the rights to use, copy, modify, merge, publish, distribute,
+# sublicense, and/or sell copies of the Software, and to permit persons to whom
+# the Software is furnished to do so, subject to the following conditions:
+
+# The above copyright notice and this permission notice shall be included in
+# all copies or substantial portions of the Software.
+
+# THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+# IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+# FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+# AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+# LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+# OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+# THE SOFTWARE.
+
+"""
+Parallel ingest of csv/binary data into lists of dataobjects.
+
+The input is split into byte ranges, which are parsed into native values
+on a thread pool without GIL. The instances are created by batches
+on the consuming thread (or directly on the worker threads in free-threaded build).
+The result is an iterator of lists of instances in the order of the input:
+
+    >>> for rows in read_csv('data.csv', Row, workers=32):
+    ...     process(rows)
+"""
+
+from recordclass._ingest import _parse_csv, _parse_binary
+from concurrent.futures import ThreadPoolExecutor
+from collections import deque
+import csv as _csv
+import mmap as _mmap
+import os as _os
+import re as _re
+import struct as _struct
+import sys as _sys
+import typing
+
+__all__ = 'read_csv', 'read_binary'
+
+_NoneType = type(None)
+
+_type_kinds = {
+    int: 'i',
+    float: 'f',
+    bool: '?',
+    str: 's',
+    bytes: 'b',
+}
+
+_name_kinds = {tp.__name__:kind for tp, kind in _type_kinds.items()}
+
+def _field_kind(tp):
+    if isinstance(tp, str):
+        kind = _name_kinds.get(tp, None)
+    else:
+        kind = _type_kinds.get(tp, None)
+    if kind is not None:
+        return kind
+
+    origin = getattr(tp, '__origin__', None)
+    if origin is typing.Union:
+        args = [a for a in tp.__args__ if a is not _NoneType]
+        if len(args) == 1:
+            return _field_kind(args[0])
+    elif getattr(tp, '__metadata__', None) is not None:
+        # typing.Annotated
+        return _field_kind(origin)
+
+    # the value is passed as str
+    return 's'
+
+def _free_threaded():
+    is_gil_enabled = getattr(_sys, '_is_gil_enabled', None)
+    return is_gil_enabled is not None and not is_gil_enabled()
+
+class _Source:
+    """Context manager, which maps the file (or returns the buffer) on enter
+    and closes it on exit."""
+
+    def __init__(self, source):
+        self.source = source
+        self.file = None
+        self.data = None
+
+    def __enter__(self):
+        source = self.source
+        if isinstance(source, (str, _os.PathLike)):
+            self.file = open(source, 'rb')
+            try:
+                size = _os.fstat(self.file.fileno()).st_size
+                if size:
+                    self.data = _mmap.mmap(self.file.fileno(), 0, access=_mmap.ACCESS_READ)
+                else:
+                    self.data = b''
+            except:
+                self.file.close()
+                raise
+        else:
+            self.data = source
+        return self.data
+
+    def __exit__(self, *exc):
+        if self.file is not None:
+            if isinstance(self.data, _mmap.mmap):
+                self.data.close()
+            self.file.close()
+            self.file = None
+        self.data = None
+
+def _csv_ranges(data, start, chunk_size):
+    size = len(data)
+    while start < size:
+        stop = data.find(b'\n', min(start + chunk_size, size) - 1)
+        stop = size if stop < 0 else stop + 1
+        yield start, stop
+        start = stop
+
+def _binary_ranges(data, record_size, chunk_size):
+    size = len(data)
+    if size % record_size:
+        raise ValueError("the size of the data is not multiple of the record size")
+    step = max(chunk_size // record_size, 1) * record_size
+    return ((start, min(start + step, size)) for start in range(0, size, step))
+
+def _iter_chunks(source, prepare, cls, workers):
+    # the source is opened by the first step of the iteration, so it's never left open
+    # by the iterator, which isn't used or closed
+    if workers is None:
+        workers = _os.cpu_count() or 1
+    free_threaded = _free_threaded()
+
+    with _Source(source) as data:
+        parse, ranges = prepare(data)
+        if free_threaded:
+            def task(start, stop):
+                return parse(start, stop).build(cls)
+        else:
+            task = parse
+
+        def get_rows(future):
+            result = future.result()
+            return result if free_threaded else result.build(cls)
+
+        # the parsed chunks refer to the source buffer, so they should be released before closing
+        pending = deque()
+        try:
+            with ThreadPoolExecutor(workers) as executor:
+                for start, stop in ranges:
+                    pending.append(executor.submit(task, start, stop))
+                    if len(pending) >= 2 * workers:
+                        yield get_rows(pending.popleft())
+                while pending:
+                    yield get_rows(pending.popleft())
+        finally:
+            pending.clear()
+
+def read_csv(source, cls, *, header=True, delimiter=',', quotechar='"',
+             chunk_size=1<<20, workers=None):
+    """Read csv from `source` (file name or object supporting buffer protocol with `find` method,
+    for example `bytes` or `mmap`) into an iterator of lists of instances of `cls`.
+
+    The columns are matched with the fields by name when `header` is true (else by position).
+    The values of the fields annotated as `int`, `float`, `bool`, `bytes` (or `Optional` of them)
+    are converted on the worker threads (empty value is converted to `None`),
+    other fields get `str` value.
+    The quoted values should not contain line breaks.
+    The source is opened by the first step of the iteration and closed at the end
+    (or by `close()`) of the iterator.
+    """
+    fields = cls.__fields__
+    if type(fields) is not tuple:
+        raise TypeError(f"{cls.__name__} has no named fields")
+    annotations = getattr(cls, '__annotations__', {})
+    kinds = ''.join(_field_kind(annotations.get(fn, None)) for fn in fields)
+
+    quotechar = quotechar or ''
+
+    def prepare(data):
+        start = 0
+        if header:
+            stop = data.find(b'\n')
+            stop = len(data) if stop < 0 else stop + 1
+            line = bytes(data[:stop]).decode('utf-8').rstrip('\r\n')
+            if quotechar:
+                reader = _csv.reader([line], delimiter=delimiter, quotechar=quotechar)
+            else:
+                reader = _csv.reader([line], delimiter=delimiter, quoting=_csv.QUOTE_NONE)
+            names = next(reader, [])
+            names = [name.strip() for name in names]
+            columns = []
+            for fn in fields:
+                try:
+                    columns.append(names.index(fn))
+                except ValueError:
+                    raise TypeError(f"column '{fn}' is missing") from None
+            start = stop
+        else:
+            columns = range(len(fields))
+        columns = tuple(columns)
+
+        def parse(start, stop):
+            return _parse_csv(data, start, stop, delimiter, quotechar, kinds, columns)
+
+        return parse, _csv_ranges(data, start, chunk_size)
+
+    return _iter_chunks(source, prepare, cls, workers)
+
+_struct_item = _re.compile(r'\s*(\d*)([xcbB?hHiIlLqQnNfds])')
+
+_struct_kinds = {
+    'b':'i', 'h':'i', 'i':'i', 'l':'i', 'q':'i', 'n':'i',
+    'B':'u', 'H':'u', 'I':'u', 'L':'u', 'Q':'u', 'N':'u',
+    'f':'f', 'd':'f', '?':'?', 'c':'b', 's':'b',
+}
+
+def _binary_layout(fmt):
+    order = ''
+    if fmt and fmt[0] in '@=<>!':
+        order, fmt = fmt[0], fmt[1:]
+    layout = []
+    prefix = order
+    pos = 0
+    while pos < len(fmt):
+        m = _struct_item.match(fmt, pos)
+        if m is None:
+            if fmt[pos:].strip():
+                raise ValueError(f"unsupported struct format: {fmt!r}")
+            break
+        pos = m.end()
+        count, code = m.groups()
+        count = int(count) if count else 1
+        if code == 'x':
+            prefix += m.group(0).strip()
+            continue
+        offset = _struct.calcsize(prefix + '0' + code)
+        if code == 's':
+            layout.append((offset, 'b', count))
+            prefix += f'{count}s'
+        else:
+            size = _struct.calcsize(order + code)
+            for i in range(count):
+                layout.append((offset + i * size, _struct_kinds[code], size))
+            prefix += f'{count}{code}'
+    return tuple(layout), _struct.calcsize(order + fmt)
+
+def read_binary(source, cls, fmt, *, chunk_size=1<<20, workers=None):
+    """Read fixed size records from `source` (file name or object supporting buffer protocol)
+    into an iterator of lists of instances of `cls`.
+
+    The layout of the record is described by `fmt` in terms of `struct` module
+    (with codes `x`, `c`, `b`, `B`, `?`, `h`, `H`, `i`, `I`, `l`, `L`, `q`, `Q`, `n`, `N`, `f`, `d`, `s`).
+    Each value of the record is passed to the corresponding field of `cls` by position.
+    The source is opened by the first step of the iteration and closed at the end
+    (or by `close()`) of the iterator.
+    """
+    layout, record_size = _binary_layout(fmt)
+    n_fields = cls.__fields__
+    if type(n_fields) is tuple:
+        n_fields = len(n_fields)
+    if len(layout) != n_fields:
+        raise TypeError(f"the number of the values in the record ({len(layout)}) != the number of the fields ({n_fields})")
+    order = fmt[:1]
+    if order in ('>', '!'):
+        swap = _sys.byteorder == 'little'
+    elif order == '<':
+        swap = _sys.byteorder == 'big'
+    else:
+        swap = False
+
+    def prepare(data):
+        def parse(start, stop):
+            return _parse_binary(data, start, stop, record_size, layout, swap)
+
+        return parse, _binary_ranges(data, record_size, chunk_size)
+
+    return _iter_chunks(source, prepare, cls, workers)
@@ -387,7 +387,8 @@ def test_all(relative=True):
     
     return pt
 
-pt = test_all()
-print(pt)
-# print(pt.get_html_string())
+if __name__ == '__main__':
+    pt = test_all()
+    print(pt)
+    # print(pt.get_html_string())
 
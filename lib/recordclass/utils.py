@@ -156,6 +156,10 @@ def collect_info_from_bases(bases, fields, fields_dict, options):
     copy_default = options.get('copy_default', False)
     gc = options.get('gc', False)
     iterable = options.get('iterable', False)
+    stats = options.get('stats', False)
+    arena = options.get('arena', False)
+    deferred_dealloc = options.get('deferred_dealloc', False)
+    validate = options.get('validate', False)
     # others = {}
     for base in bases:
         if base is dataobject:
@@ -176,6 +180,18 @@ def collect_info_from_bases(bases, fields, fields_dict, options):
             iterable = iterable or base.__options__.get('iterable', False)
             if iterable:
                 options['iterable'] = True
+            stats = stats or base.__options__.get('stats', False)
+            if stats:
+                options['stats'] = True
+            arena = arena or base.__options__.get('arena', False)
+            if arena:
+                options['arena'] = True
+            deferred_dealloc = deferred_dealloc or base.__options__.get('deferred_dealloc', False)
+            if deferred_dealloc:
+                options['deferred_dealloc'] = True
+            validate = validate or base.__options__.get('validate', False)
+            if validate:
+                options['validate'] = True
         else:
             continue
 
@@ -27,6 +27,7 @@ from setuptools import setup, find_packages
 from setuptools.command.build_ext import build_ext
 from setuptools.extension import Extension
 import sys
+import os
 
 _PY310 = sys.version_info[:2] >= (3, 10)
 
@@ -35,6 +36,12 @@ _PY310 = sys.version_info[:2] >= (3, 10)
 extra_compile_args = []
 extra_link_args = []
 
+# RECORDCLASS_INSTRUMENT=1 enables the counters of the constructor branches
+# (see recordclass.constructor_counts)
+define_macros = []
+if os.environ.get('RECORDCLASS_INSTRUMENT', ''):
+    define_macros.append(('RECORDCLASS_INSTRUMENT', '1'))
+
 use_cython = 0
 
 if use_cython:
@@ -42,6 +49,7 @@ if use_cython:
         Extension(
             "recordclass._dataobject",
             ["lib/recordclass/_dataobject.c"],
+            define_macros = define_macros,
             # extra_compile_args = extra_compile_args,
             # extra_link_args = extra_link_args,
         ),
@@ -63,12 +71,37 @@ if use_cython:
             # extra_compile_args = extra_compile_args,
             # extra_link_args = extra_link_args,
         ),
+        Extension(
+            "recordclass._arrow",
+            ["lib/recordclass/_arrow.c"],
+            # extra_compile_args = extra_compile_args,
+            # extra_link_args = extra_link_args,
+        ),
+        Extension(
+            "recordclass._typedarray",
+            ["lib/recordclass/_typedarray.c"],
+            # extra_compile_args = extra_compile_args,
+            # extra_link_args = extra_link_args,
+        ),
+        Extension(
+            "recordclass._ingest",
+            ["lib/recordclass/_ingest.c"],
+            # extra_compile_args = extra_compile_args,
+            # extra_link_args = extra_link_args,
+        ),
+        Extension(
+            "recordclass._sizeof",
+            ["lib/recordclass/_sizeof.c"],
+            # extra_compile_args = extra_compile_args,
+            # extra_link_args = extra_link_args,
+        ),
     ]
 else:
     ext_modules = [
         Extension(
             "recordclass._dataobject",
             ["lib/recordclass/_dataobject.c"],
+            define_macros = define_macros,
             # extra_compile_args = extra_compile_args,
             # extra_link_args = extra_link_args,
         ),
@@ -90,6 +123,30 @@ else:
             # extra_compile_args = extra_compile_args,
             # extra_link_args = extra_link_args,
         ),
+        Extension(
+            "recordclass._arrow",
+            ["lib/recordclass/_arrow.c"],
+            # extra_compile_args = extra_compile_args,
+            # extra_link_args = extra_link_args,
+        ),
+        Extension(
+            "recordclass._typedarray",
+            ["lib/recordclass/_typedarray.c"],
+            # extra_compile_args = extra_compile_args,
+            # extra_link_args = extra_link_args,
+        ),
+        Extension(
+            "recordclass._ingest",
+            ["lib/recordclass/_ingest.c"],
+            # extra_compile_args = extra_compile_args,
+            # extra_link_args = extra_link_args,
+        ),
+        Extension(
+            "recordclass._sizeof",
+            ["lib/recordclass/_sizeof.c"],
+            # extra_compile_args = extra_compile_args,
+            # extra_link_args = extra_link_args,
+        ),
     ]
 
 description = """Mutable variant of namedtuple -- recordclass, which support assignments, compact dataclasses and other memory saving variants."""